@@ -344,8 +344,11 @@ static int assemble(Input input, const QInstaller::Settings &settings, const Bin
             tempFile, instExe.errorString()));
     }
 
-    QtPatch::patchBinaryFile(tempFile, QByteArray("MY_InstallerCreateDateTime_MY"),
+    QHash<QByteArray, QByteArray> placeholders;
+    placeholders.insert(QByteArray("MY_InstallerCreateDateTime_MY"),
         QDateTime::currentDateTime().toString(QLatin1String("yyyy-MM-dd - HH:mm:ss")).toLatin1());
+    if (!QtPatch::patchBinaryFiles(QStringList(tempFile), placeholders))
+        throw Error(QString::fromLatin1("Cannot patch the creation date into %1.").arg(tempFile));
 
 
     input.installerExePath = tempFile;
@@ -411,7 +414,9 @@ static int assemble(Input input, const QInstaller::Settings &settings, const Bin
                 collection.setName(info.name.toUtf8());
                 qDebug() << "Creating resource archive for" << info.name;
                 foreach (const QString &copiedFile, info.copiedFiles) {
-                    const QSharedPointer<Resource> resource(new Resource(copiedFile));
+                    // Referenced archives are streamed from their source file into the binary
+                    const QSharedPointer<Resource> resource(new Resource(info.sourceFiles
+                        .value(copiedFile, copiedFile), QFileInfo(copiedFile).fileName().toUtf8()));
                     qDebug().nospace() << "Appending " << copiedFile << " (" << humanReadableSize(resource->size()) << ")";
                     collection.appendResource(resource);
                 }
@@ -818,9 +823,10 @@ int QInstallerTools::createBinary(BinaryCreatorArgs args, QString &argumentError
                 &args.filteredPackages, args.ftype);
             // 2.2; copy the packages data and setup the packages vector with the files we copied,
             //    must happen before copying meta data because files will be compressed if
-            //    needed and meta data generation relies on this
+            //    needed and meta data generation relies on this. Existing archives are not
+            //    copied when streaming, assemble() reads them from the package directories.
             copyComponentData(args.packagesDirectories, tmpRepoDir, &preparedPackages,
-                args.archiveSuffix, args.compression);
+                args.archiveSuffix, args.compression, args.streamComponentData);
             // 2.3; add to common vector
             packages.append(preparedPackages);
         }
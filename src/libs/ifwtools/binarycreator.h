@@ -69,6 +69,7 @@ struct IFWTOOLS_EXPORT BinaryCreatorArgs
     bool compileResource = false;
     QString signingIdentity;
     bool createMaintenanceTool = false;
+    bool streamComponentData = true;
 };
 
 class BundleBackup
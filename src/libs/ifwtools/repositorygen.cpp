@@ -28,6 +28,8 @@
 
 #include "repositorygen.h"
 
+#include "archivemanifest.h"
+#include "binarydelta.h"
 #include "constants.h"
 #include "fileio.h"
 #include "fileutils.h"
@@ -89,13 +91,14 @@ void QInstallerTools::copyWithException(const QString &source, const QString &ta
     if (!targetFileInfo.dir().exists())
         QInstaller::mkpath(targetFileInfo.absolutePath());
 
-    QFile sourceFile(source);
-    if (!sourceFile.copy(target)) {
+    try {
+        QInstaller::copyFile(source, target);
+    } catch (const QInstaller::Error &error) {
         qDebug() << "failed!\n";
         throw QInstaller::Error(QString::fromLatin1("Cannot copy the %1 file from \"%2\" to \"%3\": "
             "%4").arg(kind, QDir::toNativeSeparators(source), QDir::toNativeSeparators(target),
             /* in case of an existing target the error String does not show the file */
-            (targetFileInfo.exists() ? QLatin1String("Target already exist.") : sourceFile.errorString())));
+            (targetFileInfo.exists() ? QLatin1String("Target already exist.") : error.message())));
     }
 
     qDebug() << "done.";
@@ -385,6 +388,25 @@ void QInstallerTools::copyMetaData(const QString &_targetDir, const QString &met
                                                                                                          .createTextNode(realContentFiles.join(QChar::fromLatin1(','))));
             }
 
+            // write binary deltas against the previously published archives
+            if (!info.deltaArchives.isEmpty()) {
+                QDomElement deltasElement = doc.createElement(QLatin1String("DeltaArchives"));
+                foreach (const DeltaArchiveInfo &delta, info.deltaArchives) {
+                    QDomElement deltaElement = doc.createElement(QLatin1String("DeltaArchive"));
+                    deltaElement.setAttribute(QLatin1String("archive"), delta.archive);
+                    deltaElement.setAttribute(QLatin1String("base"), delta.baseSha1);
+                    deltaElement.appendChild(doc.createTextNode(delta.file));
+                    deltasElement.appendChild(deltaElement);
+                }
+                update.appendChild(deltasElement);
+            }
+
+            // list the archives described by a manifest
+            if (!info.archiveManifests.isEmpty()) {
+                update.appendChild(doc.createElement(QLatin1String("ArchiveManifests"))).appendChild(doc
+                    .createTextNode(info.archiveManifests.join(QChar::fromLatin1(','))));
+            }
+
             // copy user interfaces
             const QStringList uiFiles = copyFilesFromNode(QLatin1String("UserInterfaces"),
                                                           QLatin1String("UserInterface"), QString(), QLatin1String("user interface"), package, info,
@@ -990,8 +1012,16 @@ void QInstallerTools::copyScriptFiles(const QDomNodeList &childNodes, const Pack
     }
 }
 
+/*
+    Copies the data of the packages in \a infos to \a repoDir, compressing the data directories
+    that are not archives yet. If \a referenceArchives is set, archives found in the data
+    directories and already known package files are not copied. The target names of referenced
+    archives are recorded in PackageInfo::copiedFiles as usual, PackageInfo::sourceFiles maps
+    them to the files to read the data from.
+*/
 void QInstallerTools::copyComponentData(const QStringList &packageDirs, const QString &repoDir,
-    PackageInfoVector *const infos, const QString &archiveSuffix, Compression compression)
+    PackageInfoVector *const infos, const QString &archiveSuffix, Compression compression,
+    bool referenceArchives)
 {
     for (int i = 0; i < infos->count(); ++i) {
         const PackageInfo info = infos->at(i);
@@ -1018,6 +1048,12 @@ void QInstallerTools::copyComponentData(const QStringList &packageDirs, const QS
                         if (archive && archive->open(QIODevice::ReadOnly) && archive->isSupported()) {
                             QFile tmp(absoluteEntryFilePath);
                             QString target = QString::fromLatin1("%1-%2-%3").arg(namedRepoDir, info.version, entry);
+                            if (referenceArchives) {
+                                qDebug() << "Referencing archive" << tmp.fileName() << "as" << target;
+                                (*infos)[i].sourceFiles.insert(target, absoluteEntryFilePath);
+                                compressedFiles.append(target);
+                                continue;
+                            }
                             qDebug() << "Copying archive from" << tmp.fileName() << "to" << target;
                             if (!tmp.copy(target)) {
                                 throw QInstaller::Error(QString::fromLatin1("Cannot copy file \"%1\" to \"%2\": %3")
@@ -1048,8 +1084,8 @@ void QInstallerTools::copyComponentData(const QStringList &packageDirs, const QS
             foreach (const QString &target, compressedFiles) {
                 (*infos)[i].copiedFiles.append(target);
 
-                QFile archiveFile(target);
-                QFile archiveHashFile(archiveFile.fileName() + QLatin1String(".sha1"));
+                QFile archiveFile((*infos)[i].sourceFiles.value(target, target));
+                QFile archiveHashFile(target + QLatin1String(".sha1"));
 
                 qDebug() << "Hash is stored in" << archiveHashFile.fileName();
                 qDebug() << "Creating hash of archive" << archiveFile.fileName();
@@ -1078,6 +1114,10 @@ void QInstallerTools::copyComponentData(const QStringList &packageDirs, const QS
                 QFileInfo fromInfo(file);
                 QFile from(file);
                 QString target = QString::fromLatin1("%1-%2").arg(namedRepoDir, fromInfo.fileName());
+                if (referenceArchives) {
+                    qDebug() << "Using file" << from.fileName() << "without copying";
+                    continue;
+                }
                 qDebug() << "Copying file from" << from.fileName() << "to" << target;
                 if (!from.copy(target)) {
                     throw QInstaller::Error(QString::fromLatin1("Cannot copy file \"%1\" to \"%2\": %3")
@@ -1088,6 +1128,103 @@ void QInstallerTools::copyComponentData(const QStringList &packageDirs, const QS
     }
 }
 
+void QInstallerTools::createDeltaArchives(const QString &repoDir, PackageInfoVector *const infos)
+{
+    // The versions published before this update, Updates.xml is not rewritten yet
+    QDomDocument doc;
+    QFile existingUpdatesXml(QFileInfo(repoDir, QLatin1String("Updates.xml")).absoluteFilePath());
+    if (!existingUpdatesXml.open(QIODevice::ReadOnly) || !doc.setContent(&existingUpdatesXml))
+        return;
+
+    QHash<QString, QString> publishedVersions;
+    const QDomNodeList packageNodes = doc.documentElement().childNodes();
+    for (int i = 0; i < packageNodes.count(); ++i) {
+        const QDomNode node = packageNodes.at(i);
+        if (node.nodeName() != QLatin1String("PackageUpdate"))
+            continue;
+        publishedVersions.insert(node.firstChildElement(QLatin1String("Name")).text(),
+            node.firstChildElement(QLatin1String("Version")).text());
+    }
+
+    for (int i = 0; i < infos->count(); ++i) {
+        PackageInfo &info = (*infos)[i];
+        const QString publishedVersion = publishedVersions.value(info.name);
+        if (publishedVersion.isEmpty() || publishedVersion == info.version)
+            continue;
+
+        const QString prefix = QString::fromLatin1("%1-%2-").arg(info.name, info.version);
+        const QString basePrefix = QString::fromLatin1("%1-%2-").arg(info.name, publishedVersion);
+        foreach (const QString &target, info.copiedFiles) {
+            const QString archive = QFileInfo(target).fileName();
+            if (archive.endsWith(QLatin1String(".sha1"), Qt::CaseInsensitive) || !archive.startsWith(prefix))
+                continue;
+
+            const QString base = QString::fromLatin1("%1/%2%3").arg(repoDir, basePrefix,
+                archive.mid(prefix.length()));
+            if (!QFileInfo::exists(base))
+                continue;
+
+            const QString source = info.sourceFiles.value(target, target);
+            const QString deltaFile = QString::fromLatin1("%1.from-%2.delta").arg(archive, publishedVersion);
+            const QString delta = QString::fromLatin1("%1/%2").arg(repoDir, deltaFile);
+            qDebug() << "Creating binary delta" << delta << "against" << base;
+            QInstaller::BinaryDelta::create(base, source, delta);
+
+            if (QFileInfo(delta).size() >= QFileInfo(source).size() / 4 * 3) {
+                qDebug() << "Discarding binary delta" << delta << ", it is not significantly "
+                    "smaller than the archive. Compressed archives rarely give small deltas.";
+                QFile::remove(delta);
+                continue;
+            }
+
+            DeltaArchiveInfo deltaInfo;
+            deltaInfo.archive = archive;
+            deltaInfo.file = deltaFile;
+            deltaInfo.baseSha1 = QLatin1String(QInstaller::calculateHash(base,
+                QCryptographicHash::Sha1).toHex());
+            info.deltaArchives.append(deltaInfo);
+        }
+    }
+}
+
+void QInstallerTools::createArchiveManifests(PackageInfoVector *const infos)
+{
+    for (int i = 0; i < infos->count(); ++i) {
+        PackageInfo &info = (*infos)[i];
+        const QString prefix = QString::fromLatin1("%1-%2-").arg(info.name, info.version);
+        foreach (const QString &target, info.copiedFiles) {
+            const QString archiveName = QFileInfo(target).fileName();
+            if (archiveName.endsWith(QLatin1String(".sha1"), Qt::CaseInsensitive) || !archiveName.startsWith(prefix))
+                continue;
+
+            const QString source = info.sourceFiles.value(target, target);
+            QScopedPointer<AbstractArchive> archive(ArchiveFactory::instance().create(source));
+            if (!archive || !archive->open(QIODevice::ReadOnly) || !archive->isSupported())
+                continue;
+
+            QTemporaryDir extractDir;
+            if (!extractDir.isValid()) {
+                throw QInstaller::Error(QString::fromLatin1("Cannot create temporary directory: %1")
+                    .arg(extractDir.errorString()));
+            }
+            if (!archive->extract(extractDir.path())) {
+                throw QInstaller::Error(QString::fromLatin1("Cannot extract archive \"%1\": %2")
+                    .arg(QDir::toNativeSeparators(source), archive->errorString()));
+            }
+
+            const QString manifest = QInstaller::ArchiveManifest::manifestFileName(target);
+            qDebug() << "Creating manifest" << manifest;
+            QInstaller::ArchiveManifest::fromDirectory(extractDir.path()).save(manifest);
+
+            // installers verify the manifest like the archive before relying on it
+            QFile manifestHashFile(manifest + QLatin1String(".sha1"));
+            QInstaller::openForWrite(&manifestHashFile);
+            manifestHashFile.write(QInstaller::calculateHash(manifest, QCryptographicHash::Sha1).toHex());
+            info.archiveManifests.append(archiveName);
+        }
+    }
+}
+
 void QInstallerTools::filterNewComponents(const QString &repositoryDir, QInstallerTools::PackageInfoVector &packages)
 {
     QDomDocument doc;
@@ -1175,7 +1312,7 @@ PackageInfoVector QInstallerTools::collectPackages(RepositoryInfo info, QStringL
 
 void QInstallerTools::createRepository(RepositoryInfo info, PackageInfoVector *packages,
         const QString &tmpMetaDir, bool createComponentMetadata, bool createUnifiedMetadata,
-        const QString &archiveSuffix, Compression compression)
+        const QString &archiveSuffix, Compression compression, bool createDeltas, bool createManifests)
 {
     QHash<QString, QString> pathToVersionMapping = QInstallerTools::buildPathToVersionMapping(*packages);
 
@@ -1192,6 +1329,10 @@ void QInstallerTools::createRepository(RepositoryInfo info, PackageInfoVector *p
         }
     }
     QInstallerTools::copyComponentData(directories, info.repositoryDir, packages, archiveSuffix, compression);
+    if (createDeltas)
+        QInstallerTools::createDeltaArchives(info.repositoryDir, packages);
+    if (createManifests)
+        QInstallerTools::createArchiveManifests(packages);
     QInstallerTools::copyMetaData(tmpMetaDir, info.repositoryDir, *packages, QLatin1String("{AnyApplication}"),
         QLatin1String(QUOTE(IFW_REPOSITORY_FORMAT_VERSION)), unite7zFiles);
 
@@ -41,6 +41,13 @@
 
 namespace QInstallerTools {
 
+struct IFWTOOLS_EXPORT DeltaArchiveInfo
+{
+    QString archive;
+    QString file;
+    QString baseSha1;
+};
+
 struct IFWTOOLS_EXPORT PackageInfo
 {
     QString name;
@@ -48,10 +55,13 @@ struct IFWTOOLS_EXPORT PackageInfo
     QString directory;
     QStringList dependencies;
     QStringList copiedFiles;
+    QHash<QString, QString> sourceFiles;
     QString metaFile;
     QString metaNode;
     QString contentSha1;
     bool createContentSha1Node;
+    QVector<DeltaArchiveInfo> deltaArchives;
+    QStringList archiveManifests;
 };
 typedef QVector<PackageInfo> PackageInfoVector;
 typedef QInstaller::AbstractArchive::CompressionLevel Compression;
@@ -94,7 +104,11 @@ void IFWTOOLS_EXPORT copyMetaData(const QString &outDir, const QString &dataDir,
     const QString &appName, const QString& appVersion, const QStringList &uniteMetadatas);
 void IFWTOOLS_EXPORT copyComponentData(const QStringList &packageDir, const QString &repoDir,
                                        PackageInfoVector *const infos, const QString &archiveSuffix,
-                                       Compression compression = Compression::Normal);
+                                       Compression compression = Compression::Normal,
+                                       bool referenceArchives = false);
+
+void IFWTOOLS_EXPORT createDeltaArchives(const QString &repoDir, PackageInfoVector *const infos);
+void IFWTOOLS_EXPORT createArchiveManifests(PackageInfoVector *const infos);
 
 void IFWTOOLS_EXPORT filterNewComponents(const QString &repositoryDir, QInstallerTools::PackageInfoVector &packages);
 
@@ -102,7 +116,8 @@ QString IFWTOOLS_EXPORT existingUniteMeta7z(const QString &repositoryDir);
 PackageInfoVector IFWTOOLS_EXPORT collectPackages(RepositoryInfo info, QStringList *filteredPackages, FilterType filterType, bool updateNewComponents, QStringList packagesUpdatedWithSha);
 void IFWTOOLS_EXPORT createRepository(RepositoryInfo info, PackageInfoVector *packages, const QString &tmpMetaDir,
                                       bool createComponentMetadata, bool createUnifiedMetadata, const QString &archiveSuffix,
-                                      Compression compression = Compression::Normal);
+                                      Compression compression = Compression::Normal, bool createDeltas = false,
+                                      bool createManifests = false);
 } // namespace QInstallerTools
 
 #endif // REPOSITORYGEN_H
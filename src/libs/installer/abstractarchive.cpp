@@ -164,6 +164,17 @@ void AbstractArchive::setCompressionLevel(const CompressionLevel level)
     m_compressionLevel = level;
 }
 
+/*!
+    Sets the entries that are not written to disk when extracting the archive to
+    \a paths. The paths are archive entry paths as returned by list(). Skipped entries
+    are neither reported with currentEntryChanged() nor touched on disk, but still
+    count towards the completed entries.
+*/
+void AbstractArchive::setSkippedEntries(const QSet<QString> &paths)
+{
+    m_skippedEntries = paths;
+}
+
 /*!
     Sets a human-readable description of the current \a error.
 */
@@ -180,6 +191,14 @@ AbstractArchive::CompressionLevel AbstractArchive::compressionLevel() const
     return m_compressionLevel;
 }
 
+/*!
+    Returns the entries that are not written to disk when extracting the archive.
+*/
+QSet<QString> AbstractArchive::skippedEntries() const
+{
+    return m_skippedEntries;
+}
+
 /*!
     Reads an \a entry from the specified \a istream. Returns a reference to \a istream.
 */
@@ -35,6 +35,7 @@
 #include <QDateTime>
 #include <QDataStream>
 #include <QPoint>
+#include <QSet>
 
 #ifdef Q_OS_WIN
 #define mode_t int
@@ -97,6 +98,7 @@ public:
     virtual bool isSupported() = 0;
 
     virtual void setCompressionLevel(const CompressionLevel level);
+    virtual void setSkippedEntries(const QSet<QString> &paths);
 
 Q_SIGNALS:
     void currentEntryChanged(const QString &filename);
@@ -108,10 +110,12 @@ public Q_SLOTS:
 protected:
     void setErrorString(const QString &error);
     CompressionLevel compressionLevel() const;
+    QSet<QString> skippedEntries() const;
 
 private:
     QString m_error;
     CompressionLevel m_compressionLevel;
+    QSet<QString> m_skippedEntries;
 };
 
 INSTALLER_EXPORT QDataStream &operator>>(QDataStream &istream, ArchiveEntry &entry);
@@ -0,0 +1,392 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "archivecache.h"
+
+#include "globals.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <algorithm>
+
+namespace QInstaller {
+
+static const QLatin1String scArchiveFile("archive");
+static const qint64 scBufferSize = 1024 * 1024;
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::CachedArchive
+    \brief The CachedArchive class represents a downloaded archive stored in
+           the \l{ArchiveCache}.
+
+    Each cached archive lives in a directory named after the SHA1 checksum
+    of the archive contents. The modification time of the archive file is
+    used as the last access time of the item.
+*/
+
+/*!
+    Constructs a new cached archive object.
+*/
+CachedArchive::CachedArchive()
+    : CacheableItem()
+    , m_size(-1)
+    , m_active(false)
+{
+}
+
+/*!
+    Constructs a new cached archive object with a \a path.
+*/
+CachedArchive::CachedArchive(const QString &path)
+    : CacheableItem(path)
+    , m_size(-1)
+    , m_active(false)
+{
+}
+
+/*!
+    Returns the checksum of this archive. Unless set explicitly with
+    \l{setChecksum()}, the checksum is the name of the item directory.
+*/
+QByteArray CachedArchive::checksum() const
+{
+    if (m_checksum.isEmpty())
+        m_checksum = QFileInfo(path()).fileName().toLatin1();
+
+    return m_checksum;
+}
+
+/*!
+    Sets the checksum of this archive to \a checksum.
+*/
+void CachedArchive::setChecksum(const QByteArray &checksum)
+{
+    m_checksum = checksum;
+}
+
+/*!
+    Returns \c true if the checksum of this archive is a hexadecimal SHA1
+    digest and the archive file exists, \c false otherwise.
+*/
+bool CachedArchive::isValid() const
+{
+    return ArchiveCache::isValidChecksum(checksum()) && QFileInfo(fileName()).isFile();
+}
+
+/*!
+    Returns \c true if the archive was fetched from or stored to the cache
+    during this session, \c false otherwise. Active archives are never evicted.
+*/
+bool CachedArchive::isActive() const
+{
+    return m_active;
+}
+
+/*!
+    Sets the active state of this archive to \a active.
+*/
+void CachedArchive::setActive(bool active)
+{
+    m_active = active;
+}
+
+/*!
+    Returns \c false, archives are identified by their contents and cannot
+    obsolete each other. The \a other item is ignored.
+*/
+bool CachedArchive::obsoletes(CacheableItem *other)
+{
+    Q_UNUSED(other)
+    return false;
+}
+
+/*!
+    Returns the path of the archive file inside the item directory.
+*/
+QString CachedArchive::fileName() const
+{
+    return path() + QLatin1Char('/') + scArchiveFile;
+}
+
+/*!
+    Returns the size of the archive file in bytes, or \c 0 if the
+    file does not exist.
+*/
+qint64 CachedArchive::size() const
+{
+    if (m_size < 0)
+        m_size = QFileInfo(fileName()).size();
+
+    return m_size;
+}
+
+/*!
+    Returns the time this archive was last stored to or fetched from the cache.
+*/
+QDateTime CachedArchive::lastUsed() const
+{
+    if (!m_lastUsed.isValid())
+        m_lastUsed = QFileInfo(fileName()).lastModified();
+
+    return m_lastUsed;
+}
+
+/*!
+    Updates the last access time of this archive to the current time.
+*/
+void CachedArchive::touch()
+{
+    m_lastUsed = QDateTime::currentDateTimeUtc();
+
+    QFile file(fileName());
+    if (file.open(QIODevice::ReadWrite))
+        file.setFileTime(m_lastUsed, QFileDevice::FileModificationTime);
+}
+
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::ArchiveCache
+    \brief The ArchiveCache class is a content addressed storage for downloaded
+           component archives.
+
+    ArchiveCache stores archives keyed by the SHA1 checksum of their contents,
+    so identical archives served by different repositories share a single
+    entry. When a \l{sizeLimit()} is set, the least recently used archives
+    are evicted once the total size of the cache exceeds the limit.
+
+    Like other caches based on \l{GenericDataCache}, the cache directory is
+    locked for the lifetime of the object. Another process trying to use the
+    same directory fails to initialize the cache and should download the
+    archives as usual.
+*/
+
+/*!
+    Constructs a new empty cache. The cache is invalid until set with a
+    path and initialized.
+*/
+ArchiveCache::ArchiveCache()
+    : GenericDataCache<CachedArchive>()
+    , m_sizeLimit(0)
+{
+    setType(QLatin1String("Archive"));
+    setVersion(QLatin1String("1.0.0"));
+}
+
+/*!
+    Constructs a cache to \a path. The cache is initialized automatically.
+*/
+ArchiveCache::ArchiveCache(const QString &path)
+    : GenericDataCache(path, QLatin1String("Archive"), QLatin1String("1.0.0"))
+    , m_sizeLimit(0)
+{
+}
+
+/*!
+    Returns the path of the archive cache inside \a localCachePath.
+*/
+QString ArchiveCache::archiveCachePath(const QString &localCachePath)
+{
+    return localCachePath + QLatin1String("/archives");
+}
+
+/*!
+    Returns \c true if \a checksum is a hexadecimal SHA1 digest that
+    can be used as a key for the cache, \c false otherwise.
+*/
+bool ArchiveCache::isValidChecksum(const QByteArray &checksum)
+{
+    if (checksum.size() != 40)
+        return false;
+
+    return std::all_of(checksum.constBegin(), checksum.constEnd(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+/*!
+    Returns the maximum total size of the cached archives in bytes. A value
+    of \c 0 means the size of the cache is not limited.
+*/
+qint64 ArchiveCache::sizeLimit() const
+{
+    return m_sizeLimit;
+}
+
+/*!
+    Sets the maximum total size of the cached archives to \a bytes.
+*/
+void ArchiveCache::setSizeLimit(qint64 bytes)
+{
+    m_sizeLimit = qMax<qint64>(0, bytes);
+}
+
+/*!
+    Copies the archive matching \a checksum from the cache to \a fileName.
+    The contents are verified against the checksum while copying, a corrupt
+    archive is removed from the cache. Returns \c true on success, \c false
+    if the archive is not cached or could not be copied.
+*/
+bool ArchiveCache::fetch(const QByteArray &checksum, const QString &fileName)
+{
+    if (!isValid() || !isValidChecksum(checksum))
+        return false;
+
+    CachedArchive *archive = itemByChecksum(checksum);
+    if (!archive)
+        return false;
+
+    QFile source(archive->fileName());
+    if (!source.open(QIODevice::ReadOnly)) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot open cached archive"
+            << source.fileName() << "for reading:" << source.errorString();
+        removeItem(checksum);
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QFile target(fileName);
+    if (!target.open(QIODevice::WriteOnly)) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot open" << fileName
+            << "for writing:" << target.errorString();
+        return false;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray buffer;
+    buffer.resize(scBufferSize);
+    bool success = true;
+    while (!source.atEnd()) {
+        const qint64 read = source.read(buffer.data(), buffer.size());
+        if (read < 0 || target.write(buffer.constData(), read) != read) {
+            success = false;
+            break;
+        }
+        hash.addData(buffer.constData(), int(read));
+    }
+    target.close();
+
+    if (!success || hash.result().toHex() != checksum) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot copy cached archive"
+            << source.fileName() << "to" << fileName << ". Removing the archive from cache.";
+        target.remove();
+        source.close();
+        removeItem(checksum);
+        return false;
+    }
+
+    archive->setActive(true);
+    archive->touch();
+    return true;
+}
+
+/*!
+    Copies the archive \a fileName with contents matching \a checksum to the cache.
+    Archives larger than the \l{sizeLimit()} are not stored. Least recently used
+    archives are evicted if the cache grows past its limit. Returns \c true if the
+    archive is available from the cache afterwards, \c false otherwise.
+*/
+bool ArchiveCache::store(const QByteArray &checksum, const QString &fileName)
+{
+    if (!isValid() || !isValidChecksum(checksum))
+        return false;
+
+    if (CachedArchive *archive = itemByChecksum(checksum)) {
+        archive->setActive(true);
+        archive->touch();
+        return true;
+    }
+
+    if (m_sizeLimit > 0 && QFileInfo(fileName).size() > m_sizeLimit)
+        return false;
+
+    // Stage the copy inside the cache directory, so registering the item is a rename
+    QTemporaryDir staging(path() + QLatin1String("/staging-XXXXXX"));
+    if (!staging.isValid()) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot create staging directory for"
+            << "archive cache:" << staging.errorString();
+        return false;
+    }
+
+    if (!QFile::copy(fileName, staging.path() + QLatin1Char('/') + scArchiveFile)) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot copy" << fileName
+            << "to archive cache.";
+        return false;
+    }
+
+    QScopedPointer<CachedArchive> archive(new CachedArchive(staging.path()));
+    archive->setChecksum(checksum);
+    archive->setActive(true);
+    if (!registerItem(archive.data(), true, Move))
+        return false;
+
+    archive.take()->touch();
+    evict();
+    sync();
+    return true;
+}
+
+/*!
+    Removes the least recently used archives that are not active until the total
+    size of the cache is within \l{sizeLimit()}.
+*/
+void ArchiveCache::evict()
+{
+    if (m_sizeLimit <= 0)
+        return;
+
+    QList<CachedArchive *> archives = items();
+    qint64 totalSize = 0;
+    for (const CachedArchive *archive : qAsConst(archives))
+        totalSize += archive->size();
+
+    if (totalSize <= m_sizeLimit)
+        return;
+
+    std::sort(archives.begin(), archives.end(), [](const CachedArchive *lhs, const CachedArchive *rhs) {
+        return lhs->lastUsed() < rhs->lastUsed();
+    });
+
+    for (const CachedArchive *archive : qAsConst(archives)) {
+        if (totalSize <= m_sizeLimit)
+            break;
+        if (archive->isActive())
+            continue;
+
+        const qint64 size = archive->size();
+        if (removeItem(archive->checksum())) // deletes the archive object
+            totalSize -= size;
+    }
+}
+
+} // namespace QInstaller
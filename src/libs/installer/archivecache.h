@@ -0,0 +1,90 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef ARCHIVECACHE_H
+#define ARCHIVECACHE_H
+
+#include "genericdatacache.h"
+
+#include <QDateTime>
+
+namespace QInstaller {
+
+class INSTALLER_EXPORT CachedArchive : public CacheableItem
+{
+public:
+    CachedArchive();
+    explicit CachedArchive(const QString &path);
+    ~CachedArchive() {}
+
+    QByteArray checksum() const override;
+    void setChecksum(const QByteArray &checksum);
+
+    bool isValid() const override;
+    bool isActive() const override;
+    void setActive(bool active);
+    bool obsoletes(CacheableItem *other) override;
+
+    QString fileName() const;
+    qint64 size() const;
+
+    QDateTime lastUsed() const;
+    void touch();
+
+private:
+    mutable QByteArray m_checksum;
+    mutable qint64 m_size;
+    mutable QDateTime m_lastUsed;
+
+    bool m_active;
+};
+
+class INSTALLER_EXPORT ArchiveCache : public GenericDataCache<CachedArchive>
+{
+public:
+    ArchiveCache();
+    explicit ArchiveCache(const QString &path);
+
+    static QString archiveCachePath(const QString &localCachePath);
+    static bool isValidChecksum(const QByteArray &checksum);
+
+    qint64 sizeLimit() const;
+    void setSizeLimit(qint64 bytes);
+
+    bool fetch(const QByteArray &checksum, const QString &fileName);
+    bool store(const QByteArray &checksum, const QString &fileName);
+
+    void evict();
+
+private:
+    qint64 m_sizeLimit;
+};
+
+} // namespace QInstaller
+
+#endif // ARCHIVECACHE_H
@@ -0,0 +1,243 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "archivemanifest.h"
+
+#include "errors.h"
+#include "fileio.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+using namespace QInstaller;
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::ArchiveManifest
+    \internal
+    \brief The ArchiveManifest class lists the size and SHA1 checksum of each file
+        contained in an archive.
+
+    Manifests are created by the repository generator next to the archives they describe
+    and are stored as UTF-8 encoded text, one file per line:
+
+    \code
+    <sha1> <size> <path>
+    \endcode
+
+    The path is relative to the root of the archive and uses forward slashes as
+    separators. The Extract operation uses the manifest of an archive to skip files that
+    are already installed with identical content.
+*/
+
+/*!
+    \class QInstaller::ArchiveManifest::Entry
+    \internal
+    \brief The Entry struct holds the size and raw SHA1 checksum of a file listed in
+        a manifest.
+*/
+
+namespace {
+
+QString normalizedPath(const QString &path)
+{
+    QString result = QDir::cleanPath(QDir::fromNativeSeparators(path));
+    if (result.startsWith(QLatin1String("./")))
+        result.remove(0, 2);
+    return result;
+}
+
+QByteArray sha1Sum(QFile *file)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(file))
+        return QByteArray();
+    return hash.result();
+}
+
+} // namespace
+
+/*!
+    Returns the file name of the manifest describing \a archive.
+*/
+QString ArchiveManifest::manifestFileName(const QString &archive)
+{
+    return archive + QLatin1String(".manifest");
+}
+
+/*!
+    Creates a manifest of all regular files found recursively in \a directory. Symbolic
+    links are not listed. Throws an \c Error if a file cannot be read.
+*/
+ArchiveManifest ArchiveManifest::fromDirectory(const QString &directory)
+{
+    ArchiveManifest manifest;
+    const QDir root(directory);
+    QDirIterator it(directory, QDir::Files | QDir::Hidden | QDir::System, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QFileInfo fi(it.next());
+        if (fi.isSymLink())
+            continue;
+
+        QFile file(fi.absoluteFilePath());
+        openForRead(&file);
+        Entry entry;
+        entry.size = file.size();
+        entry.sha1 = sha1Sum(&file);
+        if (entry.sha1.isEmpty()) {
+            throw Error(QCoreApplication::translate("ArchiveManifest",
+                "Cannot calculate checksum of \"%1\": %2").arg(QDir::toNativeSeparators(
+                file.fileName()), file.errorString()));
+        }
+        manifest.insert(root.relativeFilePath(fi.absoluteFilePath()), entry);
+    }
+    return manifest;
+}
+
+/*!
+    Reads the manifest from \a fileName, replacing the current entries. Returns \c false
+    and leaves the manifest empty if the file cannot be read or is malformed.
+*/
+bool ArchiveManifest::load(const QString &fileName)
+{
+    m_entries.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        const int sizeStart = line.indexOf(' ');
+        const int pathStart = line.indexOf(' ', sizeStart + 1);
+        if (sizeStart != 40 || pathStart < 0) {
+            m_entries.clear();
+            return false;
+        }
+
+        bool ok = false;
+        Entry entry;
+        entry.sha1 = QByteArray::fromHex(line.left(sizeStart));
+        entry.size = line.mid(sizeStart + 1, pathStart - sizeStart - 1).toLongLong(&ok);
+        if (!ok || entry.size < 0 || entry.sha1.size() != 20) {
+            m_entries.clear();
+            return false;
+        }
+        insert(QString::fromUtf8(line.mid(pathStart + 1)), entry);
+    }
+    return true;
+}
+
+/*!
+    Writes the manifest to \a fileName. Throws an \c Error if the file cannot be written.
+*/
+void ArchiveManifest::save(const QString &fileName) const
+{
+    QStringList paths = m_entries.keys();
+    paths.sort();
+
+    QByteArray data;
+    foreach (const QString &path, paths) {
+        const Entry entry = m_entries.value(path);
+        data += entry.sha1.toHex() + ' ' + QByteArray::number(entry.size) + ' '
+            + path.toUtf8() + '\n';
+    }
+
+    QFile file(fileName);
+    openForWrite(&file);
+    blockingWrite(&file, data);
+}
+
+/*!
+    Returns \c true if the manifest does not list any files.
+*/
+bool ArchiveManifest::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+/*!
+    Returns the number of files listed in the manifest.
+*/
+int ArchiveManifest::count() const
+{
+    return m_entries.count();
+}
+
+/*!
+    Returns \c true if the manifest lists the file at the archive relative \a path.
+*/
+bool ArchiveManifest::contains(const QString &path) const
+{
+    return m_entries.contains(normalizedPath(path));
+}
+
+/*!
+    Returns the entry for the archive relative \a path, or an entry with a size of
+    \c -1 if the manifest does not list it.
+*/
+ArchiveManifest::Entry ArchiveManifest::entry(const QString &path) const
+{
+    return m_entries.value(normalizedPath(path));
+}
+
+/*!
+    Adds \a entry for the archive relative \a path, replacing an existing one.
+*/
+void ArchiveManifest::insert(const QString &path, const Entry &entry)
+{
+    m_entries.insert(normalizedPath(path), entry);
+}
+
+/*!
+    Returns \c true if the regular file \a fileName has the same content as the file
+    listed for the archive relative \a path. The sizes are compared first, so files
+    of a different size are never read.
+*/
+bool ArchiveManifest::matches(const QString &path, const QString &fileName) const
+{
+    const auto it = m_entries.constFind(normalizedPath(path));
+    if (it == m_entries.constEnd())
+        return false;
+
+    const QFileInfo fi(fileName);
+    if (!fi.isFile() || fi.isSymLink() || fi.size() != it->size)
+        return false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return sha1Sum(&file) == it->sha1;
+}
@@ -0,0 +1,71 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef ARCHIVEMANIFEST_H
+#define ARCHIVEMANIFEST_H
+
+#include "installer_global.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+namespace QInstaller {
+
+class INSTALLER_EXPORT ArchiveManifest
+{
+public:
+    struct Entry
+    {
+        qint64 size = -1;
+        QByteArray sha1;
+    };
+
+    ArchiveManifest() = default;
+
+    static QString manifestFileName(const QString &archive);
+    static ArchiveManifest fromDirectory(const QString &directory);
+
+    bool load(const QString &fileName);
+    void save(const QString &fileName) const;
+
+    bool isEmpty() const;
+    int count() const;
+
+    bool contains(const QString &path) const;
+    Entry entry(const QString &path) const;
+    void insert(const QString &path, const Entry &entry);
+
+    bool matches(const QString &path, const QString &fileName) const;
+
+private:
+    QHash<QString, Entry> m_entries;
+};
+
+} // namespace QInstaller
+
+#endif // ARCHIVEMANIFEST_H
@@ -32,6 +32,7 @@
 #include "errors.h"
 #include "fileio.h"
 #include "fileutils.h"
+#include "operationlog.h"
 
 namespace QInstaller {
 
@@ -203,11 +204,15 @@ void BinaryContent::readBinaryContent(QFile *file, QList<OperationBlob> *operati
         }
         // read the operations count
         qint64 operationsCount = QInstaller::retrieveInt64(file);
-        // read the operations
-        for (int i = 0; i < operationsCount; ++i) {
-            const QString name = QInstaller::retrieveString(file);
-            const QString xml = QInstaller::retrieveString(file);
-            operations->append(OperationBlob(name, xml));
+        if (operationsCount == OperationLog::Marker) {
+            OperationLog::read(file, operations);
+        } else {
+            // read the operations
+            for (int i = 0; i < operationsCount; ++i) {
+                const QString name = QInstaller::retrieveString(file);
+                const QString xml = QInstaller::retrieveString(file);
+                operations->append(OperationBlob(name, xml));
+            }
         }
         // operations count
         Q_UNUSED(QInstaller::retrieveInt64(file)) // read it, but deliberately not used
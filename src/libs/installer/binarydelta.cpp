@@ -0,0 +1,356 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "binarydelta.h"
+
+#include "errors.h"
+#include "fileio.h"
+#include "utils.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+
+#include <cstring>
+
+using namespace QInstaller;
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::BinaryDelta
+    \internal
+    \brief The BinaryDelta class creates and applies binary deltas between two versions
+        of a file.
+
+    A delta describes the target file as a sequence of byte ranges copied from the source
+    file and literal bytes inserted from the delta itself. Matching ranges are found with
+    a rolling checksum over fixed size blocks of the source, similar to rsync. The delta
+    consists of:
+
+    \list
+        \li The magic number \c Magic and the format version.
+        \li The sizes and SHA1 checksums of the source and target files.
+        \li A list of \c Copy and \c Insert commands, terminated by an \c End command.
+    \endlist
+
+    Applying a delta verifies the source file before and the produced target file
+    after reconstructing it.
+*/
+
+namespace {
+
+enum Command : quint8 {
+    End = 0,
+    Copy = 1,
+    Insert = 2
+};
+
+const QDataStream::Version scStreamVersion = QDataStream::Qt_5_15;
+const qint64 scMinimumBlockSize = 32;
+const qint64 scMaximumBlockCount = 2 * 1024 * 1024;
+const quint32 scMaximumInsertSize = 1024 * 1024;
+const int scHashSize = 20;
+
+/*
+    Read-only view of a whole file, memory mapped where possible.
+*/
+class FileView
+{
+    Q_DISABLE_COPY(FileView)
+
+public:
+    explicit FileView(const QString &fileName)
+        : m_file(fileName)
+        , m_data(nullptr)
+    {
+        openForRead(&m_file);
+        if (m_file.size() > 0)
+            m_data = m_file.map(0, m_file.size());
+        if (!m_data) {
+            m_buffer = m_file.readAll();
+            m_data = reinterpret_cast<const uchar *>(m_buffer.constData());
+        }
+    }
+
+    const uchar *data() const { return m_data; }
+    qint64 size() const { return m_file.size(); }
+
+    QByteArray sha1() const
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (qint64 offset = 0; offset < size(); offset += scMaximumInsertSize) {
+            hash.addData(reinterpret_cast<const char *>(m_data + offset),
+                int(qMin<qint64>(scMaximumInsertSize, size() - offset)));
+        }
+        return hash.result();
+    }
+
+private:
+    QFile m_file;
+    QByteArray m_buffer;
+    const uchar *m_data;
+};
+
+/*
+    Adler-32 like checksum that can be rolled over the data one byte at a time.
+*/
+class RollingChecksum
+{
+public:
+    explicit RollingChecksum(qint64 length)
+        : m_a(0)
+        , m_b(0)
+        , m_length(quint32(length))
+    {}
+
+    void reset(const uchar *data)
+    {
+        m_a = m_b = 0;
+        for (quint32 i = 0; i < m_length; ++i) {
+            m_a += data[i];
+            m_b += (m_length - i) * data[i];
+        }
+    }
+
+    void roll(uchar out, uchar in)
+    {
+        m_a += in - out;
+        m_b += m_a - m_length * out;
+    }
+
+    quint32 value() const { return (m_a & 0xffff) | (m_b << 16); }
+
+private:
+    quint32 m_a;
+    quint32 m_b;
+    quint32 m_length;
+};
+
+void writeInsert(QDataStream &stream, const uchar *data, qint64 length)
+{
+    while (length > 0) {
+        const quint32 chunk = quint32(qMin<qint64>(length, scMaximumInsertSize));
+        stream << quint8(Insert) << chunk;
+        stream.writeRawData(reinterpret_cast<const char *>(data), int(chunk));
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void throwCorrupt(const QString &fileName)
+{
+    throw Error(QCoreApplication::translate("BinaryDelta", "The binary delta \"%1\" is corrupt.")
+        .arg(fileName));
+}
+
+} // namespace
+
+/*!
+    Writes a delta to \a deltaFileName that reconstructs \a targetFileName from
+    \a sourceFileName. Throws Error if a file cannot be read or written.
+*/
+void BinaryDelta::create(const QString &sourceFileName, const QString &targetFileName,
+    const QString &deltaFileName)
+{
+    const FileView source(sourceFileName);
+    const FileView target(targetFileName);
+
+    QFile deltaFile(deltaFileName);
+    openForWrite(&deltaFile);
+
+    QDataStream stream(&deltaFile);
+    stream.setVersion(scStreamVersion);
+    stream << quint32(Magic) << quint32(Version) << quint64(source.size()) << quint64(target.size());
+    stream.writeRawData(source.sha1().constData(), scHashSize);
+    stream.writeRawData(target.sha1().constData(), scHashSize);
+
+    // Keep the block index bounded for large sources
+    qint64 blockSize = scMinimumBlockSize;
+    while (source.size() / blockSize > scMaximumBlockCount)
+        blockSize *= 2;
+
+    QHash<quint32, qint64> blocks;
+    blocks.reserve(int(source.size() / blockSize));
+    RollingChecksum checksum(blockSize);
+    for (qint64 offset = 0; offset + blockSize <= source.size(); offset += blockSize) {
+        checksum.reset(source.data() + offset);
+        if (!blocks.contains(checksum.value()))
+            blocks.insert(checksum.value(), offset);
+    }
+
+    const uchar *const sourceData = source.data();
+    const uchar *const targetData = target.data();
+    qint64 pending = 0; // start of the bytes not yet written to the delta
+    qint64 position = 0;
+    bool checksumValid = false;
+    while (position + blockSize <= target.size()) {
+        if (!checksumValid) {
+            checksum.reset(targetData + position);
+            checksumValid = true;
+        }
+
+        const auto it = blocks.constFind(checksum.value());
+        if (it != blocks.constEnd()
+                && std::memcmp(sourceData + it.value(), targetData + position, size_t(blockSize)) == 0) {
+            qint64 sourceStart = it.value();
+            qint64 targetStart = position;
+            while (targetStart > pending && sourceStart > 0
+                    && sourceData[sourceStart - 1] == targetData[targetStart - 1]) {
+                --sourceStart;
+                --targetStart;
+            }
+            qint64 length = position + blockSize - targetStart;
+            while (sourceStart + length < source.size() && targetStart + length < target.size()
+                    && sourceData[sourceStart + length] == targetData[targetStart + length]) {
+                ++length;
+            }
+
+            writeInsert(stream, targetData + pending, targetStart - pending);
+            stream << quint8(Copy) << quint64(sourceStart) << quint64(length);
+
+            position = targetStart + length;
+            pending = position;
+            checksumValid = false;
+            continue;
+        }
+
+        if (position + blockSize < target.size())
+            checksum.roll(targetData[position], targetData[position + blockSize]);
+        ++position;
+    }
+    writeInsert(stream, targetData + pending, target.size() - pending);
+    stream << quint8(End);
+
+    if (stream.status() != QDataStream::Ok || !deltaFile.flush()) {
+        throw Error(QCoreApplication::translate("BinaryDelta", "Cannot write binary delta "
+            "\"%1\": %2").arg(deltaFileName, deltaFile.errorString()));
+    }
+}
+
+/*!
+    Reconstructs \a targetFileName by applying the delta \a deltaFileName to
+    \a sourceFileName. Returns the SHA1 checksum of the reconstructed file.
+
+    Throws Error if the delta was not created for the contents of the source file,
+    if the delta is corrupt, or if the reconstructed file does not match the checksum
+    recorded in the delta.
+*/
+QByteArray BinaryDelta::apply(const QString &sourceFileName, const QString &deltaFileName,
+    const QString &targetFileName)
+{
+    QFile source(sourceFileName);
+    openForRead(&source);
+
+    QFile deltaFile(deltaFileName);
+    openForRead(&deltaFile);
+
+    QDataStream stream(&deltaFile);
+    stream.setVersion(scStreamVersion);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint64 sourceSize = 0;
+    quint64 targetSize = 0;
+    stream >> magic >> version >> sourceSize >> targetSize;
+    QByteArray sourceSha1(scHashSize, '\0');
+    QByteArray targetSha1(scHashSize, '\0');
+    if (stream.readRawData(sourceSha1.data(), scHashSize) != scHashSize
+            || stream.readRawData(targetSha1.data(), scHashSize) != scHashSize
+            || magic != quint32(Magic)) {
+        throwCorrupt(deltaFileName);
+    }
+    if (version != quint32(Version)) {
+        throw Error(QCoreApplication::translate("BinaryDelta", "Unsupported binary delta "
+            "version %1.").arg(version));
+    }
+
+    if (quint64(source.size()) != sourceSize
+            || calculateHash(&source, QCryptographicHash::Sha1) != sourceSha1) {
+        throw Error(QCoreApplication::translate("BinaryDelta", "The binary delta \"%1\" "
+            "does not apply to \"%2\".").arg(deltaFileName, sourceFileName));
+    }
+
+    QFile target(targetFileName);
+    openForWrite(&target);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray buffer;
+    quint64 written = 0;
+    forever {
+        quint8 command = End;
+        stream >> command;
+        if (stream.status() != QDataStream::Ok)
+            throwCorrupt(deltaFileName);
+        if (command == End)
+            break;
+
+        if (command == Copy) {
+            quint64 offset = 0;
+            quint64 length = 0;
+            stream >> offset >> length;
+            if (stream.status() != QDataStream::Ok || offset > sourceSize
+                    || length > sourceSize - offset || length > targetSize - written
+                    || !source.seek(qint64(offset))) {
+                throwCorrupt(deltaFileName);
+            }
+            written += length;
+            while (length > 0) {
+                buffer.resize(int(qMin<quint64>(length, scMaximumInsertSize)));
+                if (source.read(buffer.data(), buffer.size()) != buffer.size())
+                    throwCorrupt(deltaFileName);
+                hash.addData(buffer);
+                blockingWrite(&target, buffer);
+                length -= quint64(buffer.size());
+            }
+        } else if (command == Insert) {
+            quint32 length = 0;
+            stream >> length;
+            if (stream.status() != QDataStream::Ok || length > scMaximumInsertSize
+                    || length > targetSize - written) {
+                throwCorrupt(deltaFileName);
+            }
+            buffer.resize(int(length));
+            if (stream.readRawData(buffer.data(), int(length)) != int(length))
+                throwCorrupt(deltaFileName);
+            hash.addData(buffer);
+            blockingWrite(&target, buffer);
+            written += length;
+        } else {
+            throwCorrupt(deltaFileName);
+        }
+    }
+
+    const QByteArray result = hash.result();
+    if (written != targetSize || result != targetSha1) {
+        throw Error(QCoreApplication::translate("BinaryDelta", "Checksum mismatch while "
+            "applying binary delta \"%1\".").arg(deltaFileName));
+    }
+    return result;
+}
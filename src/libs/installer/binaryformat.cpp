@@ -30,6 +30,7 @@
 
 #include "errors.h"
 #include "fileio.h"
+#include "fileutils.h"
 
 #include <QFileInfo>
 #include <QFlags>
@@ -51,6 +52,16 @@ namespace QInstaller {
     \a x for the XML representation of the operation.
 */
 
+/*!
+    \fn QInstaller::OperationBlob::OperationBlob(const QString &n, const QString &c, const QByteArray &r, const QStringList &s)
+
+    Constructs the operation blob for an operation read from an operation log. \a n stands for
+    the name of the operation, \a c for the component it belongs to, \a r for its binary record,
+    and \a s for the string table of the log.
+
+    \sa OperationLog
+*/
+
 /*!
     \variable QInstaller::OperationBlob::name
     \brief The name of the operation.
@@ -61,6 +72,21 @@ namespace QInstaller {
     \brief The XML representation of the operation.
 */
 
+/*!
+    \variable QInstaller::OperationBlob::component
+    \brief The name of the component the operation belongs to, if read from an operation log.
+*/
+
+/*!
+    \variable QInstaller::OperationBlob::record
+    \brief The binary record of the operation, if read from an operation log.
+*/
+
+/*!
+    \variable QInstaller::OperationBlob::strings
+    \brief The string table of the operation log the record refers to.
+*/
+
 /*!
     \class QInstaller::Resource
     \inmodule QtInstallerFramework
@@ -231,9 +257,23 @@ qint64 Resource::writeData(const char* data, qint64 maxSize)
     \overload
 
     Copies the resource data of \a resource to a file called \a out. Throws Error on failure.
+
+    If \a out is a local file, the segment is copied from the underlying file with
+    QInstaller::copyFileSegment(), which shares or copies the data inside the kernel
+    where the file system allows it.
 */
 void Resource::copyData(Resource *resource, QFileDevice *out)
 {
+    QFile *const target = qobject_cast<QFile *>(out);
+    if (target && resource->pos() == 0) {
+        QFile source(resource->m_file.fileName());
+        if (source.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+            copyFileSegment(&source, resource->m_segment.start(), resource->size(), target);
+            resource->seek(resource->size());
+            return;
+        }
+    }
+
     qint64 left = resource->size();
     char data[4096];
     while (left > 0) {
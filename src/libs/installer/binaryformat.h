@@ -42,8 +42,13 @@ namespace QInstaller {
 struct OperationBlob {
     OperationBlob(const QString &n, const QString &x)
         : name(n), xml(x) {}
+    OperationBlob(const QString &n, const QString &c, const QByteArray &r, const QStringList &s)
+        : name(n), component(c), record(r), strings(s) {}
     QString name;
     QString xml;
+    QString component;
+    QByteArray record;
+    QStringList strings;
 };
 
 
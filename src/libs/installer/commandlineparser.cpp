@@ -238,6 +238,12 @@ CommandLineParser::CommandLineParser()
                       "to let the application determine the ideal thread count from the amount of logical "
                       "processor cores in the system."),
         QLatin1String("threads")));
+    addOption(QCommandLineOption(QStringList()
+        << CommandLineOptions::scTraceFileShort << CommandLineOptions::scTraceFileLong,
+        QLatin1String("Records the duration of installer phases like metadata fetching, archive "
+                      "downloads, operations and script calls to a binary trace file. Use "
+                      "'devtool trace' to summarize the file or to convert it to Chrome trace format."),
+        QLatin1String("file")));
 
     QCommandLineOption cleanupUpdate(CommandLineOptions::scCleanupUpdate);
     cleanupUpdate.setValueName(QLatin1String("path"));
@@ -38,6 +38,7 @@
 #include "settings.h"
 #include "utils.h"
 #include "constants.h"
+#include "tracelog.h"
 
 #include "updateoperationfactory.h"
 
@@ -46,6 +47,7 @@
 #include <QtCore/QDirIterator>
 #include <QtCore/QTranslator>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QXmlStreamReader>
 
 #include <QApplication>
 #include <QtConcurrentFilter>
@@ -305,6 +307,35 @@ void Component::loadDataFromPackage(const KDUpdater::LocalPackage &package)
     setValue(scLocalDependencies, value(scDependencies));
 }
 
+/*!
+    Looks up the UI, translation, and license files referenced in the package.xml file of
+    \a package for \a core. Only files are read and no component is changed, so this can be
+    called for many packages concurrently before their components are created with
+    loadDataFromPackage(). Throws Error if a referenced file cannot be read.
+*/
+Component::PackageFiles Component::readPackageFiles(PackageManagerCore *core,
+    const Package &package)
+{
+    PackageFiles files;
+    if (core->isPackageViewer())
+        return files;
+
+    const QString directory = scTwoArgs.arg(QInstaller::pathFromUrl(package.packageSource().url),
+        core->replaceVariables(package.data(scName).toString()));
+    const QStringList uiList = QInstaller::splitStringWithComma(package.data(scUserInterfaces).toString());
+    if (!uiList.isEmpty())
+        files.userInterfaces = userInterfaceFiles(core, QDir(directory), uiList);
+#ifndef IFW_DISABLE_TRANSLATIONS
+    const QStringList qms = QInstaller::splitStringWithComma(package.data(scTranslations).toString());
+    if (!qms.isEmpty())
+        files.translations = translationFiles(core, QDir(directory), qms);
+#endif
+    const QHash<QString, QVariant> licenseHash = package.data(scLicenses).toHash();
+    if (!licenseHash.isEmpty())
+        files.licenses = findLicenses(core, directory, licenseHash, &files.licenseFiles);
+    return files;
+}
+
 /*!
     Sets variables according to the values set in the package.xml file of \a package.
     Also loads UI files, licenses and translations if they are referenced in the package.xml.
@@ -312,6 +343,17 @@ void Component::loadDataFromPackage(const KDUpdater::LocalPackage &package)
     only sets the variables without loading referenced files.
 */
 void Component::loadDataFromPackage(const Package &package)
+{
+    loadDataFromPackage(package, readPackageFiles(d->m_core, package));
+}
+
+/*!
+    \overload
+
+    Sets variables according to the values set in the package.xml file of \a package. The UI
+    files, translations, and licenses are taken from \a files, as read by readPackageFiles().
+*/
+void Component::loadDataFromPackage(const Package &package, const PackageFiles &files)
 {
     Q_ASSERT(&package);
 
@@ -326,6 +368,7 @@ void Component::loadDataFromPackage(const Package &package)
     setValue(scInheritVersion, package.data(scInheritVersion).toString());
     setValue(scDependencies, package.data(scDependencies).toString());
     setValue(scDownloadableArchives, package.data(scDownloadableArchives).toString());
+    setValue(scArchiveManifests, package.data(scArchiveManifests).toString());
     setValue(scVirtual, package.data(scVirtual).toString());
     setValue(scSortingPriority, package.data(scSortingPriority).toString());
 
@@ -335,6 +378,7 @@ void Component::loadDataFromPackage(const Package &package)
     setValue(scNewComponent, package.data(scNewComponent).toString());
     setValue(scRequiresAdminRights, package.data(scRequiresAdminRights).toString());
     d->m_scriptHash = package.data(scScriptTag).toHash();
+    d->m_deltaArchives = package.data(scDeltaArchives).toHash();
     setValue(scReplaces, package.data(scReplaces).toString());
     setValue(scReleaseDate, package.data(scReleaseDate).toString());
     setValue(scCheckable, package.data(scCheckable).toString());
@@ -356,18 +400,16 @@ void Component::loadDataFromPackage(const Package &package)
 
     setLocalTempPath(QInstaller::pathFromUrl(package.packageSource().url));
 
-    const QStringList uiList = QInstaller::splitStringWithComma(package.data(scUserInterfaces).toString());
-    if (!uiList.isEmpty())
-        loadUserInterfaces(QDir(scTwoArgs.arg(localTempPath(), name())), uiList);
+    for (auto it = files.userInterfaces.constBegin(); it != files.userInterfaces.constEnd(); ++it)
+        d->m_userInterfaceFiles.insert(it.key(), it.value());
 
 #ifndef IFW_DISABLE_TRANSLATIONS
-    const QStringList qms = QInstaller::splitStringWithComma(package.data(scTranslations).toString());
-    if (!qms.isEmpty())
-        loadTranslations(QDir(scTwoArgs.arg(localTempPath(), name())), qms);
+    installTranslations(files.translations);
 #endif
-    QHash<QString, QVariant> licenseHash = package.data(scLicenses).toHash();
-    if (!licenseHash.isEmpty())
-        loadLicenses(scTwoArgs.arg(localTempPath(), name()), licenseHash);
+    for (auto it = files.licenses.constBegin(); it != files.licenses.constEnd(); ++it)
+        d->m_licenses.insert(it.key(), it.value());
+    for (auto it = files.licenseFiles.constBegin(); it != files.licenseFiles.constEnd(); ++it)
+        d->m_licenseFiles.insert(it.key(), it.value());
     QVariant operationsVariant = package.data(scOperations);
     if (operationsVariant.canConvert<QList<QPair<QString, QVariant>>>())
         m_operationsList = operationsVariant.value<QList<QPair<QString, QVariant>>>();
@@ -609,6 +651,10 @@ void Component::loadComponentScript(const bool postLoad)
 */
 void Component::evaluateComponentScript(const QString &fileName, const bool postScriptContent)
 {
+    const bool traced = TraceLog::instance().isEnabled();
+    TraceSpan span(TraceLog::Script, traced ? QLatin1String("load script") : QString(),
+        traced ? name() : QString());
+
     // introduce the component object as javascript value and call the name to check that it
     // was successful
     try {
@@ -650,8 +696,19 @@ void Component::languageChanged()
 */
 void Component::loadTranslations(const QDir &directory, const QStringList &qms)
 {
+    installTranslations(translationFiles(d->m_core, directory, qms));
+}
+
+/*
+    Returns the files matching the name filters \a qms inside \a directory that are
+    translations for the UI language or allowed by the settings of \a core.
+*/
+QStringList Component::translationFiles(PackageManagerCore *core, const QDir &directory,
+    const QStringList &qms)
+{
+    QStringList files;
     QDirIterator it(directory.path(), qms, QDir::Files);
-    const QStringList translations = d->m_core->settings().translations();
+    const QStringList translations = core->settings().translations();
     const QString uiLanguage = QLocale().uiLanguages().value(0, scEn);
     while (it.hasNext()) {
         const QString filename = it.next();
@@ -666,7 +723,17 @@ void Component::loadTranslations(const QDir &directory, const QStringList &qms)
         } else if (!uiLanguage.startsWith(QFileInfo(filename).baseName(), Qt::CaseInsensitive)) {
             continue; // do not load the file if it does not match the UI language
         }
+        files.append(filename);
+    }
+    return files;
+}
 
+/*
+    Loads and installs the translation \a files.
+*/
+void Component::installTranslations(const QStringList &files)
+{
+    foreach (const QString &filename, files) {
         QScopedPointer<QTranslator> translator(new QTranslator(this));
         if (translator->load(filename)) {
             // Do not throw if translator returns false as it may just be an intentionally
@@ -679,39 +746,105 @@ void Component::loadTranslations(const QDir &directory, const QStringList &qms)
 /*!
     Loads the user interface files matching the name filters \a uis inside \a directory. The loaded
     interface can be accessed via userInterfaces() by using the class name set in the UI file.
+
+    Only the name of the top level widget is read from the files. The widget is created the
+    first time it is requested with userInterface().
 */
 void Component::loadUserInterfaces(const QDir &directory, const QStringList &uis)
 {
+    const QHash<QString, QString> files = userInterfaceFiles(d->m_core, directory, uis);
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it)
+        d->m_userInterfaceFiles.insert(it.key(), it.value());
+}
+
+/*
+    Returns the files matching the name filters \a uis inside \a directory by the object name
+    of their top level widget. Only the beginning of each file is read. Throws Error if a file
+    cannot be read.
+*/
+QHash<QString, QString> Component::userInterfaceFiles(PackageManagerCore *core,
+    const QDir &directory, const QStringList &uis)
+{
+    QHash<QString, QString> files;
     if (qobject_cast<QApplication*> (qApp) == 0)
-        return;
+        return files;
 
     QDirIterator it(directory.path(), uis, QDir::Files);
     while (it.hasNext()) {
         QFile file(it.next());
         if (!file.open(QIODevice::ReadOnly)) {
             throw Error(tr("Cannot open the requested UI file \"%1\": %2.\n\n%3 \"%4\"").arg(
-                            it.fileName(), file.errorString(), tr(scClearCacheHint), packageManagerCore()->settings().localCachePath()));
+                            it.fileName(), file.errorString(), tr(scClearCacheHint), core->settings().localCachePath()));
         }
 
-        static QUiLoader loader;
-        loader.setTranslationEnabled(true);
-        loader.setLanguageChangeEnabled(true);
-        QWidget *const widget = loader.load(&file, 0);
-        if (!widget) {
+        QString name;
+        QXmlStreamReader reader(&file);
+        if (reader.readNextStartElement() && reader.name() == QLatin1String("ui")) {
+            while (reader.readNextStartElement()) {
+                if (reader.name() == QLatin1String("widget")) {
+                    name = reader.attributes().value(QLatin1String("name")).toString();
+                    break;
+                }
+                reader.skipCurrentElement();
+            }
+        }
+        if (reader.hasError()) {
             throw Error(tr("Cannot load the requested UI file \"%1\": %2.\n\n%3 \"%4\"").arg(
-                            it.fileName(), loader.errorString(), tr(scClearCacheHint), packageManagerCore()->settings().localCachePath()));
+                            it.fileName(), reader.errorString(), tr(scClearCacheHint), core->settings().localCachePath()));
         }
-        d->scriptEngine()->newQObject(widget);
-        d->m_userInterfaces.insert(widget->objectName(), widget);
+        files.insert(name, file.fileName());
+    }
+    return files;
+}
+
+/*
+    Creates the widget of the UI file \a fileName. Returns \c nullptr if it cannot be loaded.
+*/
+QWidget *Component::loadUserInterface(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot open the requested UI file"
+            << fileName << ":" << file.errorString();
+        return nullptr;
+    }
+
+    static QUiLoader loader;
+    loader.setTranslationEnabled(true);
+    loader.setLanguageChangeEnabled(true);
+    QWidget *const widget = loader.load(&file, 0);
+    if (!widget) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot load the requested UI file"
+            << fileName << ":" << loader.errorString();
+        return nullptr;
     }
+    d->scriptEngine()->newQObject(widget);
+    return widget;
 }
 
 /*!
-  Loads the text of the licenses contained in \a licenseHash from \a directory.
+  Loads the licenses contained in \a licenseHash from \a directory.
   This is saved into a new hash containing the filename, the text and the priority of that file.
+  The text is read from the license file when the licenses are requested.
 */
 void Component::loadLicenses(const QString &directory, const QHash<QString, QVariant> &licenseHash)
 {
+    const QHash<QString, QVariantMap> licenses = findLicenses(d->m_core, directory, licenseHash,
+        &d->m_licenseFiles);
+    for (auto it = licenses.constBegin(); it != licenses.constEnd(); ++it)
+        d->m_licenses.insert(it.key(), it.value());
+}
+
+/*
+    Looks up the files of the licenses contained in \a licenseHash in \a directory, preferring
+    translated license files, and stores them in \a licenseFiles. The license texts are not
+    read. Throws Error if a license file cannot be opened.
+*/
+QHash<QString, QVariantMap> Component::findLicenses(PackageManagerCore *core,
+    const QString &directory, const QHash<QString, QVariant> &licenseHash,
+    QHash<QString, QString> *licenseFiles)
+{
+    QHash<QString, QVariantMap> licenses;
     QHash<QString, QVariant>::const_iterator it;
     for (it = licenseHash.begin(); it != licenseHash.end(); ++it) {
         QVariantMap license = it.value().toMap();
@@ -745,13 +878,12 @@ void Component::loadLicenses(const QString &directory, const QHash<QString, QVar
         QFile file(fileInfo.filePath());
         if (!file.open(QIODevice::ReadOnly)) {
             throw Error(tr("Cannot open the requested license file \"%1\": %2.\n\n%3 \"%4\"").arg(
-                            file.fileName(), file.errorString(), tr(scClearCacheHint), packageManagerCore()->settings().localCachePath()));
+                            file.fileName(), file.errorString(), tr(scClearCacheHint), core->settings().localCachePath()));
         }
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8");
-        license.insert(scContent, stream.readAll());
-        d->m_licenses.insert(it.key(), license);
+        licenses.insert(it.key(), license);
+        licenseFiles->insert(it.key(), file.fileName());
     }
+    return licenses;
 }
 
 /*!
@@ -795,17 +927,45 @@ void Component::loadXMLExtractOperations()
 */
 QStringList Component::userInterfaces() const
 {
-    return d->m_userInterfaces.keys();
+    return d->m_userInterfaces.keys() + d->m_userInterfaceFiles.keys();
 }
 
 /*!
     Returns a hash that contains the file names, text and priorities of license files for the component.
+    The texts are read from the license files on the first call and kept afterwards. A license
+    whose file cannot be read is logged and returned without text; reading it is tried again on
+    the next call.
+
+    \sa hasLicenses()
 */
 QHash<QString, QVariantMap> Component::licenses() const
 {
+    for (auto it = d->m_licenseFiles.begin(); it != d->m_licenseFiles.end();) {
+        QFile file(it.value());
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot open the requested license file"
+                << file.fileName() << ":" << file.errorString();
+            ++it;
+            continue;
+        }
+        QTextStream stream(&file);
+        stream.setCodec("UTF-8");
+        d->m_licenses[it.key()].insert(scContent, stream.readAll());
+        it = d->m_licenseFiles.erase(it);
+    }
     return d->m_licenses;
 }
 
+/*!
+    Returns \c true if the component has licenses, without reading them.
+
+    \sa licenses()
+*/
+bool Component::hasLicenses() const
+{
+    return !d->m_licenses.isEmpty();
+}
+
 /*!
     Returns the QWidget created for \a name or \c 0 if the widget has been deleted or cannot
     be found.
@@ -814,6 +974,9 @@ QHash<QString, QVariantMap> Component::licenses() const
 */
 QWidget *Component::userInterface(const QString &name) const
 {
+    const QString fileName = d->m_userInterfaceFiles.take(name);
+    if (!fileName.isEmpty())
+        d->m_userInterfaces.insert(name, loadUserInterface(fileName));
     return d->m_userInterfaces.value(name).data();
 }
 
@@ -836,9 +999,11 @@ void Component::createOperationsForPath(const QString &path)
 {
     const QFileInfo fi(path);
 
-    // don't copy over a checksum file
-    if (fi.suffix() == scSha1 && QFileInfo(fi.dir(), fi.completeBaseName()).exists())
+    // don't copy over a checksum or manifest file
+    if ((fi.suffix() == scSha1 || fi.suffix() == scManifest)
+            && QFileInfo(fi.dir(), fi.completeBaseName()).exists()) {
         return;
+    }
 
     // the script can override this method
     if (!callScriptMethod(scCreateOperationsForPath, QJSValueList() << path).isUndefined())
@@ -880,9 +1045,11 @@ void Component::createOperationsForArchive(const QString &archive)
 {
     const QFileInfo fi(archive);
 
-    // don't do anything with sha1 files
-    if (fi.suffix() == scSha1 && QFileInfo(fi.dir(), fi.completeBaseName()).exists())
+    // don't do anything with sha1 or manifest files
+    if ((fi.suffix() == scSha1 || fi.suffix() == scManifest)
+            && QFileInfo(fi.dir(), fi.completeBaseName()).exists()) {
         return;
+    }
 
     // the script can override this method
     if (!callScriptMethod(scCreateOperationsForArchive, QJSValueList() << archive).isUndefined())
@@ -995,6 +1162,22 @@ void Component::addDownloadableArchives(const QString& archives)
     d->m_downloadableArchivesVariable = archives;
 }
 
+/*!
+    Returns the binary deltas the repository provides for the downloadable \a archive,
+    as a hash of the SHA1 checksums of the base archives and the file names of the
+    deltas that reconstruct \a archive from them.
+*/
+QHash<QByteArray, QString> Component::deltaArchives(const QString &archive) const
+{
+    QHash<QByteArray, QString> deltas;
+    for (auto it = d->m_deltaArchives.constBegin(); it != d->m_deltaArchives.constEnd(); ++it) {
+        const QVariantMap attributes = it.value().toMap();
+        if (attributes.value(QLatin1String("archive")).toString() == archive)
+            deltas.insert(attributes.value(QLatin1String("base")).toString().toLatin1(), it.key());
+    }
+    return deltas;
+}
+
 /*!
     Removes the archive \a path previously added via addDownloadableArchive() from this component.
     This can only be called if this component was downloaded from an online repository.
@@ -1090,8 +1273,15 @@ OperationList Component::operations(const Operation::OperationGroups &mask) cons
             d->m_licenseOperation->setValue(scComponentSmall, name());
 
             QVariantMap licenses;
-            const QList<QVariantMap> values = d->m_licenses.values();
+            const QList<QVariantMap> values = this->licenses().values();
             for (int i = 0; i < values.count(); ++i) {
+                // Do not install an empty license, the file was reported by licenses().
+                if (!values.at(i).contains(scContent)) {
+                    qCWarning(QInstaller::lcInstallerInstallLog) << "Missing text of license"
+                        << values.at(i).value(scFile).toString() << "of component" << name();
+                    d->m_operationsCreatedSuccessfully = false;
+                    continue;
+                }
                 licenses.insert(values.at(i).value(scFile).toString(),
                         values.at(i).value(scContent));
             }
@@ -1217,6 +1407,10 @@ void Component::markComponentUnstable(Component::UnstableError error, const QStr
 
 QJSValue Component::callScriptMethod(const QString &methodName, const QJSValueList &arguments) const
 {
+    // Called for every script callback, do not build the detail if tracing is off
+    TraceSpan span(TraceLog::Script, methodName,
+        TraceLog::instance().isEnabled() ? name() : QString());
+
     QJSValue scriptContext;
     if (!d->m_postScriptContext.isUndefined() && d->m_postScriptContext.property(methodName).isCallable())
         scriptContext = d->m_postScriptContext;
@@ -103,7 +103,17 @@ public:
         }
     };
 
+    struct PackageFiles
+    {
+        QHash<QString, QString> userInterfaces;
+        QStringList translations;
+        QHash<QString, QVariantMap> licenses;
+        QHash<QString, QString> licenseFiles;
+    };
+
+    static PackageFiles readPackageFiles(PackageManagerCore *core, const Package &package);
     void loadDataFromPackage(const Package &package);
+    void loadDataFromPackage(const Package &package, const PackageFiles &files);
     void loadDataFromPackage(const KDUpdater::LocalPackage &package);
 
     QHash<QString, QString> variables() const;
@@ -131,6 +141,7 @@ public:
 
     QStringList userInterfaces() const;
     QHash<QString, QVariantMap> licenses() const;
+    bool hasLicenses() const;
     Q_INVOKABLE QWidget *userInterface(const QString &name) const;
     Q_INVOKABLE virtual void beginInstallation();
     Q_INVOKABLE virtual void createOperations();
@@ -154,6 +165,7 @@ public:
     Q_INVOKABLE void addDownloadableArchive(const QString &path);
     Q_INVOKABLE void removeDownloadableArchive(const QString &path);
     void addDownloadableArchives(const QString& archives);
+    QHash<QByteArray, QString> deltaArchives(const QString &archive) const;
 
     QStringList stopProcessForUpdateRequests() const;
     Q_INVOKABLE void addStopProcessForUpdateRequest(const QString &process);
@@ -229,6 +241,16 @@ private Q_SLOTS:
 private:
     void setLocalTempPath(const QString &tempPath);
 
+    static QStringList translationFiles(PackageManagerCore *core, const QDir &directory,
+        const QStringList &qms);
+    static QHash<QString, QString> userInterfaceFiles(PackageManagerCore *core,
+        const QDir &directory, const QStringList &uis);
+    static QHash<QString, QVariantMap> findLicenses(PackageManagerCore *core,
+        const QString &directory, const QHash<QString, QVariant> &licenseHash,
+        QHash<QString, QString> *licenseFiles);
+    void installTranslations(const QStringList &files);
+    QWidget *loadUserInterface(const QString &fileName) const;
+
     Operation *createOperation(const QString &operationName, const QString &parameter1 = QString(),
         const QString &parameter2 = QString(), const QString &parameter3 = QString(),
         const QString &parameter4 = QString(), const QString &parameter5 = QString(),
@@ -76,12 +76,18 @@ public:
     QList<Component*> m_allChildComponents;
     QStringList m_downloadableArchives;
     QString m_downloadableArchivesVariable;
+    // < delta file name, < archive, base archive checksum > >
+    QHash<QString, QVariant> m_deltaArchives;
     QStringList m_stopProcessForUpdateRequests;
     QHash<QString, QPointer<QWidget> > m_userInterfaces;
+    // < object name, UI file not loaded yet >
+    QHash<QString, QString> m_userInterfaceFiles;
     QHash<QString, QVariant> m_scriptHash;
 
-    // < display name, < file name, file content > >
+    // < display name, < file name, priority > >, the content is read on demand
     QHash<QString, QVariantMap> m_licenses;
+    // < display name, license file >, for the licenses whose content is not read yet
+    QHash<QString, QString> m_licenseFiles;
     QList<QPair<QString, bool> > m_pathsForUninstallation;
 };
 
@@ -39,6 +39,12 @@ namespace QInstaller {
     \inmodule QtInstallerFramework
     \brief The ComponentModel class holds a data model for visual representation of available
         components to install.
+
+    The children of a component are only reported to views after fetchMore() was called for
+    it, so that views like QTreeView only lay out the branches the user expanded. Components
+    can be looked up with indexFromComponentName() and changed with setData() regardless of
+    that. The check state of the components is tracked in bit arrays indexed by the
+    position of a component in a pre-order walk of the tree.
 */
 
 /*!
@@ -128,8 +134,10 @@ Qt::ItemFlags ComponentModel::flags(const QModelIndex &index) const
 */
 int ComponentModel::rowCount(const QModelIndex &parent) const
 {
-    if (Component *component = componentFromIndex(parent))
-        return component->childCount();
+    if (Component *component = componentFromIndex(parent)) {
+        const int id = componentId(component);
+        return (id >= 0 && m_fetched.testBit(id)) ? component->childCount() : 0;
+    }
     return m_rootComponentList.count();
 }
 
@@ -153,7 +161,7 @@ QModelIndex ComponentModel::parent(const QModelIndex &child) const
 
     if (Component *childComponent = componentFromIndex(child)) {
         if (Component *parent = childComponent->parentComponent())
-            return indexFromComponentName(parent->treeName());
+            return indexFromComponent(parent);
     }
     return QModelIndex();
 }
@@ -177,6 +185,73 @@ QModelIndex ComponentModel::index(int row, int column, const QModelIndex &parent
     return QModelIndex();
 }
 
+/*!
+    Returns \c true if the item at \a parent has child items, even if they were not fetched
+    yet; otherwise returns \c false.
+*/
+bool ComponentModel::hasChildren(const QModelIndex &parent) const
+{
+    if (Component *component = componentFromIndex(parent))
+        return component->childCount() > 0;
+    return !m_rootComponentList.isEmpty();
+}
+
+/*!
+    Returns \c true if the item at \a parent has child items that were not fetched yet;
+    otherwise returns \c false.
+*/
+bool ComponentModel::canFetchMore(const QModelIndex &parent) const
+{
+    Component *component = componentFromIndex(parent);
+    if (!component)
+        return false;
+    const int id = componentId(component);
+    return id >= 0 && !m_fetched.testBit(id);
+}
+
+/*!
+    Makes the child items of \a parent available to views. The rowsInserted() signal is
+    emitted for them.
+*/
+void ComponentModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    Component *component = componentFromIndex(parent);
+    beginInsertRows(indexFromComponent(component), 0, component->childCount() - 1);
+    m_fetched.setBit(componentId(component));
+    endInsertRows();
+}
+
+/*!
+    Fetches the child items of all ancestors of \a index, top-down, so that \a index can be
+    reached by views.
+*/
+void ComponentModel::fetchAncestors(const QModelIndex &index)
+{
+    ComponentList ancestors;
+    Component *component = componentFromIndex(index);
+    while (component && (component = component->parentComponent()))
+        ancestors.prepend(component);
+
+    foreach (Component *const ancestor, ancestors)
+        fetchMore(indexFromComponent(ancestor));
+}
+
+/*!
+    Fetches the child items of all components, for example before the whole tree is
+    searched.
+*/
+void ComponentModel::fetchAll()
+{
+    // pre-order fetches every parent before its children
+    for (int id = 0; id < m_components.count(); ++id) {
+        if (!m_fetched.testBit(id))
+            fetchMore(indexFromComponent(m_components.at(id)));
+    }
+}
+
 /*!
     Returns the data stored under the given \a role for the item referred to by the \a index.
 
@@ -307,7 +382,7 @@ bool ComponentModel::setHeaderData(int section, Qt::Orientation orientation, con
 */
 QSet<Component *> ComponentModel::checked() const
 {
-    return m_currentCheckedState[Qt::Checked];
+    return componentsIn(m_currentCheckedState.checked);
 }
 
 /*!
@@ -315,7 +390,7 @@ QSet<Component *> ComponentModel::checked() const
 */
 QSet<Component *> ComponentModel::partially() const
 {
-    return m_currentCheckedState[Qt::PartiallyChecked];
+    return componentsIn(m_currentCheckedState.partially);
 }
 
 /*!
@@ -323,7 +398,8 @@ QSet<Component *> ComponentModel::partially() const
 */
 QSet<Component *> ComponentModel::unchecked() const
 {
-    return m_currentCheckedState[Qt::Unchecked];
+    return componentsIn(m_currentCheckedState.tracked
+        & ~(m_currentCheckedState.checked | m_currentCheckedState.partially));
 }
 
 /*!
@@ -332,7 +408,7 @@ QSet<Component *> ComponentModel::unchecked() const
 */
 QSet<Component *> ComponentModel::uncheckable() const
 {
-    return m_uncheckable;
+    return componentsIn(m_uncheckable);
 }
 
 /*!
@@ -358,11 +434,11 @@ ComponentModel::ModelState ComponentModel::checkedState() const
 */
 QModelIndex ComponentModel::indexFromComponentName(const QString &name) const
 {
-    if (m_indexByNameCache.isEmpty()) {
-        for (int i = 0; i < m_rootComponentList.count(); ++i)
-            collectComponents(m_rootComponentList.at(i), index(i, 0, QModelIndex()));
+    if (m_componentByNameCache.isEmpty()) {
+        foreach (Component *const component, m_components)
+            m_componentByNameCache.insert(component->treeName(), component);
     }
-    return m_indexByNameCache.value(name, QModelIndex());
+    return indexFromComponent(m_componentByNameCache.value(name, nullptr));
 }
 
 /*!
@@ -391,19 +467,13 @@ void ComponentModel::reset(QList<Component *> rootComponents)
 {
     beginResetModel();
 
-    m_uncheckable.clear();
-    m_indexByNameCache.clear();
+    m_componentByNameCache.clear();
     m_rootComponentList.clear();
+    m_components.clear();
+    m_rows.clear();
+    m_idByComponent.clear();
     m_modelState = !rootComponents.isEmpty() ? DefaultChecked : Empty;
 
-    // Initialize these with an empty set for every possible state, cause we compare the hashes later in
-    // updateAndEmitModelState(). The comparison than might lead to wrong results if one of the checked
-    // states is absent initially.
-    m_initialCheckedState[Qt::Checked] = ComponentSet();
-    m_initialCheckedState[Qt::Unchecked] = ComponentSet();
-    m_initialCheckedState[Qt::PartiallyChecked] = ComponentSet();
-    m_currentCheckedState = m_initialCheckedState;  // both should be equal
-
     // show virtual components only in case we run as updater or if the core engine is set to show them
     const bool showVirtuals = m_core->isUpdater() || m_core->virtualComponentsVisible();
     foreach (Component *const component, rootComponents) {
@@ -412,6 +482,19 @@ void ComponentModel::reset(QList<Component *> rootComponents)
             continue;
         m_rootComponentList.append(component);
     }
+    for (int i = 0; i < m_rootComponentList.count(); ++i)
+        collectComponents(m_rootComponentList.at(i), i);
+
+    // only the root components are visible initially, leaves have nothing to fetch
+    const int count = m_components.count();
+    m_fetched = QBitArray(count);
+    for (int id = 0; id < count; ++id) {
+        if (m_components.at(id)->childCount() == 0)
+            m_fetched.setBit(id);
+    }
+    m_uncheckable = QBitArray(count);
+    m_initialCheckedState.resize(count);
+    m_currentCheckedState = m_initialCheckedState;  // both should be equal
     endResetModel();
     postModelReset();
 }
@@ -427,15 +510,15 @@ void ComponentModel::setCheckedState(QInstaller::ComponentModel::ModelStateFlag
 {
     switch (state) {
         case AllChecked:
-            updateCheckedState(m_currentCheckedState[Qt::Unchecked], Qt::Checked);
+            updateCheckedState(unchecked(), Qt::Checked);
         break;
         case AllUnchecked:
-            updateCheckedState(m_currentCheckedState[Qt::Checked], Qt::Unchecked);
+            updateCheckedState(checked(), Qt::Unchecked);
         break;
         case DefaultChecked:
             // record all changes, to be able to update the UI properly
-            updateCheckedState(m_currentCheckedState[Qt::Checked], Qt::Unchecked);
-            updateCheckedState(m_initialCheckedState[Qt::Checked], Qt::Checked);
+            updateCheckedState(checked(), Qt::Unchecked);
+            updateCheckedState(componentsIn(m_initialCheckedState.checked), Qt::Checked);
         break;
         default:
             break;
@@ -457,24 +540,25 @@ void ComponentModel::onVirtualStateChanged()
 
 void ComponentModel::postModelReset()
 {
-    ComponentList components = m_rootComponentList;
-    if (!m_core->isUpdater()) {
-        foreach (Component *const component, m_rootComponentList)
-            components += component->childItems();
-    }
-
+    // the updater only tracks the check state of the root components
+    QVector<int> ids;
     ComponentSet checked;
-    foreach (Component *const component, components) {
+    for (int id = 0; id < m_components.count(); ++id) {
+        Component *const component = m_components.at(id);
+        if (m_core->isUpdater() && component->parentComponent())
+            continue;
+        ids.append(id);
         if (component->checkState() == Qt::Checked)
             checked.insert(component);
         connect(component, &Component::virtualStateChanged, this, &ComponentModel::onVirtualStateChanged);
     }
 
     updateCheckedState(checked, Qt::Checked);
-    foreach (Component *const component, components) {
+    foreach (const int id, ids) {
+        Component *const component = m_components.at(id);
         if (!component->isCheckable())
-            m_uncheckable.insert(component);
-        m_initialCheckedState[component->checkState()].insert(component);
+            m_uncheckable.setBit(id);
+        m_initialCheckedState.insert(id, component->checkState());
     }
 
     m_currentCheckedState = m_initialCheckedState;
@@ -491,12 +575,14 @@ void ComponentModel::updateAndEmitModelState()
     if (m_initialCheckedState != m_currentCheckedState)
         m_modelState = ComponentModel::PartiallyChecked;
 
-    if (checked().count() == 0 && partially().count() == 0) {
+    const CheckStates &current = m_currentCheckedState;
+    const bool nonePartially = current.partially.count(true) == 0;
+    if (current.checked.count(true) == 0 && nonePartially) {
         m_modelState |= ComponentModel::AllUnchecked;
         m_modelState &= ~ComponentModel::PartiallyChecked;
     }
 
-    if (unchecked().count() == 0 && partially().count() == 0) {
+    if ((current.tracked & ~current.checked).count(true) == 0 && nonePartially) {
         m_modelState |= ComponentModel::AllChecked;
         m_modelState &= ~ComponentModel::PartiallyChecked;
     }
@@ -504,11 +590,72 @@ void ComponentModel::updateAndEmitModelState()
     emit checkStateChanged(m_modelState);
 }
 
-void ComponentModel::collectComponents(Component *const component, const QModelIndex &parent) const
+/*
+    Assigns the next ID to component and its descendants in pre-order, so that every
+    component has a higher ID than its ancestors.
+*/
+void ComponentModel::collectComponents(Component *const component, int row)
 {
-    m_indexByNameCache.insert(component->treeName(), parent);
+    m_idByComponent.insert(component, m_components.count());
+    m_components.append(component);
+    m_rows.append(row);
     for (int i = 0; i < component->childCount(); ++i)
-        collectComponents(component->childAt(i), index(i, 0, parent));
+        collectComponents(component->childAt(i), i);
+}
+
+int ComponentModel::componentId(Component *component) const
+{
+    return m_idByComponent.value(component, -1);
+}
+
+QModelIndex ComponentModel::indexFromComponent(Component *component) const
+{
+    const int id = componentId(component);
+    if (id < 0)
+        return QModelIndex();
+    return createIndex(m_rows.at(id), 0, component);
+}
+
+/*
+    Returns true if all ancestors of component were fetched, so that views know about it.
+*/
+bool ComponentModel::isReachable(Component *component) const
+{
+    while ((component = component->parentComponent())) {
+        const int id = componentId(component);
+        if (id < 0 || !m_fetched.testBit(id))
+            return false;
+    }
+    return true;
+}
+
+ComponentModel::ComponentSet ComponentModel::componentsIn(const QBitArray &ids) const
+{
+    ComponentSet components;
+    for (int id = 0; id < ids.size(); ++id) {
+        if (ids.testBit(id))
+            components.insert(m_components.at(id));
+    }
+    return components;
+}
+
+void ComponentModel::CheckStates::resize(int size)
+{
+    tracked = QBitArray(size);
+    checked = QBitArray(size);
+    partially = QBitArray(size);
+}
+
+void ComponentModel::CheckStates::insert(int id, Qt::CheckState state)
+{
+    tracked.setBit(id);
+    checked.setBit(id, state == Qt::Checked);
+    partially.setBit(id, state == Qt::PartiallyChecked);
+}
+
+bool ComponentModel::CheckStates::operator==(const CheckStates &other) const
+{
+    return tracked == other.tracked && checked == other.checked && partially == other.partially;
 }
 
 namespace ComponentModelPrivate {
@@ -548,19 +695,23 @@ static Qt::CheckState verifyPartiallyChecked(Component *component)
 QSet<QModelIndex> ComponentModel::updateCheckedState(const ComponentSet &components, const Qt::CheckState state)
 {
     // get all parent nodes for the components we're going to update
-    QMultiMap<QString, Component *> sortedNodesMap;
+    QBitArray nodes(m_components.count());
     foreach (Component *component, components) {
-        while (component && !sortedNodesMap.values(component->treeName()).contains(component)) {
-            sortedNodesMap.insert(component->treeName(), component);
+        int id = componentId(component);
+        while (id >= 0 && !nodes.testBit(id)) {
+            nodes.setBit(id);
             component = component->parentComponent();
+            id = component ? componentId(component) : -1;
         }
     }
 
     QSet<QModelIndex> changed;
-    const ComponentList sortedNodes = sortedNodesMap.values();
-    // we can start in descending order to check node and tri-state nodes properly
-    for (int i = sortedNodes.count(); i > 0; i--) {
-        Component * const node = sortedNodes.at(i - 1);
+    // we can start in descending pre-order to check node and tri-state nodes properly,
+    // children always come before their parents then
+    for (int id = nodes.size() - 1; id >= 0; --id) {
+        if (!nodes.testBit(id))
+            continue;
+        Component * const node = m_components.at(id);
 
         bool checkable = true;
         if (node->value(scCheckable, scTrue).toLower() == scFalse) {
@@ -581,23 +732,11 @@ QSet<QModelIndex> ComponentModel::updateCheckedState(const ComponentSet &compone
             continue;
 
         node->setCheckState(newState);
-        changed.insert(indexFromComponentName(node->treeName()));
-
-        m_currentCheckedState[Qt::Checked].remove(node);
-        m_currentCheckedState[Qt::Unchecked].remove(node);
-        m_currentCheckedState[Qt::PartiallyChecked].remove(node);
+        // nodes not fetched by views yet read their state once they are fetched
+        if (isReachable(node))
+            changed.insert(indexFromComponent(node));
 
-        switch (newState) {
-            case Qt::Checked:
-                m_currentCheckedState[Qt::Checked].insert(node);
-            break;
-            case Qt::Unchecked:
-                m_currentCheckedState[Qt::Unchecked].insert(node);
-            break;
-            case Qt::PartiallyChecked:
-                m_currentCheckedState[Qt::PartiallyChecked].insert(node);
-            break;
-        }
+        m_currentCheckedState.insert(id, newState);
     }
     return changed;
 }
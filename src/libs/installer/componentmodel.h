@@ -34,6 +34,7 @@
 #include "component.h"
 
 #include <QtCore/QAbstractItemModel>
+#include <QtCore/QBitArray>
 #include <QtCore/QList>
 #include <QtCore/QSet>
 #include <QtCore/QVector>
@@ -69,6 +70,12 @@ public:
     QModelIndex parent(const QModelIndex &child) const override;
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
 
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    void fetchAncestors(const QModelIndex &index);
+    void fetchAll();
+
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
 
@@ -98,22 +105,45 @@ private Q_SLOTS:
     void onVirtualStateChanged();
 
 private:
+    struct CheckStates
+    {
+        void resize(int size);
+        void insert(int id, Qt::CheckState state);
+        bool operator==(const CheckStates &other) const;
+        bool operator!=(const CheckStates &other) const { return !operator==(other); }
+
+        QBitArray tracked;
+        QBitArray checked;
+        QBitArray partially;
+    };
+
     void postModelReset();
     void updateAndEmitModelState();
-    void collectComponents(Component *const component, const QModelIndex &parent) const;
+    void collectComponents(Component *const component, int row);
     QSet<QModelIndex> updateCheckedState(const ComponentSet &components, const Qt::CheckState state);
 
+    int componentId(Component *component) const;
+    QModelIndex indexFromComponent(Component *component) const;
+    bool isReachable(Component *component) const;
+    ComponentSet componentsIn(const QBitArray &ids) const;
+
 private:
     PackageManagerCore *m_core;
 
     ModelState m_modelState;
-    ComponentSet m_uncheckable;
+    QBitArray m_uncheckable;
     QVector<QVariant> m_headerData;
     ComponentList m_rootComponentList;
 
-    QHash<Qt::CheckState, ComponentSet> m_initialCheckedState;
-    QHash<Qt::CheckState, ComponentSet> m_currentCheckedState;
-    mutable QHash<QString, QPersistentModelIndex> m_indexByNameCache;
+    // Components in pre-order, indexed by their ID in this model.
+    QVector<Component *> m_components;
+    QVector<int> m_rows;
+    QHash<Component *, int> m_idByComponent;
+    QBitArray m_fetched;
+
+    CheckStates m_initialCheckedState;
+    CheckStates m_currentCheckedState;
+    mutable QHash<QString, Component *> m_componentByNameCache;
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(ComponentModel::ModelState);
 
@@ -53,6 +53,7 @@
 #include <QLineEdit>
 #include <QStandardItemModel>
 #include <QStyledItemDelegate>
+#include <QTimer>
 
 namespace QInstaller {
 
@@ -67,6 +68,8 @@ constexpr int scCheckDefaultIndex = 0;
 constexpr int scCheckAllIndex = 1;
 constexpr int scUncheckAllIndex = 2;
 
+constexpr int scSearchDelay = 250; // milliseconds
+
 ComponentSelectionPagePrivate::ComponentSelectionPagePrivate(ComponentSelectionPage *qq, PackageManagerCore *core)
         : q(qq)
         , m_core(core)
@@ -182,12 +185,20 @@ ComponentSelectionPagePrivate::ComponentSelectionPagePrivate(ComponentSelectionP
     metaLayout->addWidget(m_progressBar);
     metaLayout->addSpacerItem(new QSpacerItem(1, 1, QSizePolicy::Minimum, QSizePolicy::Expanding));
 
+    // Filter once the user paused typing, not after every key stroke
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(scSearchDelay);
+    connect(m_searchTimer, &QTimer::timeout, this, [this]() {
+        setSearchPattern(m_searchLineEdit->text());
+    });
+
     m_searchLineEdit = new QLineEdit(q);
     m_searchLineEdit->setObjectName(QLatin1String("SearchLineEdit"));
     m_searchLineEdit->setPlaceholderText(ComponentSelectionPage::tr("Search"));
     m_searchLineEdit->setClearButtonEnabled(true);
     connect(m_searchLineEdit, &QLineEdit::textChanged,
-            this, &ComponentSelectionPagePrivate::setSearchPattern);
+            this, &ComponentSelectionPagePrivate::onSearchTextChanged);
     connect(q, &ComponentSelectionPage::entered, m_searchLineEdit, &QLineEdit::clear);
     topHLayout->addWidget(m_searchLineEdit);
 
@@ -371,8 +382,9 @@ void ComponentSelectionPagePrivate::expandDefault()
     m_treeView->setExpanded(m_proxyModel->index(0, 0), true);
     foreach (auto *component, m_core->components(PackageManagerCore::ComponentType::All)) {
         if (component->isExpandedByDefault()) {
-            const QModelIndex index = m_proxyModel->mapFromSource(
-                m_currentModel->indexFromComponentName(component->treeName()));
+            const QModelIndex sourceIndex = m_currentModel->indexFromComponentName(component->treeName());
+            m_currentModel->fetchAncestors(sourceIndex);
+            const QModelIndex index = m_proxyModel->mapFromSource(sourceIndex);
             m_treeView->setExpanded(index, true);
         }
     }
@@ -620,12 +632,29 @@ void ComponentSelectionPagePrivate::onModelStateChanged(QInstaller::ComponentMod
         currentSelectedChanged(m_treeView->selectionModel()->currentIndex());
 }
 
+/*!
+    Applies an empty search \a text right away and delays the search for other text
+    until no further changes arrive.
+*/
+void ComponentSelectionPagePrivate::onSearchTextChanged(const QString &text)
+{
+    if (text.isEmpty()) {
+        m_searchTimer->stop();
+        setSearchPattern(text);
+    } else {
+        m_searchTimer->start();
+    }
+}
+
 /*!
     Sets the new filter pattern to \a text and expands the tree nodes.
 */
 void ComponentSelectionPagePrivate::setSearchPattern(const QString &text)
 {
-    m_proxyModel->setFilterWildcard(text);
+    // the filter needs to see all components, not only the fetched ones
+    if (!text.isEmpty())
+        m_currentModel->fetchAll();
+    m_proxyModel->setFilterPattern(text);
 
     m_treeView->collapseAll();
     if (text.isEmpty()) {
@@ -48,6 +48,7 @@ class QVBoxLayout;
 class QHBoxLayout;
 class QGridLayout;
 class QStackedLayout;
+class QTimer;
 
 namespace QInstaller {
 
@@ -90,6 +91,7 @@ public slots:
     void setTotalProgress(int totalProgress);
     void selectDefault();
     void onModelStateChanged(QInstaller::ComponentModel::ModelState state);
+    void onSearchTextChanged(const QString &text);
     void setSearchPattern(const QString &text);
 
 private:
@@ -121,6 +123,7 @@ private:
     QStackedLayout *m_stackedLayout;
     ComponentSortFilterProxyModel *m_proxyModel;
     QLineEdit *m_searchLineEdit;
+    QTimer *m_searchTimer;
     bool m_componentsResolved;
 
     bool m_headerStretchLastSection;
@@ -40,6 +40,11 @@ namespace QInstaller {
            filters affect also child indexes in the base model, meaning if a
            certain row has a parent that is accepted by filter, it is also accepted.
            A distinction is made betweed directly and indirectly accepted indexes.
+
+           When the filter is set with setFilterPattern(), the acceptance of all rows is
+           computed once per filter change in a single pre-order pass over the source
+           model, and looked up from there afterwards. If the new pattern contains the
+           previous one, only rows that matched the previous pattern are evaluated again.
 */
 
 /*!
@@ -60,7 +65,64 @@ namespace QInstaller {
 */
 ComponentSortFilterProxyModel::ComponentSortFilterProxyModel(QObject *parent)
     : QSortFilterProxyModel(parent)
+    , m_narrowFilter(false)
+    , m_acceptCacheValid(false)
+{
+}
+
+/*!
+    \reimp
+*/
+void ComponentSortFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (QAbstractItemModel *oldModel = this->sourceModel())
+        disconnect(oldModel, nullptr, this, nullptr);
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+    invalidateAcceptCache();
+    if (!sourceModel)
+        return;
+
+    // Invalidate before QSortFilterProxyModel filters the changed rows, the cache is
+    // rebuilt on the next lookup then.
+    connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset,
+            this, &ComponentSortFilterProxyModel::invalidateAcceptCache);
+    connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged,
+            this, &ComponentSortFilterProxyModel::invalidateAcceptCache);
+    connect(sourceModel, &QAbstractItemModel::rowsAboutToBeInserted,
+            this, &ComponentSortFilterProxyModel::invalidateAcceptCache);
+    connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &ComponentSortFilterProxyModel::invalidateAcceptCache);
+    connect(sourceModel, &QAbstractItemModel::rowsAboutToBeMoved,
+            this, &ComponentSortFilterProxyModel::invalidateAcceptCache);
+    connect(sourceModel, &QAbstractItemModel::dataChanged,
+            this, &ComponentSortFilterProxyModel::onSourceDataChanged);
+}
+
+/*!
+    \fn QInstaller::ComponentSortFilterProxyModel::filterPattern() const
+
+    Returns the wildcard pattern set with setFilterPattern().
+*/
+
+/*!
+    Sets the wildcard pattern used to filter the source model to \a pattern, like
+    QSortFilterProxyModel::setFilterWildcard() does, and computes which rows are accepted.
+*/
+void ComponentSortFilterProxyModel::setFilterPattern(const QString &pattern)
 {
+    if (pattern == m_filterPattern)
+        return;
+
+    // Any text matched by the unanchored pattern also contains a match of each part of the
+    // pattern, unless the part splits a character set or an escape sequence.
+    m_narrowFilter = m_acceptCacheValid && !m_filterPattern.isEmpty()
+        && pattern.contains(m_filterPattern, filterCaseSensitivity())
+        && !m_filterPattern.contains(QLatin1Char('[')) && !m_filterPattern.contains(QLatin1Char(']'))
+        && !m_filterPattern.contains(QLatin1Char('\\'));
+    m_filterPattern = pattern;
+    m_acceptCacheValid = false;
+    setFilterWildcard(pattern);
 }
 
 /*!
@@ -96,6 +158,27 @@ bool ComponentSortFilterProxyModel::acceptsRow(int sourceRow, const QModelIndex
     if (type)
         *type = AcceptType::Rejected;
 
+    if (!m_filterPattern.isEmpty()) {
+        const RowKey id(sourceModel()->index(sourceRow, 0, sourceParent).internalId(), sourceRow);
+        if (!m_acceptCacheValid || !m_acceptCache.contains(id))
+            updateAcceptCache();
+
+        const auto it = m_acceptCache.constFind(id);
+        if (it != m_acceptCache.constEnd()) {
+            if (it.value() & AcceptedDirectly) {
+                if (type)
+                    *type = AcceptType::Direct;
+                return true;
+            }
+            if (isRecursiveFilteringEnabled() && (it.value() & AncestorAccepted)) {
+                if (type)
+                    *type = AcceptType::Descendant;
+                return true;
+            }
+            return false;
+        }
+    }
+
     if (QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent)) {
         if (type)
             *type = AcceptType::Direct;
@@ -149,4 +232,68 @@ bool ComponentSortFilterProxyModel::findDirectlyAcceptedIndexes(const QModelInde
     return found;
 }
 
+/*!
+    Computes the accept flags of all rows of the source model in one pre-order pass, so
+    that every row is matched only once and the result for its ancestors is passed down.
+*/
+void ComponentSortFilterProxyModel::updateAcceptCache() const
+{
+    AcceptCache previous;
+    if (m_narrowFilter)
+        previous.swap(m_acceptCache);
+    m_acceptCache.clear();
+    m_acceptCache.reserve(previous.size());
+
+    if (sourceModel())
+        updateAcceptCache(QModelIndex(), false, previous);
+    m_narrowFilter = false;
+    m_acceptCacheValid = true;
+}
+
+void ComponentSortFilterProxyModel::updateAcceptCache(const QModelIndex &sourceParent,
+    bool ancestorAccepted, const AcceptCache &previous) const
+{
+    QAbstractItemModel *const model = sourceModel();
+    const int rowCount = model->rowCount(sourceParent);
+    for (int row = 0; row < rowCount; ++row) {
+        const QModelIndex index = model->index(row, 0, sourceParent);
+        const RowKey id(index.internalId(), row);
+
+        // rows that did not match the previous pattern cannot match the narrower one
+        bool accepted = false;
+        if (previous.value(id, AcceptedDirectly) & AcceptedDirectly)
+            accepted = QSortFilterProxyModel::filterAcceptsRow(row, sourceParent);
+
+        m_acceptCache.insert(id, quint8((accepted ? AcceptedDirectly : 0)
+            | (ancestorAccepted ? AncestorAccepted : 0)));
+        updateAcceptCache(index, ancestorAccepted || accepted, previous);
+    }
+}
+
+void ComponentSortFilterProxyModel::invalidateAcceptCache()
+{
+    m_narrowFilter = false;
+    m_acceptCacheValid = false;
+    m_acceptCache.clear();
+}
+
+void ComponentSortFilterProxyModel::onSourceDataChanged(const QModelIndex &topLeft,
+    const QModelIndex &bottomRight)
+{
+    if (!m_acceptCacheValid || m_filterPattern.isEmpty())
+        return;
+
+    // Changes of the check state are the common case and do not affect the filter.
+    const QModelIndex parent = topLeft.parent();
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const RowKey id(sourceModel()->index(row, 0, parent).internalId(), row);
+        const bool cached = m_acceptCache.value(id) & AcceptedDirectly;
+        if (cached != QSortFilterProxyModel::filterAcceptsRow(row, parent)) {
+            invalidateAcceptCache();
+            invalidateFilter();
+            return;
+        }
+    }
+}
+
 } // namespace QInstaller
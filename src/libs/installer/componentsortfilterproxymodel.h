@@ -31,6 +31,8 @@
 
 #include "installer_global.h"
 
+#include <QHash>
+#include <QPair>
 #include <QSortFilterProxyModel>
 
 namespace QInstaller {
@@ -48,14 +50,43 @@ public:
 
     explicit ComponentSortFilterProxyModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    QString filterPattern() const { return m_filterPattern; }
+    void setFilterPattern(const QString &pattern);
+
     QVector<QModelIndex> directlyAcceptedIndexes() const;
 
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
 
+private slots:
+    void invalidateAcceptCache();
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
 private:
+    // Identifies a row by the internal ID of its index and its row number, which is unique
+    // for tree models that use either the item or the parent item as internal pointer.
+    typedef QPair<quintptr, int> RowKey;
+    typedef QHash<RowKey, quint8> AcceptCache;
+
+    enum AcceptFlag {
+        AcceptedDirectly = 0x01,
+        AncestorAccepted = 0x02
+    };
+
     bool acceptsRow(int sourceRow, const QModelIndex &sourceParent, AcceptType *type = nullptr) const;
     bool findDirectlyAcceptedIndexes(const QModelIndex &in, QVector<QModelIndex> &indexes) const;
+
+    void updateAcceptCache() const;
+    void updateAcceptCache(const QModelIndex &sourceParent, bool ancestorAccepted,
+        const AcceptCache &previous) const;
+
+private:
+    QString m_filterPattern;
+    mutable bool m_narrowFilter;
+    mutable bool m_acceptCacheValid;
+    mutable AcceptCache m_acceptCache;
 };
 
 } // namespace QInstaller
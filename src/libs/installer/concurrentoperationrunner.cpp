@@ -30,6 +30,7 @@
 
 #include "errors.h"
 #include "operationtracer.h"
+#include "tracelog.h"
 
 #include <QtConcurrent>
 
@@ -250,6 +251,14 @@ bool ConcurrentOperationRunner::runOperation(Operation *const operation)
 {
     emit operationStarted(operation);
 
+    static const QString names[] = {
+        QLatin1String("backup"), QLatin1String("perform"), QLatin1String("undo")
+    };
+    TraceSpan span(TraceLog::Operation, names[qBound(0, int(m_type), 2)],
+        TraceLog::instance().isEnabled()
+            ? operation->value(QLatin1String("component")).toString() + QLatin1Char(' ') + operation->name()
+            : QString());
+
     switch (m_type) {
     case Operation::Backup:
         operation->backup();
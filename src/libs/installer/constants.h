@@ -51,6 +51,8 @@ static const QLatin1String scRemoteDisplayVersion("RemoteDisplayVersion");
 static const QLatin1String scInheritVersion("inheritVersionFrom");
 static const QLatin1String scReplaces("Replaces");
 static const QLatin1String scDownloadableArchives("DownloadableArchives");
+static const QLatin1String scDeltaArchives("DeltaArchives");
+static const QLatin1String scArchiveManifests("ArchiveManifests");
 static const QLatin1String scEssential("Essential");
 static const QLatin1String scForcedUpdate("ForcedUpdate");
 static const QLatin1String scTargetDir("TargetDir");
@@ -116,6 +118,7 @@ static const QLatin1String scFile("file");
 static const QLatin1String scContent("content");
 static const QLatin1String scExtract("Extract");
 static const QLatin1String scSha1("sha1");
+static const QLatin1String scManifest("manifest");
 static const QLatin1String scCreateOperationsForPath("createOperationsForPath");
 static const QLatin1String scCreateOperationsForArchive("createOperationsForArchive");
 static const QLatin1String scCreateOperations("createOperations");
@@ -284,6 +287,8 @@ static const QLatin1String scSquishPortShort("q");
 static const QLatin1String scSquishPortLong("squish-port");
 static const QLatin1String scMaxConcurrentOperationsShort("mco");
 static const QLatin1String scMaxConcurrentOperationsLong("max-concurrent-operations");
+static const QLatin1String scTraceFileShort("tf");
+static const QLatin1String scTraceFileLong("trace-file");
 static const QLatin1String scCleanupUpdate("cleanup-update");
 static const QLatin1String scCleanupUpdateOnly("cleanup-update-only");
 
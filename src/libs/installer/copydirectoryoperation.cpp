@@ -28,10 +28,15 @@
 
 #include "copydirectoryoperation.h"
 
+#include "errors.h"
+#include "fileutils.h"
+
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtCore/QDir>
-#include <QtCore/QDirIterator>
 #include <QtCore/QFileInfo>
 
+#include <algorithm>
+
 using namespace QInstaller;
 
 /*!
@@ -100,11 +105,29 @@ bool CopyDirectoryOperation::performOperation()
     const QDir targetDir = targetInfo.absoluteDir();
 
     AutoPush autoPush(this);
-    QDirIterator it(sourceInfo.absoluteFilePath(), QDir::NoDotAndDotDot | QDir::AllEntries | QDir::Hidden,
-        QDirIterator::Subdirectories);
-    while (it.hasNext()) {
-        const QString itemName = it.next();
-        const QFileInfo itemInfo(sourceDir.absoluteFilePath(itemName));
+    DirectoryTree tree = listDirectoryTree(sourceInfo.absoluteFilePath(),
+        QDir::AllEntries | QDir::Hidden);
+    foreach (const QStringList &directories, tree.directories) {
+        foreach (const QString &directory, directories) {
+            const QString relativePath = sourceDir.relativeFilePath(directory);
+            if (!targetDir.mkpath(targetDir.absoluteFilePath(relativePath))) {
+                setError(InvalidArguments);
+                setErrorString(tr("Cannot create directory \"%1\".").arg(
+                                   QDir::toNativeSeparators(targetDir.absoluteFilePath(relativePath))));
+                return false;
+            }
+        }
+    }
+
+    struct FileCopy
+    {
+        QString source;
+        QString target;
+        QString error;
+    };
+    QVector<FileCopy> copies;
+    foreach (const QString &itemName, tree.files) {
+        const QFileInfo itemInfo(itemName);
         const QString relativePath = sourceDir.relativeFilePath(itemName);
         if (itemInfo.isSymLink()) {
             // Check if symlink target is inside copied directory
@@ -121,13 +144,6 @@ bool CopyDirectoryOperation::performOperation()
             // add file entry
             autoPush.m_files.prepend(targetDir.absoluteFilePath(relativePath));
             emit outputTextChanged(autoPush.m_files.first());
-        } else if (itemInfo.isDir()) {
-            if (!targetDir.mkpath(targetDir.absoluteFilePath(relativePath))) {
-                setError(InvalidArguments);
-                setErrorString(tr("Cannot create directory \"%1\".").arg(
-                                   QDir::toNativeSeparators(targetDir.absoluteFilePath(relativePath))));
-                return false;
-            }
         } else {
             const QString absolutePath = targetDir.absoluteFilePath(relativePath);
             if (overwrite && QFile::exists(absolutePath) && !deleteFileNowOrLater(absolutePath)) {
@@ -135,18 +151,38 @@ bool CopyDirectoryOperation::performOperation()
                 setErrorString(tr("Failed to overwrite \"%1\".").arg(QDir::toNativeSeparators(absolutePath)));
                 return false;
             }
-            QFile file(sourceDir.absoluteFilePath(itemName));
-            if (!file.copy(absolutePath)) {
-                setError(UserDefinedError);
-                setErrorString(tr("Cannot copy file \"%1\" to \"%2\": %3").arg(
-                                   QDir::toNativeSeparators(sourceDir.absoluteFilePath(itemName)),
-                                   QDir::toNativeSeparators(targetDir.absoluteFilePath(relativePath)),
-                                   file.errorString()));
-                return false;
-            }
-            autoPush.m_files.prepend(targetDir.absoluteFilePath(relativePath));
-            emit outputTextChanged(autoPush.m_files.first());
+            copies.append({ itemName, absolutePath, QString() });
+        }
+    }
+
+    // The copies are independent of each other, run them concurrently unless the
+    // remote file engine is in use.
+    const auto copy = [](FileCopy &item) {
+        try {
+            copyFile(item.source, item.target);
+        } catch (const Error &error) {
+            item.error = error.message();
         }
+    };
+    if (canWalkConcurrently())
+        QtConcurrent::blockingMap(copies, copy);
+    else
+        std::for_each(copies.begin(), copies.end(), copy);
+
+    QString errorString;
+    for (const FileCopy &item : qAsConst(copies)) {
+        if (!item.error.isEmpty()) {
+            if (errorString.isEmpty())
+                errorString = item.error;
+            continue;
+        }
+        autoPush.m_files.prepend(item.target);
+        emit outputTextChanged(item.target);
+    }
+    if (!errorString.isEmpty()) {
+        setError(UserDefinedError);
+        setErrorString(errorString);
+        return false;
     }
     return true;
 }
@@ -26,8 +26,11 @@
 **
 **************************************************************************/
 #include "copyfiletask.h"
+#include "errors.h"
+#include "fileutils.h"
 #include "observer.h"
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QTemporaryFile>
@@ -91,33 +94,30 @@ void CopyFileTask::doTask(QFutureInterface<FileTaskResult> &fi)
         fi.reportFinished(); return;    // error
     }
 
-    QByteArray buffer(32768, Qt::Uninitialized);
-    while (!source.atEnd() && source.error() == QFile::NoError) {
-        if (fi.isCanceled())
-            break;
-        if (fi.isPaused())
-            fi.waitForResume();
-
-        const qint64 read = source.read(buffer.data(), buffer.size());
-        qint64 written = 0;
-        while (written < read) {
-            const qint64 toWrite = file->write(buffer.constData() + written, read - written);
-            if (toWrite < 0) {
-                fi.reportException(TaskException(tr("Writing to file \"%1\" failed: %2")
-                    .arg(QDir::toNativeSeparators(file->fileName()), file->errorString())));
-            }
-            written += toWrite;
-        }
-
-        observer.addSample(read);
-        observer.timerEvent(nullptr);
-        observer.addBytesTransfered(read);
-        observer.addCheckSumData(buffer.data(), read);
-
-        fi.setProgressValueAndText(observer.progressValue(), observer.progressText());
+    // The data is copied by the kernel where possible, the checksum is still calculated
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    qint64 bytesCopied = 0;
+    try {
+        copyFileData(&source, file.data(), FileCopyMethod::Automatic, [&](qint64 copied) {
+            if (fi.isCanceled())
+                return false;
+            if (fi.isPaused())
+                fi.waitForResume();
+
+            observer.addSample(copied - bytesCopied);
+            observer.timerEvent(nullptr);
+            observer.setBytesTransfered(copied);
+            bytesCopied = copied;
+
+            fi.setProgressValueAndText(observer.progressValue(), observer.progressText());
+            return true;
+        }, &hash);
+    } catch (const Error &error) {
+        fi.reportException(TaskException(error.message()));
+        fi.reportFinished(); return;    // error
     }
 
-    fi.reportResult(FileTaskResult(file->fileName(), observer.checkSum(), item, false), 0);
+    fi.reportResult(FileTaskResult(file->fileName(), hash.result(), item, false), 0);
     fi.reportFinished();
 }
 
@@ -34,6 +34,7 @@
 #include "fileio.h"
 #include "fileutils.h"
 #include "copydirectoryoperation.h"
+#include "deletionservice.h"
 #include "archivefactory.h"
 #include "packagemanagercore.h"
 #include "productkeycheck.h"
@@ -94,6 +95,22 @@ static void fixPermissions(const QString &repoPath)
     }
 }
 
+/*
+    Removes the repository at repoPath left by a previous installation. The directory is
+    handed to DeletionService, which removes it in the background while the new
+    repository is written. If the service cannot take it, for example while running
+    through the remote file engine, the directory is removed right away.
+*/
+static void removePreviousRepository(const QString &repoPath)
+{
+    const QString path = QDir::cleanPath(repoPath);
+    if (DeletionService::instance().remove(path, QFileInfo(path).absolutePath()))
+        return;
+
+    fixPermissions(path);
+    QInstaller::removeDirectory(path);
+}
+
 static void removeDirectory(const QString &path, AutoHelper *const helper)
 {
     QInstaller::removeDirectory(path);
@@ -181,10 +198,8 @@ bool CreateLocalRepositoryOperation::performOperation()
         }
 
         // if we're running as installer and install into an existing target, remove possible previous repos
-        if (QFile::exists(repoPath)) {
-            Static::fixPermissions(repoPath);
-            QInstaller::removeDirectory(repoPath);
-        }
+        if (QFile::exists(repoPath))
+            Static::removePreviousRepository(repoPath);
 
         // create the local repository target dir
         KDUpdater::MkdirOperation mkDirOp;
@@ -329,7 +344,8 @@ bool CreateLocalRepositoryOperation::performOperation()
                     repo.filePath(name), nameVersionHash.value(name), &helper));
                 emit outputTextChanged(helper.m_files.first());
 
-                // copy the 7z files that are inside the component index into the target
+                // copy the 7z files that are inside the component index into the target,
+                // directly from their segments in the installer binary
                 const ResourceCollection collection = manager.collectionByName(name.toUtf8());
                 foreach (const QSharedPointer<Resource> &resource, collection.resources()) {
                     const bool isOpen = resource->isOpen();
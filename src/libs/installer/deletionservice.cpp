@@ -0,0 +1,331 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "deletionservice.h"
+
+#include "fileutils.h"
+#include "globals.h"
+#include "lockfile.h"
+#include "remoteclient.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <QTemporaryDir>
+#include <QThread>
+
+using namespace QInstaller;
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::DeletionService
+    \brief The \c DeletionService class removes files and directories in the background.
+
+    Removing a large directory tree or many single files can take a long time, which is
+    spent on the critical path of an update or uninstallation otherwise. remove() only
+    renames the given path into a trash directory on the same file system, which is cheap
+    regardless of the size of the tree, and leaves the actual removal to a background
+    thread running with idle priority.
+
+    Each trash directory is guarded by a lock file next to it while the application is
+    running. Whatever cannot be removed, for example a file that is still in use, stays in
+    the trash directory and is removed by a later run, either through removeStaleTrash()
+    or when a new trash directory is created in the same place.
+
+    Pending removals are finished when the application exits. The service is not used
+    while running through the remote file engine, remove() returns \c false then and the
+    caller is expected to delete the path itself.
+*/
+
+static void removePath(const QString &path)
+{
+    const QFileInfo fi(path);
+    if (fi.isDir() && !fi.isSymLink()) {
+        QInstaller::removeDirectory(path, true);
+    } else {
+        QFile file(path);
+        if (!file.remove()) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot remove file" << path << ":"
+                << file.errorString() << ". It is removed by a later run.";
+        }
+    }
+}
+
+DeletionService::DeletionService()
+    : m_thread(nullptr)
+    , m_counter(0)
+    , m_busy(false)
+    , m_stopped(false)
+{
+    qAddPostRoutine([] { DeletionService::instance().shutdown(); });
+}
+
+DeletionService::~DeletionService()
+{
+    shutdown();
+}
+
+/*!
+    Returns the application global instance.
+*/
+DeletionService &DeletionService::instance()
+{
+    static DeletionService instance;
+    return instance;
+}
+
+/*!
+    Moves \a path out of the way and schedules it for removal in the background. \a path
+    can be a file, a symbolic link, or a directory, which is removed recursively.
+
+    The trash directory is created in the temporary directory if it is on the same volume
+    as \a path. Otherwise it is created next to \a root, which should be a directory that
+    contains \a path, for example the installation directory. This keeps the trash out of
+    the tree that is cleaned up.
+
+    Returns \c true if \a path has been moved to the trash. Returns \c false if \a path
+    does not exist or cannot be moved, in which case the caller needs to remove it.
+*/
+bool DeletionService::remove(const QString &path, const QString &root)
+{
+    if (RemoteClient::instance().isActive())
+        return false;
+
+    const QFileInfo fi(path);
+    if (!fi.exists() && !fi.isSymLink())
+        return false;
+
+    const QString source = fi.absoluteFilePath();
+    QString target;
+    {
+        QMutexLocker _(&m_mutex);
+        if (m_stopped)
+            return false;
+        const QString trash = trashDirectory(source, root);
+        if (trash.isEmpty())
+            return false;
+        target = trash + QLatin1Char('/') + QString::number(++m_counter);
+    }
+
+    if (!QDir().rename(source, target))
+        return false;
+
+    QMutexLocker _(&m_mutex);
+    schedule(target);
+    return true;
+}
+
+/*!
+    Schedules the trash directories in \a directory that were left behind by previous runs
+    for removal. Trash directories of applications that are still running are not touched.
+*/
+void DeletionService::removeStaleTrash(const QString &directory)
+{
+    if (RemoteClient::instance().isActive())
+        return;
+
+    QMutexLocker _(&m_mutex);
+    if (!m_stopped)
+        collectStaleTrash(QDir::cleanPath(directory));
+}
+
+/*!
+    Blocks until all paths scheduled by remove() and removeStaleTrash() have been removed.
+*/
+void DeletionService::waitForDone()
+{
+    QMutexLocker _(&m_mutex);
+    while (m_busy || !m_queue.isEmpty())
+        m_idle.wait(&m_mutex);
+}
+
+/*!
+    Returns the trash directories created by this application.
+*/
+QStringList DeletionService::trashDirectories()
+{
+    QMutexLocker _(&m_mutex);
+    return m_trashByBase.values();
+}
+
+/*!
+    \internal
+
+    Returns the trash directory to use for \a path, creating it on first use. Expects
+    the mutex to be locked. Results are cached per \a root, or per parent directory of
+    \a path if \a root is empty, as looking up the volume is not free.
+*/
+QString DeletionService::trashDirectory(const QString &path, const QString &root)
+{
+    const QString key = root.isEmpty() ? QFileInfo(path).absolutePath() : QDir::cleanPath(root);
+    const auto it = m_trashDirectories.constFind(key);
+    if (it != m_trashDirectories.constEnd())
+        return it.value();
+
+    QStringList candidates;
+    const QStorageInfo volume(path);
+    if (volume.isValid() && volume == QStorageInfo(QDir::tempPath()))
+        candidates.append(QDir::tempPath());
+    if (!root.isEmpty())
+        candidates.append(QFileInfo(key).absolutePath());
+
+    QString trash;
+    foreach (const QString &candidate, candidates) {
+        trash = m_trashByBase.value(candidate);
+        if (!trash.isEmpty())
+            break;
+        collectStaleTrash(candidate);
+
+        QTemporaryDir dir(candidate + QLatin1String("/installerTrash-XXXXXX"));
+        if (!dir.isValid())
+            continue;
+        KDUpdater::LockFile *lock = new KDUpdater::LockFile(dir.path() + QLatin1String(".lock"));
+        if (!lock->lock()) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot use trash directory"
+                << dir.path() << ":" << lock->errorString();
+            delete lock;
+            continue;
+        }
+        dir.setAutoRemove(false);
+        trash = dir.path();
+        m_trashByBase.insert(candidate, trash);
+        m_locks.insert(trash, lock);
+        break;
+    }
+    m_trashDirectories.insert(key, trash);
+    return trash;
+}
+
+/*!
+    \internal
+
+    Schedules the trash directories in \a directory that are not locked, which means that
+    the application that created them is not running anymore. The lock is kept until the
+    application exits, so a concurrent run does not pick them up twice. Expects the mutex
+    to be locked.
+*/
+void DeletionService::collectStaleTrash(const QString &directory)
+{
+    const QStringList names = QDir(directory).entryList(QStringList()
+        << QLatin1String("installerTrash-*"), QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+    foreach (const QString &name, names) {
+        const QString path = directory + QLatin1Char('/') + name;
+        if (m_locks.contains(path))
+            continue;
+
+        KDUpdater::LockFile *lock = new KDUpdater::LockFile(path + QLatin1String(".lock"));
+        if (!lock->lock()) {
+            delete lock;
+            continue;
+        }
+        m_locks.insert(path, lock);
+        schedule(path);
+    }
+}
+
+/*!
+    \internal
+
+    Adds \a path to the queue and starts the background thread if needed. Expects the
+    mutex to be locked.
+*/
+void DeletionService::schedule(const QString &path)
+{
+    m_queue.append(path);
+    if (!m_thread) {
+        // Idle priority, the removal must not slow down the remaining installation steps.
+        m_thread = QThread::create([this] { run(); });
+        m_thread->setObjectName(QLatin1String("DeletionService"));
+        m_thread->start(QThread::IdlePriority);
+    }
+    m_queueChanged.wakeOne();
+}
+
+/*!
+    \internal
+*/
+void DeletionService::run()
+{
+    QMutexLocker locker(&m_mutex);
+    forever {
+        while (m_queue.isEmpty() && !m_stopped)
+            m_queueChanged.wait(&m_mutex);
+        if (m_queue.isEmpty())
+            break;
+
+        const QString path = m_queue.takeFirst();
+        m_busy = true;
+        locker.unlock();
+        removePath(path);
+        locker.relock();
+        m_busy = false;
+        m_idle.wakeAll();
+    }
+    m_idle.wakeAll();
+}
+
+/*!
+    \internal
+
+    Finishes the pending removals and removes the trash directories if they are empty.
+    Releases the locks in any case, so that a later run picks up what is left.
+*/
+void DeletionService::shutdown()
+{
+    QThread *thread = nullptr;
+    {
+        QMutexLocker _(&m_mutex);
+        if (m_stopped)
+            return;
+        m_stopped = true;
+        thread = m_thread;
+        m_queueChanged.wakeAll();
+    }
+
+    if (thread) {
+        thread->wait();
+        delete thread;
+    }
+
+    QMutexLocker _(&m_mutex);
+    m_thread = nullptr;
+    QDir dir;
+    foreach (const QString &trash, m_trashByBase) {
+        if (!dir.rmdir(trash)) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot remove trash directory"
+                << trash;
+        }
+    }
+    foreach (KDUpdater::LockFile *lock, m_locks)
+        lock->unlock();
+    qDeleteAll(m_locks);
+    m_locks.clear();
+    m_trashDirectories.clear();
+    m_trashByBase.clear();
+}
@@ -0,0 +1,86 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef DELETIONSERVICE_H
+#define DELETIONSERVICE_H
+
+#include "installer_global.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QWaitCondition>
+
+QT_FORWARD_DECLARE_CLASS(QThread)
+
+namespace KDUpdater {
+class LockFile;
+}
+
+namespace QInstaller {
+
+class INSTALLER_EXPORT DeletionService
+{
+    Q_DISABLE_COPY(DeletionService)
+
+public:
+    static DeletionService &instance();
+
+    bool remove(const QString &path, const QString &root = QString());
+    void removeStaleTrash(const QString &directory);
+    void waitForDone();
+
+    QStringList trashDirectories();
+
+private:
+    DeletionService();
+    ~DeletionService();
+
+    QString trashDirectory(const QString &path, const QString &root);
+    void collectStaleTrash(const QString &directory);
+    void schedule(const QString &path);
+    void run();
+    void shutdown();
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_queueChanged;
+    QWaitCondition m_idle;
+    QStringList m_queue;
+    QHash<QString, QString> m_trashDirectories;
+    QHash<QString, QString> m_trashByBase;
+    QHash<QString, KDUpdater::LockFile *> m_locks;
+    QThread *m_thread;
+    quint64 m_counter;
+    bool m_busy;
+    bool m_stopped;
+};
+
+} // namespace QInstaller
+
+#endif // DELETIONSERVICE_H
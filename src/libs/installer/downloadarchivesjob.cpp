@@ -27,16 +27,24 @@
 **************************************************************************/
 #include "downloadarchivesjob.h"
 
+#include "archivecache.h"
+#include "archivemanifest.h"
+#include "binarydelta.h"
 #include "binaryformatenginehandler.h"
 #include "component.h"
+#include "errors.h"
 #include "messageboxhandler.h"
 #include "packagemanagercore.h"
 #include "utils.h"
 #include "fileutils.h"
+#include "globals.h"
+#include "settings.h"
+#include "tracelog.h"
 
 #include "filedownloader.h"
 #include "filedownloaderfactory.h"
 
+#include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QTimerEvent>
 
@@ -58,6 +66,8 @@ DownloadArchivesJob::DownloadArchivesJob(PackageManagerCore *core)
     , m_progressChangedTimerId(0)
     , m_totalSizeToDownload(0)
     , m_totalSizeDownloaded(0)
+    , m_traceStart(-1)
+    , m_skipDelta(false)
 {
     setCapabilities(Cancelable);
 }
@@ -96,6 +106,7 @@ void DownloadArchivesJob::doStart()
 {
     m_totalDownloadSpeedTimer.start();
     m_archivesDownloaded = 0;
+    initializeArchiveCache();
     fetchNextArchiveHash();
 }
 
@@ -116,6 +127,9 @@ void DownloadArchivesJob::fetchNextArchiveHash()
         return;
     }
 
+    m_traceStart = TraceLog::instance().timestamp();
+    m_skipDelta = false;
+    m_currentManifest.clear();
     if (m_archivesToDownload.first().checkSha1CheckSum) {
         if (m_canceled) {
             finishWithError(tr("Canceled"));
@@ -136,7 +150,7 @@ void DownloadArchivesJob::fetchNextArchiveHash()
                 this, &DownloadArchivesJob::finishedHashDownload, Qt::QueuedConnection);
         m_downloader->download();
     } else {
-        QMetaObject::invokeMethod(this, "fetchNextArchive", Qt::QueuedConnection);
+        QMetaObject::invokeMethod(this, "fetchArchiveManifest", Qt::QueuedConnection);
     }
 }
 
@@ -148,12 +162,90 @@ void DownloadArchivesJob::finishedHashDownload()
     if (sha1HashFile.open(QFile::ReadOnly)) {
         emit hashDownloadReady(m_downloader->downloadedFileName());
         m_currentHash = sha1HashFile.readAll();
-        fetchNextArchive();
+        fetchArchiveManifest();
     } else {
         finishWithError(tr("Downloading hash signature failed."));
     }
 }
 
+/*!
+    Fetches the manifest of the next archive if the repository provides one, and
+    continues with fetching the archive. If the checksum of the archive is verified,
+    the checksum of the manifest is fetched and verified as well.
+*/
+void DownloadArchivesJob::fetchArchiveManifest()
+{
+    if (m_canceled) {
+        finishWithError(tr("Canceled"));
+        return;
+    }
+
+    if (m_archivesToDownload.isEmpty() || !m_archivesToDownload.first().hasManifest) {
+        fetchNextArchive();
+        return;
+    }
+
+    m_currentManifestHash.clear();
+    if (m_archivesToDownload.first().checkSha1CheckSum)
+        downloadManifestFile(QLatin1String(".manifest.sha1"), &DownloadArchivesJob::finishedManifestHashDownload);
+    else
+        downloadManifestFile(QLatin1String(".manifest"), &DownloadArchivesJob::finishedManifestDownload);
+}
+
+/*!
+    Remembers the just downloaded checksum of the archive manifest and fetches the manifest.
+*/
+void DownloadArchivesJob::finishedManifestHashDownload()
+{
+    Q_ASSERT(m_downloader != nullptr);
+
+    if (m_canceled || m_archivesToDownload.isEmpty())
+        return;
+
+    QFile sha1HashFile(m_downloader->downloadedFileName());
+    if (!sha1HashFile.open(QFile::ReadOnly)) {
+        manifestDownloadFailed(tr("Cannot open file \"%1\" for reading: %2").arg(QDir::toNativeSeparators(
+            sha1HashFile.fileName()), sha1HashFile.errorString()));
+        return;
+    }
+    m_currentManifestHash = sha1HashFile.readAll().trimmed();
+    downloadManifestFile(QLatin1String(".manifest"), &DownloadArchivesJob::finishedManifestDownload);
+}
+
+/*!
+    Remembers the just downloaded archive manifest and fetches the archive. The manifest
+    is ignored if its checksum does not match.
+*/
+void DownloadArchivesJob::finishedManifestDownload()
+{
+    Q_ASSERT(m_downloader != nullptr);
+
+    if (m_canceled || m_archivesToDownload.isEmpty())
+        return;
+
+    if (m_archivesToDownload.first().checkSha1CheckSum
+            && m_currentManifestHash != m_downloader->sha1Sum().toHex()) {
+        manifestDownloadFailed(tr("Hash verification of \"%1\" failed.")
+            .arg(m_downloader->url().toString()));
+        return;
+    }
+
+    m_currentManifest = m_downloader->downloadedFileName();
+    fetchNextArchive();
+}
+
+/*!
+    Continues with fetching the archive after the manifest download failed with \a error.
+*/
+void DownloadArchivesJob::manifestDownloadFailed(const QString &error)
+{
+    if (m_canceled)
+        return;
+
+    qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot download archive manifest:" << error;
+    fetchNextArchive();
+}
+
 /*!
     Fetches the next archive and registers it in the installer.
 */
@@ -169,6 +261,14 @@ void DownloadArchivesJob::fetchNextArchive()
         return;
     }
 
+    if (fetchArchiveFromCache()) {
+        QMetaObject::invokeMethod(this, "fetchNextArchiveHash", Qt::QueuedConnection);
+        return;
+    }
+
+    if (fetchDeltaArchive())
+        return;
+
     if (m_downloader != nullptr)
         m_downloader->deleteLater();
 
@@ -300,23 +400,94 @@ void DownloadArchivesJob::registerFile()
             return;
         }
     } else {
-        ++m_archivesDownloaded;
-        m_totalSizeDownloaded += QFile(m_downloader->downloadedFileName()).size();
-        if (m_progressChangedTimerId) {
-            killTimer(m_progressChangedTimerId);
-            m_progressChangedTimerId = 0;
-            emit progressChanged(double(m_archivesDownloaded) / m_archivesToDownloadCount);
-        }
+        if (m_archiveCache && m_archivesToDownload.first().checkSha1CheckSum)
+            m_archiveCache->store(m_currentHash, m_downloader->downloadedFileName());
+
+        registerArchive(m_downloader->downloadedFileName(), QLatin1String("download archive"));
+    }
+    fetchNextArchiveHash();
+}
+
+/*!
+    Registers the archive  fileName of the first pending download item in the
+    installer's file system, and records a trace span named  traceName for it.
+*/
+void DownloadArchivesJob::registerArchive(const QString &fileName, const QString &traceName)
+{
+    ++m_archivesDownloaded;
+    m_totalSizeDownloaded += QFile(fileName).size();
+    if (m_progressChangedTimerId) {
+        killTimer(m_progressChangedTimerId);
+        m_progressChangedTimerId = 0;
+        emit progressChanged(double(m_archivesDownloaded) / m_archivesToDownloadCount);
+    }
+
+    const PackageManagerCore::DownloadItem item = m_archivesToDownload.takeFirst();
+    BinaryFormatEngineHandler::instance()->registerResource(item.fileName, fileName);
+    if (!m_currentManifest.isEmpty()) {
+        BinaryFormatEngineHandler::instance()->registerResource(
+            ArchiveManifest::manifestFileName(item.fileName), m_currentManifest);
+    }
+    TraceLog::instance().addSpan(TraceLog::Download, traceName, item.sourceUrl, m_traceStart);
+
+    emit fileDownloadReady(fileName);
+}
 
-        const PackageManagerCore::DownloadItem item = m_archivesToDownload.takeFirst();
-        BinaryFormatEngineHandler::instance()->registerResource(item.fileName,
-            m_downloader->downloadedFileName());
+/*!
+    Reconstructs the current archive from the just downloaded binary delta and
+    the cached base archive. Falls back to downloading the full archive if the
+    delta cannot be applied.
+*/
+void DownloadArchivesJob::finishedDeltaDownload()
+{
+    Q_ASSERT(m_downloader != nullptr);
 
-        emit fileDownloadReady(m_downloader->downloadedFileName());
+    if (m_canceled || m_archivesToDownload.isEmpty())
+        return;
+
+    const QString deltaFileName = m_downloader->downloadedFileName();
+    emit fileDownloadReady(deltaFileName);
+
+    const QString fileName = archiveFileName();
+    CachedArchive *const base = m_archiveCache->itemByChecksum(m_currentDeltaBase);
+    try {
+        if (!base)
+            throw Error(tr("The base archive is not cached."));
+
+        base->setActive(true);
+        const QByteArray checksum = BinaryDelta::apply(base->fileName(), deltaFileName, fileName);
+        if (checksum.toHex() != m_currentHash)
+            throw Error(tr("The reconstructed archive does not match the expected checksum."));
+    } catch (const Error &error) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot apply binary delta"
+            << deltaFileName << ":" << error.message() << "Downloading the full archive.";
+        QFile::remove(fileName);
+        m_skipDelta = true;
+        fetchNextArchive();
+        return;
     }
+
+    base->touch();
+    m_archiveCache->store(m_currentHash, fileName);
+    registerArchive(fileName, QLatin1String("delta archive"));
     fetchNextArchiveHash();
 }
 
+/*!
+    Falls back to downloading the full archive after the binary delta download
+    failed with \a error.
+*/
+void DownloadArchivesJob::deltaDownloadFailed(const QString &error)
+{
+    if (m_canceled)
+        return;
+
+    qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot download binary delta:" << error
+        << "Downloading the full archive.";
+    m_skipDelta = true;
+    fetchNextArchive();
+}
+
 void DownloadArchivesJob::downloadCanceled()
 {
     emitFinishedWithError(Job::Canceled, m_downloader->errorString());
@@ -350,7 +521,133 @@ void DownloadArchivesJob::finishWithError(const QString &error)
         emitFinishedWithError(QInstaller::DownloadError, msg.arg(error, m_downloader->url().toString()));
 }
 
-KDUpdater::FileDownloader *DownloadArchivesJob::setupDownloader(const QString &suffix, const QString &queryString)
+/*
+    Opens the persistent archive cache if enabled in the installer settings. The cache
+    is left unused if another process holds the lock of the cache directory.
+*/
+void DownloadArchivesJob::initializeArchiveCache()
+{
+    m_archiveCache.reset();
+
+    const qint64 sizeLimit = m_core->settings().archiveCacheSize();
+    if (sizeLimit <= 0)
+        return;
+
+    m_archiveCache.reset(new ArchiveCache(ArchiveCache::archiveCachePath(
+        m_core->settings().localCachePath())));
+    if (!m_archiveCache->isValid()) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot use archive cache:"
+            << m_archiveCache->errorString();
+        m_archiveCache.reset();
+        return;
+    }
+    m_archiveCache->setSizeLimit(sizeLimit * 1024 * 1024);
+}
+
+/*
+    Copies the first pending archive from the archive cache to the location it would
+    be downloaded to. The cache is keyed by the expected SHA1 checksum, so only archives
+    with a downloaded hash are looked up. Returns true if the archive was found and
+    registered.
+*/
+bool DownloadArchivesJob::fetchArchiveFromCache()
+{
+    const PackageManagerCore::DownloadItem &item = m_archivesToDownload.first();
+    if (!m_archiveCache || !item.checkSha1CheckSum)
+        return false;
+
+    const QString fileName = archiveFileName();
+    if (fileName.isEmpty() || !m_archiveCache->fetch(m_currentHash, fileName))
+        return false;
+
+    emit outputTextChanged(tr("Using cached archive \"%1\".").arg(QFileInfo(fileName).fileName()));
+    registerArchive(fileName, QLatin1String("cached archive"));
+    return true;
+}
+
+/*
+    Starts downloading a binary delta for the first pending archive if the repository
+    provides one against an archive available from the archive cache. Returns true if
+    the download was started.
+*/
+bool DownloadArchivesJob::fetchDeltaArchive()
+{
+    const PackageManagerCore::DownloadItem &item = m_archivesToDownload.first();
+    if (m_skipDelta || !m_archiveCache || !item.checkSha1CheckSum || item.deltaUrls.isEmpty())
+        return false;
+
+    m_currentDeltaBase.clear();
+    for (auto it = item.deltaUrls.constBegin(); it != item.deltaUrls.constEnd(); ++it) {
+        if (m_archiveCache->itemByChecksum(it.key())) {
+            m_currentDeltaBase = it.key();
+            break;
+        }
+    }
+    if (m_currentDeltaBase.isEmpty() || archiveFileName().isEmpty())
+        return false;
+
+    if (m_downloader != nullptr)
+        m_downloader->deleteLater();
+
+    m_downloader = setupDownloader(QLatin1String(".delta"), m_core->value(scUrlQueryString),
+        item.deltaUrls.value(m_currentDeltaBase));
+    if (!m_downloader)
+        return false;
+
+    // Do not bother the user about a missing delta, the full archive is still available
+    disconnect(m_downloader, &FileDownloader::downloadAborted, this, &DownloadArchivesJob::downloadFailed);
+    connect(m_downloader, &FileDownloader::downloadAborted, this, &DownloadArchivesJob::deltaDownloadFailed,
+        Qt::QueuedConnection);
+
+    emit progressChanged(double(m_archivesDownloaded) / m_archivesToDownloadCount);
+    connect(m_downloader, SIGNAL(downloadProgress(double)), this, SLOT(emitDownloadProgress(double)));
+    connect(m_downloader, &FileDownloader::downloadCompleted,
+            this, &DownloadArchivesJob::finishedDeltaDownload, Qt::QueuedConnection);
+
+    m_downloader->download();
+    return true;
+}
+
+/*
+    Returns the local file name for the first pending archive, or an empty string
+    if the component of the archive cannot be found.
+*/
+QString DownloadArchivesJob::archiveFileName() const
+{
+    const QFileInfo fi = QFileInfo(m_archivesToDownload.first().fileName);
+    const Component *const component = m_core->componentByName(PackageManagerCore::checkableName(QFileInfo(fi.path()).fileName()));
+    if (!component)
+        return QString();
+
+    return component->localTempPath() + QLatin1Char('/') + component->name()
+        + QLatin1Char('/') + fi.fileName();
+}
+
+/*
+    Downloads the file with \a suffix that belongs to the manifest of the current archive
+    and calls \a finished when done. Failed downloads do not abort the job, the archive
+    can be installed without its manifest, only slower.
+*/
+void DownloadArchivesJob::downloadManifestFile(const QString &suffix, void (DownloadArchivesJob::*finished)())
+{
+    if (m_downloader)
+        m_downloader->deleteLater();
+
+    m_downloader = setupDownloader(suffix);
+    if (!m_downloader) {
+        fetchNextArchive();
+        return;
+    }
+
+    disconnect(m_downloader, &FileDownloader::downloadAborted, this, &DownloadArchivesJob::downloadFailed);
+    connect(m_downloader, &FileDownloader::downloadAborted, this, &DownloadArchivesJob::manifestDownloadFailed,
+        Qt::QueuedConnection);
+    connect(m_downloader, &FileDownloader::downloadCompleted, this, finished, Qt::QueuedConnection);
+    m_downloader->download();
+}
+
+KDUpdater::FileDownloader *DownloadArchivesJob::setupDownloader(const QString &suffix, const QString &queryString,
+    const QString &sourceUrl)
 {
     KDUpdater::FileDownloader *downloader = nullptr;
     const QFileInfo fi = QFileInfo(m_archivesToDownload.first().fileName);
@@ -359,7 +656,8 @@ KDUpdater::FileDownloader *DownloadArchivesJob::setupDownloader(const QString &s
         QString fullQueryString;
         if (!queryString.isEmpty())
             fullQueryString = QLatin1String("?") + queryString;
-        const QUrl url(m_archivesToDownload.first().sourceUrl + suffix + fullQueryString);
+        const QUrl url((sourceUrl.isEmpty() ? m_archivesToDownload.first().sourceUrl + suffix : sourceUrl)
+            + fullQueryString);
         const QString &scheme = url.scheme();
         downloader = FileDownloaderFactory::instance().create(scheme, this);
 
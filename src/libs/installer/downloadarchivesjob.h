@@ -33,6 +33,7 @@
 #include "packagemanagercore.h"
 #include <QtCore/QPair>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QScopedPointer>
 
 QT_BEGIN_NAMESPACE
 class QTimerEvent;
@@ -44,6 +45,7 @@ namespace KDUpdater {
 
 namespace QInstaller {
 
+class ArchiveCache;
 class MessageBoxHandler;
 
 class DownloadArchivesJob : public Job
@@ -82,10 +84,23 @@ protected Q_SLOTS:
     void fetchNextArchive();
     void fetchNextArchiveHash();
     void finishedHashDownload();
+    void fetchArchiveManifest();
+    void finishedManifestHashDownload();
+    void finishedManifestDownload();
+    void manifestDownloadFailed(const QString &error);
+    void finishedDeltaDownload();
+    void deltaDownloadFailed(const QString &error);
     void emitDownloadProgress(double progress);
 
 private:
-    KDUpdater::FileDownloader *setupDownloader(const QString &suffix = QString(), const QString &queryString = QString());
+    KDUpdater::FileDownloader *setupDownloader(const QString &suffix = QString(), const QString &queryString = QString(),
+        const QString &sourceUrl = QString());
+    QString archiveFileName() const;
+    void initializeArchiveCache();
+    bool fetchArchiveFromCache();
+    bool fetchDeltaArchive();
+    void registerArchive(const QString &fileName, const QString &traceName);
+    void downloadManifestFile(const QString &suffix, void (DownloadArchivesJob::*finished)());
 
 private:
     PackageManagerCore *m_core;
@@ -97,12 +112,19 @@ private:
 
     bool m_canceled;
     QByteArray m_currentHash;
+    QString m_currentManifest;
+    QByteArray m_currentManifestHash;
     double m_lastFileProgress;
     int m_progressChangedTimerId;
 
     quint64 m_totalSizeToDownload;
     quint64 m_totalSizeDownloaded;
     QElapsedTimer m_totalDownloadSpeedTimer;
+    qint64 m_traceStart;
+
+    QScopedPointer<ArchiveCache> m_archiveCache;
+    QByteArray m_currentDeltaBase;
+    bool m_skipDelta;
 };
 
 } // namespace QInstaller
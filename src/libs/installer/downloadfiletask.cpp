@@ -73,6 +73,8 @@ AuthenticationRequiredException::AuthenticationRequiredException(Type type, cons
 
 Downloader::Downloader()
     : m_finished(0)
+    , m_maxDownloads(16)
+    , m_maxHostDownloads(6)
 {
     connect(&m_timer, &QTimer::timeout, this, &Downloader::onTimeout);
     connect(&m_nam, &QNetworkAccessManager::finished, this, &Downloader::onFinished);
@@ -105,16 +107,27 @@ void Downloader::download(QFutureInterface<FileTaskResult> &fi, const QList<File
     QTimer::singleShot(0, this, &Downloader::doDownload);
 }
 
+/*!
+    Limits the number of downloads running at the same time to \a downloads, and to
+    \a downloadsPerHost for a single host. The remaining items are queued and started
+    as soon as running downloads finish, instead of creating a network reply for each
+    item up front.
+*/
+void Downloader::setMaxConcurrentDownloads(int downloads, int downloadsPerHost)
+{
+    m_maxDownloads = qMax(1, downloads);
+    m_maxHostDownloads = qMax(1, downloadsPerHost);
+}
+
 void Downloader::doDownload()
 {
     m_timer.start(1000); // Use a timer to check for canceled downloads.
 
-    foreach (const FileTaskItem &item, m_items) {
-        if (!startDownload(item))
-            break;
-    }
+    foreach (const FileTaskItem &item, m_items)
+        m_pending[QUrl(item.source()).host()].enqueue(item);
+    startPendingDownloads();
 
-    if (m_items.isEmpty() || m_futureInterface->isCanceled()) {
+    if (m_downloads.empty() || m_futureInterface->isCanceled()) {
         m_futureInterface->reportFinished();
         emit finished();    // emit finished, so the event loop can shutdown
     }
@@ -230,7 +243,7 @@ void Downloader::onFinished(QNetworkReply *reply)
                     m_redirects.insert(redirectReply, redirect);
                 m_redirects.insert(redirectReply, url);
 
-                m_downloads.erase(reply);
+                releaseDownload(reply);
                 m_redirects.remove(reply);
                 reply->deleteLater();
                 return;
@@ -255,14 +268,22 @@ void Downloader::onFinished(QNetworkReply *reply)
         if (expectedCheckSum != data.observer->checkSum().toHex())
             checksumMismatch = true;
     }
-    m_futureInterface->reportResult(FileTaskResult(filename, data.observer->checkSum(), data.taskItem,
-                                                  checksumMismatch));
-
-    m_downloads.erase(reply);
+    FileTaskResult result(filename, data.observer->checkSum(), data.taskItem, checksumMismatch);
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304)
+        result.insert(TaskRole::NotModified, true);
+    if (reply->hasRawHeader("ETag"))
+        result.insert(TaskRole::ETag, reply->rawHeader("ETag"));
+    if (reply->hasRawHeader("Last-Modified"))
+        result.insert(TaskRole::LastModified, reply->rawHeader("Last-Modified"));
+    m_futureInterface->reportResult(result);
+
+    releaseDownload(reply);
     m_redirects.remove(reply);
     reply->deleteLater();
 
     m_finished++;
+    if (!m_futureInterface->isCanceled())
+        startPendingDownloads();
     if (m_downloads.empty() || m_futureInterface->isCanceled()) {
         m_futureInterface->reportFinished();
         emit finished();    // emit finished, so the event loop can shutdown
@@ -396,9 +417,20 @@ QNetworkReply *Downloader::startDownload(const FileTaskItem &item)
         return 0;
     }
 
-    QNetworkReply *reply = m_nam.get(QNetworkRequest(source));
+    QNetworkRequest request(source);
+    // Conditional request, the server answers 304 Not Modified if the file is unchanged.
+    const QByteArray eTag = item.value(TaskRole::ETag).toByteArray();
+    if (!eTag.isEmpty())
+        request.setRawHeader("If-None-Match", eTag);
+    const QByteArray lastModified = item.value(TaskRole::LastModified).toByteArray();
+    if (!lastModified.isEmpty())
+        request.setRawHeader("If-Modified-Since", lastModified);
+
+    QNetworkReply *reply = m_nam.get(request);
     std::unique_ptr<Data> data(new Data(item));
+    data->host = source.host();
     m_downloads[reply] = std::move(data);
+    ++m_hostDownloads[source.host()];
 
     connect(reply, &QIODevice::readyRead, this, &Downloader::onReadyRead);
     connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this,
@@ -410,6 +442,45 @@ QNetworkReply *Downloader::startDownload(const FileTaskItem &item)
     return reply;
 }
 
+/*
+    Starts queued downloads until the overall limit is reached, taking one item
+    per host in turn so that all hosts progress at the same time.
+*/
+void Downloader::startPendingDownloads()
+{
+    bool started = true;
+    while (started && int(m_downloads.size()) < m_maxDownloads) {
+        started = false;
+        auto it = m_pending.begin();
+        while (it != m_pending.end() && int(m_downloads.size()) < m_maxDownloads) {
+            if (m_hostDownloads.value(it.key()) >= m_maxHostDownloads) {
+                ++it;
+                continue;
+            }
+            const FileTaskItem item = it.value().dequeue();
+            it = it.value().isEmpty() ? m_pending.erase(it) : std::next(it);
+
+            if (!startDownload(item)) {
+                m_pending.clear();
+                return;
+            }
+            started = true;
+        }
+    }
+}
+
+void Downloader::releaseDownload(QNetworkReply *reply)
+{
+    const auto it = m_downloads.find(reply);
+    if (it == m_downloads.end())
+        return;
+
+    const QString host = it->second->host;
+    if (--m_hostDownloads[host] <= 0)
+        m_hostDownloads.remove(host);
+    m_downloads.erase(it);
+}
+
 
 // -- DownloadFileTask
 
@@ -449,6 +520,16 @@ void DownloadFileTask::setProxyFactory(KDUpdater::FileDownloaderProxyFactory *fa
     m_proxyFactory.reset(factory);
 }
 
+/*!
+    Limits the number of concurrent downloads of this task to \a downloads in total
+    and to \a downloadsPerHost for a single host.
+*/
+void DownloadFileTask::setMaxConcurrentDownloads(int downloads, int downloadsPerHost)
+{
+    m_maxDownloads = downloads;
+    m_maxHostDownloads = downloadsPerHost;
+}
+
 void DownloadFileTask::doTask(QFutureInterface<FileTaskResult> &fi)
 {
     QEventLoop el;
@@ -462,6 +543,7 @@ void DownloadFileTask::doTask(QFutureInterface<FileTaskResult> &fi)
                 items[i].insert(TaskRole::Authenticator, QVariant::fromValue(m_authenticator));
         }
     }
+    downloader.setMaxConcurrentDownloads(m_maxDownloads, m_maxHostDownloads);
     downloader.download(fi, items, (m_proxyFactory.isNull() ? 0 : m_proxyFactory->clone()));
     el.exec();  // That's tricky here, we need to run our own event loop to keep QNAM working.
 }
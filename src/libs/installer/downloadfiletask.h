@@ -40,7 +40,10 @@ namespace QInstaller {
 namespace TaskRole {
 enum
 {
-    Authenticator = TaskRole::TargetFile + 10
+    Authenticator = TaskRole::TargetFile + 10,
+    ETag,           // sent as If-None-Match, result holds the ETag response header
+    LastModified,   // sent as If-Modified-Since, result holds the Last-Modified response header
+    NotModified     // result only, set when the server answered 304 Not Modified
 };
 }
 
@@ -97,12 +100,15 @@ public:
 
     void setAuthenticator(const QAuthenticator &authenticator);
     void setProxyFactory(KDUpdater::FileDownloaderProxyFactory *factory);
+    void setMaxConcurrentDownloads(int downloads, int downloadsPerHost);
 
     void doTask(QFutureInterface<FileTaskResult> &fi) override;
 
 private:
     friend class Downloader;
     QAuthenticator m_authenticator;
+    int m_maxDownloads = 16;
+    int m_maxHostDownloads = 6;
     QScopedPointer<KDUpdater::FileDownloaderProxyFactory> m_proxyFactory;
 };
 
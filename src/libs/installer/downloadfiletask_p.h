@@ -36,6 +36,7 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QQueue>
 #include <QTimer>
 
 #include <memory>
@@ -63,6 +64,7 @@ struct Data
     {}
 
     FileTaskItem taskItem;
+    QString host;
     std::unique_ptr<QFile> file;
     std::unique_ptr<FileTaskObserver> observer;
 };
@@ -78,6 +80,7 @@ public:
 
     void download(QFutureInterface<FileTaskResult> &fi, const QList<FileTaskItem> &items,
         QNetworkProxyFactory *networkProxyFactory);
+    void setMaxConcurrentDownloads(int downloads, int downloadsPerHost);
 
 signals:
     void finished();
@@ -96,14 +99,20 @@ private slots:
 private:
     bool testCanceled();
     QNetworkReply *startDownload(const FileTaskItem &item);
+    void startPendingDownloads();
+    void releaseDownload(QNetworkReply *reply);
 
 private:
     QFutureInterface<FileTaskResult> *m_futureInterface;
 
     QTimer m_timer;
     int m_finished;
+    int m_maxDownloads;
+    int m_maxHostDownloads;
     QNetworkAccessManager m_nam;
     QList<FileTaskItem> m_items;
+    QMap<QString, QQueue<FileTaskItem>> m_pending;
+    QHash<QString, int> m_hostDownloads;
     QMultiHash<QNetworkReply*, QUrl> m_redirects;
     std::unordered_map<QNetworkReply*, std::unique_ptr<Data>> m_downloads;
 };
@@ -28,6 +28,7 @@
 
 #include "extractarchiveoperation_p.h"
 
+#include "archivemanifest.h"
 #include "constants.h"
 #include "globals.h"
 #include "fileguard.h"
@@ -36,6 +37,11 @@
 #include <QThreadPool>
 #include <QFileInfo>
 #include <QDataStream>
+#include <QDirIterator>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 namespace QInstaller {
 
@@ -107,18 +113,34 @@ void ExtractArchiveOperation::backup()
     const bool canCreateSymLinks = QInstaller::canCreateSymbolicLinks();
     bool needsAdminRights = false;
 
+    // Files already installed with the same content are neither backed up nor extracted
+    ArchiveManifest manifest;
+    manifest.load(ArchiveManifest::manifestFileName(archivePath));
+    m_unchangedEntries.clear();
+
     for (auto &entry : entries) {
         const QString completeFilePath = targetDir + QDir::separator() + entry.path;
+        if (!entry.isDirectory && !entry.isSymbolicLink && !manifest.isEmpty()
+                && manifest.matches(entry.path, completeFilePath)
+                && hasSameExecutableBit(entry, completeFilePath)) {
+            m_unchangedEntries.insert(entry.path);
+            continue;
+        }
         if (!entry.isDirectory) {
             // Ignore failed backups, existing files are overwritten when extracting.
             // Should the backups be used on rollback too, this may not be the
             // desired behavior anymore.
-            prepareForFile(completeFilePath);
+            if (!snapshotFile(targetDir, entry.path))
+                prepareForFile(completeFilePath);
         }
         if (!hasAdminRights && !canCreateSymLinks && entry.isSymbolicLink)
             needsAdminRights = true;
     }
     m_totalEntries = entries.size();
+    if (!m_unchangedEntries.isEmpty()) {
+        qCDebug(QInstaller::lcInstallerInstallLog) << "Skipping" << m_unchangedEntries.count()
+            << "unchanged files of" << archivePath;
+    }
     if (needsAdminRights)
         setValue(QLatin1String("admin"), true);
 
@@ -140,7 +162,7 @@ bool ExtractArchiveOperation::performOperation()
 
     connect(&callback, &Callback::progressChanged, this, &ExtractArchiveOperation::progressChanged);
 
-    Worker *worker = new Worker(archivePath, targetDir, m_totalEntries, &callback);
+    Worker *worker = new Worker(archivePath, targetDir, m_totalEntries, m_unchangedEntries, &callback);
     connect(worker, &Worker::finished, &receiver, &Receiver::workerFinished,
         Qt::QueuedConnection);
 
@@ -174,6 +196,9 @@ bool ExtractArchiveOperation::performOperation()
     //    -<filename>.txt (file)
 
     QStringList files = callback.extractedFiles();
+    // Unchanged files are not extracted, but still belong to the package
+    foreach (const QString &entry, m_unchangedEntries)
+        files.prepend(QDir::toNativeSeparators(targetDir + QDir::separator() + entry));
 
     QString installDir = targetDir;
     // If we have package manager in use (normal installer run) then use
@@ -225,6 +250,7 @@ bool ExtractArchiveOperation::performOperation()
     // TODO: Use backups for rollback, too? Doesn't work for uninstallation though.
 
     // delete all backups we can delete right now, remember the rest
+    removeSnapshot();
     foreach (const Backup &i, m_backupFiles)
         deleteFileNowOrLater(i.second);
 
@@ -253,7 +279,9 @@ bool ExtractArchiveOperation::undoOperation()
         if (!readDataFileContents(targetDir, &files))
             return false;
     }
-    startUndoProcess(files);
+    if (hasValue(QLatin1String("keepUnchangedFiles")))
+        keepUnchangedFiles(value(QLatin1String("keepUnchangedFiles")).toString(), &files);
+    startUndoProcess(files, targetDir);
     if (!useStringListType)
         deleteDataFile(m_relocatedDataFileName);
 
@@ -263,9 +291,9 @@ bool ExtractArchiveOperation::undoOperation()
     return true;
 }
 
-void ExtractArchiveOperation::startUndoProcess(const QStringList &files)
+void ExtractArchiveOperation::startUndoProcess(const QStringList &files, const QString &targetDir)
 {
-    WorkerThread *const thread = new WorkerThread(this, files);
+    WorkerThread *const thread = new WorkerThread(this, files, targetDir);
     connect(thread, &WorkerThread::currentFileChanged, this,
         &ExtractArchiveOperation::outputTextChanged);
     connect(thread, &WorkerThread::progressChanged, this,
@@ -327,6 +355,133 @@ bool ExtractArchiveOperation::prepareForFile(const QString &filename)
     return true;
 }
 
+/*
+    Moves the existing file \a relativePath in \a targetDir to the same relative path inside
+    the snapshot directory of this operation. The snapshot directory is created on demand in
+    \a targetDir, so the rename stays on the same file system and keeps the file data in
+    place, like a hard link followed by removing the original would. Returns \c false if the
+    file could not be moved, for example because it lives on a different mount point.
+*/
+bool ExtractArchiveOperation::snapshotFile(const QString &targetDir, const QString &relativePath)
+{
+    const QString filename = targetDir + QDir::separator() + relativePath;
+    if (!QFile::exists(filename))
+        return true;
+
+    if (m_snapshotDir.isEmpty()) {
+        // QDir::mkdir() fails for existing directories, which makes picking a free
+        // name safe against other extract operations running concurrently.
+        const QString base = QDir::cleanPath(targetDir) + QLatin1String("/installerBackup.tmpUpdate");
+        QString path = base;
+        for (int i = 0; !QDir().mkdir(path); ++i) {
+            if (!QFileInfo::exists(path))
+                return false;
+            path = base + QString::fromLatin1(".%1").arg(i);
+        }
+        m_snapshotDir = path;
+        m_snapshotPaths.insert(path);
+    }
+
+    FileGuardLocker locker(filename, FileGuard::globalObject());
+
+    const QString backup = QDir::cleanPath(m_snapshotDir + QLatin1Char('/') + relativePath);
+    const QString backupPath = QFileInfo(backup).absolutePath();
+    if (!m_snapshotPaths.contains(backupPath)) {
+        if (!QDir().mkpath(backupPath))
+            return false;
+        m_snapshotPaths.insert(backupPath);
+    }
+    return QFile::rename(filename, backup);
+}
+
+/*
+    Removes the snapshot directory created by backup() in one go. The directory is handed
+    to DeletionService, with the target directory it lives in as root. If the service
+    cannot take it, for example while running through the remote file engine, the
+    directory is removed right away and files that cannot be removed, for example
+    because they are still in use, are registered for delayed deletion.
+*/
+void ExtractArchiveOperation::removeSnapshot()
+{
+    if (m_snapshotDir.isEmpty())
+        return;
+
+    const QString path = m_snapshotDir;
+    m_snapshotDir.clear();
+    m_snapshotPaths.clear();
+
+    if (DeletionService::instance().remove(path, QFileInfo(path).absolutePath()))
+        return;
+
+    try {
+        QInstaller::removeDirectory(path, true);
+    } catch (const Error &e) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot remove backup directory"
+            << path << ":" << e.message();
+    }
+    QStringList remaining;
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::System,
+        QDirIterator::Subdirectories);
+    while (it.hasNext())
+        remaining.append(it.next());
+    registerForDelayedDeletion(remaining);
+}
+
+/*
+    Removes the files from \a files that the pending Extract operation of the updated
+    component claims, so that they are left in place when the old version of the component
+    is removed during an update. The pending operation extracts \a archive into the same
+    target directory and either skips the files if their content is still identical, or
+    overwrites them. Only files that the manifest of \a archive lists with the same relative
+    path and size are kept.
+*/
+void ExtractArchiveOperation::keepUnchangedFiles(const QString &archive, QStringList *files)
+{
+    ArchiveManifest manifest;
+    if (!manifest.load(ArchiveManifest::manifestFileName(archive)))
+        return;
+
+    const QDir targetDir(arguments().at(1));
+    int kept = 0;
+    for (auto it = files->begin(); it != files->end();) {
+        const QFileInfo fi(*it);
+        const QString relativePath = targetDir.relativeFilePath(fi.absoluteFilePath());
+        if (fi.isFile() && !fi.isSymLink() && !relativePath.startsWith(QLatin1String(".."))
+                && manifest.entry(relativePath).size == fi.size()) {
+            it = files->erase(it);
+            ++kept;
+        } else {
+            ++it;
+        }
+    }
+    if (kept > 0) {
+        qCDebug(QInstaller::lcInstallerInstallLog) << "Keeping" << kept << "files of"
+            << arguments().at(0) << "for comparison with" << archive;
+    }
+}
+
+/*
+    Returns \c true if the executable permission of the installed file \a fileName
+    matches the one of the archive \a entry. Always returns \c true on non-Unix platforms.
+*/
+bool ExtractArchiveOperation::hasSameExecutableBit(const ArchiveEntry &entry, const QString &fileName)
+{
+#ifndef Q_OS_UNIX
+    Q_UNUSED(entry)
+    Q_UNUSED(fileName)
+    return true;
+#else
+    bool executable = false;
+    if (entry.permissions_mode != 0)
+        executable = (entry.permissions_mode & S_IXUSR);
+    else if (entry.permissions_enum != static_cast<QFile::Permissions>(-1))
+        executable = entry.permissions_enum.testFlag(QFile::ExeOwner);
+    else
+        return true;
+    return QFile::permissions(fileName).testFlag(QFile::ExeOwner) == executable;
+#endif
+}
+
 bool ExtractArchiveOperation::testOperation()
 {
     return true;
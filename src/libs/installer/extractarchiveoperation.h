@@ -32,9 +32,12 @@
 #include "qinstallerglobal.h"
 
 #include <QtCore/QObject>
+#include <QtCore/QSet>
 
 namespace QInstaller {
 
+struct ArchiveEntry;
+
 class INSTALLER_EXPORT ExtractArchiveOperation : public QObject, public Operation
 {
     Q_OBJECT
@@ -57,11 +60,15 @@ Q_SIGNALS:
     void progressChanged(double);
 
 private:
-    void startUndoProcess(const QStringList &files);
+    void startUndoProcess(const QStringList &files, const QString &targetDir);
     void deleteDataFile(const QString &fileName);
 
     QString generateBackupName(const QString &fn);
     bool prepareForFile(const QString &filename);
+    bool snapshotFile(const QString &targetDir, const QString &relativePath);
+    void removeSnapshot();
+    void keepUnchangedFiles(const QString &archive, QStringList *files);
+    static bool hasSameExecutableBit(const ArchiveEntry &entry, const QString &fileName);
 
 private:
     typedef QPair<QString, QString> Backup;
@@ -74,6 +81,9 @@ private:
 private:
     QString m_relocatedDataFileName;
     BackupFiles m_backupFiles;
+    QString m_snapshotDir;
+    QSet<QString> m_snapshotPaths;
+    QSet<QString> m_unchangedEntries;
     quint64 m_totalEntries;
 };
 
@@ -31,6 +31,7 @@
 #include "extractarchiveoperation.h"
 
 #include "fileutils.h"
+#include "deletionservice.h"
 #include "archivefactory.h"
 #include "packagemanagercore.h"
 #include "remoteclient.h"
@@ -53,8 +54,9 @@ class WorkerThread : public QThread
     Q_DISABLE_COPY(WorkerThread)
 
 public:
-    WorkerThread(ExtractArchiveOperation *op, const QStringList &files)
+    WorkerThread(ExtractArchiveOperation *op, const QStringList &files, const QString &root)
         : m_files(files)
+        , m_root(root)
         , m_op(op)
     {
         setObjectName(QLatin1String("ExtractArchive"));
@@ -75,7 +77,8 @@ public:
                 emit currentFileChanged(QDir::toNativeSeparators(file));
             emit progressChanged(double(removedCounter) / m_files.count());
             if (fi.isFile() || fi.isSymLink()) {
-                m_op->deleteFileNowOrLater(fi.absoluteFilePath());
+                if (!DeletionService::instance().remove(fi.absoluteFilePath(), m_root))
+                    m_op->deleteFileNowOrLater(fi.absoluteFilePath());
             } else if (fi.isDir()) {
                 directories.append(file);
             }
@@ -107,6 +110,7 @@ signals:
 
 private:
     QStringList m_files;
+    QString m_root;
     ExtractArchiveOperation *m_op;
 };
 
@@ -158,10 +162,12 @@ class ExtractArchiveOperation::Worker : public QObject
     Q_DISABLE_COPY(Worker)
 
 public:
-    Worker(const QString &archivePath, const QString &targetDir, quint64 totalEntries, Callback *callback)
+    Worker(const QString &archivePath, const QString &targetDir, quint64 totalEntries,
+            const QSet<QString> &skippedEntries, Callback *callback)
         : m_archivePath(archivePath)
         , m_targetDir(targetDir)
         , m_totalEntries(totalEntries)
+        , m_skippedEntries(skippedEntries)
         , m_callback(callback)
     {}
 
@@ -186,6 +192,7 @@ public Q_SLOTS:
                 m_archive->errorString()));
             return;
         }
+        m_archive->setSkippedEntries(m_skippedEntries);
 
         if (!m_archive->extract(m_targetDir, m_totalEntries)) {
             emit finished(false, tr("Error while extracting archive \"%1\": %2").arg(m_archivePath,
@@ -216,6 +223,7 @@ private:
     QString m_archivePath;
     QString m_targetDir;
     quint64 m_totalEntries;
+    QSet<QString> m_skippedEntries;
     QScopedPointer<AbstractArchive> m_archive;
     Callback *m_callback;
 };
@@ -30,8 +30,10 @@
 #include "globals.h"
 #include "constants.h"
 #include "fileio.h"
+#include "remoteclient.h"
 #include <errors.h>
 
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QDirIterator>
@@ -40,6 +42,7 @@
 #include <QtCore/QThread>
 #include <QtCore/QUrl>
 #include <QtCore/QCoreApplication>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QImageReader>
 #include <QRandomGenerator>
 #include <QGuiApplication>
@@ -53,6 +56,13 @@
 #include <unistd.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
 using namespace QInstaller;
 
 /*!
@@ -64,6 +74,22 @@ using namespace QInstaller;
            Default permissions for an executable file.
 */
 
+/*!
+    \enum QInstaller::FileCopyMethod
+
+    \value Automatic
+           Use the fastest method supported for the source and target files.
+    \value Clone
+           Share the data blocks of the source file with the target (reflink). Requires a
+           copy-on-write file system, such as Btrfs or XFS, on Linux.
+    \value CopyFileRange
+           Copy the data inside the kernel with \c copy_file_range(). Linux only.
+    \value SendFile
+           Copy the data inside the kernel with \c sendfile(). Linux only.
+    \value Buffered
+           Read and write the data through a buffer in user space.
+*/
+
 /*!
     \inmodule QtInstallerFramework
     \class QInstaller::TempPathDeleter
@@ -186,34 +212,132 @@ QString QInstaller::pathFromUrl(const QUrl &url)
 
 /*!
     \internal
+
+    Returns \c true if directory trees can be processed from several threads. This is not
+    the case while the remote file engine is active, as it serves one thread at a time.
 */
-void QInstaller::removeFiles(const QString &path, bool ignoreErrors)
+bool QInstaller::canWalkConcurrently()
 {
-    const QFileInfoList entries = QDir(path).entryInfoList(QDir::AllEntries | QDir::Hidden);
-    foreach (const QFileInfo &fi, entries) {
-        if (fi.isSymLink() || fi.isFile()) {
-            QString filePath = fi.filePath();
-            QFile f(filePath);
-            bool ok = f.remove();
-            if (!ok) { //ReadOnly can prevent removing in Windows. Change permission and try again.
-                const QFile::Permissions permissions = f.permissions();
-                if (!(permissions & QFile::WriteUser)) {
-                    ok = f.setPermissions(filePath, permissions | QFile::WriteUser)
-                            && f.remove(filePath);
-                }
-                if (!ok) {
-                    const QString errorMessage = QCoreApplication::translate("QInstaller",
-                        "Cannot remove file \"%1\": %2").arg(
-                                QDir::toNativeSeparators(f.fileName()), f.errorString());
-                    if (!ignoreErrors)
-                        throw Error(errorMessage);
-                    qCWarning(QInstaller::lcInstallerInstallLog).noquote() << errorMessage;
+    return !RemoteClient::instance().isActive();
+}
+
+/*
+    Calls \a function for each item of \a sequence, concurrently if possible. Errors
+    thrown by \a function are rethrown in the calling thread.
+*/
+template <typename Sequence, typename Function>
+static void forEachConcurrently(Sequence &sequence, Function function)
+{
+    if (sequence.size() > 1 && canWalkConcurrently()) {
+        QtConcurrent::blockingMap(sequence, function);
+    } else {
+        for (auto &item : sequence)
+            function(item);
+    }
+}
+
+namespace {
+
+struct DirectoryListing
+{
+    QString path;
+    QStringList directories;
+    QStringList files;
+};
+
+} // namespace
+
+/*!
+    \internal
+
+    Lists the contents of the directory \a path recursively. The directories of one level of
+    the tree are read concurrently, so the latency of the file system calls overlaps
+    instead of adding up for large trees.
+
+    The returned tree contains the absolute paths of all subdirectories grouped by depth,
+    starting with the direct children of \a path, and the absolute paths of all other
+    entries. Parents are always listed on a lower level than their children, so removing
+    the directories in reverse order and creating them in order is safe. Within a level
+    the entries appear in the order the directories were read.
+
+    \a filters selects the entries to list. Symbolic links to directories are only
+    descended into if \a followSymLinks is \c true, otherwise they are listed as files.
+    If \a descend is set, only directories it returns \c true for are listed and
+    descended into.
+*/
+DirectoryTree QInstaller::listDirectoryTree(const QString &path, QDir::Filters filters,
+    bool followSymLinks, const std::function<bool (const QString &)> &descend)
+{
+    DirectoryTree tree;
+    QVector<DirectoryListing> level(1);
+    level[0].path = path;
+
+    filters |= QDir::NoDotAndDotDot;
+    while (!level.isEmpty()) {
+        forEachConcurrently(level, [&](DirectoryListing &listing) {
+            QDirIterator it(listing.path, filters);
+            while (it.hasNext()) {
+                const QString entry = it.next();
+                const QFileInfo fi = it.fileInfo();
+                if (fi.isDir() && (followSymLinks || !fi.isSymLink())) {
+                    if (!descend || descend(entry))
+                        listing.directories.append(entry);
+                } else {
+                    listing.files.append(entry);
                 }
             }
+        });
+
+        QStringList directories;
+        QVector<DirectoryListing> next;
+        for (const DirectoryListing &listing : qAsConst(level)) {
+            tree.files += listing.files;
+            for (const QString &directory : listing.directories) {
+                directories.append(directory);
+                next.append(DirectoryListing());
+                next.last().path = directory;
+            }
+        }
+        if (!directories.isEmpty())
+            tree.directories.append(directories);
+        level = next;
+    }
+    return tree;
+}
+
+static void removeFile(const QString &filePath, bool ignoreErrors)
+{
+    QFile f(filePath);
+    bool ok = f.remove();
+    if (!ok) { //ReadOnly can prevent removing in Windows. Change permission and try again.
+        const QFile::Permissions permissions = f.permissions();
+        if (!(permissions & QFile::WriteUser)) {
+            ok = f.setPermissions(filePath, permissions | QFile::WriteUser)
+                    && f.remove(filePath);
+        }
+        if (!ok) {
+            const QString errorMessage = QCoreApplication::translate("QInstaller",
+                "Cannot remove file \"%1\": %2").arg(
+                        QDir::toNativeSeparators(f.fileName()), f.errorString());
+            if (!ignoreErrors)
+                throw Error(errorMessage);
+            qCWarning(QInstaller::lcInstallerInstallLog).noquote() << errorMessage;
         }
     }
 }
 
+/*!
+    \internal
+*/
+void QInstaller::removeFiles(const QString &path, bool ignoreErrors)
+{
+    const QFileInfoList entries = QDir(path).entryInfoList(QDir::AllEntries | QDir::Hidden);
+    foreach (const QFileInfo &fi, entries) {
+        if (fi.isSymLink() || fi.isFile())
+            removeFile(fi.filePath(), ignoreErrors);
+    }
+}
+
 static QString errnoToQString(int error)
 {
 #if defined(Q_OS_WIN) && !defined(Q_CC_MINGW)
@@ -241,18 +365,15 @@ void QInstaller::removeDirectory(const QString &path, bool ignoreErrors)
     if (path.isEmpty()) // QDir("") points to the working directory! We never want to remove that one.
         return;
 
-    QStringList dirs;
-    QDirIterator it(path, QDir::NoDotAndDotDot | QDir::Dirs | QDir::NoSymLinks | QDir::Hidden,
-        QDirIterator::Subdirectories);
-    while (it.hasNext()) {
-        dirs.prepend(it.next());
-        removeFiles(dirs.at(0), ignoreErrors);
-    }
+    // Files of all directories are removed concurrently, the directories afterwards
+    // level by level, starting with the deepest one.
+    DirectoryTree tree = listDirectoryTree(path);
+    forEachConcurrently(tree.files, [ignoreErrors](const QString &file) {
+        removeFile(file, ignoreErrors);
+    });
 
-    QDir d;
-    dirs.append(path);
-    removeFiles(path, ignoreErrors);
-    foreach (const QString &dir, dirs) {
+    const auto removeDir = [&path, ignoreErrors](const QString &dir) {
+        QDir d;
         errno = 0;
         if (d.exists(path) && !d.rmdir(dir)) {
             const QString errorMessage = QCoreApplication::translate("QInstaller",
@@ -262,7 +383,10 @@ void QInstaller::removeDirectory(const QString &path, bool ignoreErrors)
                 throw Error(errorMessage);
             qCWarning(QInstaller::lcInstallerInstallLog).noquote() << errorMessage;
         }
-    }
+    };
+    for (int i = tree.directories.size() - 1; i >= 0; --i)
+        forEachConcurrently(tree.directories[i], removeDir);
+    removeDir(path);
 }
 
 class RemoveDirectoryThread : public QThread
@@ -376,24 +500,377 @@ void QInstaller::copyDirectoryContents(const QString &sourceDir, const QString &
         throw Error(QCoreApplication::translate("QInstaller", "Cannot create directory \"%1\".")
             .arg(QDir::toNativeSeparators(targetDir)));
     }
-    QDirIterator it(sourceDir, QDir::NoDotAndDotDot | QDir::AllEntries);
-    while (it.hasNext()) {
-        const QFileInfo i(it.next());
-        if (i.isDir()) {
-            copyDirectoryContents(QDir(sourceDir).absoluteFilePath(i.fileName()),
-                QDir(targetDir).absoluteFilePath(i.fileName()));
-        } else {
-            QFile f(i.filePath());
-            const QString target = QDir(targetDir).absoluteFilePath(i.fileName());
-            if (!f.copy(target)) {
+
+    const QDir source(sourceDir);
+    const QDir target(targetDir);
+    DirectoryTree tree = listDirectoryTree(sourceDir, QDir::AllEntries, true);
+    for (QStringList &directories : tree.directories) {
+        forEachConcurrently(directories, [&](const QString &directory) {
+            const QString path = target.absoluteFilePath(source.relativeFilePath(directory));
+            if (!QDir().mkpath(path)) {
                 throw Error(QCoreApplication::translate("QInstaller",
-                    "Cannot copy file from \"%1\" to \"%2\": %3").arg(
-                                QDir::toNativeSeparators(f.fileName()),
-                                QDir::toNativeSeparators(target),
-                                f.errorString()));
+                    "Cannot create directory \"%1\".").arg(QDir::toNativeSeparators(path)));
             }
+        });
+    }
+    forEachConcurrently(tree.files, [&](const QString &file) {
+        copyFile(file, target.absoluteFilePath(source.relativeFilePath(file)));
+    });
+}
+
+namespace {
+
+enum CopyResult {
+    CopyFinished,
+    CopyUnsupported,
+    CopyCanceled
+};
+
+// Progress is reported after each chunk, the kernel methods use larger chunks
+// as they do not need a buffer of that size.
+static const qint64 scKernelCopyChunkSize = 16 * 1024 * 1024;
+static const qint64 scBufferedCopyChunkSize = 1024 * 1024;
+
+Error copyError(QFile *source, QFile *target, const QString &reason)
+{
+    return Error(QCoreApplication::translate("QInstaller",
+        "Cannot copy file from \"%1\" to \"%2\": %3").arg(
+            QDir::toNativeSeparators(source->fileName()),
+            QDir::toNativeSeparators(target->fileName()), reason));
+}
+
+#ifdef Q_OS_LINUX
+bool isUnsupportedCopyError(int error)
+{
+    // The method is not available for this kernel, file system or file combination.
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP
+        || error == ENOTTY || error == EBADF;
+}
+
+/*
+    The helpers below copy size bytes from sourceOffset in source to targetOffset in target.
+    They continue after the already copied bytes and update copied.
+*/
+CopyResult cloneFile(QFile *source, qint64 sourceOffset, QFile *target, qint64 targetOffset,
+    qint64 size, qint64 *copied, const std::function<bool (qint64)> &progress)
+{
+    if (*copied != 0)
+        return CopyUnsupported;
+
+    int result = -1;
+    if (sourceOffset == 0 && targetOffset == 0 && size == source->size() && target->size() == 0) {
+#ifdef FICLONE
+        result = ::ioctl(target->handle(), FICLONE, source->handle());
+#else
+        return CopyUnsupported;
+#endif
+    } else {
+        // Requires offsets aligned to the block size of the file system, EINVAL otherwise.
+#ifdef FICLONERANGE
+        struct file_clone_range range;
+        range.src_fd = source->handle();
+        range.src_offset = quint64(sourceOffset);
+        range.src_length = quint64(size);
+        range.dest_offset = quint64(targetOffset);
+        result = ::ioctl(target->handle(), FICLONERANGE, &range);
+#else
+        return CopyUnsupported;
+#endif
+    }
+    if (result != 0) {
+        if (isUnsupportedCopyError(errno))
+            return CopyUnsupported;
+        throw copyError(source, target, errnoToQString(errno));
+    }
+    *copied = size;
+    if (progress && !progress(*copied))
+        return CopyCanceled;
+    return CopyFinished;
+}
+
+CopyResult copyFileRange(QFile *source, qint64 sourceOffset, QFile *target, qint64 targetOffset,
+    qint64 size, qint64 *copied, const std::function<bool (qint64)> &progress)
+{
+#ifdef SYS_copy_file_range
+    while (*copied < size) {
+        loff_t inOffset = sourceOffset + *copied;
+        loff_t outOffset = targetOffset + *copied;
+        const ssize_t result = ::syscall(SYS_copy_file_range, source->handle(), &inOffset,
+            target->handle(), &outOffset, size_t(qMin(size - *copied, scKernelCopyChunkSize)), 0u);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            if (isUnsupportedCopyError(errno))
+                return CopyUnsupported;
+            throw copyError(source, target, errnoToQString(errno));
+        }
+        if (result == 0) {
+            // procfs, sysfs and some cross file system copies report no data,
+            // the next method continues from here
+            return CopyUnsupported;
+        }
+        *copied += result;
+        if (progress && !progress(*copied))
+            return CopyCanceled;
+    }
+    return CopyFinished;
+#else
+    Q_UNUSED(source)
+    Q_UNUSED(sourceOffset)
+    Q_UNUSED(target)
+    Q_UNUSED(targetOffset)
+    Q_UNUSED(size)
+    Q_UNUSED(copied)
+    Q_UNUSED(progress)
+    return CopyUnsupported;
+#endif
+}
+
+CopyResult sendFile(QFile *source, qint64 sourceOffset, QFile *target, qint64 targetOffset,
+    qint64 size, qint64 *copied, const std::function<bool (qint64)> &progress)
+{
+    // sendfile() writes at the current position of the target
+    if (::lseek(target->handle(), targetOffset + *copied, SEEK_SET) < 0)
+        return CopyUnsupported;
+
+    while (*copied < size) {
+        off_t offset = sourceOffset + *copied;
+        const ssize_t result = ::sendfile(target->handle(), source->handle(), &offset,
+            size_t(qMin(size - *copied, scKernelCopyChunkSize)));
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            if (isUnsupportedCopyError(errno))
+                return CopyUnsupported;
+            throw copyError(source, target, errnoToQString(errno));
         }
+        if (result == 0)
+            return CopyUnsupported;
+        *copied += result;
+        if (progress && !progress(*copied))
+            return CopyCanceled;
+    }
+    return CopyFinished;
+}
+
+/*
+    Tries the kernel methods allowed by method in order, and returns the first one that
+    is supported, or FileCopyMethod::Buffered if none is.
+*/
+FileCopyMethod kernelCopy(QFile *source, qint64 sourceOffset, QFile *target, qint64 targetOffset,
+    qint64 size, qint64 *copied, FileCopyMethod method, const std::function<bool (qint64)> &progress,
+    CopyResult *result)
+{
+    static const FileCopyMethod methods[] = {
+        FileCopyMethod::Clone, FileCopyMethod::CopyFileRange, FileCopyMethod::SendFile
+    };
+    for (const FileCopyMethod current : methods) {
+        if (method != FileCopyMethod::Automatic && method != current)
+            continue;
+
+        if (current == FileCopyMethod::Clone)
+            *result = cloneFile(source, sourceOffset, target, targetOffset, size, copied, progress);
+        else if (current == FileCopyMethod::CopyFileRange)
+            *result = copyFileRange(source, sourceOffset, target, targetOffset, size, copied, progress);
+        else
+            *result = sendFile(source, sourceOffset, target, targetOffset, size, copied, progress);
+        if (*result != CopyUnsupported)
+            return current;
+    }
+    return FileCopyMethod::Buffered;
+}
+#endif
+
+/*
+    Copies size bytes, or everything up to the end of source if size is negative. Returns
+    the number of copied bytes.
+*/
+qint64 bufferedCopy(QFile *source, qint64 sourceOffset, QFile *target, qint64 targetOffset,
+    qint64 size, qint64 copied, const std::function<bool (qint64)> &progress,
+    QCryptographicHash *hash)
+{
+    if (!source->seek(sourceOffset + copied) || !target->seek(targetOffset + copied))
+        throw copyError(source, target, source->errorString());
+
+    QByteArray buffer(scBufferedCopyChunkSize, Qt::Uninitialized);
+    while (size < 0 || copied < size) {
+        const qint64 maxSize = size < 0 ? buffer.size() : qMin<qint64>(buffer.size(), size - copied);
+        const qint64 read = source->read(buffer.data(), maxSize);
+        if (read < 0)
+            throw copyError(source, target, source->errorString());
+        if (read == 0)
+            break;
+        if (target->write(buffer.constData(), read) != read)
+            throw copyError(source, target, target->errorString());
+        if (hash)
+            hash->addData(buffer.constData(), int(read));
+
+        copied += read;
+        if (progress && !progress(copied))
+            break;
+    }
+    return copied;
+}
+
+bool isNativeCopy(QFile *source, QFile *target)
+{
+    return source->handle() != -1 && target->handle() != -1
+        && !RemoteClient::instance().isActive();
+}
+
+} // namespace
+
+/*!
+    \internal
+
+    Copies the data of the opened file \a source to the opened and empty file \a target
+    using \a method, and returns the method that finished the copy. If the method is not
+    supported for the two files, the remaining data is copied with the next faster method,
+    down to FileCopyMethod::Buffered. The fast methods are only used for local files, not
+    for Qt resources or files accessed through the remote file engine.
+
+    The \a progress function is called with the number of copied bytes after every chunk,
+    the copy is canceled if it returns \c false. If \a hash is given, the copied data is
+    added to it. The kernel methods never see the data, so if they copied any part of it,
+    the whole source is read again for that afterwards.
+
+    Throws QInstaller::Error on failure, also if less data than the size of \a source
+    was copied without being canceled.
+*/
+FileCopyMethod QInstaller::copyFileData(QFile *source, QFile *target, FileCopyMethod method,
+    const std::function<bool (qint64)> &progress, QCryptographicHash *hash)
+{
+    Q_ASSERT(source->isOpen() && target->isOpen());
+
+    bool canceled = false;
+    std::function<bool (qint64)> checkedProgress;
+    if (progress) {
+        checkedProgress = [&progress, &canceled](qint64 copied) {
+            canceled = !progress(copied);
+            return !canceled;
+        };
     }
+
+    qint64 copied = 0;
+    FileCopyMethod current = FileCopyMethod::Buffered;
+#ifdef Q_OS_LINUX
+    // Files of procfs and sysfs report no size, but are read until their end
+    if (isNativeCopy(source, target) && method != FileCopyMethod::Buffered && source->pos() == 0
+            && target->pos() == 0 && target->size() == 0 && source->size() > 0) {
+        CopyResult result = CopyUnsupported;
+        current = kernelCopy(source, 0, target, 0, source->size(), &copied, method,
+            checkedProgress, &result);
+        if (current != FileCopyMethod::Buffered && !target->seek(copied))
+            throw copyError(source, target, target->errorString());
+    }
+#else
+    Q_UNUSED(method)
+#endif
+    const qint64 kernelCopied = copied;
+    if (current == FileCopyMethod::Buffered && !canceled) {
+        copied = bufferedCopy(source, 0, target, 0, -1, copied, checkedProgress,
+            kernelCopied > 0 ? nullptr : hash);
+    }
+    if (canceled)
+        return current;
+
+    if (copied < source->size()) {
+        throw copyError(source, target, QCoreApplication::translate("QInstaller",
+            "Read failed after %1 bytes.").arg(copied));
+    }
+    if (hash && kernelCopied > 0) {
+        if (!source->seek(0) || !hash->addData(source))
+            throw copyError(source, target, source->errorString());
+    }
+    return current;
+}
+
+/*!
+    \internal
+
+    Copies \a length bytes starting at \a offset in the opened file \a source to the
+    current position of the opened file \a target, and returns the method that finished
+    the copy. This allows to extract a segment of a larger file, like the resources of an
+    installer binary, without passing the data through user space.
+
+    Reflinks need the offsets to be aligned to the block size of the file system; if they
+    are not, the data is copied inside the kernel. Afterwards \a target is positioned
+    behind the copied data.
+
+    Throws QInstaller::Error on failure.
+*/
+FileCopyMethod QInstaller::copyFileSegment(QFile *source, qint64 offset, qint64 length,
+    QFile *target, FileCopyMethod method)
+{
+    Q_ASSERT(source->isOpen() && target->isOpen());
+
+    const qint64 targetOffset = target->pos();
+    qint64 copied = 0;
+    FileCopyMethod current = FileCopyMethod::Buffered;
+#ifdef Q_OS_LINUX
+    if (isNativeCopy(source, target) && method != FileCopyMethod::Buffered) {
+        // the kernel methods bypass the write buffer of the target
+        if (!target->flush())
+            throw copyError(source, target, target->errorString());
+        CopyResult result = CopyUnsupported;
+        current = kernelCopy(source, offset, target, targetOffset, length, &copied, method,
+            nullptr, &result);
+    }
+#endif
+    if (current == FileCopyMethod::Buffered)
+        copied = bufferedCopy(source, offset, target, targetOffset, length, copied, nullptr, nullptr);
+    if (copied != length) {
+        throw copyError(source, target, QCoreApplication::translate("QInstaller",
+            "Read failed after %1 bytes.").arg(copied));
+    }
+    if (!target->seek(targetOffset + length))
+        throw copyError(source, target, target->errorString());
+    return current;
+}
+
+/*!
+    \internal
+
+    Copies the file \a source to \a target using \a method, and returns the method that
+    finished the copy. Like QFile::copy(), the target must not exist and gets the permissions
+    of the source. The fast methods are only used on Linux; other platforms, and the remote
+    file engine, copy with QFile::copy().
+
+    Throws QInstaller::Error on failure.
+*/
+FileCopyMethod QInstaller::copyFile(const QString &source, const QString &target,
+    FileCopyMethod method)
+{
+    QFile sourceFile(source);
+    QFile targetFile(target);
+#ifndef Q_OS_LINUX
+    // Keeps the native copy of the platform, like CopyFileW() or clonefile()
+    Q_UNUSED(method)
+    if (!sourceFile.copy(target))
+        throw copyError(&sourceFile, &targetFile, sourceFile.errorString());
+    return FileCopyMethod::Buffered;
+#else
+    if (RemoteClient::instance().isActive()) {
+        if (!sourceFile.copy(target))
+            throw copyError(&sourceFile, &targetFile, sourceFile.errorString());
+        return FileCopyMethod::Buffered;
+    }
+
+    if (!sourceFile.open(QIODevice::ReadOnly))
+        throw copyError(&sourceFile, &targetFile, sourceFile.errorString());
+    if (!targetFile.open(QIODevice::WriteOnly | QIODevice::NewOnly))
+        throw copyError(&sourceFile, &targetFile, targetFile.errorString());
+
+    try {
+        method = copyFileData(&sourceFile, &targetFile, method);
+        if (!targetFile.setPermissions(sourceFile.permissions()))
+            throw copyError(&sourceFile, &targetFile, targetFile.errorString());
+    } catch (const Error &) {
+        targetFile.remove();
+        throw;
+    }
+    return method;
+#endif
 }
 
 /*!
@@ -407,27 +884,22 @@ void QInstaller::moveDirectoryContents(const QString &sourceDir, const QString &
 //        throw Error(QCoreApplication::translate("QInstaller", "Cannot create directory \"%1\".")
 //            .arg(QDir::toNativeSeparators(targetDir)));
 //    }
-    QDirIterator it(sourceDir, QDir::NoDotAndDotDot | QDir::AllEntries);
-    while (it.hasNext()) {
-        const QFileInfo i(it.next());
-        if (i.isDir()) {
-            // only copy directories that are not the target to avoid loop dir creations
-            QString newSource = QDir(sourceDir).absoluteFilePath(i.fileName());
-            if (QDir(newSource) != QDir(targetDir)) {
-                moveDirectoryContents(newSource, QDir(targetDir).absoluteFilePath(i.fileName()));
-            }
-        } else {
-            QFile f(i.filePath());
-            const QString target = QDir(targetDir).absoluteFilePath(i.fileName());
-            if (!f.rename(target)) {
-                throw Error(QCoreApplication::translate("QInstaller",
-                    "Cannot move file from \"%1\" to \"%2\": %3").arg(
-                                QDir::toNativeSeparators(f.fileName()),
-                                QDir::toNativeSeparators(target),
-                                f.errorString()));
-            }
+    const QDir source(sourceDir);
+    const QDir target(targetDir);
+    // only copy directories that are not the target to avoid loop dir creations
+    DirectoryTree tree = listDirectoryTree(sourceDir, QDir::AllEntries, true,
+        [&target](const QString &directory) { return QDir(directory) != target; });
+    forEachConcurrently(tree.files, [&](const QString &file) {
+        QFile f(file);
+        const QString newPath = target.absoluteFilePath(source.relativeFilePath(file));
+        if (!f.rename(newPath)) {
+            throw Error(QCoreApplication::translate("QInstaller",
+                "Cannot move file from \"%1\" to \"%2\": %3").arg(
+                            QDir::toNativeSeparators(f.fileName()),
+                            QDir::toNativeSeparators(newPath),
+                            f.errorString()));
         }
-    }
+    });
 }
 
 /*!
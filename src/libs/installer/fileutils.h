@@ -30,13 +30,18 @@
 
 #include "installer_global.h"
 
+#include <QtCore/QDir>
 #include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QVector>
 #include <QtXml/QDomDocument>
 #include <QtXml/QDomNodeList>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
+class QCryptographicHash;
 class QFileInfo;
 class QFile;
 class QUrl;
@@ -49,6 +54,14 @@ enum DefaultFilePermissions {
     Executable = 0x7755
 };
 
+enum struct FileCopyMethod {
+    Automatic,
+    Clone,
+    CopyFileRange,
+    SendFile,
+    Buffered
+};
+
 class INSTALLER_EXPORT TempPathDeleter
 {
 public:
@@ -69,8 +82,19 @@ private:
     QSet<QString> m_paths;
 };
 
+struct INSTALLER_EXPORT DirectoryTree
+{
+    QVector<QStringList> directories;
+    QStringList files;
+};
+
     QString INSTALLER_EXPORT humanReadableSize(const qint64 &size, int precision = 2);
 
+    DirectoryTree INSTALLER_EXPORT listDirectoryTree(const QString &path,
+        QDir::Filters filters = QDir::AllEntries | QDir::Hidden | QDir::System,
+        bool followSymLinks = false, const std::function<bool (const QString &)> &descend = nullptr);
+    bool INSTALLER_EXPORT canWalkConcurrently();
+
     void INSTALLER_EXPORT removeFiles(const QString &path, bool ignoreErrors = false);
     void INSTALLER_EXPORT removeDirectory(const QString &path, bool ignoreErrors = false);
     void INSTALLER_EXPORT removeDirectoryThreaded(const QString &path, bool ignoreErrors = false);
@@ -84,6 +108,14 @@ private:
     void INSTALLER_EXPORT moveDirectoryContents(const QString &sourceDir, const QString &targetDir);
     void INSTALLER_EXPORT copyDirectoryContents(const QString &sourceDir, const QString &targetDir);
 
+    FileCopyMethod INSTALLER_EXPORT copyFileData(QFile *source, QFile *target,
+        FileCopyMethod method = FileCopyMethod::Automatic,
+        const std::function<bool (qint64)> &progress = nullptr, QCryptographicHash *hash = nullptr);
+    FileCopyMethod INSTALLER_EXPORT copyFile(const QString &source, const QString &target,
+        FileCopyMethod method = FileCopyMethod::Automatic);
+    FileCopyMethod INSTALLER_EXPORT copyFileSegment(QFile *source, qint64 offset, qint64 length,
+        QFile *target, FileCopyMethod method = FileCopyMethod::Automatic);
+
     bool INSTALLER_EXPORT isLocalUrl(const QUrl &url);
     QString INSTALLER_EXPORT pathFromUrl(const QUrl &url);
 
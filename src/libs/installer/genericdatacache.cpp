@@ -28,6 +28,7 @@
 
 #include "genericdatacache.h"
 
+#include "archivecache.h"
 #include "errors.h"
 #include "fileutils.h"
 #include "globals.h"
@@ -691,5 +692,6 @@ bool GenericDataCache<T>::remove(const QByteArray &checksum)
 }
 
 template class GenericDataCache<Metadata>;
+template class GenericDataCache<CachedArchive>;
 
 } // namespace QInstaller
@@ -146,7 +146,17 @@ HEADERS += packagemanagercore.h \
     directoryguard.h \
     archivefactory.h \
     operationtracer.h \
-    customcombobox.h
+    customcombobox.h \
+    tracelog.h \
+    packagesearchindex.h \
+    streamreplacer.h \
+    relocationstage.h \
+    deletionservice.h \
+    operationlog.h \
+    operationjournal.h \
+    archivecache.h \
+    binarydelta.h \
+    archivemanifest.h
 
 SOURCES += packagemanagercore.cpp \
     abstractarchive.cpp \
@@ -235,7 +245,17 @@ SOURCES += packagemanagercore.cpp \
     repositorycategory.cpp \
     componentselectionpage_p.cpp \
     commandlineparser.cpp \
-    customcombobox.cpp
+    customcombobox.cpp \
+    tracelog.cpp \
+    packagesearchindex.cpp \
+    streamreplacer.cpp \
+    relocationstage.cpp \
+    deletionservice.cpp \
+    operationlog.cpp \
+    operationjournal.cpp \
+    archivecache.cpp \
+    binarydelta.cpp \
+    archivemanifest.cpp
 
 macos:SOURCES += fileutils_mac.mm
 
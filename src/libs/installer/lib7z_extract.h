@@ -33,6 +33,7 @@
 #include <Common/MyCom.h>
 #include <7zip/Archive/IArchive.h>
 
+#include <QSet>
 #include <QString>
 
 class CArc;
@@ -53,6 +54,7 @@ namespace Lib7z
 
         void setArchive(CArc *carc) { arc = carc; }
         void setTarget(const QString &dir) { targetDir = dir; }
+        void setSkippedEntries(const QSet<QString> &paths) { skippedEntries = paths; }
 
         MY_UNKNOWN_IMP
         INTERFACE_IArchiveExtractCallback(;)
@@ -69,6 +71,9 @@ namespace Lib7z
         quint64 total = 0;
         quint64 completed = 0;
         quint32 currentIndex = 0;
+
+        QSet<QString> skippedEntries;
+        bool skipCurrent = false;
     };
 
     void INSTALLER_EXPORT extractArchive(QFileDevice *archive, const QString &targetDirectory,
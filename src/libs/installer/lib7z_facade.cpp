@@ -610,6 +610,11 @@ STDMETHODIMP ExtractCallback::GetStream(UInt32 index, ISequentialOutStream **out
         return E_FAIL;
     }
 
+    // Leaving the stream unset makes the decoder skip the data of the item
+    skipCurrent = skippedEntries.contains(UString2QString(s).replace(QLatin1Char('\\'), QLatin1Char('/')));
+    if (skipCurrent)
+        return S_OK;
+
     const QFileInfo fi(QString::fromLatin1("%1/%2").arg(targetDir, UString2QString(s)));
 
     QInstaller::DirectoryGuard guard(fi.absolutePath());
@@ -672,7 +677,7 @@ STDMETHODIMP ExtractCallback::PrepareOperation(Int32 /*askExtractMode*/)
 */
 STDMETHODIMP ExtractCallback::SetOperationResult(Int32 /*resultEOperationResult*/)
 {
-    if (targetDir.isEmpty())
+    if (targetDir.isEmpty() || skipCurrent)
         return S_OK;
 
     UString s;
@@ -796,6 +801,13 @@ STDMETHODIMP ExtractCallback::SetOperationResult(Int32 /*resultEOperationResult*
     is returned, the extraction will be aborted. The default implementation returns \c true.
 */
 
+/*!
+    \fn void Lib7z::ExtractCallback::setSkippedEntries(const QSet<QString> &paths)
+
+    Sets the archive items that are not written to disk to \a paths. The paths use
+    forward slashes as separators.
+*/
+
 /*!
     \fn bool Lib7z::ExtractCallback::setArchive(CArc *carc)
 
@@ -124,6 +124,7 @@ void Lib7zArchive::setFilename(const QString &filename)
 bool Lib7zArchive::extract(const QString &dirPath)
 {
     m_extractCallback->setState(S_OK);
+    m_extractCallback->setSkippedEntries(skippedEntries());
     try {
         Lib7z::extractArchive(&m_file, dirPath, m_extractCallback);
     } catch (const Lib7z::SevenZipException &e) {
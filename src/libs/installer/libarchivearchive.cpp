@@ -258,6 +258,14 @@ ExtractWorker::Status ExtractWorker::status() const
     return m_status;
 }
 
+/*!
+    Sets the entries that are not written to disk by the next extract() to \a paths.
+*/
+void ExtractWorker::setSkippedEntries(const QSet<QString> &paths)
+{
+    m_skippedEntries = paths;
+}
+
 void ExtractWorker::extract(const QString &dirPath, const quint64 totalFiles)
 {
     m_status = Unfinished;
@@ -310,6 +318,12 @@ void ExtractWorker::extract(const QString &dirPath, const quint64 totalFiles)
                 return;
             }
             const QString current = ArchiveEntryPaths::callWithSystemLocale<QString>(ArchiveEntryPaths::pathname, entry);
+            if (m_skippedEntries.contains(current)) {
+                archive_read_data_skip(reader.get());
+                ++completed;
+                emit completedChanged(completed, totalFiles);
+                continue;
+            }
             const QString outputPath = dirPath + QDir::separator() + current;
             ArchiveEntryPaths::callWithSystemLocale(&ArchiveEntryPaths::setPathname, entry, outputPath);
 
@@ -648,6 +662,12 @@ bool LibArchiveArchive::extract(const QString &dirPath, const quint64 totalFiles
             }
 
             const QString current = ArchiveEntryPaths::callWithSystemLocale<QString>(ArchiveEntryPaths::pathname, entry);
+            if (skippedEntries().contains(current)) {
+                archive_read_data_skip(reader.get());
+                ++completed;
+                emit completedChanged(completed, totalFiles);
+                continue;
+            }
             const QString outputPath = dirPath + QDir::separator() + current;
             ArchiveEntryPaths::callWithSystemLocale(ArchiveEntryPaths::setPathname, entry, outputPath);
 
@@ -881,6 +901,7 @@ bool LibArchiveArchive::isSupported()
 */
 void LibArchiveArchive::workerExtract(const QString &dirPath, const quint64 totalFiles)
 {
+    m_worker.setSkippedEntries(skippedEntries());
     emit workerAboutToExtract(dirPath, totalFiles);
 }
 
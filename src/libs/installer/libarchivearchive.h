@@ -60,6 +60,7 @@ public:
     ExtractWorker() = default;
 
     Status status() const;
+    void setSkippedEntries(const QSet<QString> &paths);
 
 public Q_SLOTS:
     void extract(const QString &dirPath, const quint64 totalFiles);
@@ -87,6 +88,7 @@ private:
     QByteArray m_buffer;
     qint64 m_lastPos = 0;
     Status m_status;
+    QSet<QString> m_skippedEntries;
 };
 
 class INSTALLER_EXPORT LibArchiveArchive : public AbstractArchive
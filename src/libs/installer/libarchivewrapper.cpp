@@ -179,6 +179,15 @@ void LibArchiveWrapper::setCompressionLevel(const CompressionLevel level)
     d->setCompressionLevel(level);
 }
 
+/*!
+    Sets the entries that are not written to disk when extracting the archive to \a paths.
+*/
+void LibArchiveWrapper::setSkippedEntries(const QSet<QString> &paths)
+{
+    AbstractArchive::setSkippedEntries(paths);
+    d->setSkippedEntries(paths);
+}
+
 /*!
     Cancels the extract operation in progress.
 
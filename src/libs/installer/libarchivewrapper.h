@@ -59,6 +59,7 @@ public:
     bool isSupported() override;
 
     void setCompressionLevel(const AbstractArchive::CompressionLevel level) override;
+    void setSkippedEntries(const QSet<QString> &paths) override;
 
 public Q_SLOTS:
     void cancel() override;
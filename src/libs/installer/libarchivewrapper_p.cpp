@@ -210,6 +210,22 @@ void LibArchiveWrapperPrivate::setCompressionLevel(const AbstractArchive::Compre
     m_archive.setCompressionLevel(level);
 }
 
+/*!
+    Sets the entries that are not written to disk when extracting the archive to \a paths.
+
+    If the remote connection is active, the method is called by the server instead.
+*/
+void LibArchiveWrapperPrivate::setSkippedEntries(const QSet<QString> &paths)
+{
+    if (connectToServer()) {
+        m_lock.lockForWrite();
+        callRemoteMethodDefaultReply(QLatin1String(Protocol::AbstractArchiveSetSkippedEntries), paths);
+        m_lock.unlock();
+        return;
+    }
+    m_archive.setSkippedEntries(paths);
+}
+
 /*!
     Cancels the extract operation in progress.
 
@@ -27,10 +27,9 @@
 **************************************************************************/
 
 #include "linereplaceoperation.h"
+#include "streamreplacer.h"
 
 #include <QtCore/QDir>
-#include <QtCore/QFile>
-#include <QtCore/QTextStream>
 
 using namespace QInstaller;
 
@@ -72,36 +71,23 @@ bool LineReplaceOperation::performOperation()
         return false;
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    StreamReplacer replacer(fileName);
+    const StreamReplacer::Status status = replacer.replaceLinesStartingWith(searchString,
+        replaceString);
+
+    if (status == StreamReplacer::ReadError) {
         setError(UserDefinedError);
         setErrorString(tr("Cannot open file \"%1\" for reading: %2").arg(
-                           QDir::toNativeSeparators(fileName), file.errorString()));
+                           QDir::toNativeSeparators(fileName), replacer.errorString()));
         return false;
     }
-
-    QString replacement;
-    QTextStream stream(&file);
-    while (!stream.atEnd()) {
-        const QString line = stream.readLine();
-        if (line.trimmed().startsWith(searchString))
-            replacement.append(replaceString + QLatin1String("\n"));
-        else
-            replacement.append(line + QLatin1String("\n"));
-    }
-    file.close();
-
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    if (status == StreamReplacer::WriteError) {
         setError(UserDefinedError);
         setErrorString(tr("Cannot open file \"%1\" for writing: %2").arg(
-                           QDir::toNativeSeparators(fileName), file.errorString()));
+                           QDir::toNativeSeparators(fileName), replacer.errorString()));
         return false;
     }
 
-    stream.setDevice(&file);
-    stream << replacement;
-    file.close();
-
     return true;
 }
 
@@ -35,8 +35,13 @@
 #include "remoteclient.h"
 #include "remotefileengine.h"
 
+#include <QCoreApplication>
 #include <QXmlStreamWriter>
 #include <QElapsedTimer>
+#include <QAtomicPointer>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
 
 #include <iostream>
 #if defined(Q_OS_UNIX)
@@ -106,6 +111,253 @@ public:
     Uptime() { start(); }
 };
 
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::AsyncLogWriter
+    \internal
+
+    Writes preformatted log messages to the verbose log and the standard
+    output from a dedicated thread. Producers push messages to a lock-free
+    multiple-producer single-consumer queue and never wait for the actual
+    output, the writer thread drains the queue in batches and flushes the
+    standard output once per batch. Messages from a single thread are written
+    in the order they were pushed.
+
+    Once shutdown() has joined the writer thread, messages are still pushed to
+    the queue, but the producer drains it synchronously right away. This keeps
+    the order with messages that were pushed while the writer was stopping.
+*/
+class AsyncLogWriter : public QThread
+{
+    Q_DISABLE_COPY(AsyncLogWriter)
+
+public:
+    enum MessageKind {
+        LogMessage,
+        ProgressMessage
+    };
+
+    struct Message
+    {
+        Message() : next(nullptr), kind(LogMessage), toStdOut(false) {}
+
+        QAtomicPointer<Message> next;
+        MessageKind kind;
+        bool toStdOut;
+        QString text;
+    };
+
+    AsyncLogWriter(bool outputRedirected)
+        : m_head(&m_stub)
+        , m_tail(&m_stub)
+        , m_pending(0)
+        , m_started(false)
+        , m_stopRequested(false)
+        , m_stopped(false)
+        , m_outputRedirected(outputRedirected)
+        , m_pushed(0)
+        , m_written(0)
+    {
+        setObjectName(QLatin1String("AsyncLogWriter"));
+    }
+
+    ~AsyncLogWriter()
+    {
+        shutdown();
+    }
+
+    void push(Message *message)
+    {
+        ensureStarted();
+
+        m_pushed.fetchAndAddOrdered(1);
+        message->next.storeRelaxed(nullptr);
+        Message *prev = m_head.fetchAndStoreOrdered(message);
+        prev->next.storeRelease(message);
+
+        // Pairs with shutdown(): either it sees the message, or we see that it is done.
+        if (m_stopped.fetchAndAddOrdered(0)) {
+            QMutexLocker _(&m_fallbackMutex);
+            drain();
+            return;
+        }
+
+        // Wake up the writer only on the transition from an empty queue.
+        if (m_pending.fetchAndAddOrdered(1) == 0)
+            m_wakeUp.release();
+    }
+
+    void flush()
+    {
+        if (QThread::currentThread() == this)
+            return;
+
+        // Every pushed message is written eventually, either by the writer thread or
+        // synchronously after shutdown().
+        const quint64 target = m_pushed.loadAcquire();
+        QMutexLocker locker(&m_flushMutex);
+        while (m_written.loadAcquire() < target)
+            m_flushed.wait(&m_flushMutex, 100);
+    }
+
+    void shutdown()
+    {
+        {
+            QMutexLocker _(&m_fallbackMutex);
+            if (m_stopRequested.loadRelaxed())
+                return;
+            m_stopRequested.storeRelease(true); // no writer thread is started from now on
+        }
+
+        if (m_started.loadAcquire()) {
+            m_wakeUp.release();
+            wait();
+        }
+
+        // Write out anything that was pushed while the writer was stopping. Producers
+        // keep using the queue, so the order of their messages is kept.
+        QMutexLocker _(&m_fallbackMutex);
+        m_stopped.fetchAndStoreOrdered(1);
+        drain();
+    }
+
+protected:
+    void run() override
+    {
+        while (true) {
+            m_wakeUp.acquire();
+
+            int drained = 0;
+            while (true) {
+                Message *message = pop();
+                if (!message) {
+                    if (m_pending.loadAcquire() - drained <= 0)
+                        break;
+                    // A producer is in the middle of a push, the node becomes visible shortly.
+                    QThread::yieldCurrentThread();
+                    continue;
+                }
+                write(message);
+                delete message;
+                ++drained;
+            }
+            std::cout << std::flush;
+
+            {
+                QMutexLocker _(&m_flushMutex);
+                m_written.fetchAndAddOrdered(drained);
+                m_flushed.wakeAll();
+            }
+
+            const int remaining = m_pending.fetchAndAddOrdered(-drained) - drained;
+            if (remaining > 0) {
+                m_wakeUp.release(); // more messages arrived while draining
+                continue;
+            }
+            if (m_stopRequested.loadAcquire() && remaining <= 0)
+                break;
+        }
+
+        QMutexLocker _(&m_flushMutex);
+        m_flushed.wakeAll();
+    }
+
+private:
+    void ensureStarted()
+    {
+        // Start lazily, so that no thread exists before the process forks.
+        if (m_started.loadAcquire() || m_stopRequested.loadAcquire())
+            return;
+
+        QMutexLocker _(&m_fallbackMutex);
+        if (!m_started.loadRelaxed() && !m_stopRequested.loadRelaxed()) {
+            start(QThread::LowPriority);
+            m_started.storeRelease(true);
+        }
+    }
+
+    Message *pop()
+    {
+        Message *tail = m_tail;
+        Message *next = tail->next.loadAcquire();
+        if (tail == &m_stub) {
+            if (!next)
+                return nullptr;
+            m_tail = next;
+            tail = next;
+            next = next->next.loadAcquire();
+        }
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        if (tail != m_head.loadAcquire())
+            return nullptr;
+
+        // Re-insert the stub so that the last real message can be detached.
+        m_stub.next.storeRelaxed(nullptr);
+        Message *prev = m_head.fetchAndStoreOrdered(&m_stub);
+        prev->next.storeRelease(&m_stub);
+
+        next = tail->next.loadAcquire();
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    // Expects m_fallbackMutex to be locked and the writer thread to be finished.
+    void drain()
+    {
+        quint64 drained = 0;
+        while (Message *message = pop()) {
+            write(message);
+            delete message;
+            ++drained;
+        }
+        std::cout << std::flush;
+
+        QMutexLocker _(&m_flushMutex);
+        m_written.fetchAndAddOrdered(drained);
+        m_flushed.wakeAll();
+    }
+
+    void write(const Message *message)
+    {
+        if (message->kind == ProgressMessage) {
+            if (!m_outputRedirected)
+                std::cout << message->text.toStdString() << "\r";
+            return;
+        }
+
+        if (VerboseWriter *log = VerboseWriter::instance())
+            log->appendLine(message->text);
+
+        if (message->toStdOut)
+            std::cout << qPrintable(message->text) << '\n';
+    }
+
+private:
+    Message m_stub;
+    QAtomicPointer<Message> m_head;
+    Message *m_tail;
+
+    QAtomicInt m_pending;
+    QAtomicInt m_started;
+    QAtomicInt m_stopRequested;
+    QAtomicInt m_stopped;
+    QSemaphore m_wakeUp;
+    const bool m_outputRedirected;
+
+    QAtomicInteger<quint64> m_pushed;
+    QAtomicInteger<quint64> m_written;
+    QMutex m_flushMutex;
+    QWaitCondition m_flushed;
+
+    QMutex m_fallbackMutex;
+};
+
 /*!
     \internal
 */
@@ -118,6 +370,11 @@ LoggingHandler::LoggingHandler()
 #elif defined(Q_OS_WIN)
     m_outputRedirected = !_isatty(_fileno(stdout));
 #endif
+    m_writer.reset(new AsyncLogWriter(m_outputRedirected));
+
+    // Join the writer thread while the application still exists, not during the
+    // destruction of static objects.
+    qAddPostRoutine([] { LoggingHandler::instance().m_writer->shutdown(); });
 }
 
 /*!
@@ -125,6 +382,7 @@ LoggingHandler::LoggingHandler()
 */
 LoggingHandler::~LoggingHandler()
 {
+    m_writer->shutdown();
 }
 
 /*!
@@ -134,15 +392,17 @@ LoggingHandler::~LoggingHandler()
 */
 void LoggingHandler::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-    QMutexLocker _(&m_mutex);
-
     // suppress warning from QPA minimal plugin
     if (msg.contains(QLatin1String("This plugin does not support propagateSizeHints")))
         return;
 
     if (context.category == lcProgressIndicator().categoryName()) {
-        if (!outputRedirected())
-            std::cout << msg.toStdString() << "\r" << std::flush;
+        if (!outputRedirected()) {
+            AsyncLogWriter::Message *message = new AsyncLogWriter::Message;
+            message->kind = AsyncLogWriter::ProgressMessage;
+            message->text = msg;
+            m_writer->push(message);
+        }
         return;
     }
 
@@ -157,19 +417,29 @@ void LoggingHandler::messageHandler(QtMsgType type, const QMessageLogContext &co
                     QString::fromLatin1(context.function));
     }
 
-    if (VerboseWriter *log = VerboseWriter::instance())
-        log->appendLine(ba);
-
-    if (type != QtDebugMsg || isVerbose())
-        std::cout << qPrintable(ba) << std::endl;
+    AsyncLogWriter::Message *message = new AsyncLogWriter::Message;
+    message->toStdOut = (type != QtDebugMsg || isVerbose());
+    message->text = ba;
+    m_writer->push(message);
 
     if (type == QtFatalMsg) {
+        // make sure everything is written before the application aborts
+        flushMessages();
         QtMessageHandler oldMsgHandler = qInstallMessageHandler(nullptr);
         qt_message_output(type, context, msg);
         qInstallMessageHandler(oldMsgHandler);
     }
 }
 
+/*!
+    Blocks until all messages passed to messageHandler() before this call
+    have been written to the log and the standard output.
+*/
+void LoggingHandler::flushMessages() const
+{
+    m_writer->flush();
+}
+
 /*!
     Trims the trailing space character and surrounding quotes from \a msg.
     Also prepends the message \a type to the message.
@@ -255,6 +525,8 @@ bool LoggingHandler::outputRedirected() const
 */
 void LoggingHandler::printUpdateInformation(const QList<Component *> &components) const
 {
+    flushMessages();
+
     QString output;
     QXmlStreamWriter stream(&output);
     stream.setAutoFormatting(true);
@@ -281,6 +553,8 @@ void LoggingHandler::printUpdateInformation(const QList<Component *> &components
 */
 void LoggingHandler::printLocalPackageInformation(const QList<KDUpdater::LocalPackage> &packages) const
 {
+    flushMessages();
+
     QString output;
     QXmlStreamWriter stream(&output);
     stream.setAutoFormatting(true);
@@ -319,44 +593,47 @@ void LoggingHandler::printLocalPackageInformation(const QList<KDUpdater::LocalPa
     depending on the current verbosity level. If a package is also present in \a installedPackages,
     the installed version will be included in printed information.
 */
-void LoggingHandler::printPackageInformation(const PackagesList &matchedPackages, const LocalPackagesMap &installedPackages) const
+void LoggingHandler::printPackageInformation(const QList<PackageSearchIndex::Entry> &matchedPackages,
+    const LocalPackagesMap &installedPackages) const
 {
+    flushMessages();
+
     QString output;
     QXmlStreamWriter stream(&output);
     stream.setAutoFormatting(true);
     stream.writeStartDocument();
 
     stream.writeStartElement(QLatin1String("availablepackages"));
-    foreach (Package *package, matchedPackages) {
-        const QString name = package->data(scName).toString();
+    foreach (const PackageSearchIndex::Entry &package, matchedPackages) {
+        const QString name = package.name();
         stream.writeStartElement(QLatin1String("package"));
         stream.writeAttribute(QLatin1String("name"), name);
-        stream.writeAttribute(QLatin1String("displayname"), package->data(scDisplayName).toString());
-        stream.writeAttribute(QLatin1String("version"), package->data(scVersion).toString());
+        stream.writeAttribute(QLatin1String("displayname"), package.value(scDisplayName));
+        stream.writeAttribute(QLatin1String("version"), package.value(scVersion));
         //Check if package already installed
         if (installedPackages.contains(name))
             stream.writeAttribute(QLatin1String("installedVersion"), installedPackages.value(name).version);
         if (verboseLevel() == VerbosityLevel::Detailed) {
-            stream.writeAttribute(QLatin1String("description"), package->data(scDescription).toString());
-            stream.writeAttribute(QLatin1String("treeName"), package->data(scTreeName).value<QPair<QString, bool>>().first);
-            stream.writeAttribute(QLatin1String("moveChildren"), QVariant(package->data(scTreeName).value<QPair<QString, bool>>().second).toString());
-            stream.writeAttribute(QLatin1String("dependencies"), package->data(scDependencies).toString());
-            stream.writeAttribute(QLatin1String("autoDependencies"), package->data(scAutoDependOn).toString());
-            stream.writeAttribute(QLatin1String("virtual"), package->data(scVirtual).toString());
-            stream.writeAttribute(QLatin1String("forcedInstallation"), package->data(QLatin1String("ForcedInstallation")).toString());
-            stream.writeAttribute(QLatin1String("checkable"), package->data(scCheckable).toString());
-            stream.writeAttribute(QLatin1String("default"), package->data(scDefault).toString());
-            stream.writeAttribute(QLatin1String("essential"), package->data(scEssential).toString());
-            stream.writeAttribute(QLatin1String("forcedUpdate"), package->data(scForcedUpdate).toString());
-            stream.writeAttribute(QLatin1String("compressedsize"), package->data(QLatin1String("CompressedSize")).toString());
-            stream.writeAttribute(QLatin1String("uncompressedsize"), package->data(QLatin1String("UncompressedSize")).toString());
-            stream.writeAttribute(QLatin1String("releaseDate"), package->data(scReleaseDate).toString());
-            stream.writeAttribute(QLatin1String("downloadableArchives"), package->data(scDownloadableArchives).toString());
-            stream.writeAttribute(QLatin1String("licenses"), package->data(QLatin1String("Licenses")).toString());
-            stream.writeAttribute(QLatin1String("script"), package->data(scScript).toString());
-            stream.writeAttribute(QLatin1String("sortingPriority"), package->data(scSortingPriority).toString());
-            stream.writeAttribute(QLatin1String("replaces"), package->data(scReplaces).toString());
-            stream.writeAttribute(QLatin1String("requiresAdminRights"), package->data(scRequiresAdminRights).toString());
+            stream.writeAttribute(QLatin1String("description"), package.value(scDescription));
+            stream.writeAttribute(QLatin1String("treeName"), package.value(scTreeName));
+            stream.writeAttribute(QLatin1String("moveChildren"), QVariant(package.moveChildren).toString());
+            stream.writeAttribute(QLatin1String("dependencies"), package.value(scDependencies));
+            stream.writeAttribute(QLatin1String("autoDependencies"), package.value(scAutoDependOn));
+            stream.writeAttribute(QLatin1String("virtual"), package.value(scVirtual));
+            stream.writeAttribute(QLatin1String("forcedInstallation"), package.value(QLatin1String("ForcedInstallation")));
+            stream.writeAttribute(QLatin1String("checkable"), package.value(scCheckable));
+            stream.writeAttribute(QLatin1String("default"), package.value(scDefault));
+            stream.writeAttribute(QLatin1String("essential"), package.value(scEssential));
+            stream.writeAttribute(QLatin1String("forcedUpdate"), package.value(scForcedUpdate));
+            stream.writeAttribute(QLatin1String("compressedsize"), package.value(QLatin1String("CompressedSize")));
+            stream.writeAttribute(QLatin1String("uncompressedsize"), package.value(QLatin1String("UncompressedSize")));
+            stream.writeAttribute(QLatin1String("releaseDate"), package.value(scReleaseDate));
+            stream.writeAttribute(QLatin1String("downloadableArchives"), package.value(scDownloadableArchives));
+            stream.writeAttribute(QLatin1String("licenses"), package.value(QLatin1String("Licenses")));
+            stream.writeAttribute(QLatin1String("script"), package.value(scScript));
+            stream.writeAttribute(QLatin1String("sortingPriority"), package.value(scSortingPriority));
+            stream.writeAttribute(QLatin1String("replaces"), package.value(scReplaces));
+            stream.writeAttribute(QLatin1String("requiresAdminRights"), package.value(scRequiresAdminRights));
         }
         stream.writeEndElement();
     }
@@ -383,7 +660,7 @@ VerboseWriter::~VerboseWriter()
 {
     if (m_preFileBuffer.isOpen()) {
         PlainVerboseWriterOutput output;
-        (void)flush(&output);
+        (void)writeToOutput(&output);
     }
 }
 
@@ -392,6 +669,17 @@ VerboseWriter::~VerboseWriter()
 */
 bool VerboseWriter::flush(VerboseWriterOutput *output)
 {
+    // make sure messages still queued in the asynchronous writer end up in the log
+    LoggingHandler::instance().flushMessages();
+    return writeToOutput(output);
+}
+
+/*!
+    \internal
+*/
+bool VerboseWriter::writeToOutput(VerboseWriterOutput *output)
+{
+    QMutexLocker _(&m_mutex);
     m_stream.flush();
     if (m_logFileName.isEmpty()) // binarycreator
         return true;
@@ -425,6 +713,7 @@ bool VerboseWriter::flush(VerboseWriterOutput *output)
 */
 void VerboseWriter::setFileName(const QString &fileName)
 {
+    QMutexLocker _(&m_mutex);
     m_logFileName = fileName;
 }
 
@@ -443,7 +732,8 @@ VerboseWriter *VerboseWriter::instance()
 */
 void VerboseWriter::appendLine(const QString &msg)
 {
-    m_stream << msg << Qt::endl;
+    QMutexLocker _(&m_mutex);
+    m_stream << msg << QLatin1Char('\n');
 }
 
 /*!
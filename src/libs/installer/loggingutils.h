@@ -31,16 +31,19 @@
 
 #include "qinstallerglobal.h"
 #include "localpackagehub.h"
+#include "packagesearchindex.h"
 
 #include <QObject>
 #include <QIODevice>
 #include <QTextStream>
 #include <QBuffer>
 #include <QMutex>
+#include <QScopedPointer>
 
 namespace QInstaller {
 
 class Component;
+class AsyncLogWriter;
 
 class INSTALLER_EXPORT LoggingHandler
 {
@@ -58,6 +61,7 @@ public:
 
     static LoggingHandler &instance();
     void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+    void flushMessages() const;
 
     void setVerbose(bool v);
     bool isVerbose() const;
@@ -66,7 +70,8 @@ public:
 
     void printUpdateInformation(const QList<Component *> &components) const;
     void printLocalPackageInformation(const QList<KDUpdater::LocalPackage> &packages) const;
-    void printPackageInformation(const PackagesList &matchedPackages, const LocalPackagesMap &installedPackages) const;
+    void printPackageInformation(const QList<PackageSearchIndex::Entry> &matchedPackages,
+        const LocalPackagesMap &installedPackages) const;
 
     friend VerbosityLevel &operator++(VerbosityLevel &level, int);
     friend VerbosityLevel &operator--(VerbosityLevel &level, int);
@@ -81,7 +86,7 @@ private:
     VerbosityLevel m_verbLevel;
     bool m_outputRedirected;
 
-    QMutex m_mutex;
+    QScopedPointer<AsyncLogWriter> m_writer;
 };
 
 class INSTALLER_EXPORT VerboseWriterOutput
@@ -123,11 +128,16 @@ public:
     void appendLine(const QString &msg);
     void setFileName(const QString &fileName);
 
+private:
+    bool writeToOutput(VerboseWriterOutput *output);
+
 private:
     QTextStream m_stream;
     QBuffer m_preFileBuffer;
     QString m_logFileName;
     QString m_currentDateTimeAsString;
+
+    QMutex m_mutex;
 };
 
 LoggingHandler::VerbosityLevel &operator++(LoggingHandler::VerbosityLevel &level, int);
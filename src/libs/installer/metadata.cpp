@@ -36,7 +36,9 @@
 #include <QDir>
 #include <QDomDocument>
 #include <QFile>
+#include <QFileInfo>
 #include <QByteArrayMatcher>
+#include <QSettings>
 
 namespace QInstaller {
 
@@ -105,6 +107,7 @@ static bool verifyFileIntegrityFromElement(const QDomElement &element, const QSt
 */
 Metadata::Metadata()
     : CacheableItem()
+    , m_validatorsRead(false)
     , m_fromDefaultRepository(false)
 {
 }
@@ -114,6 +117,7 @@ Metadata::Metadata()
 */
 Metadata::Metadata(const QString &path)
     : CacheableItem(path)
+    , m_validatorsRead(false)
     , m_fromDefaultRepository(false)
 {
 }
@@ -313,6 +317,90 @@ QString Metadata::persistentRepositoryPath()
     return m_persistentRepositoryPath;
 }
 
+/*!
+    \class QInstaller::Metadata::UpdatesValidators
+    \inmodule QtInstallerFramework
+    \brief The UpdatesValidators struct holds the values used to check whether
+    the \c Updates.xml file of a repository has changed since it was fetched.
+
+    Remote repositories are validated with the \c ETag and \c Last-Modified headers
+    returned by the server, local repositories with the size and modification time
+    of the file.
+*/
+
+/*!
+    Returns \c true if no validator is set, \c false otherwise.
+*/
+bool Metadata::UpdatesValidators::isEmpty() const
+{
+    return eTag.isEmpty() && lastModified.isEmpty() && size < 0 && !modified.isValid();
+}
+
+/*!
+    Returns \c true if all values of this object equal the values of \a other,
+    \c false otherwise.
+*/
+bool Metadata::UpdatesValidators::operator==(const UpdatesValidators &other) const
+{
+    return url == other.url && eTag == other.eTag && lastModified == other.lastModified
+        && size == other.size && modified == other.modified;
+}
+
+/*!
+    Returns the validators of the \c Updates.xml file of this metadata. The
+    values are read from the metadata directory on first call.
+*/
+Metadata::UpdatesValidators Metadata::updatesValidators() const
+{
+    if (m_validatorsRead)
+        return m_validators;
+
+    m_validatorsRead = true;
+    const QString fileName = path() + QLatin1String("/validators.ini");
+    if (!QFileInfo::exists(fileName))
+        return m_validators;
+
+    const QSettings settings(fileName, QSettings::IniFormat);
+    m_validators.url = settings.value(QLatin1String("Url")).toString();
+    m_validators.eTag = settings.value(QLatin1String("ETag")).toByteArray();
+    m_validators.lastModified = settings.value(QLatin1String("LastModified")).toByteArray();
+    m_validators.size = settings.value(QLatin1String("Size"), -1).toLongLong();
+    m_validators.modified = settings.value(QLatin1String("Modified")).toDateTime();
+    return m_validators;
+}
+
+/*!
+    Sets the validators of the \c Updates.xml file of this metadata to \a validators.
+    The values are saved to disk, so that later runs can check whether the repository
+    has changed without fetching the file again.
+*/
+void Metadata::setUpdatesValidators(const UpdatesValidators &validators)
+{
+    if (updatesValidators() == validators)
+        return;
+
+    QSettings settings(path() + QLatin1String("/validators.ini"), QSettings::IniFormat);
+    settings.clear();
+    if (!validators.isEmpty()) {
+        settings.setValue(QLatin1String("Url"), validators.url);
+        if (!validators.eTag.isEmpty())
+            settings.setValue(QLatin1String("ETag"), validators.eTag);
+        if (!validators.lastModified.isEmpty())
+            settings.setValue(QLatin1String("LastModified"), validators.lastModified);
+        if (validators.size >= 0)
+            settings.setValue(QLatin1String("Size"), validators.size);
+        if (validators.modified.isValid())
+            settings.setValue(QLatin1String("Modified"), validators.modified);
+    }
+    settings.sync();
+    if (settings.status() != QSettings::NoError) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot write validators to"
+            << settings.fileName();
+        return;
+    }
+    m_validators = validators;
+}
+
 /*!
     Returns true if the updates document of this metadata contains the repository
     update element, which can include actions to \c add, \c remove, and \c replace
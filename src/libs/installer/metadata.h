@@ -33,6 +33,7 @@
 #include "genericdatacache.h"
 #include "repository.h"
 
+#include <QDateTime>
 #include <QDomDocument>
 
 class QFile;
@@ -42,6 +43,19 @@ namespace QInstaller {
 class INSTALLER_EXPORT Metadata : public CacheableItem
 {
 public:
+    struct UpdatesValidators
+    {
+        QString url;
+        QByteArray eTag;
+        QByteArray lastModified;
+        qint64 size = -1;
+        QDateTime modified;
+
+        bool isEmpty() const;
+        bool operator==(const UpdatesValidators &other) const;
+        bool operator!=(const UpdatesValidators &other) const { return !(*this == other); }
+    };
+
     Metadata();
     explicit Metadata(const QString &path);
     ~Metadata() {}
@@ -63,6 +77,9 @@ public:
     void setPersistentRepositoryPath(const QUrl &url);
     QString persistentRepositoryPath();
 
+    UpdatesValidators updatesValidators() const;
+    void setUpdatesValidators(const UpdatesValidators &validators);
+
     bool containsRepositoryUpdates() const;
 
 private:
@@ -72,6 +89,8 @@ private:
     Repository m_repository;
     QString m_persistentRepositoryPath;
     mutable QByteArray m_checksum;
+    mutable UpdatesValidators m_validators;
+    mutable bool m_validatorsRead;
 
     bool m_fromDefaultRepository;
 };
@@ -36,10 +36,10 @@
 #include "settings.h"
 #include "testrepository.h"
 #include "globals.h"
+#include "tracelog.h"
 
 #include <QTemporaryDir>
 #include <QtConcurrent>
-#include <QtMath>
 #include <QRandomGenerator>
 
 namespace QInstaller {
@@ -70,6 +70,13 @@ namespace QInstaller {
     \internal
 */
 
+namespace TaskRole {
+enum
+{
+    CachedChecksum = TaskRole::UserRole + 1
+};
+}
+
 static QUrl resolveUrl(const FileTaskResult &result, const QString &url)
 {
     QUrl u(url);
@@ -78,23 +85,48 @@ static QUrl resolveUrl(const FileTaskResult &result, const QString &url)
     return u;
 }
 
+static Metadata::UpdatesValidators localUpdatesValidators(const Repository &repository)
+{
+    Metadata::UpdatesValidators validators;
+    const QFileInfo fileInfo(repository.url().toLocalFile() + QLatin1Char('/') + scUpdatesXML);
+    if (!fileInfo.isFile())
+        return validators;
+
+    validators.url = repository.url().toString();
+    validators.size = fileInfo.size();
+    validators.modified = fileInfo.lastModified();
+    return validators;
+}
+
+static Metadata::UpdatesValidators updatesValidators(const FileTaskResult &result)
+{
+    const FileTaskItem item = result.value(TaskRole::TaskItem).value<FileTaskItem>();
+    const Repository repository = item.value(TaskRole::UserRole).value<Repository>();
+    if (repository.url().isLocalFile())
+        return localUpdatesValidators(repository);
+
+    Metadata::UpdatesValidators validators;
+    validators.eTag = result.value(TaskRole::ETag).toByteArray();
+    validators.lastModified = result.value(TaskRole::LastModified).toByteArray();
+    if (!validators.isEmpty())
+        validators.url = repository.url().toString();
+    return validators;
+}
+
 MetadataJob::MetadataJob(QObject *parent)
     : Job(parent)
     , m_core(nullptr)
     , m_downloadType(DownloadType::All)
-    , m_downloadableChunkSize(1000)
-    , m_taskNumber(0)
+    , m_metadataDownloadFinished(false)
     , m_defaultRepositoriesFetched(false)
+    , m_xmlTaskStart(-1)
+    , m_metadataTaskStart(-1)
+    , m_unzipTasksStart(-1)
+    , m_updateCacheTaskStart(-1)
 {
-    QByteArray downloadableChunkSize = qgetenv("IFW_METADATA_SIZE");
-    if (!downloadableChunkSize.isEmpty()) {
-        int chunkSize = QString::fromLocal8Bit(downloadableChunkSize).toInt();
-        if (chunkSize > 0)
-            m_downloadableChunkSize = chunkSize;
-    }
-
     setCapabilities(Cancelable);
     connect(&m_xmlTask, &QFutureWatcherBase::finished, this, &MetadataJob::xmlTaskFinished);
+    connect(&m_metadataTask, &QFutureWatcherBase::resultReadyAt, this, &MetadataJob::metadataResultReady);
     connect(&m_metadataTask, &QFutureWatcherBase::finished, this, &MetadataJob::metadataTaskFinished);
     connect(&m_metadataTask, &QFutureWatcherBase::progressValueChanged, this, &MetadataJob::progressChanged);
     connect(&m_updateCacheTask, &QFutureWatcherBase::finished, this, &MetadataJob::updateCacheTaskFinished);
@@ -219,7 +251,6 @@ void MetadataJob::doStart()
 {
     setError(Job::NoError);
     setErrorString(QString());
-    m_metadataResult.clear();
     setProgressTotalAmount(100);
 
     if (!m_core) {
@@ -284,6 +315,17 @@ void MetadataJob::doStart()
                     FileTaskItem item(url, tmp.path() + QLatin1String("/Updates.xml"));
                     item.insert(TaskRole::UserRole, QVariant::fromValue(repo));
                     item.insert(TaskRole::Authenticator, QVariant::fromValue(authenticator));
+
+                    // Ask the server to answer 304 Not Modified if the Updates.xml
+                    // has not changed since it was cached.
+                    if (!repo.url().isLocalFile()) {
+                        if (Metadata *cached = cachedMetadataForRepository(repo)) {
+                            const Metadata::UpdatesValidators validators = cached->updatesValidators();
+                            item.insert(TaskRole::ETag, validators.eTag);
+                            item.insert(TaskRole::LastModified, validators.lastModified);
+                            item.insert(TaskRole::CachedChecksum, cached->checksum());
+                        }
+                    }
                     items.append(item);
                 }
             }
@@ -335,6 +377,7 @@ void MetadataJob::doStart()
 
 void MetadataJob::startXMLTask(const QList<FileTaskItem> &items)
 {
+    m_xmlTaskStart = TraceLog::instance().timestamp();
     DownloadFileTask *const xmlTask = new DownloadFileTask(items);
     xmlTask->setProxyFactory(m_core->proxyFactory());
     connect(&m_xmlTask, &QFutureWatcher<FileTaskResult>::progressValueChanged, this,
@@ -369,6 +412,37 @@ void MetadataJob::startUnzipRepositoryTask(const Repository &repo)
     watcher->setFuture(QtConcurrent::run(&UnzipArchiveTask::doTask, task));
 }
 
+void MetadataJob::startUnzipTask(const FileTaskResult &result)
+{
+    const FileTaskItem item = result.value(TaskRole::TaskItem).value<FileTaskItem>();
+    if (result.value(TaskRole::ChecksumMismatch).toBool()) {
+        QString mismatchMessage = tr("Checksum mismatch detected for \"%1\".")
+                .arg(item.value(TaskRole::SourceFile).toString());
+        if (m_core->settings().allowUnstableComponents()) {
+            m_shaMissmatchPackages.append(item.value(TaskRole::Name).toString());
+            qCWarning(QInstaller::lcInstallerInstallLog) << mismatchMessage;
+        } else {
+            throw QInstaller::TaskException(mismatchMessage);
+        }
+        QFileInfo fi(result.target());
+        QString targetPath = fi.absolutePath();
+        if (m_fetchedMetadata.contains(targetPath)) {
+            delete m_fetchedMetadata.value(targetPath);
+            m_fetchedMetadata.remove(targetPath);
+        }
+        return;
+    }
+    UnzipArchiveTask *task = new UnzipArchiveTask(result.target(),
+        item.value(TaskRole::UserRole).toString());
+    task->setRemoveArchive(true);
+    task->setStoreChecksums(true);
+
+    QFutureWatcher<void> *watcher = new QFutureWatcher<void>();
+    m_unzipTasks.insert(watcher, qobject_cast<QObject*> (task));
+    connect(watcher, &QFutureWatcherBase::finished, this, &MetadataJob::unzipTaskFinished);
+    watcher->setFuture(QtConcurrent::run(&UnzipArchiveTask::doTask, task));
+}
+
 void MetadataJob::startUpdateCacheTask()
 {
     const int toRegisterCount = m_fetchedMetadata.count();
@@ -376,6 +450,7 @@ void MetadataJob::startUpdateCacheTask()
         emit infoMessage(this, tr("Updating local cache with %n new items...",
                                   nullptr, toRegisterCount));
 
+    m_updateCacheTaskStart = TraceLog::instance().timestamp();
     UpdateCacheTask *task = new UpdateCacheTask(m_metaFromCache, m_fetchedMetadata);
     m_updateCacheTask.setFuture(QtConcurrent::run(&UpdateCacheTask::doTask, task));
 }
@@ -471,6 +546,10 @@ void MetadataJob::xmlTaskFinished()
     Status status = XmlDownloadFailure;
     try {
         m_xmlTask.waitForFinished();
+        TraceLog::instance().addSpan(TraceLog::Metadata, QLatin1String("download Updates.xml"),
+            QString::number(m_xmlTask.future().resultCount()), m_xmlTaskStart);
+
+        TraceSpan span(TraceLog::Metadata, QLatin1String("parse Updates.xml"));
         status = parseUpdatesXml(m_xmlTask.future().results());
     } catch (const AuthenticationRequiredException &e) {
         if (e.type() == AuthenticationRequiredException::Type::Proxy) {
@@ -581,8 +660,11 @@ void MetadataJob::unzipTaskFinished()
     m_unzipTasks.remove(watcher);
     delete watcher;
 
-    if (m_unzipTasks.isEmpty())
+    if (m_unzipTasks.isEmpty() && m_metadataDownloadFinished) {
+        TraceLog::instance().addSpan(TraceLog::Metadata, QLatin1String("extract meta packages"),
+            QString(), m_unzipTasksStart);
         startUpdateCacheTask();
+    }
 }
 
 void MetadataJob::progressChanged(int progress)
@@ -595,50 +677,30 @@ void MetadataJob::setProgressTotalAmount(int maximum)
     setTotalAmount(maximum);
 }
 
+void MetadataJob::metadataResultReady(int index)
+{
+    if (error() != Job::NoError)
+        return;
+
+    // Extract meta packages while the remaining ones are still downloading.
+    try {
+        startUnzipTask(m_metadataTask.resultAt(index));
+    } catch (const TaskException &e) {
+        reset();
+        emitFinishedWithError(QInstaller::DownloadError, e.message());
+    }
+}
+
 void MetadataJob::metadataTaskFinished()
 {
+    // The job has already failed or was canceled, and the download was aborted.
+    if (error() != Job::NoError)
+        return;
+
     try {
         m_metadataTask.waitForFinished();
-        m_metadataResult.append(m_metadataTask.future().results());
-        if (!fetchMetaDataPackages()) {
-            if (m_metadataResult.count() > 0) {
-                emit infoMessage(this, tr("Extracting meta information..."));
-                foreach (const FileTaskResult &result, m_metadataResult) {
-                    const FileTaskItem item = result.value(TaskRole::TaskItem).value<FileTaskItem>();
-                    if (result.value(TaskRole::ChecksumMismatch).toBool()) {
-                        QString mismatchMessage = tr("Checksum mismatch detected for \"%1\".")
-                                .arg(item.value(TaskRole::SourceFile).toString());
-                        if (m_core->settings().allowUnstableComponents()) {
-                            m_shaMissmatchPackages.append(item.value(TaskRole::Name).toString());
-                            qCWarning(QInstaller::lcInstallerInstallLog) << mismatchMessage;
-                        } else {
-                            throw QInstaller::TaskException(mismatchMessage);
-                        }
-                        QFileInfo fi(result.target());
-                        QString targetPath = fi.absolutePath();
-                        if (m_fetchedMetadata.contains(targetPath)) {
-                            delete m_fetchedMetadata.value(targetPath);
-                            m_fetchedMetadata.remove(targetPath);
-                        }
-                        continue;
-                    }
-                    UnzipArchiveTask *task = new UnzipArchiveTask(result.target(),
-                        item.value(TaskRole::UserRole).toString());
-                    task->setRemoveArchive(true);
-                    task->setStoreChecksums(true);
-
-                    QFutureWatcher<void> *watcher = new QFutureWatcher<void>();
-                    m_unzipTasks.insert(watcher, qobject_cast<QObject*> (task));
-                    connect(watcher, &QFutureWatcherBase::finished, this, &MetadataJob::unzipTaskFinished);
-                    watcher->setFuture(QtConcurrent::run(&UnzipArchiveTask::doTask, task));
-                }
-                if (m_unzipTasks.isEmpty())
-                    startUpdateCacheTask();
-
-            } else {
-                startUpdateCacheTask();
-            }
-        }
+        TraceLog::instance().addSpan(TraceLog::Metadata, QLatin1String("download meta packages"),
+            QString::number(m_metadataTask.future().resultCount()), m_metadataTaskStart);
     } catch (const TaskException &e) {
         reset();
         emitFinishedWithError(QInstaller::DownloadError, e.message());
@@ -649,6 +711,15 @@ void MetadataJob::metadataTaskFinished()
         reset();
         emitFinishedWithError(QInstaller::DownloadError, tr("Unknown exception during download."));
     }
+
+    if (error() != Job::NoError)
+        return;
+
+    m_metadataDownloadFinished = true;
+    if (m_unzipTasks.isEmpty())
+        startUpdateCacheTask();
+    else
+        emit infoMessage(this, tr("Extracting meta information..."));
 }
 
 void MetadataJob::updateCacheTaskFinished()
@@ -666,6 +737,8 @@ void MetadataJob::updateCacheTaskFinished()
     if (error() != Job::NoError)
         return;
 
+    TraceLog::instance().addSpan(TraceLog::Metadata, QLatin1String("update cache"),
+        QString::number(m_fetchedMetadata.count()), m_updateCacheTaskStart);
     setProcessedAmount(100);
     emitFinished();
 }
@@ -675,25 +748,21 @@ void MetadataJob::updateCacheTaskFinished()
 
 bool MetadataJob::fetchMetaDataPackages()
 {
-    //Download files in chunks. QtConcurrent will choke if too many task is given to it
-    int chunkSize = qMin(m_packages.length(), m_downloadableChunkSize);
-    QList<FileTaskItem> tempPackages = m_packages.mid(0, chunkSize);
-    m_packages = m_packages.mid(chunkSize, m_packages.length());
-    if (tempPackages.length() > 0) {
-        m_taskNumber++;
-        setProcessedAmount(0);
-        DownloadFileTask *const metadataTask = new DownloadFileTask(tempPackages);
-        metadataTask->setProxyFactory(m_core->proxyFactory());
-        m_metadataTask.setFuture(QtConcurrent::run(&DownloadFileTask::doTask, metadataTask));
-        QString metaInformation;
-        if (m_totalTaskCount > 1)
-            metaInformation = tr("Retrieving meta information from remote repository... %1/%2 ").arg(m_taskNumber).arg(m_totalTaskCount);
-        else
-            metaInformation = tr("Retrieving meta information from remote repository... ");
-        emit infoMessage(this, metaInformation);
-        return true;
-    }
-    return false;
+    if (m_packages.isEmpty())
+        return false;
+
+    // All meta packages go to a single queue. The download task limits the number
+    // of concurrent connections and the packages are extracted as they arrive.
+    setProcessedAmount(0);
+    m_metadataDownloadFinished = false;
+    m_metadataTaskStart = TraceLog::instance().timestamp();
+    m_unzipTasksStart = m_metadataTaskStart;
+    DownloadFileTask *const metadataTask = new DownloadFileTask(m_packages);
+    metadataTask->setProxyFactory(m_core->proxyFactory());
+    m_packages.clear();
+    m_metadataTask.setFuture(QtConcurrent::run(&DownloadFileTask::doTask, metadataTask));
+    emit infoMessage(this, tr("Retrieving meta information from remote repository... "));
+    return true;
 }
 
 void MetadataJob::reset()
@@ -716,8 +785,7 @@ void MetadataJob::reset()
         m_metadataTask.waitForFinished();
     } catch (...) {}
     m_tempDirDeleter.releaseAndDeleteAll();
-    m_metadataResult.clear();
-    m_taskNumber = 0;
+    m_metadataDownloadFinished = false;
 }
 
 void MetadataJob::resetCompressedFetch()
@@ -751,6 +819,13 @@ MetadataJob::Status MetadataJob::parseUpdatesXml(const QList<FileTaskResult> &re
         if (error() != Job::NoError)
             return XmlDownloadFailure;
 
+        if (result.value(TaskRole::NotModified).toBool()) {
+            const Status status = refreshNotModifiedItem(result);
+            if (status != XmlDownloadSuccess)
+                return status;
+            continue;
+        }
+
         //If repository is not found, target might be empty. Do not continue parsing the
         //repository and do not prevent further repositories usage.
         if (result.target().isEmpty()) {
@@ -789,6 +864,7 @@ MetadataJob::Status MetadataJob::parseUpdatesXml(const QList<FileTaskResult> &re
             continue;
 
         metadata->setChecksum(updatesChecksum);
+        metadata->setUpdatesValidators(updatesValidators(result));
 
         file.seek(0);
 
@@ -870,10 +946,6 @@ MetadataJob::Status MetadataJob::parseUpdatesXml(const QList<FileTaskResult> &re
             return status;
         }
     }
-    double taskCount = m_packages.length()/static_cast<double>(m_downloadableChunkSize);
-    m_totalTaskCount = qCeil(taskCount);
-    m_taskNumber = 0;
-
     return XmlDownloadSuccess;
 }
 
@@ -902,6 +974,9 @@ MetadataJob::Status MetadataJob::refreshCacheItem(const FileTaskResult &result,
         // Refresh also persistent information, the url of the repository may have changed
         // from the last fetch.
         cachedMetadata->setPersistentRepositoryPath(repository.url());
+        const Metadata::UpdatesValidators validators = updatesValidators(result);
+        if (!validators.isEmpty())
+            cachedMetadata->setUpdatesValidators(validators);
 
         // search for additional repositories that we might need to check
         if (cachedMetadata->containsRepositoryUpdates()) {
@@ -929,21 +1004,29 @@ MetadataJob::Status MetadataJob::refreshCacheItem(const FileTaskResult &result,
 
 MetadataJob::Status MetadataJob::findCachedUpdatesFile(const Repository &repository, const QString &fileUrl)
 {
-    if (repository.xmlChecksum().isEmpty())
-        return XmlDownloadFailure;
-
-    Metadata *metadata = m_metaFromCache.itemByChecksum(repository.xmlChecksum());
+    Metadata *metadata = nullptr;
+    if (!repository.xmlChecksum().isEmpty())
+        metadata = m_metaFromCache.itemByChecksum(repository.xmlChecksum());
+
+    // Local repositories are unchanged if the size and modification time
+    // of the Updates.xml match the values recorded when it was cached.
+    if (!metadata && repository.url().isLocalFile()) {
+        metadata = cachedMetadataForRepository(repository);
+        if (metadata && metadata->updatesValidators() != localUpdatesValidators(repository))
+            metadata = nullptr;
+    }
     if (!metadata)
         return XmlDownloadFailure;
 
+    const QByteArray checksum = metadata->checksum();
     const QString targetPath = metadata->path() + QLatin1Char('/') + scUpdatesXML;
 
     FileTaskItem cachedMetaTaskItem(fileUrl, targetPath);
     cachedMetaTaskItem.insert(TaskRole::UserRole, QVariant::fromValue(repository));
-    const FileTaskResult cachedMetaTaskResult(targetPath, repository.xmlChecksum(), cachedMetaTaskItem, false);
+    const FileTaskResult cachedMetaTaskResult(targetPath, checksum, cachedMetaTaskItem, false);
 
     bool isCached = false;
-    const Status status = refreshCacheItem(cachedMetaTaskResult, repository.xmlChecksum(), &isCached);
+    const Status status = refreshCacheItem(cachedMetaTaskResult, checksum, &isCached);
     if (isCached)
         return XmlDownloadSuccess;
     else if (status == XmlDownloadRetry)
@@ -952,6 +1035,44 @@ MetadataJob::Status MetadataJob::findCachedUpdatesFile(const Repository &reposit
         return XmlDownloadFailure;
 }
 
+/*
+    Reuses the cached metadata of a repository that answered the conditional
+    request for Updates.xml with 304 Not Modified. If the cached metadata is
+    no longer usable, the fetch is restarted without validators.
+*/
+MetadataJob::Status MetadataJob::refreshNotModifiedItem(const FileTaskResult &result)
+{
+    const FileTaskItem item = result.value(TaskRole::TaskItem).value<FileTaskItem>();
+    const QByteArray checksum = item.value(TaskRole::CachedChecksum).toByteArray();
+
+    if (Metadata *cachedMetadata = m_metaFromCache.itemByChecksum(checksum)) {
+        const QString targetPath = cachedMetadata->path() + QLatin1Char('/') + scUpdatesXML;
+        const FileTaskResult cachedResult(targetPath, checksum, item, false);
+
+        bool refreshed = false;
+        const Status status = refreshCacheItem(cachedResult, checksum, &refreshed);
+        if (status != XmlDownloadSuccess || refreshed)
+            return status;
+    }
+    qCWarning(QInstaller::lcInstallerInstallLog) << "Cached metadata for"
+        << item.source() << "is not usable. Fetching again.";
+    return XmlDownloadRetry;
+}
+
+/*
+    Returns the cached metadata last fetched from the URL of \a repository,
+    or \c nullptr if there is none.
+*/
+Metadata *MetadataJob::cachedMetadataForRepository(const Repository &repository) const
+{
+    const QString url = repository.url().toString();
+    for (Metadata *metadata : m_metaFromCache.items()) {
+        if (metadata->updatesValidators().url == url)
+            return metadata;
+    }
+    return nullptr;
+}
+
 MetadataJob::Status MetadataJob::parseRepositoryUpdates(const QDomElement &root,
     const FileTaskResult &result, Metadata *metadata)
 {
@@ -81,6 +81,7 @@ private slots:
 
     void xmlTaskFinished();
     void unzipTaskFinished();
+    void metadataResultReady(int index);
     void metadataTaskFinished();
     void updateCacheTaskFinished();
     void progressChanged(int progress);
@@ -91,6 +92,7 @@ private slots:
 private:
     bool fetchMetaDataPackages();
     void startUnzipRepositoryTask(const Repository &repo);
+    void startUnzipTask(const FileTaskResult &result);
     void startUpdateCacheTask();
     void resetCacheRepositories();
     void reset();
@@ -98,6 +100,8 @@ private:
     Status parseUpdatesXml(const QList<FileTaskResult> &results);
     Status refreshCacheItem(const FileTaskResult &result, const QByteArray &checksum, bool *refreshed);
     Status findCachedUpdatesFile(const Repository &repository, const QString &fileUrl);
+    Status refreshNotModifiedItem(const FileTaskResult &result);
+    Metadata *cachedMetadataForRepository(const Repository &repository) const;
     Status parseRepositoryUpdates(const QDomElement &root, const FileTaskResult &result, Metadata *metadata);
     QSet<Repository> getRepositories();
     void addFileTaskItem(const QString &source, const QString &target, Metadata *metadata,
@@ -124,16 +128,18 @@ private:
     QHash<QFutureWatcher<void> *, QObject*> m_unzipRepositoryTasks;
     DownloadType m_downloadType;
     QList<FileTaskItem> m_unzipRepositoryitems;
-    QList<FileTaskResult> m_metadataResult;
-    int m_downloadableChunkSize;
-    int m_taskNumber;
-    int m_totalTaskCount;
+    bool m_metadataDownloadFinished;
     QStringList m_shaMissmatchPackages;
     bool m_defaultRepositoriesFetched;
 
     QSet<Repository> m_fetchedCategorizedRepositories;
     QHash<QString, Metadata *> m_fetchedMetadata;
     MetadataCache m_metaFromCache;
+
+    qint64 m_xmlTaskStart;
+    qint64 m_metadataTaskStart;
+    qint64 m_unzipTasksStart;
+    qint64 m_updateCacheTaskStart;
 };
 
 }   // namespace QInstaller
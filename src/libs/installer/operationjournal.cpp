@@ -0,0 +1,283 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "operationjournal.h"
+
+#include "binaryformat.h"
+#include "errors.h"
+#include "globals.h"
+#include "operationlog.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+using namespace QInstaller;
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::OperationJournal
+    \internal
+    \brief The OperationJournal class records changes to the performed operations next to the
+        maintenance tool data file.
+
+    Rewriting the maintenance tool data file after every update copies all of its resources
+    and serializes all operations again, even if only one component changed. Instead, the
+    changes of an update can be appended to the journal as one session:
+
+    \list
+        \li The identifiers of the operations that were removed, for example because their
+            component was uninstalled.
+        \li The operations that were added, in the format of the OperationLog.
+    \endlist
+
+    The operations of the data file get the identifiers \c 0 to \c{n - 1}, added operations
+    continue with the next free identifier in the order they were appended. Each session is
+    stored with a checksum, so that a session that was not completely written is ignored.
+
+    The journal starts with a header holding the size of the data file and its number of
+    operations. If they do not match the data file, the journal belongs to an older data file
+    and is ignored. The data file needs to be rewritten and the journal removed once
+    needsCompaction() returns \c true.
+*/
+
+/*!
+    \enum QInstaller::OperationJournal::anonymous
+
+    \value Version
+           The current version of the journal format.
+    \value MinimumCompactionSize
+           The size the journal can always grow to before it needs to be compacted.
+*/
+
+namespace {
+
+const quint32 scJournalMagic = 0x4f504a4e; // "OPJN"
+const QDataStream::Version scStreamVersion = QDataStream::Qt_5_15;
+
+QByteArray checksum(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+// Reads the journal header from stream. Returns false if it does not match the data file.
+bool readHeader(QDataStream &stream, const QString &dataFileName, quint32 baseCount)
+{
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 dataSize = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> dataSize >> count;
+    return stream.status() == QDataStream::Ok && magic == scJournalMagic
+        && version == OperationJournal::Version && dataSize == QFileInfo(dataFileName).size()
+        && count == baseCount;
+}
+
+// Reads the next session from stream. Returns false if it was not completely written.
+bool readSession(QDataStream &stream, QByteArray *session)
+{
+    QByteArray sum;
+    stream >> *session >> sum;
+    return stream.status() == QDataStream::Ok && sum == checksum(*session);
+}
+
+} // namespace
+
+/*!
+    Creates a journal for the maintenance tool data file \a dataFileName.
+*/
+OperationJournal::OperationJournal(const QString &dataFileName)
+    : m_dataFileName(dataFileName)
+{
+}
+
+/*!
+    Returns the file name of the journal.
+*/
+QString OperationJournal::fileName() const
+{
+    return m_dataFileName + QLatin1String(".journal");
+}
+
+/*!
+    Returns the size of the journal, or \c 0 if it does not exist.
+*/
+qint64 OperationJournal::size() const
+{
+    return QFileInfo(fileName()).size();
+}
+
+/*!
+    Returns whether the journal grew larger than the operations stored in the data file,
+    which take up \a operationsSize bytes there. Replaying the journal is then more
+    expensive than rewriting the data file.
+*/
+bool OperationJournal::needsCompaction(qint64 operationsSize) const
+{
+    return size() > qMax(operationsSize, qint64(MinimumCompactionSize));
+}
+
+/*!
+    Applies the sessions of the journal to \a operations, which hold the operations read from
+    the data file. Fills \a ids with the identifier of each resulting operation and returns the
+    identifier the next added operation gets.
+
+    A journal that does not belong to the data file is ignored. Reading stops at the first
+    session that is incomplete or corrupt.
+*/
+quint32 OperationJournal::replay(QList<OperationBlob> *operations, QVector<quint32> *ids) const
+{
+    const quint32 baseCount = quint32(operations->size());
+    ids->clear();
+    ids->reserve(operations->size());
+    for (quint32 id = 0; id < baseCount; ++id)
+        ids->append(id);
+
+    QFile file(fileName());
+    if (!file.exists())
+        return baseCount;
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot open operation journal"
+            << file.fileName() << ":" << file.errorString();
+        return baseCount;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(scStreamVersion);
+    if (!readHeader(stream, m_dataFileName, baseCount)) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Ignoring operation journal"
+            << file.fileName() << "as it does not belong to" << m_dataFileName;
+        return baseCount;
+    }
+
+    quint32 nextId = baseCount;
+    while (!stream.atEnd()) {
+        QByteArray session;
+        if (!readSession(stream, &session)) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "Ignoring incomplete session at the"
+                " end of operation journal" << file.fileName();
+            break;
+        }
+
+        QDataStream sessionStream(session);
+        sessionStream.setVersion(scStreamVersion);
+        QVector<quint32> removed;
+        sessionStream >> removed;
+        QList<OperationBlob> added;
+        try {
+            OperationLog::read(sessionStream, &added);
+        } catch (const Error &error) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "Ignoring session of operation"
+                " journal" << file.fileName() << ":" << error.message();
+            break;
+        }
+
+        if (!removed.isEmpty()) {
+            const QSet<quint32> removedIds(removed.constBegin(), removed.constEnd());
+            for (int i = ids->size() - 1; i >= 0; --i) {
+                if (removedIds.contains(ids->at(i))) {
+                    ids->remove(i);
+                    operations->removeAt(i);
+                }
+            }
+        }
+        foreach (const OperationBlob &operation, added) {
+            operations->append(operation);
+            ids->append(nextId++);
+        }
+    }
+    return nextId;
+}
+
+/*!
+    Appends a session to the journal, removing the operations with the identifiers \a removed
+    and adding the operations \a added. \a baseCount is the number of operations stored in the
+    data file. Creates the journal if it does not exist or belongs to another data file, and
+    drops a previous session that was not completely written. Throws Error on failure.
+*/
+void OperationJournal::append(quint32 baseCount, const QVector<quint32> &removed,
+    const OperationList &added)
+{
+    QByteArray session;
+    {
+        QDataStream stream(&session, QIODevice::WriteOnly);
+        stream.setVersion(scStreamVersion);
+        stream << removed;
+        OperationLog::write(stream, added);
+    }
+
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadWrite)) {
+        throw Error(QCoreApplication::translate("OperationJournal",
+            "Cannot open operation journal \"%1\": %2").arg(file.fileName(), file.errorString()));
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(scStreamVersion);
+    qint64 end = 0;
+    if (file.size() > 0 && readHeader(stream, m_dataFileName, baseCount)) {
+        end = file.pos();
+        QByteArray existing;
+        while (!stream.atEnd() && readSession(stream, &existing))
+            end = file.pos();
+    }
+
+    stream.resetStatus();
+    if (!file.resize(end) || !file.seek(end)) {
+        throw Error(QCoreApplication::translate("OperationJournal",
+            "Cannot write operation journal \"%1\": %2").arg(file.fileName(), file.errorString()));
+    }
+    if (end == 0) {
+        stream << scJournalMagic << quint32(Version) << QFileInfo(m_dataFileName).size()
+            << baseCount;
+    }
+    stream << session << checksum(session);
+
+    if (stream.status() != QDataStream::Ok || !file.flush()) {
+        throw Error(QCoreApplication::translate("OperationJournal",
+            "Cannot write operation journal \"%1\": %2").arg(file.fileName(), file.errorString()));
+    }
+}
+
+/*!
+    Removes the journal. Returns \c true if it does not exist anymore.
+*/
+bool OperationJournal::remove()
+{
+    QFile file(fileName());
+    if (!file.exists() || file.remove())
+        return true;
+
+    qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot remove operation journal"
+        << file.fileName() << ":" << file.errorString();
+    return false;
+}
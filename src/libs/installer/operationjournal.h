@@ -0,0 +1,64 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef OPERATIONJOURNAL_H
+#define OPERATIONJOURNAL_H
+
+#include "qinstallerglobal.h"
+
+#include <QtCore/QVector>
+
+namespace QInstaller {
+
+struct OperationBlob;
+
+class INSTALLER_EXPORT OperationJournal
+{
+public:
+    enum {
+        Version = 1,
+        MinimumCompactionSize = 1024 * 1024
+    };
+
+    explicit OperationJournal(const QString &dataFileName);
+
+    QString fileName() const;
+    qint64 size() const;
+    bool needsCompaction(qint64 operationsSize) const;
+
+    quint32 replay(QList<OperationBlob> *operations, QVector<quint32> *ids) const;
+    void append(quint32 baseCount, const QVector<quint32> &removed, const OperationList &added);
+    bool remove();
+
+private:
+    QString m_dataFileName;
+};
+
+} // namespace QInstaller
+
+#endif // OPERATIONJOURNAL_H
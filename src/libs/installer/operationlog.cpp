@@ -0,0 +1,254 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "operationlog.h"
+
+#include "binaryformat.h"
+#include "errors.h"
+#include "fileio.h"
+#include "globals.h"
+#include "updateoperationfactory.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QHash>
+#include <QScopedPointer>
+
+using namespace QInstaller;
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::OperationLog
+    \internal
+    \brief The OperationLog class reads and writes the performed operations in a compact
+        binary form.
+
+    The maintenance tool stores all operations performed by the installation, which can be
+    hundreds of thousands. Previously each of them was stored as an XML document that had to
+    be parsed when starting the maintenance tool. The operation log stores them as binary
+    records instead:
+
+    \list
+        \li The marker \c Marker, which distinguishes the log from the XML based format
+            starting with the number of operations.
+        \li The format version.
+        \li A table of interned strings, holding operation names, component names, and value
+            names.
+        \li For each operation its name and component as indexes into the string table, and
+            its binary record with the arguments and the values. The values are written as
+            QVariant with QDataStream, so they keep their type and are read back without any
+            conversion from text.
+        \li The number of operations, as in the XML based format.
+    \endlist
+
+    Reading the log only splits it into OperationBlob instances. The operations are created
+    from them with create() when they are actually needed.
+*/
+
+/*!
+    \enum QInstaller::OperationLog::anonymous
+
+    \value Marker
+           Written instead of the number of operations at the start of the log.
+    \value Version
+           The current version of the log format.
+*/
+
+namespace {
+
+const QDataStream::Version scStreamVersion = QDataStream::Qt_5_15;
+
+} // namespace
+
+/*!
+    Writes \a operations to \a out. Only the values of an operation that it considers
+    persistent are written, the same as in its XML representation. Throws Error on failure.
+*/
+void OperationLog::write(QFileDevice *out, const OperationList &operations)
+{
+    QInstaller::appendInt64(out, Marker);
+    QDataStream stream(out);
+    write(stream, operations);
+    if (stream.status() != QDataStream::Ok) {
+        throw Error(QCoreApplication::translate("OperationLog",
+            "Cannot write operations to %1: %2").arg(out->fileName(), out->errorString()));
+    }
+    QInstaller::appendInt64(out, operations.count());
+}
+
+/*!
+    \overload
+
+    Writes the version, string table, and records of \a operations to \a stream, without the
+    marker and the trailing number of operations. The version of \a stream is set to the one
+    used by the log. Check the status of \a stream for errors.
+*/
+void OperationLog::write(QDataStream &stream, const OperationList &operations)
+{
+    QStringList strings;
+    QHash<QString, quint32> indexes;
+    const auto intern = [&strings, &indexes](const QString &string) -> quint32 {
+        auto it = indexes.constFind(string);
+        if (it == indexes.constEnd()) {
+            it = indexes.insert(string, quint32(strings.size()));
+            strings.append(string);
+        }
+        return it.value();
+    };
+
+    QByteArray records;
+    QDataStream recordStream(&records, QIODevice::WriteOnly);
+    recordStream.setVersion(scStreamVersion);
+    foreach (Operation *operation, operations) {
+        const QVariantMap values = operation->relocatableValues();
+
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream.setVersion(scStreamVersion);
+        stream << operation->relocatableArguments() << quint32(values.count());
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+            stream << intern(it.key()) << it.value();
+
+        recordStream << intern(operation->name())
+            << intern(operation->value(QLatin1String("component")).toString()) << record;
+
+        // for the ui not to get blocked
+        qApp->processEvents();
+    }
+
+    stream.setVersion(scStreamVersion);
+    stream << quint32(Version) << strings << quint32(operations.count());
+    stream.writeRawData(records.constData(), records.size());
+}
+
+/*!
+    Reads the operations of a log written by write() from \a in and appends them to
+    \a operations. Expects the marker to be consumed already. Throws Error on failure.
+
+    The operations are not created, only their records are read.
+*/
+void OperationLog::read(QFileDevice *in, QList<OperationBlob> *operations)
+{
+    QDataStream stream(in);
+    try {
+        read(stream, operations);
+    } catch (const Error &error) {
+        throw Error(QCoreApplication::translate("OperationLog",
+            "Cannot read operations from %1: %2").arg(in->fileName(), error.message()));
+    }
+}
+
+/*!
+    \overload
+
+    Reads operations written by write() from \a stream and appends them to \a operations.
+    The version of \a stream is set to the one used by the log. Throws Error on failure.
+*/
+void OperationLog::read(QDataStream &stream, QList<OperationBlob> *operations)
+{
+    stream.setVersion(scStreamVersion);
+
+    quint32 version = 0;
+    stream >> version;
+    if (version != Version) {
+        throw Error(QCoreApplication::translate("OperationLog",
+            "Unsupported operation log version %1.").arg(version));
+    }
+
+    QStringList strings;
+    quint32 count = 0;
+    stream >> strings >> count;
+    const int start = operations->size();
+    operations->reserve(start + int(count));
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        quint32 name = 0;
+        quint32 component = 0;
+        QByteArray record;
+        stream >> name >> component >> record;
+        if (name >= quint32(strings.size()) || component >= quint32(strings.size()))
+            break;
+        operations->append(OperationBlob(strings.at(name), strings.at(component), record,
+            strings));
+    }
+
+    if (stream.status() != QDataStream::Ok || operations->size() - start < int(count)) {
+        throw Error(QCoreApplication::translate("OperationLog",
+            "The operation data is corrupt."));
+    }
+}
+
+/*!
+    Creates the operation described by \a blob for \a core, from either its binary record
+    or its XML representation. Returns \c nullptr if the operation is unknown or its data
+    cannot be read.
+*/
+Operation *OperationLog::create(const OperationBlob &blob, PackageManagerCore *core)
+{
+    QScopedPointer<Operation> op(KDUpdater::UpdateOperationFactory::instance()
+        .create(blob.name, core));
+    if (op.isNull()) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Failed to load unknown operation"
+            << blob.name;
+        return nullptr;
+    }
+
+    if (blob.record.isEmpty()) {
+        if (!op->fromXml(blob.xml)) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "Failed to load XML for operation"
+                << blob.name;
+            return nullptr;
+        }
+        return op.take();
+    }
+
+    QDataStream stream(blob.record);
+    stream.setVersion(scStreamVersion);
+
+    QStringList arguments;
+    quint32 count = 0;
+    stream >> arguments >> count;
+    QVariantMap values;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        quint32 name = 0;
+        QVariant value;
+        stream >> name >> value;
+        if (name >= quint32(blob.strings.size())) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        values.insert(blob.strings.at(name), value);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "Failed to load data for operation"
+            << blob.name;
+        return nullptr;
+    }
+    op->restore(arguments, values);
+    return op.take();
+}
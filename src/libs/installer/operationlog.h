@@ -0,0 +1,58 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef OPERATIONLOG_H
+#define OPERATIONLOG_H
+
+#include "qinstallerglobal.h"
+
+QT_FORWARD_DECLARE_CLASS(QDataStream)
+QT_FORWARD_DECLARE_CLASS(QFileDevice)
+
+namespace QInstaller {
+
+struct OperationBlob;
+
+class INSTALLER_EXPORT OperationLog
+{
+public:
+    enum {
+        Marker = -1,
+        Version = 2
+    };
+
+    static void write(QFileDevice *out, const OperationList &operations);
+    static void write(QDataStream &stream, const OperationList &operations);
+    static void read(QFileDevice *in, QList<OperationBlob> *operations);
+    static void read(QDataStream &stream, QList<OperationBlob> *operations);
+    static Operation *create(const OperationBlob &blob, PackageManagerCore *core);
+};
+
+} // namespace QInstaller
+
+#endif // OPERATIONLOG_H
@@ -71,6 +71,9 @@ AbstractOperationTracer::AbstractOperationTracer(Operation *operation)
     \class QInstaller::OperationTracer
     \brief The OperationTracer prints trace output for starting of operations
            and automatically indicates finish on destruction.
+
+    If the TraceLog is enabled, the time between trace() and destruction is
+    also recorded as a span.
 */
 
 /*!
@@ -100,6 +103,11 @@ void OperationTracer::trace(const QString &state)
     if (!m_operation)
         return;
 
+    if (TraceLog::instance().isEnabled()) {
+        m_span.reset(new TraceSpan(TraceLog::Operation, state, m_operation
+            ->value(QLatin1String("component")).toString() + QLatin1Char(' ') + m_operation->name()));
+    }
+
     qCDebug(lcInstallerInstallLog).noquote() << QString::fromLatin1("%1 %2 operation: %3")
         .arg(state, m_operation->value(QLatin1String("component")).toString(), m_operation->name());
 
@@ -31,6 +31,9 @@
 
 #include "qinstallerglobal.h"
 #include "globals.h"
+#include "tracelog.h"
+
+#include <QScopedPointer>
 
 namespace QInstaller {
 
@@ -53,6 +56,9 @@ public:
     ~OperationTracer() override;
 
     void trace(const QString &state) override;
+
+private:
+    QScopedPointer<TraceSpan> m_span;
 };
 
 class INSTALLER_EXPORT ConcurrentOperationTracer : public AbstractOperationTracer
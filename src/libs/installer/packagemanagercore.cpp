@@ -29,11 +29,13 @@
 #include "packagemanagercore_p.h"
 
 #include "adminauthorization.h"
+#include "archivecache.h"
 #include "binarycontent.h"
 #include "component.h"
 #include "componentmodel.h"
 #include "downloadarchivesjob.h"
 #include "errors.h"
+#include "fileutils.h"
 #include "globals.h"
 #include "messageboxhandler.h"
 #include "packagemanagerproxyfactory.h"
@@ -51,6 +53,7 @@
 
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 
 #include <QtCore/QMutex>
@@ -460,6 +463,38 @@ static bool sVirtualComponentsVisible = false;
 static bool sCreateLocalRepositoryFromBinary = false;
 static int sMaxConcurrentOperations = 0;
 
+/*
+    Reads the files referenced by the valid \a packages for \a core concurrently, so that the
+    components only need to be created from them afterwards. Throws Error if a file cannot be
+    read.
+*/
+static QHash<const Package *, Component::PackageFiles> readPackageFiles(PackageManagerCore *core,
+    const PackagesList &packages)
+{
+    QList<const Package *> validPackages;
+    foreach (Package *const package, packages) {
+        if (ProductKeyCheck::instance()->isValidPackage(package->data(scName).toString()))
+            validPackages.append(package);
+    }
+
+    const auto read = [core](const Package *package) {
+        return Component::readPackageFiles(core, *package);
+    };
+    QList<Component::PackageFiles> files;
+    if (validPackages.count() > 1 && QInstaller::canWalkConcurrently()) {
+        files = QtConcurrent::blockingMapped<QList<Component::PackageFiles> >(validPackages, read);
+    } else {
+        foreach (const Package *package, validPackages)
+            files.append(read(package));
+    }
+
+    QHash<const Package *, Component::PackageFiles> result;
+    result.reserve(validPackages.count());
+    for (int i = 0; i < validPackages.count(); ++i)
+        result.insert(validPackages.at(i), files.at(i));
+    return result;
+}
+
 static bool componentMatches(const Component *component, const QString &name,
     const QString &version = QString())
 {
@@ -485,7 +520,7 @@ void PackageManagerCore::writeMaintenanceTool()
 
     if (d->m_needToWriteMaintenanceTool) {
         try {
-            d->writeMaintenanceTool(d->m_performedOperationsOld + d->m_performedOperationsCurrentSession);
+            d->writeMaintenanceTool(d->performedOperationsOld() + d->m_performedOperationsCurrentSession);
 
             bool gainedAdminRights = false;
             if (!directoryWritable(d->targetDir())) {
@@ -584,12 +619,22 @@ bool PackageManagerCore::resetLocalCache(bool init)
 }
 
 /*!
-    Clears the contents of the cache used to store downloaded metadata.
-    Returns \c true on success, \c false otherwise. An error string can
-    be retrieved with \a error.
+    Clears the contents of the cache used to store downloaded metadata, and
+    the archive cache if one exists. Returns \c true on success, \c false
+    otherwise. An error string can be retrieved with \a error.
 */
 bool PackageManagerCore::clearLocalCache(QString *error)
 {
+    const QString archiveCachePath = ArchiveCache::archiveCachePath(settings().localCachePath());
+    if (QFileInfo::exists(archiveCachePath)) {
+        ArchiveCache archiveCache(archiveCachePath);
+        if (!archiveCache.isValid() || !archiveCache.clear()) {
+            if (error)
+                *error = archiveCache.errorString();
+            return false;
+        }
+    }
+
     if (d->m_metadataJob.clearCache())
         return true;
 
@@ -823,11 +868,19 @@ int PackageManagerCore::downloadNeededArchives(double partProgressSize)
         // collect all archives to be downloaded
         const QStringList toDownload = component->downloadableArchives();
         bool checkSha1CheckSum = (component->value(scCheckSha1CheckSum).toLower() == scTrue);
+        const QStringList manifests = component->value(scArchiveManifests)
+            .split(QInstaller::commaRegExp(), Qt::SkipEmptyParts);
         foreach (const QString &versionFreeString, toDownload) {
             DownloadItem item;
             item.checkSha1CheckSum = checkSha1CheckSum;
+            item.hasManifest = manifests.contains(versionFreeString);
             item.fileName = scInstallerPrefixWithTwoArgs.arg(component->name(), versionFreeString);
             item.sourceUrl = QLatin1String("%1/%2").arg(component->repositoryUrl().toString(), versionFreeString);
+            const QHash<QByteArray, QString> deltas = component->deltaArchives(versionFreeString);
+            for (auto it = deltas.constBegin(); it != deltas.constEnd(); ++it) {
+                item.deltaUrls.insert(it.key(), QLatin1String("%1/%2")
+                    .arg(component->repositoryUrl().toString(), it.value()));
+            }
             archivesToDownload.push_back(item);
         }
         archivesToDownloadTotalSize += component->value(scCompressedSize).toULongLong();
@@ -1305,11 +1358,7 @@ PackageManagerCore::PackageManagerCore(qint64 magicmaker, const QList<OperationB
     //
     const QStringList localPackageList = d->m_core->localInstalledPackages().keys();
     QSet<QString> installedPackages(localPackageList.begin(), localPackageList.end());
-    QSet<QString> operationPackages;
-    foreach (QInstaller::Operation *operation, d->m_performedOperationsOld) {
-        if (operation->hasValue(QLatin1String("component")))
-            operationPackages.insert(operation->value(QLatin1String("component")).toString());
-    }
+    const QSet<QString> operationPackages = d->performedOperationComponents();
 
     QSet<QString> packagesWithoutOperation = installedPackages - operationPackages;
     QSet<QString> orphanedOperations = operationPackages - installedPackages;
@@ -2494,6 +2543,9 @@ ComponentModel *PackageManagerCore::updaterComponentModel() const
     hash containing package information elements and regular expressions
     can be used to further filter listed packages.
 
+    Packages are searched from the repository metadata only, no components are
+    created and no component scripts are loaded.
+
     \sa setVirtualComponentsVisible()
 */
 void PackageManagerCore::listAvailablePackages(const QString &regexp, const QHash<QString, QString> &filters)
@@ -2502,42 +2554,19 @@ void PackageManagerCore::listAvailablePackages(const QString &regexp, const QHas
     qCDebug(QInstaller::lcInstallerInstallLog)
         << "Searching packages with regular expression:" << regexp;
 
-    ComponentModel *model = defaultComponentModel();
     d->fetchMetaInformationFromRepositories();
-
     d->addUpdateResourcesFromRepositories();
-    QRegularExpression re(regexp);
-    re.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-    const PackagesList &packages = d->remotePackages();
-    if (!fetchAllPackages(packages, LocalPackagesMap())) {
+
+    bool ok = false;
+    const PackageSearchIndex &index = d->packageSearchIndex(&ok);
+    if (!ok) {
         qCWarning(QInstaller::lcInstallerInstallLog)
             << "There was a problem with loading the package data.";
         return;
     }
 
-    PackagesList matchedPackages;
-    foreach (Package *package, packages) {
-        const QString name = package->data(scName).toString();
-        Component *component = componentByName(name);
-        if (!component)
-            continue;
-
-        const QModelIndex &idx = model->indexFromComponentName(component->treeName());
-        if (idx.isValid() && re.match(name).hasMatch()) {
-            bool ignoreComponent = false;
-            for (auto &key : filters.keys()) {
-                const QString elementValue = component->value(key);
-                QRegularExpression elementRegexp(filters.value(key));
-                elementRegexp.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-                if (elementValue.isEmpty() || !elementRegexp.match(elementValue).hasMatch()) {
-                    ignoreComponent = true;
-                    break;
-                }
-            }
-            if (!ignoreComponent)
-                matchedPackages.append(package);
-        }
-    }
+    const QList<PackageSearchIndex::Entry> matchedPackages
+        = index.search(regexp, filters, virtualComponentsVisible());
     if (matchedPackages.count() == 0)
         qCDebug(QInstaller::lcInstallerInstallLog) << "No matching packages found.";
     else
@@ -3993,12 +4022,11 @@ bool PackageManagerCore::updateComponentData(struct Data &data, Component *compo
         if (settings().allowUnstableComponents()) {
             // Check if there are sha checksum mismatch. Component will still show in install tree
             // but is unselectable.
-            foreach (const QString pkgName, d->m_metadataJob.shaMismatchPackages()) {
-                if (pkgName == component->name()) {
-                    const QString errorString = QLatin1String("SHA mismatch detected for component ") + pkgName;
-                    d->m_pendingUnstableComponents.insert(component->name(),
-                        QPair<Component::UnstableError, QString>(Component::ShaMismatch, errorString));
-                }
+            if (d->m_metadataJob.shaMismatchPackages().contains(component->name())) {
+                const QString errorString = QLatin1String("SHA mismatch detected for component ")
+                    + component->name();
+                d->m_pendingUnstableComponents.insert(component->name(),
+                    QPair<Component::UnstableError, QString>(Component::ShaMismatch, errorString));
             }
         }
 
@@ -4126,6 +4154,11 @@ bool PackageManagerCore::fetchAllPackages(const PackagesList &remotes, const Loc
         QMap<QString, QString> remoteTreeNameComponents;
         QMap<QString, QString> allTreeNameComponents;
 
+        // Read the license and translation files of all packages concurrently, creating and
+        // linking the components is still done in order, so the tree does not change.
+        const QHash<const Package *, Component::PackageFiles> packageFiles
+            = readPackageFiles(this, remotes);
+
         std::function<bool(PackagesList *, bool)> loadRemotePackages;
         loadRemotePackages = [&](PackagesList *treeNamePackages, bool firstRun) -> bool {
             foreach (Package *const package, (firstRun ? remotes : *treeNamePackages)) {
@@ -4144,7 +4177,7 @@ bool PackageManagerCore::fetchAllPackages(const PackagesList &remotes, const Loc
 
                 QScopedPointer<QInstaller::Component> remoteComponent(new QInstaller::Component(this));
                 data.package = package;
-                remoteComponent->loadDataFromPackage(*package);
+                remoteComponent->loadDataFromPackage(*package, packageFiles.value(package));
                 if (updateComponentData(data, remoteComponent.data())) {
                     // Create a list where is name and treename. Repo can contain a package with
                     // a different treename of component which is already installed. We don't want
@@ -4275,6 +4308,9 @@ bool PackageManagerCore::fetchUpdaterPackages(const PackagesList &remotes, const
         LocalPackagesMap installedPackages = locals;
         QStringList replaceMes;
 
+        const QHash<const Package *, Component::PackageFiles> packageFiles
+            = readPackageFiles(this, remotes);
+
         foreach (Package *const update, remotes) {
             if (d->statusCanceledOrFailed())
                 return false;
@@ -4284,7 +4320,7 @@ bool PackageManagerCore::fetchUpdaterPackages(const PackagesList &remotes, const
 
             QScopedPointer<QInstaller::Component> component(new QInstaller::Component(this));
             data.package = update;
-            component->loadDataFromPackage(*update);
+            component->loadDataFromPackage(*update, packageFiles.value(update));
             if (updateComponentData(data, component.data())) {
                 // Keep a reference so we can resolve dependencies during update.
                 d->m_updaterComponentsDeps.append(component.take());
@@ -111,6 +111,8 @@ public:
         QString fileName;
         QString sourceUrl;
         bool checkSha1CheckSum;
+        bool hasManifest;
+        QHash<QByteArray, QString> deltaUrls;
     };
 
     Q_DECLARE_FLAGS(ComponentTypes, ComponentType)
@@ -40,6 +40,7 @@
 #include "messageboxhandler.h"
 #include "packagemanagercore.h"
 #include "progresscoordinator.h"
+#include "relocationstage.h"
 #include "qprocesswrapper.h"
 #include "protocol.h"
 #include "qsettingswrapper.h"
@@ -50,8 +51,12 @@
 #include "binarycreator.h"
 #include "loggingutils.h"
 #include "concurrentoperationrunner.h"
+#include "deletionservice.h"
+#include "operationjournal.h"
+#include "operationlog.h"
 #include "remoteclient.h"
 #include "operationtracer.h"
+#include "tracelog.h"
 
 #include "selfrestarter.h"
 #include "filedownloaderfactory.h"
@@ -163,6 +168,8 @@ PackageManagerCorePrivate::PackageManagerCorePrivate(PackageManagerCore *core)
     , m_launchedAsRoot(AdminAuthorization::hasAdminRights())
     , m_completeUninstall(false)
     , m_needToWriteMaintenanceTool(false)
+    , m_storedOperationBaseCount(0)
+    , m_nextOperationId(0)
     , m_dependsOnLocalInstallerBinary(false)
     , m_core(core)
     , m_updates(false)
@@ -227,22 +234,19 @@ PackageManagerCorePrivate::PackageManagerCorePrivate(PackageManagerCore *core, q
     , m_autoConfirmCommand(false)
     , m_datFileName(datFileName)
 {
-    foreach (const OperationBlob &operation, performedOperations) {
-        QScopedPointer<QInstaller::Operation> op(KDUpdater::UpdateOperationFactory::instance()
-            .create(operation.name, core));
-        if (op.isNull()) {
-            qCWarning(QInstaller::lcInstallerInstallLog) << "Failed to load unknown operation"
-                << operation.name;
-            continue;
-        }
-
-        if (!op->fromXml(operation.xml)) {
-            qCWarning(QInstaller::lcInstallerInstallLog) << "Failed to load XML for operation"
-                << operation.name;
-            continue;
-        }
-        m_performedOperationsOld.append(op.take());
+    // The operations are only created when needed, see performedOperationsOld().
+    m_pendingOperations = performedOperations;
+    m_storedOperationBaseCount = quint32(m_pendingOperations.count());
+    if (m_datFileName.isEmpty()) {
+        m_nextOperationId = m_storedOperationBaseCount;
+        for (quint32 id = 0; id < m_nextOperationId; ++id)
+            m_pendingOperationIds.append(id);
+    } else {
+        m_nextOperationId = OperationJournal(m_datFileName).replay(&m_pendingOperations,
+            &m_pendingOperationIds);
     }
+    m_storedOperationIds = QSet<quint32>(m_pendingOperationIds.constBegin(),
+        m_pendingOperationIds.constEnd());
 
     connect(this, &PackageManagerCorePrivate::installationStarted,
             m_core, &PackageManagerCore::installationStarted);
@@ -817,6 +821,19 @@ QString PackageManagerCorePrivate::datFileName()
     return m_datFileName;
 }
 
+/*
+    Returns the file name of \a archive without the component \a version it contains,
+    so that the archives of different versions of a component can be matched.
+*/
+static QString versionFreeArchiveName(const QString &archive, const QString &version)
+{
+    QString name = QFileInfo(archive).fileName();
+    const int index = version.isEmpty() ? -1 : name.indexOf(version);
+    if (index >= 0)
+        name.remove(index, version.length());
+    return name;
+}
+
 static QNetworkProxy readProxy(QXmlStreamReader &reader)
 {
     QNetworkProxy proxy(QNetworkProxy::HttpProxy);
@@ -1234,15 +1251,7 @@ void PackageManagerCorePrivate::writeMaintenanceToolBinaryData(QFileDevice *outp
     }
 
     const qint64 operationsStart = output->pos();
-    QInstaller::appendInt64(output, performedOperations.count());
-    foreach (Operation *operation, performedOperations) {
-        QInstaller::appendString(output, operation->name());
-        QInstaller::appendString(output, operation->toXml().toString());
-
-        // for the ui not to get blocked
-        qApp->processEvents();
-    }
-    QInstaller::appendInt64(output, performedOperations.count());
+    OperationLog::write(output, performedOperations);
     const qint64 operationsEnd = output->pos();
 
     // we don't save any component-indexes.
@@ -1352,6 +1361,72 @@ void PackageManagerCorePrivate::writeMaintenanceToolAppBundle(OperationList &per
 #endif
 }
 
+/*
+    Appends the changes of \a performedOperations since the maintenance tool data file was
+    written to the operation journal of the data file. Returns \c false if the data file needs
+    to be rewritten instead, because the journal needs to be compacted into the operations
+    segment of \a layout or cannot be written.
+*/
+bool PackageManagerCorePrivate::appendToOperationJournal(const OperationList &performedOperations,
+    const BinaryLayout &layout)
+{
+    OperationJournal journal(datFileName());
+    if (journal.needsCompaction(layout.operationsSegment.length())) {
+        qCDebug(QInstaller::lcInstallerInstallLog) << "Compacting operation journal"
+            << journal.fileName();
+        return false;
+    }
+
+    QSet<quint32> removed = m_storedOperationIds;
+    OperationList added;
+    foreach (Operation *operation, performedOperations) {
+        const auto it = m_operationIds.constFind(operation);
+        if (it == m_operationIds.constEnd())
+            added.append(operation);
+        else
+            removed.remove(it.value());
+    }
+    if (removed.isEmpty() && added.isEmpty())
+        return true;
+
+    QVector<quint32> removedIds(removed.constBegin(), removed.constEnd());
+    std::sort(removedIds.begin(), removedIds.end());
+    try {
+        journal.append(m_storedOperationBaseCount, removedIds, added);
+    } catch (const Error &error) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << error.message();
+        return false;
+    }
+    qCDebug(QInstaller::lcInstallerInstallLog) << "Appended" << added.count() << "and removed"
+        << removedIds.count() << "operations in operation journal" << journal.fileName();
+
+    m_storedOperationIds.subtract(removed);
+    foreach (Operation *operation, added) {
+        m_operationIds.insert(operation, m_nextOperationId);
+        m_storedOperationIds.insert(m_nextOperationId++);
+    }
+    // the appended operations are not sorted into the stored ones
+    if (!added.isEmpty())
+        m_core->setValue(QLatin1String("installedOperationAreSorted"), QLatin1String("false"));
+    return true;
+}
+
+/*
+    Assigns the identifiers of the operation journal to \a performedOperations after they
+    were written to a new maintenance tool data file.
+*/
+void PackageManagerCorePrivate::resetStoredOperations(const OperationList &performedOperations)
+{
+    m_operationIds.clear();
+    m_storedOperationIds.clear();
+    m_storedOperationBaseCount = quint32(performedOperations.count());
+    for (quint32 id = 0; id < m_storedOperationBaseCount; ++id) {
+        m_operationIds.insert(performedOperations.at(int(id)), id);
+        m_storedOperationIds.insert(id);
+    }
+    m_nextOperationId = m_storedOperationBaseCount;
+}
+
 void PackageManagerCorePrivate::writeMaintenanceTool(OperationList performedOperations)
 {
     if (m_disableWriteMaintenanceTool) {
@@ -1359,6 +1434,9 @@ void PackageManagerCorePrivate::writeMaintenanceTool(OperationList performedOper
         return;
     }
 
+    TraceSpan span(TraceLog::MaintenanceTool, QLatin1String("write maintenance tool"),
+        QString::number(performedOperations.count()));
+
     bool gainedAdminRights = false;
     if (!directoryWritable(targetDir())) {
         m_core->gainAdminRights();
@@ -1463,6 +1541,7 @@ void PackageManagerCorePrivate::writeMaintenanceTool(OperationList performedOper
 
         QFile input;
         BinaryLayout layout;
+        bool inputIsDataFile = false;
         const QString dataFile = datFileName();
         try {
             if (isInstaller()) {
@@ -1476,6 +1555,7 @@ void PackageManagerCorePrivate::writeMaintenanceTool(OperationList performedOper
             input.setFileName(dataFile);
             QInstaller::openForRead(&input);
             layout = BinaryContent::binaryLayout(&input, BinaryContent::MagicCookieDat);
+            inputIsDataFile = true;
         } catch (const Error &/*error*/) {
             // We are only here when using installer
             QString binaryName = installerBinaryPath();
@@ -1505,41 +1585,48 @@ void PackageManagerCorePrivate::writeMaintenanceTool(OperationList performedOper
             }
         }
 
-        performedOperations = sortOperationsBasedOnComponentDependencies(performedOperations);
-        m_core->setValue(QLatin1String("installedOperationAreSorted"), QLatin1String("true"));
-
-        try {
-            QFile file(generateTemporaryFileName());
-            QInstaller::openForWrite(&file);
-            writeMaintenanceToolBinaryData(&file, &input, performedOperations, layout);
-            QInstaller::appendInt64(&file, BinaryContent::MagicCookieDat);
+        // If neither the binary nor the resources change, only the changes of the performed
+        // operations need to be written, as a new session of the operation journal.
+        const bool journaled = inputIsDataFile && !newBinaryWritten
+            && m_core->value(QLatin1String("DefaultResourceReplacement")).isEmpty()
+            && appendToOperationJournal(performedOperations, layout);
+        if (!journaled) {
+            performedOperations = sortOperationsBasedOnComponentDependencies(performedOperations);
+            m_core->setValue(QLatin1String("installedOperationAreSorted"), QLatin1String("true"));
+
+            try {
+                QFile file(generateTemporaryFileName());
+                QInstaller::openForWrite(&file);
+                writeMaintenanceToolBinaryData(&file, &input, performedOperations, layout);
+                QInstaller::appendInt64(&file, BinaryContent::MagicCookieDat);
+
+                QFile dummy(dataFile + QLatin1String(".new"));
+                if (dummy.exists() && !dummy.remove()) {
+                    throw Error(tr("Cannot remove data file \"%1\": %2").arg(dummy.fileName(),
+                        dummy.errorString()));
+                }
 
-            QFile dummy(dataFile + QLatin1String(".new"));
-            if (dummy.exists() && !dummy.remove()) {
-                throw Error(tr("Cannot remove data file \"%1\": %2").arg(dummy.fileName(),
-                    dummy.errorString()));
-            }
+                if (!file.rename(dataFile + QLatin1String(".new"))) {
+                    throw Error(tr("Cannot write maintenance tool binary data to %1: %2")
+                        .arg(file.fileName(), file.errorString()));
+                }
+                setDefaultFilePermissions(&file, DefaultFilePermissions::NonExecutable);
+            } catch (const Error &/*error*/) {
+                if (!newBinaryWritten) {
+                    newBinaryWritten = true;
+                    QFile tmp(isInstaller() ? installerBinaryPath() : maintenanceToolName());
+                    QInstaller::openForRead(&tmp);
+                    BinaryLayout tmpLayout = BinaryContent::binaryLayout(&tmp, BinaryContent::MagicCookie);
+                    writeMaintenanceToolBinary(&tmp, tmpLayout.endOfBinaryContent
+                        - tmpLayout.binaryContentSize, false);
+                }
 
-            if (!file.rename(dataFile + QLatin1String(".new"))) {
-                throw Error(tr("Cannot write maintenance tool binary data to %1: %2")
-                    .arg(file.fileName(), file.errorString()));
-            }
-            setDefaultFilePermissions(&file, DefaultFilePermissions::NonExecutable);
-        } catch (const Error &/*error*/) {
-            if (!newBinaryWritten) {
-                newBinaryWritten = true;
-                QFile tmp(isInstaller() ? installerBinaryPath() : maintenanceToolName());
-                QInstaller::openForRead(&tmp);
-                BinaryLayout tmpLayout = BinaryContent::binaryLayout(&tmp, BinaryContent::MagicCookie);
-                writeMaintenanceToolBinary(&tmp, tmpLayout.endOfBinaryContent
-                    - tmpLayout.binaryContentSize, false);
+                QFile file(maintenanceToolName() + QLatin1String(".new"));
+                QInstaller::openForAppend(&file);
+                file.seek(file.size());
+                writeMaintenanceToolBinaryData(&file, &input, performedOperations, layout);
+                QInstaller::appendInt64(&file, BinaryContent::MagicCookie);
             }
-
-            QFile file(maintenanceToolName() + QLatin1String(".new"));
-            QInstaller::openForAppend(&file);
-            file.seek(file.size());
-            writeMaintenanceToolBinaryData(&file, &input, performedOperations, layout);
-            QInstaller::appendInt64(&file, BinaryContent::MagicCookie);
         }
         input.close();
         if (m_core->isInstaller())
@@ -1558,10 +1645,15 @@ void PackageManagerCorePrivate::writeMaintenanceTool(OperationList performedOper
 #endif
         writeMaintenanceConfigFiles();
 
-        QFile::remove(dataFile);
-        QFileInfo fi(mtName);
-        //Rename the dat file according to maintenancetool name
-        QFile::rename(dataFile + QLatin1String(".new"), targetDir() + QLatin1Char('/') + fi.baseName() + QLatin1String(".dat"));
+        if (!journaled) {
+            // the journal belongs to the old data file and is compacted into the new one
+            OperationJournal(dataFile).remove();
+            QFile::remove(dataFile);
+            QFileInfo fi(mtName);
+            //Rename the dat file according to maintenancetool name
+            QFile::rename(dataFile + QLatin1String(".new"), targetDir() + QLatin1Char('/') + fi.baseName() + QLatin1String(".dat"));
+            resetStoredOperations(performedOperations);
+        }
 
         const bool restart = !statusCanceledOrFailed() && m_needsHardRestart;
         qCDebug(QInstaller::lcInstallerInstallLog) << "Maintenance tool hard restart:"
@@ -1874,6 +1966,42 @@ bool PackageManagerCorePrivate::runInstaller()
     return true;
 }
 
+/*
+    Lets the Extract operations in \a undoOperations keep the installed files that a pending
+    Extract operation of the same component in \a components extracts again from the same
+    archive into the same target directory. The manifest of the pending archive decides which
+    files are kept, the pending operation skips or overwrites all of them. Only components
+    whose repository provides archive manifests create their operations this early.
+*/
+void PackageManagerCorePrivate::keepFilesForUpdatedExtracts(const OperationList &undoOperations,
+    const QList<Component *> &components)
+{
+    foreach (Operation *operation, undoOperations) {
+        if (operation->name() != scExtract || operation->arguments().count() != 2)
+            continue;
+
+        Component *component = m_core->componentByName(PackageManagerCore::checkableName(operation
+            ->value(QLatin1String("component")).toString()));
+        if (!component || !components.contains(component)
+                || component->value(scArchiveManifests).isEmpty()) {
+            continue;
+        }
+
+        const QString archive = versionFreeArchiveName(operation->arguments().at(0),
+            component->value(scInstalledVersion));
+        const QString targetDir = QDir::cleanPath(operation->arguments().at(1));
+        foreach (Operation *pending, component->operations(Operation::Unpack)) {
+            if (pending->name() != scExtract || pending->arguments().count() != 2)
+                continue;
+            if (versionFreeArchiveName(pending->arguments().at(0), component->value(scVersion)) == archive
+                    && QDir::cleanPath(pending->arguments().at(1)) == targetDir) {
+                operation->setValue(QLatin1String("keepUnchangedFiles"), pending->arguments().at(0));
+                break;
+            }
+        }
+    }
+}
+
 bool PackageManagerCorePrivate::runPackageUpdater()
 {
     bool adminRightsGained = false;
@@ -1919,9 +2047,9 @@ bool PackageManagerCorePrivate::runPackageUpdater()
 
         // order the operations in the right component dependency order
         // next loop will save the needed operations in reverse order for uninstallation
-        OperationList performedOperationsOld = m_performedOperationsOld;
+        OperationList performedOperationsOld = this->performedOperationsOld();
         if (m_core->value(QLatin1String("installedOperationAreSorted")) != QLatin1String("true"))
-            performedOperationsOld = sortOperationsBasedOnComponentDependencies(m_performedOperationsOld);
+            performedOperationsOld = sortOperationsBasedOnComponentDependencies(performedOperationsOld);
 
         // build a list of undo operations based on the checked state of the component
         foreach (Operation *operation, performedOperationsOld) {
@@ -2003,10 +2131,14 @@ bool PackageManagerCorePrivate::runPackageUpdater()
         m_core->downloadNeededArchives(downloadPartProgressSize);
 
         if (undoOperations.count() > 0) {
+            // Files the updated components extract again are not removed, the Extract
+            // operations of the new versions skip them if their content is unchanged.
+            keepFilesForUpdatedExtracts(undoOperations, componentsToInstall);
+
             ProgressCoordinator::instance()->emitLabelAndDetailTextChanged(tr("Removing deselected components..."));
             runUndoOperations(undoOperations, undoOperationProgressSize, adminRightsGained, true);
         }
-        m_performedOperationsOld = nonRevertedOperations; // these are all operations left: those not reverted
+        this->performedOperationsOld() = nonRevertedOperations; // these are all operations left: those not reverted
 
         const double progressOperationCount = countProgressOperations(componentsToInstall);
         const double progressOperationSize = componentsInstallPartProgressSize / progressOperationCount;
@@ -2068,12 +2200,12 @@ bool PackageManagerCorePrivate::runUninstaller()
         if (!directoryWritable(targetDir()))
             adminRightsGained = m_core->gainAdminRights();
 
-        OperationList undoOperations = m_performedOperationsOld;
+        OperationList undoOperations = performedOperationsOld();
         std::reverse(undoOperations.begin(), undoOperations.end());
 
         bool updateAdminRights = false;
         if (!adminRightsGained) {
-            foreach (Operation *op, m_performedOperationsOld) {
+            foreach (Operation *op, undoOperations) {
                 updateAdminRights |= op->value(QLatin1String("admin")).toBool();
                 if (updateAdminRights)
                     break;  // an operation needs elevation to be able to perform their undo
@@ -2417,55 +2549,19 @@ void PackageManagerCorePrivate::installComponent(Component *component, double pr
         showDetailsLog = true;
     }
 
-    foreach (Operation *operation, operations) {
+    for (int i = 0; i < operations.count();) {
         if (statusCanceledOrFailed())
             throw Error(tr("Installation canceled by user"));
 
-        // maybe this operations wants us to be admin...
-        bool becameAdmin = false;
-        if (!adminRightsGained && operation->value(QLatin1String("admin")).toBool()) {
-            becameAdmin = m_core->gainAdminRights();
-            qCDebug(QInstaller::lcInstallerInstallLog) << operation->name() << "as admin:" << becameAdmin;
-        }
-
-        connectOperationToInstaller(operation, progressOperationSize);
-        connectOperationCallMethodRequest(operation);
-
-        // allow the operation to backup stuff before performing the operation
-        performOperationThreaded(operation, Operation::Backup);
-
-        bool ignoreError = false;
-        bool ok = performOperationThreaded(operation);
-        while (!ok && !ignoreError && m_core->status() != PackageManagerCore::Canceled) {
-            qCDebug(QInstaller::lcInstallerInstallLog) << QString::fromLatin1("Operation \"%1\" with arguments "
-                "\"%2\" failed: %3").arg(operation->name(), operation->arguments()
-                .join(QLatin1String("; ")), operation->errorString());
-            const QMessageBox::StandardButton button =
-                MessageBoxHandler::warning(MessageBoxHandler::currentBestSuitParent(),
-                QLatin1String("installationErrorWithCancel"), tr("Installer Error"),
-                tr("Error during installation process (%1):\n%2").arg(component->name(),
-                operation->errorString()),
-                QMessageBox::Retry | QMessageBox::Ignore | QMessageBox::Cancel, QMessageBox::Cancel);
-
-            if (button == QMessageBox::Retry)
-                ok = performOperationThreaded(operation);
-            else if (button == QMessageBox::Ignore)
-                ignoreError = true;
-            else if (button == QMessageBox::Cancel)
-                m_core->interrupt();
-        }
-
-        if (ok || operation->error() > Operation::InvalidArguments) {
-            // Remember that the operation was performed, that allows us to undo it if a following operation
-            // fails or if this operation failed but still needs an undo call to cleanup.
-            addPerformed(operation);
+        const int relocated = runRelocationStage(component, operations, i, progressOperationSize,
+            adminRightsGained);
+        if (relocated > 0) {
+            i += relocated;
+            continue;
         }
 
-        if (becameAdmin)
-            m_core->dropAdminRights();
-
-        if (!ok && !ignoreError)
-            throw Error(operation->errorString());
+        installOperation(component, operations.at(i), progressOperationSize, adminRightsGained);
+        ++i;
     }
 
     if (!m_core->isCommandLineInstance()) {
@@ -2512,6 +2608,101 @@ void PackageManagerCorePrivate::installComponent(Component *component, double pr
         ProgressCoordinator::instance()->emitDetailTextChanged(tr("Done"));
 }
 
+/*!
+    Performs the install \a operation of \a component. If the operation fails, the user
+    can retry or ignore the error, otherwise an exception is thrown.
+*/
+void PackageManagerCorePrivate::installOperation(Component *component, Operation *operation,
+    double progressOperationSize, bool adminRightsGained)
+{
+    // maybe this operations wants us to be admin...
+    bool becameAdmin = false;
+    if (!adminRightsGained && operation->value(QLatin1String("admin")).toBool()) {
+        becameAdmin = m_core->gainAdminRights();
+        qCDebug(QInstaller::lcInstallerInstallLog) << operation->name() << "as admin:" << becameAdmin;
+    }
+
+    connectOperationToInstaller(operation, progressOperationSize);
+    connectOperationCallMethodRequest(operation);
+
+    // allow the operation to backup stuff before performing the operation
+    performOperationThreaded(operation, Operation::Backup);
+
+    bool ignoreError = false;
+    bool ok = performOperationThreaded(operation);
+    while (!ok && !ignoreError && m_core->status() != PackageManagerCore::Canceled) {
+        qCDebug(QInstaller::lcInstallerInstallLog) << QString::fromLatin1("Operation \"%1\" with arguments "
+            "\"%2\" failed: %3").arg(operation->name(), operation->arguments()
+            .join(QLatin1String("; ")), operation->errorString());
+        const QMessageBox::StandardButton button =
+            MessageBoxHandler::warning(MessageBoxHandler::currentBestSuitParent(),
+            QLatin1String("installationErrorWithCancel"), tr("Installer Error"),
+            tr("Error during installation process (%1):\n%2").arg(component->name(),
+            operation->errorString()),
+            QMessageBox::Retry | QMessageBox::Ignore | QMessageBox::Cancel, QMessageBox::Cancel);
+
+        if (button == QMessageBox::Retry)
+            ok = performOperationThreaded(operation);
+        else if (button == QMessageBox::Ignore)
+            ignoreError = true;
+        else if (button == QMessageBox::Cancel)
+            m_core->interrupt();
+    }
+
+    if (ok || operation->error() > Operation::InvalidArguments) {
+        // Remember that the operation was performed, that allows us to undo it if a following operation
+        // fails or if this operation failed but still needs an undo call to cleanup.
+        addPerformed(operation);
+    }
+
+    if (becameAdmin)
+        m_core->dropAdminRights();
+
+    if (!ok && !ignoreError)
+        throw Error(operation->errorString());
+}
+
+/*!
+    Runs consecutive \c Replace operations of \a component starting at index \a start in
+    \a operations as one relocation stage, so that each affected file is read and written
+    only once. Returns the number of operations handled, or \c 0 if fewer than two
+    operations could be combined. All operations of the stage are then installed one by
+    one as usual; those whose file was relocated only confirm the result, the others
+    perform the replacement themselves and report their errors.
+*/
+int PackageManagerCorePrivate::runRelocationStage(Component *component,
+    const OperationList &operations, int start, double progressOperationSize, bool adminRightsGained)
+{
+    RelocationStage stage;
+    for (int i = start; i < operations.count(); ++i) {
+        if (!stage.addOperation(operations.at(i)))
+            break;
+    }
+    if (stage.count() < 2)
+        return 0;
+
+    qCDebug(QInstaller::lcInstallerInstallLog) << "Relocating" << stage.fileNames().count()
+        << "files for" << stage.count() << "Replace operations of component" << component->name();
+
+    QFutureWatcher<bool> futureWatcher;
+    const QFuture<bool> future = QtConcurrent::run([&stage] { return stage.run(); });
+
+    QEventLoop loop;
+    QObject::connect(&futureWatcher, &decltype(futureWatcher)::finished, &loop, &QEventLoop::quit,
+                     Qt::QueuedConnection);
+    futureWatcher.setFuture(future);
+
+    if (!future.isFinished())
+        loop.exec();
+
+    foreach (Operation *operation, stage.operations()) {
+        if (statusCanceledOrFailed())
+            throw Error(tr("Installation canceled by user"));
+        installOperation(component, operation, progressOperationSize, adminRightsGained);
+    }
+    return stage.count();
+}
+
 void PackageManagerCorePrivate::setComponentSelection(const QString &id, Qt::CheckState state)
 {
     ComponentModel *model = m_core->isUpdater() ? m_core->updaterComponentModel() : m_core->defaultComponentModel();
@@ -2534,6 +2725,7 @@ void PackageManagerCorePrivate::deleteMaintenanceTool()
     resourcePath.remove(QLatin1String("installer.dat"));
     QDir installDir(targetDir());
     installDir.remove(m_data.settings().maintenanceToolName() + QLatin1String(".dat"));
+    OperationJournal(datFileName()).remove();
     installDir.remove(QLatin1String("network.xml"));
     installDir.remove(m_data.settings().maintenanceToolIniFile());
     QInstaller::VerboseWriter::instance()->setFileName(QString());
@@ -2720,8 +2912,10 @@ void PackageManagerCorePrivate::runUndoOperations(const OperationList &undoOpera
             if (becameAdmin)
                 m_core->dropAdminRights();
 
-            if (deleteOperation)
+            if (deleteOperation) {
+                m_operationIds.remove(undoOperation);
                 delete undoOperation;
+            }
         }
     } catch (const Error &error) {
         m_localPackageHub->writeToDisk();
@@ -2758,6 +2952,48 @@ PackagesList PackageManagerCorePrivate::remotePackages()
     return m_updateFinder->updates();
 }
 
+/*!
+    Returns the search index of the packages available from the current package sources.
+    A search index saved to the local cache for the same \c Updates.xml files is reused,
+    otherwise the index is built from remotePackages() and saved if the local cache is
+    persistent.
+
+    If \a ok is not \c nullptr, it is set to \c false if the package information
+    could not be read from the package sources. An empty index with \a ok set
+    to \c true means that no packages are available.
+*/
+const PackageSearchIndex &PackageManagerCorePrivate::packageSearchIndex(bool *ok)
+{
+    if (ok)
+        *ok = true;
+
+    const QString applicationName = m_localPackageHub->isValid()
+        ? m_localPackageHub->applicationName() : QCoreApplication::applicationName();
+    const QByteArray fingerprint = PackageSearchIndex::fingerprint(m_packageSources
+        + m_compressedPackageSources, applicationName);
+    if (!fingerprint.isEmpty() && m_searchIndex.fingerprint() == fingerprint)
+        return m_searchIndex;
+
+    const QString fileName = m_data.settings().localCachePath()
+        + QLatin1String("/searchindex.dat");
+    if (m_searchIndex.load(fileName, fingerprint))
+        return m_searchIndex;
+
+    const PackagesList packages = remotePackages();
+    m_searchIndex.build(packages);
+    if (packages.isEmpty() && ok && m_updateFinder && m_updateFinder->error() != KDUpdater::ENoError)
+        *ok = false;
+    if (packages.isEmpty() || fingerprint.isEmpty())
+        return m_searchIndex;
+
+    m_searchIndex.setFingerprint(fingerprint);
+    if (m_data.settings().persistentLocalCache() && !m_searchIndex.save(fileName)) {
+        qCDebug(QInstaller::lcInstallerInstallLog) << "Cannot write package search index"
+            << fileName;
+    }
+    return m_searchIndex;
+}
+
 /*!
     Returns a hash containing the installed package name and it's associated package information. If
     the application is running in installer mode or the local components file could not be parsed, the
@@ -2983,14 +3219,66 @@ void PackageManagerCorePrivate::unpackAndInstallComponents(const QList<Component
     ProgressCoordinator::instance()->emitAdditionalProgressStatus(tr("All components installed."));
 }
 
+/*
+    Returns the operations performed by previous runs. They are created from the operation
+    log on first use only, as starting the maintenance tool does not need most of them.
+*/
+OperationList &PackageManagerCorePrivate::performedOperationsOld()
+{
+    if (!m_pendingOperations.isEmpty()) {
+        const QList<OperationBlob> pendingOperations = std::move(m_pendingOperations);
+        const QVector<quint32> pendingOperationIds = std::move(m_pendingOperationIds);
+        m_pendingOperations.clear();
+        m_pendingOperationIds.clear();
+        for (int i = 0; i < pendingOperations.count(); ++i) {
+            if (Operation *op = OperationLog::create(pendingOperations.at(i), m_core)) {
+                m_performedOperationsOld.append(op);
+                m_operationIds.insert(op, pendingOperationIds.at(i));
+            }
+        }
+    }
+    return m_performedOperationsOld;
+}
+
+/*
+    Returns the names of the components that have operations performed by previous runs.
+    Uses the component index of the operation log, so that the operations do not need to
+    be created if they were read from one.
+*/
+QSet<QString> PackageManagerCorePrivate::performedOperationComponents()
+{
+    QSet<QString> components;
+    foreach (const OperationBlob &operation, m_pendingOperations) {
+        if (operation.record.isEmpty()) {
+            // XML based format without index, the operations need to be created
+            performedOperationsOld();
+            components.clear();
+            break;
+        }
+        if (!operation.component.isEmpty())
+            components.insert(operation.component);
+    }
+
+    foreach (Operation *operation, m_performedOperationsOld) {
+        if (operation->hasValue(QLatin1String("component")))
+            components.insert(operation->value(QLatin1String("component")).toString());
+    }
+    return components;
+}
+
 void PackageManagerCorePrivate::processFilesForDelayedDeletion()
 {
+    // Files that were in use when moved to the trash are still there
+    DeletionService::instance().removeStaleTrash(QDir::tempPath());
+
     if (m_filesForDelayedDeletion.isEmpty())
         return;
 
     const QStringList filesForDelayedDeletion = std::move(m_filesForDelayedDeletion);
     foreach (const QString &i, filesForDelayedDeletion) {
-        QFile file(i);   //TODO: this should happen asnyc and report errors, I guess
+        if (DeletionService::instance().remove(i))
+            continue;
+        QFile file(i);
         if (file.exists() && !file.remove()) {
             qCWarning(QInstaller::lcInstallerInstallLog) << "Cannot delete file " << qPrintable(i) <<
                 ": " << qPrintable(file.errorString());
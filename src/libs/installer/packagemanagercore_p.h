@@ -33,6 +33,7 @@
 #include "packagemanagercore.h"
 #include "packagemanagercoredata.h"
 #include "packagemanagerproxyfactory.h"
+#include "packagesearchindex.h"
 #include "packagesource.h"
 #include "qinstallerglobal.h"
 #include "component.h"
@@ -161,12 +162,15 @@ public:
     void registerPathsForUninstallation(const QList<QPair<QString, bool> > &pathsForUninstallation,
         const QString &componentName);
 
+    OperationList &performedOperationsOld();
+    QSet<QString> performedOperationComponents();
+
     void addPerformed(Operation *op) {
         m_performedOperationsCurrentSession.append(op);
     }
 
     void commitSessionOperations() {
-        m_performedOperationsOld += m_performedOperationsCurrentSession;
+        performedOperationsOld() += m_performedOperationsCurrentSession;
         m_performedOperationsCurrentSession.clear();
     }
 
@@ -175,6 +179,12 @@ public:
 
     void installComponent(Component *component, double progressOperationSize,
         bool adminRightsGained = false);
+    void installOperation(Component *component, Operation *operation,
+        double progressOperationSize, bool adminRightsGained);
+    int runRelocationStage(Component *component, const OperationList &operations, int start,
+        double progressOperationSize, bool adminRightsGained);
+    void keepFilesForUpdatedExtracts(const OperationList &undoOperations,
+        const QList<Component *> &components);
 
     void setComponentSelection(const QString &id, Qt::CheckState state);
 
@@ -191,6 +201,7 @@ public:
     QSet<PackageSource> m_packageSources;
     QSet<PackageSource> m_compressedPackageSources;
     std::shared_ptr<LocalPackageHub> m_localPackageHub;
+    PackageSearchIndex m_searchIndex;
     QStringList m_filesForDelayedDeletion;
 
     int m_status;
@@ -219,8 +230,15 @@ public:
 
     OperationList m_ownedOperations;
     OperationList m_performedOperationsOld;
+    QList<OperationBlob> m_pendingOperations;
+    QVector<quint32> m_pendingOperationIds;
     OperationList m_performedOperationsCurrentSession;
 
+    QHash<Operation *, quint32> m_operationIds;
+    QSet<quint32> m_storedOperationIds;
+    quint32 m_storedOperationBaseCount;
+    quint32 m_nextOperationId;
+
     bool m_dependsOnLocalInstallerBinary;
     QStringList m_allowedRunningProcesses;
     bool m_autoAcceptLicenses;
@@ -255,11 +273,15 @@ private:
     void writeMaintenanceToolBinaryData(QFileDevice *output, QFile *const input,
         const OperationList &performed, const BinaryLayout &layout);
     void writeMaintenanceToolAppBundle(OperationList &performedOperations);
+    bool appendToOperationJournal(const OperationList &performedOperations,
+        const BinaryLayout &layout);
+    void resetStoredOperations(const OperationList &performedOperations);
 
     void runUndoOperations(const OperationList &undoOperations, double undoOperationProgressSize,
         bool adminRightsGained, bool deleteOperation);
 
     PackagesList remotePackages();
+    const PackageSearchIndex &packageSearchIndex(bool *ok = nullptr);
     LocalPackagesMap localInstalledPackages();
     bool fetchMetaInformationFromRepositories(DownloadType type = DownloadType::All);
     bool addUpdateResourcesFromRepositories(bool compressedRepository = false);
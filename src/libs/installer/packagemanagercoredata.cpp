@@ -51,6 +51,41 @@ namespace QInstaller
     \internal
 */
 
+// The number of parsed templates after which the template cache is cleared.
+static const int scMaxCachedTemplates = 4096;
+
+/*
+    A string passed to replaceVariables(), split into literal text and variables. The
+    variables are indexes into the interned variables of the cache.
+*/
+struct PackageManagerCoreData::VariableTemplate
+{
+    enum {
+        Literal = -1,
+        Uncached = -2
+    };
+
+    struct Segment {
+        int position;
+        int length;
+        int variable; // index of the interned variable, Literal or Uncached
+    };
+
+    QString source;
+    QVector<Segment> segments;
+};
+
+PackageManagerCoreData::VariableCache &PackageManagerCoreData::VariableCache::operator=(
+    const VariableCache &other)
+{
+    Q_UNUSED(other)
+    // The interned names and parsed templates stay valid, only the values need to be resolved
+    // again.
+    QMutexLocker _(&mutex);
+    ++generation;
+    return *this;
+}
+
 PackageManagerCoreData::PackageManagerCoreData(const QHash<QString, QString> &variables, const bool isInstaller)
 {
     // Add user defined variables before dynamic as user settings can affect dynamic variables.
@@ -116,6 +151,7 @@ PackageManagerCoreData::PackageManagerCoreData(const QHash<QString, QString> &va
 void PackageManagerCoreData::clear()
 {
     m_variables.clear();
+    invalidateVariables();
 }
 
 /*!
@@ -207,12 +243,15 @@ void PackageManagerCoreData::setUserDefinedVariables(const QHash<QString, QStrin
     QHash<QString, QString>::const_iterator it;
     for (it = variables.begin(); it != variables.end(); ++it)
         m_variables.insert(it.key(), it.value());
+    invalidateVariables();
 }
 
 void PackageManagerCoreData::addNewVariable(const QString &key, const QString &value)
 {
-    if (!m_variables.contains(key))
+    if (!m_variables.contains(key)) {
         m_variables.insert(key, value);
+        invalidateVariables();
+    }
 }
 
 Settings &PackageManagerCoreData::settings() const
@@ -235,6 +274,7 @@ bool PackageManagerCoreData::setValue(const QString &key, const QString &normali
     if (m_variables.contains(key) && m_variables.value(key) == normalizedValue)
         return false;
     m_variables.insert(key, normalizedValue);
+    invalidateVariables();
     return true;
 }
 
@@ -275,24 +315,27 @@ QString PackageManagerCoreData::key(const QString &value) const
     return m_variables.key(value, QString());
 }
 
+/*
+    Replaces all variables enclosed in \c @ in \a str with their values. The parsed form of
+    \a str is cached, as well as the values of the variables, until a variable is changed.
+*/
 QString PackageManagerCoreData::replaceVariables(const QString &str) const
 {
     static const QChar at = QLatin1Char('@');
+    if (!str.contains(at))
+        return str;
+
+    const QSharedPointer<const VariableTemplate> parsed = variableTemplate(str);
     QString res;
-    int pos = 0;
-    while (true) {
-        const int pos1 = str.indexOf(at, pos);
-        if (pos1 == -1)
-            break;
-        const int pos2 = str.indexOf(at, pos1 + 1);
-        if (pos2 == -1)
-            break;
-        res += str.mid(pos, pos1 - pos);
-        const QString name = str.mid(pos1 + 1, pos2 - pos1 - 1);
-        res += value(name).toString();
-        pos = pos2 + 1;
+    res.reserve(str.size());
+    foreach (const VariableTemplate::Segment &segment, parsed->segments) {
+        if (segment.variable == VariableTemplate::Literal)
+            res.append(parsed->source.constData() + segment.position, segment.length);
+        else if (segment.variable == VariableTemplate::Uncached)
+            res += value(parsed->source.mid(segment.position, segment.length)).toString();
+        else
+            res += variableValue(segment.variable);
     }
-    res += str.mid(pos);
     return res;
 }
 
@@ -310,11 +353,117 @@ QByteArray PackageManagerCoreData::replaceVariables(const QByteArray &ba) const
             break;
         res += ba.mid(pos, pos1 - pos);
         const QString name = QString::fromLocal8Bit(ba.mid(pos1 + 1, pos2 - pos1 - 1));
-        res += value(name).toString().toLocal8Bit();
+        if (m_variables.contains(name)) {
+            int index = -1;
+            {
+                QMutexLocker _(&m_cache.mutex);
+                index = variableIndex(name);
+            }
+            res += variableValue(index).toLocal8Bit();
+        } else {
+            res += value(name).toString().toLocal8Bit();
+        }
         pos = pos2 + 1;
     }
     res += ba.mid(pos);
     return res;
 }
 
+/*
+    Returns the parsed form of \a str, from the cache if it was parsed before.
+*/
+QSharedPointer<const PackageManagerCoreData::VariableTemplate>
+    PackageManagerCoreData::variableTemplate(const QString &str) const
+{
+    static const QChar at = QLatin1Char('@');
+
+    QMutexLocker _(&m_cache.mutex);
+    const auto it = m_cache.templates.constFind(str);
+    if (it != m_cache.templates.constEnd())
+        return it.value();
+
+    QSharedPointer<VariableTemplate> parsed(new VariableTemplate);
+    parsed->source = str;
+    int pos = 0;
+    while (true) {
+        const int pos1 = str.indexOf(at, pos);
+        if (pos1 == -1)
+            break;
+        const int pos2 = str.indexOf(at, pos1 + 1);
+        if (pos2 == -1)
+            break;
+        if (pos1 > pos)
+            parsed->segments.append({ pos, pos1 - pos, VariableTemplate::Literal });
+        // Only variables set on this object are interned, their number is bounded and only
+        // their values are cached. Anything else between two @ is looked up each time.
+        const int length = pos2 - pos1 - 1;
+        const QString name = str.mid(pos1 + 1, length);
+        parsed->segments.append({ pos1 + 1, length, m_variables.contains(name)
+            ? variableIndex(name) : int(VariableTemplate::Uncached) });
+        pos = pos2 + 1;
+    }
+    if (pos < str.size())
+        parsed->segments.append({ pos, str.size() - pos, VariableTemplate::Literal });
+
+    if (m_cache.templates.size() >= scMaxCachedTemplates)
+        m_cache.templates.clear();
+    m_cache.templates.insert(str, parsed);
+    return parsed;
+}
+
+/*
+    Returns the value of the interned variable at \a index. Values of variables set on this
+    object are cached until a variable changes. Other values, for example from the settings
+    or the registry, are looked up each time.
+*/
+QString PackageManagerCoreData::variableValue(int index) const
+{
+    QString name;
+    quint64 generation = 0;
+    {
+        QMutexLocker _(&m_cache.mutex);
+        const VariableCache::Variable &variable = m_cache.variables.at(index);
+        if (variable.generation == m_cache.generation)
+            return variable.value;
+        name = variable.name;
+        generation = m_cache.generation;
+    }
+
+    // resolve outside of the lock, value() can call replaceVariables()
+    const QString result = value(name).toString();
+    if (m_variables.contains(name) && (name != scTargetDir || !m_variables.value(name).isEmpty())) {
+        QMutexLocker _(&m_cache.mutex);
+        if (generation == m_cache.generation) {
+            VariableCache::Variable &variable = m_cache.variables[index];
+            variable.value = result;
+            variable.generation = generation;
+        }
+    }
+    return result;
+}
+
+/*
+    Returns the index of the interned variable \a name, interning it if needed. Only called
+    for variables set on this object, so the table cannot grow with arbitrary text between
+    two @. Expects the cache to be locked.
+*/
+int PackageManagerCoreData::variableIndex(const QString &name) const
+{
+    auto it = m_cache.indexes.constFind(name);
+    if (it == m_cache.indexes.constEnd()) {
+        it = m_cache.indexes.insert(name, m_cache.variables.size());
+        m_cache.variables.append({ name, QString(), 0 });
+    }
+    return it.value();
+}
+
+/*
+    Invalidates the cached variable values, to be called whenever a variable changes.
+*/
+void PackageManagerCoreData::invalidateVariables()
+{
+    QMutexLocker _(&m_cache.mutex);
+    ++m_cache.generation;
+}
+
 }   // namespace QInstaller
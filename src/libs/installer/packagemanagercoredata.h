@@ -30,7 +30,10 @@
 #define PACKAGEMANAGERCOREDATA_H
 
 #include "settings.h"
+
+#include <QMutex>
 #include <QSettings>
+#include <QSharedPointer>
 
 namespace QInstaller {
 
@@ -61,9 +64,38 @@ public:
     QByteArray replaceVariables(const QByteArray &ba) const;
 
 private:
+    struct VariableTemplate;
+
+    // Parsed templates of replaceVariables() and the resolved values of the variables they
+    // use. Copies start empty, as the copied variables can change independently.
+    struct VariableCache
+    {
+        struct Variable {
+            QString name;
+            QString value;
+            quint64 generation;
+        };
+
+        VariableCache() = default;
+        VariableCache(const VariableCache &) {}
+        VariableCache &operator=(const VariableCache &other);
+
+        QMutex mutex;
+        quint64 generation = 1;
+        QHash<QString, QSharedPointer<const VariableTemplate> > templates;
+        QHash<QString, int> indexes;
+        QVector<Variable> variables;
+    };
+
+    QSharedPointer<const VariableTemplate> variableTemplate(const QString &str) const;
+    QString variableValue(int index) const;
+    int variableIndex(const QString &name) const;
+    void invalidateVariables();
+
     mutable Settings m_settings;
     QString m_settingsFilePath;
     QHash<QString, QString> m_variables;
+    mutable VariableCache m_cache;
 };
 
 }   // namespace QInstaller
@@ -42,6 +42,7 @@
 #include "repositorycategory.h"
 #include "componentselectionpage_p.h"
 #include "loggingutils.h"
+#include "tracelog.h"
 
 #include "sysinfo.h"
 #include "globals.h"
@@ -728,6 +729,8 @@ void PackageManagerGui::callControlScriptMethod(const QString &methodName)
     if (d->m_controlScriptContext.isUndefined())
         return;
     try {
+        TraceSpan span(TraceLog::Script, methodName,
+            TraceLog::instance().isEnabled() ? QLatin1String("Controller") : QString());
         const QJSValue returnValue = m_core->controlScriptEngine()->callScriptMethod(
             d->m_controlScriptContext, methodName);
         if (returnValue.isUndefined()) {
@@ -1462,7 +1465,7 @@ int PackageManagerPage::nextId() const
 
             // The component is about to be installed and provides a license, so the page needs to
             // be shown.
-            if (!component->licenses().isEmpty())
+            if (component->hasLicenses())
                 return next;
         }
         return nextNextId;  // no component with a license or all components with license installed
@@ -0,0 +1,425 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "packagesearchindex.h"
+
+#include "constants.h"
+#include "fileutils.h"
+#include "update.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+namespace QInstaller {
+
+static const quint32 scSearchIndexMagic = 0x49465753; // 'IFWS'
+static const quint32 scSearchIndexVersion = 1;
+
+/*!
+    \class QInstaller::PackageSearchIndex
+    \inmodule QtInstallerFramework
+    \brief The PackageSearchIndex class answers package searches from repository metadata.
+
+    The index keeps the string values of every \c PackageUpdate element read from the
+    \c Updates.xml files of the package sources, so that searching for packages does not
+    require creating components or running component scripts. Package names are indexed by
+    their trigrams, which narrows down the packages a regular expression needs to be
+    matched against.
+
+    The index can be saved next to the local metadata cache. A saved index is identified
+    by a fingerprint of the \c Updates.xml files it was built from and is only loaded if
+    the fingerprint still matches.
+*/
+
+/*!
+    \class QInstaller::PackageSearchIndex::Entry
+    \inmodule QtInstallerFramework
+    \brief The Entry class holds the indexed values of a single package.
+*/
+
+/*!
+    Returns the name of the package.
+*/
+QString PackageSearchIndex::Entry::name() const
+{
+    return values.value(scName);
+}
+
+/*!
+    \fn QInstaller::PackageSearchIndex::Entry::value(const QString &key) const
+
+    Returns the value of the package element \a key, or an empty string if
+    the package has no such element.
+*/
+
+namespace {
+
+quint64 trigramKey(const QChar *chars)
+{
+    return (quint64(chars[0].unicode()) << 32) | (quint64(chars[1].unicode()) << 16)
+        | quint64(chars[2].unicode());
+}
+
+QSet<quint64> trigrams(const QString &text)
+{
+    QSet<quint64> result;
+    const QString lower = text.toLower();
+    for (int i = 0; i + 2 < lower.size(); ++i)
+        result.insert(trigramKey(lower.constData() + i));
+    return result;
+}
+
+/*
+    Returns literal substrings that each match of \a pattern must contain. Returns
+    an empty list if the pattern uses constructs that are not understood here, in
+    which case all packages are candidates.
+*/
+QStringList requiredLiterals(const QString &pattern)
+{
+    static const QString unsupported = QLatin1String("|()[]{}\\");
+    QStringList literals;
+    QString current;
+    for (const QChar &c : pattern) {
+        if (unsupported.contains(c))
+            return QStringList();
+
+        if (c == QLatin1Char('*') || c == QLatin1Char('?')) {
+            // the preceding character is optional
+            current.chop(1);
+        } else if (c != QLatin1Char('^') && c != QLatin1Char('$')
+                && c != QLatin1Char('.') && c != QLatin1Char('+')) {
+            current.append(c);
+            continue;
+        }
+        if (current.size() >= 3)
+            literals.append(current);
+        current.clear();
+    }
+    if (current.size() >= 3)
+        literals.append(current);
+    return literals;
+}
+
+QString treePath(const PackageSearchIndex::Entry &entry)
+{
+    const QString treeName = entry.value(scTreeName);
+    return treeName.isEmpty() ? entry.name() : treeName;
+}
+
+} // namespace
+
+/*!
+    Constructs an empty search index.
+*/
+PackageSearchIndex::PackageSearchIndex()
+{
+}
+
+/*!
+    Rebuilds the index from the metadata of \a packages. The order of \a packages is kept
+    in search results.
+*/
+void PackageSearchIndex::build(const PackagesList &packages)
+{
+    clear();
+    m_entries.reserve(packages.count());
+    foreach (Package *package, packages) {
+        Entry entry;
+        const QHash<QString, QVariant> data = package->allData();
+        for (auto it = data.constBegin(); it != data.constEnd(); ++it) {
+            if (it.key() == scTreeName) {
+                const QPair<QString, bool> treeName = it.value().value<QPair<QString, bool>>();
+                entry.values.insert(scTreeName, treeName.first);
+                entry.moveChildren = treeName.second;
+            } else {
+                entry.values.insert(it.key(), it.value().toString());
+            }
+        }
+        addEntry(entry);
+    }
+}
+
+/*!
+    Removes all entries and the fingerprint from the index.
+*/
+void PackageSearchIndex::clear()
+{
+    m_fingerprint.clear();
+    m_entries.clear();
+    m_entryByName.clear();
+    m_trigrams.clear();
+}
+
+/*!
+    \fn QInstaller::PackageSearchIndex::isEmpty() const
+
+    Returns \c true if the index contains no packages.
+*/
+
+/*!
+    \fn QInstaller::PackageSearchIndex::count() const
+
+    Returns the number of packages in the index.
+*/
+
+/*!
+    \fn QInstaller::PackageSearchIndex::fingerprint() const
+
+    Returns the fingerprint of the package sources the index was built from.
+*/
+
+/*!
+    \fn QInstaller::PackageSearchIndex::setFingerprint(const QByteArray &fingerprint)
+
+    Sets the \a fingerprint of the package sources the index was built from.
+*/
+
+/*!
+    Loads the index from \a fileName. Returns \c true if the file exists, is readable and
+    was written for \a fingerprint, \c false otherwise. On failure the index is left empty.
+*/
+bool PackageSearchIndex::load(const QString &fileName, const QByteArray &fingerprint)
+{
+    clear();
+    if (fingerprint.isEmpty())
+        return false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray storedFingerprint;
+    stream >> magic >> version;
+    if (magic != scSearchIndexMagic || version != scSearchIndexVersion)
+        return false;
+
+    stream >> storedFingerprint;
+    if (storedFingerprint != fingerprint)
+        return false;
+
+    qint32 entryCount = 0;
+    stream >> entryCount;
+    if (stream.status() != QDataStream::Ok || entryCount < 0)
+        return false;
+
+    m_entries.reserve(entryCount);
+    for (qint32 i = 0; i < entryCount; ++i) {
+        Entry entry;
+        stream >> entry.values >> entry.moveChildren;
+        if (stream.status() != QDataStream::Ok) {
+            clear();
+            return false;
+        }
+        addEntry(entry);
+    }
+    m_fingerprint = fingerprint;
+    return true;
+}
+
+/*!
+    Writes the index to \a fileName. The trigram table is not stored, it is rebuilt from
+    the package names when the index is loaded. Returns \c true on success, \c false if the
+    index has no fingerprint or the file could not be written.
+*/
+bool PackageSearchIndex::save(const QString &fileName) const
+{
+    if (m_fingerprint.isEmpty())
+        return false;
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << scSearchIndexMagic << scSearchIndexVersion << m_fingerprint
+        << qint32(m_entries.count());
+    for (const Entry &entry : m_entries)
+        stream << entry.values << entry.moveChildren;
+
+    if (stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/*!
+    Returns the packages whose name matches \a regexp and whose values match every regular
+    expression in \a filters, keyed by package element name. Matching is case insensitive.
+    Virtual packages and the descendants of virtual packages are only returned if
+    \a includeVirtual is \c true.
+*/
+QList<PackageSearchIndex::Entry> PackageSearchIndex::search(const QString &regexp,
+    const QHash<QString, QString> &filters, bool includeVirtual) const
+{
+    QRegularExpression re(regexp, QRegularExpression::CaseInsensitiveOption);
+    QHash<QString, QRegularExpression> filterExpressions;
+    for (auto it = filters.constBegin(); it != filters.constEnd(); ++it) {
+        filterExpressions.insert(it.key(),
+            QRegularExpression(it.value(), QRegularExpression::CaseInsensitiveOption));
+    }
+
+    QList<Entry> result;
+    const QVector<int> indexes = candidates(regexp);
+    for (int index : indexes) {
+        const Entry &entry = m_entries.at(index);
+        if (!re.match(entry.name()).hasMatch())
+            continue;
+        if (!includeVirtual && isHidden(index))
+            continue;
+
+        bool matchesFilters = true;
+        for (auto it = filterExpressions.constBegin(); it != filterExpressions.constEnd(); ++it) {
+            const QString elementValue = entry.value(it.key());
+            if (elementValue.isEmpty() || !it.value().match(elementValue).hasMatch()) {
+                matchesFilters = false;
+                break;
+            }
+        }
+        if (matchesFilters)
+            result.append(entry);
+    }
+    return result;
+}
+
+/*!
+    Returns a fingerprint of the \c Updates.xml files of \a sources as seen by an application
+    named \a applicationName. Returns an empty byte array if one of the sources is not a local
+    file or a resource.
+*/
+QByteArray PackageSearchIndex::fingerprint(const QSet<PackageSource> &sources,
+    const QString &applicationName)
+{
+    QList<PackageSource> sortedSources = sources.values();
+    std::sort(sortedSources.begin(), sortedSources.end(),
+        [](const PackageSource &lhs, const PackageSource &rhs) {
+            return lhs.url.toString() < rhs.url.toString();
+        });
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(scSearchIndexVersion));
+    hash.addData(applicationName.toUtf8());
+    for (const PackageSource &source : qAsConst(sortedSources)) {
+        const QString scheme = source.url.scheme();
+        if (scheme != QLatin1String("file") && scheme != QLatin1String("resource"))
+            return QByteArray();
+
+        hash.addData(source.url.toString().toUtf8());
+        hash.addData(QByteArray::number(source.priority));
+
+        QFile updatesFile(pathFromUrl(source.url) + QLatin1String("/Updates.xml"));
+        if (updatesFile.open(QIODevice::ReadOnly))
+            hash.addData(&updatesFile);
+    }
+    return hash.result().toHex();
+}
+
+/*!
+    \internal
+*/
+void PackageSearchIndex::addEntry(const Entry &entry)
+{
+    const int index = m_entries.count();
+    m_entries.append(entry);
+    m_entryByName.insert(treePath(entry), index);
+
+    const QSet<quint64> keys = trigrams(entry.name());
+    for (const quint64 key : keys)
+        m_trigrams[key].append(index);
+}
+
+/*!
+    \internal
+
+    Returns \c true if the entry at \a index or one of its ancestors is virtual.
+*/
+bool PackageSearchIndex::isHidden(int index) const
+{
+    QString path = treePath(m_entries.at(index));
+    while (true) {
+        const int ancestor = m_entryByName.value(path, -1);
+        if (ancestor >= 0 && m_entries.at(ancestor).value(scVirtual).toLower() == scTrue)
+            return true;
+
+        const int dot = path.lastIndexOf(QLatin1Char('.'));
+        if (dot < 0)
+            return false;
+        path.truncate(dot);
+    }
+}
+
+/*!
+    \internal
+
+    Returns the indexes of the entries whose names contain the trigrams of all literal
+    parts that a match of \a regexp requires, in index order.
+*/
+QVector<int> PackageSearchIndex::candidates(const QString &regexp) const
+{
+    QSet<quint64> keys;
+    foreach (const QString &literal, requiredLiterals(regexp))
+        keys.unite(trigrams(literal));
+
+    if (keys.isEmpty()) {
+        QVector<int> all(m_entries.count());
+        std::iota(all.begin(), all.end(), 0);
+        return all;
+    }
+
+    QVector<int> result;
+    bool first = true;
+    for (const quint64 key : qAsConst(keys)) {
+        const QVector<int> postings = m_trigrams.value(key);
+        if (first) {
+            result = postings;
+            first = false;
+        } else {
+            QVector<int> intersection;
+            std::set_intersection(result.constBegin(), result.constEnd(),
+                postings.constBegin(), postings.constEnd(), std::back_inserter(intersection));
+            result = intersection;
+        }
+        if (result.isEmpty())
+            break;
+    }
+    return result;
+}
+
+} // namespace QInstaller
@@ -0,0 +1,87 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef PACKAGESEARCHINDEX_H
+#define PACKAGESEARCHINDEX_H
+
+#include "installer_global.h"
+#include "packagesource.h"
+#include "qinstallerglobal.h"
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+namespace QInstaller {
+
+class INSTALLER_EXPORT PackageSearchIndex
+{
+public:
+    struct Entry
+    {
+        QString name() const;
+        QString value(const QString &key) const { return values.value(key); }
+
+        QHash<QString, QString> values;
+        bool moveChildren = false;
+    };
+
+    PackageSearchIndex();
+
+    void build(const PackagesList &packages);
+    void clear();
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int count() const { return m_entries.count(); }
+    QByteArray fingerprint() const { return m_fingerprint; }
+    void setFingerprint(const QByteArray &fingerprint) { m_fingerprint = fingerprint; }
+
+    bool load(const QString &fileName, const QByteArray &fingerprint);
+    bool save(const QString &fileName) const;
+
+    QList<Entry> search(const QString &regexp, const QHash<QString, QString> &filters,
+        bool includeVirtual = false) const;
+
+    static QByteArray fingerprint(const QSet<PackageSource> &sources, const QString &applicationName);
+
+private:
+    void addEntry(const Entry &entry);
+    bool isHidden(int index) const;
+    QVector<int> candidates(const QString &regexp) const;
+
+private:
+    QByteArray m_fingerprint;
+    QVector<Entry> m_entries;
+    QHash<QString, int> m_entryByName;
+    QHash<quint64, QVector<int>> m_trigrams;
+};
+
+} // namespace QInstaller
+
+#endif // PACKAGESEARCHINDEX_H
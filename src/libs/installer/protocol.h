@@ -176,6 +176,7 @@ const char AbstractArchiveCreate[] = "AbstractArchive::create";
 const char AbstractArchiveList[] = "AbstractArchive::list";
 const char AbstractArchiveIsSupported[] = "AbstractArchive::isSupported";
 const char AbstractArchiveSetCompressionLevel[] = "AbstractArchive::setCompressionLevel";
+const char AbstractArchiveSetSkippedEntries[] = "AbstractArchive::setSkippedEntries";
 const char AbstractArchiveAddDataBlock[] = "AbstractArchive::addDataBlock";
 const char AbstractArchiveSetClientDataAtEnd[] = "AbstractArchive::setClientDataAtEnd";
 const char AbstractArchiveSetFilePosition[] = "AbstractArchive::setFilePosition";
@@ -29,6 +29,7 @@
 #include "qtpatch.h"
 #include "utils.h"
 #include "globals.h"
+#include "remoteclient.h"
 
 #include <QString>
 #include <QStringList>
@@ -40,6 +41,141 @@
 #include <QtCore/QDebug>
 #include <QCoreApplication>
 #include <QByteArrayMatcher>
+#include <QMutex>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/*
+    Finds several byte patterns in one pass over the data. The data is scanned with a
+    Horspool skip table built from the shortest pattern, so most bytes are skipped
+    without being compared. At a possible match position, the candidate patterns with
+    the same first byte are compared, longest first.
+*/
+class MultiPatternMatcher
+{
+public:
+    explicit MultiPatternMatcher(const QList<QByteArray> &patterns)
+        : m_patterns(patterns)
+        , m_minLength(0)
+    {
+        std::sort(m_patterns.begin(), m_patterns.end(), [](const QByteArray &lhs, const QByteArray &rhs) {
+            return lhs.size() > rhs.size();
+        });
+        if (m_patterns.isEmpty())
+            return;
+
+        m_minLength = int(m_patterns.last().size());
+        std::fill(m_shift, m_shift + 256, m_minLength);
+        for (int i = 0; i < m_patterns.size(); ++i) {
+            const QByteArray &pattern = m_patterns.at(i);
+            for (int j = 0; j < m_minLength - 1; ++j)
+                m_shift[uchar(pattern.at(j))] = qMin(m_shift[uchar(pattern.at(j))], m_minLength - 1 - j);
+            m_shift[uchar(pattern.at(m_minLength - 1))] = 0;
+            m_candidates[uchar(pattern.at(0))].append(i);
+        }
+    }
+
+    const QList<QByteArray> &patterns() const { return m_patterns; }
+
+    // Returns the offset of the next match at or after from, or -1.
+    qint64 indexIn(const char *data, qint64 size, qint64 from, int *patternIndex) const
+    {
+        if (m_minLength == 0)
+            return -1;
+
+        qint64 pos = from;
+        while (pos + m_minLength <= size) {
+            const int shift = m_shift[uchar(data[pos + m_minLength - 1])];
+            if (shift > 0) {
+                pos += shift;
+                continue;
+            }
+            for (int index : m_candidates[uchar(data[pos])]) {
+                const QByteArray &pattern = m_patterns.at(index);
+                if (pos + pattern.size() <= size
+                        && std::memcmp(data + pos, pattern.constData(), pattern.size()) == 0) {
+                    *patternIndex = index;
+                    return pos;
+                }
+            }
+            ++pos;
+        }
+        return -1;
+    }
+
+private:
+    QList<QByteArray> m_patterns;
+    int m_minLength;
+    int m_shift[256];
+    QVector<int> m_candidates[256];
+};
+
+/*
+    Overwrites all matches in data with the padded replacements and returns the
+    patched ranges.
+*/
+QVector<QPair<qint64, int>> patchData(char *data, qint64 size, const MultiPatternMatcher &matcher,
+    const QList<QByteArray> &replacements)
+{
+    QVector<QPair<qint64, int>> patched;
+    qint64 offset = 0;
+    int index = -1;
+    while ((offset = matcher.indexIn(data, size, offset, &index)) != -1) {
+        const QByteArray &replacement = replacements.at(index);
+        std::memcpy(data + offset, replacement.constData(), replacement.size());
+        patched.append(qMakePair(offset, int(replacement.size())));
+        offset += replacement.size();
+    }
+    return patched;
+}
+
+bool patchBinaryFileInPlace(const QString &fileName, const MultiPatternMatcher &matcher,
+    const QList<QByteArray> &replacements)
+{
+    QFile file(fileName);
+    if (!file.exists()) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "qpatch: warning: file" << fileName << "not found";
+        return false;
+    }
+
+    QtPatch::openFileForPatching(&file);
+    if (!file.isOpen()) {
+        qCWarning(QInstaller::lcInstallerInstallLog) << "qpatch: warning: file" << qPrintable(fileName)
+            << "cannot open.";
+        qCWarning(QInstaller::lcInstallerInstallLog).noquote() << file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size == 0)
+        return true;
+
+    if (uchar *data = file.map(0, size)) {
+        patchData(reinterpret_cast<char *>(data), size, matcher, replacements);
+        file.unmap(data);
+        return true;
+    }
+
+    // the file engine does not support mapping, patch a copy and write the changed ranges back
+    QByteArray source = file.readAll();
+    const QVector<QPair<qint64, int>> patched = patchData(source.data(), source.size(), matcher,
+        replacements);
+    for (const auto &range : patched) {
+        if (!file.seek(range.first)
+                || file.write(source.constData() + range.first, range.second) != range.second) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "qpatch: warning: cannot write to file"
+                << fileName << ":" << file.errorString();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
 QHash<QString, QByteArray> QtPatch::readQmakeOutput(const QByteArray &data)
 {
@@ -167,6 +303,64 @@ bool QtPatch::patchBinaryFile(QIODevice *device,
     return true;
 }
 
+/*
+    Patches all occurrences of the old paths in the keys of oldAndNewPaths with the
+    corresponding new paths in every file of fileNames. New paths are padded with null
+    bytes to the length of the old path, so they must not be longer than the old path.
+    Files are memory mapped and patched in place, several files are processed in parallel
+    unless the remote file engine is active.
+    Returns true if all files were patched; otherwise the names of the files that could
+    not be patched are added to failedFiles.
+*/
+bool QtPatch::patchBinaryFiles(const QStringList &fileNames,
+                               const QHash<QByteArray, QByteArray> &oldAndNewPaths,
+                               QStringList *failedFiles)
+{
+    QList<QByteArray> oldPaths;
+    for (auto it = oldAndNewPaths.constBegin(); it != oldAndNewPaths.constEnd(); ++it) {
+        if (it.key().isEmpty())
+            continue;
+        if (it.value().size() > it.key().size()) {
+            qCWarning(QInstaller::lcInstallerInstallLog) << "qpatch: warning: new path" << it.value()
+                << "is longer than the old path" << it.key();
+            if (failedFiles)
+                *failedFiles = fileNames;
+            return false;
+        }
+        oldPaths.append(it.key());
+    }
+
+    const MultiPatternMatcher matcher(oldPaths);
+    QList<QByteArray> replacements;
+    for (const QByteArray &oldPath : matcher.patterns()) {
+        QByteArray replacement = oldAndNewPaths.value(oldPath);
+        replacement.append(QByteArray(oldPath.size() - replacement.size(), '\0'));
+        replacements.append(replacement);
+    }
+
+    QMutex mutex;
+    QStringList failed;
+    const auto patchFile = [&](const QString &fileName) {
+        if (!patchBinaryFileInPlace(fileName, matcher, replacements)) {
+            QMutexLocker _(&mutex);
+            failed.append(fileName);
+        }
+    };
+
+    // The remote file engine serves one thread at a time, patch files one by one then.
+    if (RemoteClient::instance().isActive()) {
+        for (const QString &fileName : fileNames)
+            patchFile(fileName);
+    } else {
+        QStringList files = fileNames;
+        QtConcurrent::blockingMap(files, patchFile);
+    }
+
+    if (failedFiles)
+        *failedFiles = failed;
+    return failed.isEmpty();
+}
+
 bool QtPatch::patchTextFile(const QString &fileName,
                             const QHash<QByteArray, QByteArray> &searchReplacePairs)
 {
@@ -34,6 +34,7 @@
 #include <QByteArray>
 #include <QHash>
 #include <QFile>
+#include <QStringList>
 
 namespace QtPatch {
 
@@ -48,6 +49,10 @@ bool INSTALLER_EXPORT patchBinaryFile(QIODevice *device,
                                       const QByteArray &oldQtPath,
                                       const QByteArray &newQtPath );
 
+bool INSTALLER_EXPORT patchBinaryFiles(const QStringList &fileNames,
+                                       const QHash<QByteArray, QByteArray> &oldAndNewPaths,
+                                       QStringList *failedFiles = nullptr);
+
 bool INSTALLER_EXPORT patchTextFile(const QString &fileName,
                                     const QHash<QByteArray, QByteArray> &searchReplacePairs);
 bool INSTALLER_EXPORT openFileForPatching(QFile *file);
@@ -0,0 +1,169 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "relocationstage.h"
+
+#include "fileutils.h"
+#include "globals.h"
+#include "streamreplacer.h"
+
+#include <QDir>
+#include <QMutex>
+#include <QtConcurrent>
+
+namespace QInstaller {
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::RelocationStage
+    \internal
+    \brief The RelocationStage class applies the string replacements of several Replace
+    operations with one pass over each file.
+
+    Components often queue many \c Replace operations that substitute paths or
+    placeholders in the same files. Instead of reading and writing a file once per
+    operation, the stage collects the replacements of consecutive operations per file and
+    applies them in one pass with StreamReplacer::replaceStrings(), which gives the same
+    result as applying them one after the other. Files are processed in parallel unless
+    the remote file engine is active.
+
+    The stage does not replace the operations: run() marks each operation whose file was
+    relocated, and ReplaceOperation::performOperation() then only confirms the result when
+    the operation is performed the usual way.
+*/
+
+/*!
+    Constructs an empty relocation stage.
+*/
+RelocationStage::RelocationStage()
+{
+}
+
+/*!
+    Adds the replacement of \a operation to the stage. Returns \c false if \a operation is
+    not a valid \c Replace operation in string mode or if it needs administrator rights.
+*/
+bool RelocationStage::addOperation(Operation *operation)
+{
+    if (operation->name() != QLatin1String("Replace"))
+        return false;
+    if (operation->value(QLatin1String("admin")).toBool())
+        return false;
+
+    const QStringList args = operation->arguments();
+    if (args.count() < 3 || args.count() > 4)
+        return false;
+    if (args.count() == 4 && !args.at(3).isEmpty() && args.at(3) != QLatin1String("string"))
+        return false;
+
+    if (!addReplacement(args.at(0), args.at(1), args.at(2)))
+        return false;
+
+    m_operations.append(operation);
+    return true;
+}
+
+/*!
+    Adds the replacement of \a before with \a after in the file \a fileName. Returns
+    \c false if \a before is empty.
+*/
+bool RelocationStage::addReplacement(const QString &fileName, const QString &before,
+    const QString &after)
+{
+    if (before.isEmpty())
+        return false;
+
+    const QString key = QDir::cleanPath(fileName);
+    QVector<QPair<QString, QString>> &replacements = m_replacements[key];
+    if (replacements.isEmpty())
+        m_fileNames.append(key);
+    replacements.append(qMakePair(before, after));
+    return true;
+}
+
+/*!
+    \fn QInstaller::RelocationStage::count() const
+
+    Returns the number of operations added to the stage.
+*/
+
+/*!
+    \fn QInstaller::RelocationStage::operations() const
+
+    Returns the operations added to the stage.
+*/
+
+/*!
+    \fn QInstaller::RelocationStage::fileNames() const
+
+    Returns the files the stage modifies.
+*/
+
+/*!
+    \fn QInstaller::RelocationStage::failedFiles() const
+
+    Returns the files that could not be processed by the last run().
+*/
+
+/*!
+    Applies the replacements to all files, several files in parallel if the directory
+    trees can be walked concurrently. A file that cannot be processed is left unchanged.
+    Operations of the stage whose file was processed are marked with the
+    \c relocated value. Returns \c true if all files were processed, otherwise \c false.
+*/
+bool RelocationStage::run()
+{
+    m_failedFiles.clear();
+
+    QMutex mutex;
+    auto relocate = [&](const QString &fileName) {
+        StreamReplacer replacer(fileName);
+        if (replacer.replaceStrings(m_replacements.value(fileName)) != StreamReplacer::NoError) {
+            qCDebug(QInstaller::lcInstallerInstallLog) << "Cannot relocate file" << fileName
+                << ":" << replacer.errorString();
+            QMutexLocker _(&mutex);
+            m_failedFiles.append(fileName);
+        }
+    };
+
+    QStringList fileNames = m_fileNames;
+    if (fileNames.count() > 1 && canWalkConcurrently()) {
+        QtConcurrent::blockingMap(fileNames, relocate);
+    } else {
+        foreach (const QString &fileName, fileNames)
+            relocate(fileName);
+    }
+
+    foreach (Operation *operation, m_operations) {
+        if (!m_failedFiles.contains(QDir::cleanPath(operation->arguments().at(0))))
+            operation->setValue(QLatin1String("relocated"), true);
+    }
+    return m_failedFiles.isEmpty();
+}
+
+} // namespace QInstaller
@@ -0,0 +1,65 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef RELOCATIONSTAGE_H
+#define RELOCATIONSTAGE_H
+
+#include "qinstallerglobal.h"
+
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+namespace QInstaller {
+
+class INSTALLER_EXPORT RelocationStage
+{
+public:
+    RelocationStage();
+
+    bool addOperation(Operation *operation);
+    bool addReplacement(const QString &fileName, const QString &before, const QString &after);
+
+    int count() const { return m_operations.count(); }
+    OperationList operations() const { return m_operations; }
+    QStringList fileNames() const { return m_fileNames; }
+
+    bool run();
+    QStringList failedFiles() const { return m_failedFiles; }
+
+private:
+    OperationList m_operations;
+    QStringList m_fileNames;
+    QHash<QString, QVector<QPair<QString, QString>>> m_replacements;
+    QStringList m_failedFiles;
+};
+
+} // namespace QInstaller
+
+#endif // RELOCATIONSTAGE_H
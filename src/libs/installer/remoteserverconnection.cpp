@@ -619,6 +619,10 @@ void RemoteServerConnection::handleArchive(RemoteServerReply *reply, const QStri
         qint32 level;
         data >> level;
         archive->setCompressionLevel(static_cast<AbstractArchive::CompressionLevel>(level));
+    } else if (command == QLatin1String(Protocol::AbstractArchiveSetSkippedEntries)) {
+        QSet<QString> paths;
+        data >> paths;
+        archive->setSkippedEntries(paths);
     } else if (command == QLatin1String(Protocol::AbstractArchiveAddDataBlock)) {
         QByteArray buff;
         data >> buff;
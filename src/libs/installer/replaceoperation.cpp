@@ -27,10 +27,9 @@
 **************************************************************************/
 
 #include "replaceoperation.h"
+#include "streamreplacer.h"
 
 #include <QtCore/QDir>
-#include <QtCore/QFile>
-#include <QtCore/QTextStream>
 #include <QtCore/QRegularExpression>
 
 using namespace QInstaller;
@@ -93,34 +92,30 @@ bool ReplaceOperation::performOperation()
         return false;
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) {
+    // The replacement was already applied by a RelocationStage together with others.
+    if (value(QLatin1String("relocated")).toBool()) {
+        clearValue(QLatin1String("relocated"));
+        return true;
+    }
+
+    StreamReplacer replacer(fileName);
+    const StreamReplacer::Status status = (mode == regexMode)
+        ? replacer.replaceRegularExpression(QRegularExpression(before), after)
+        : replacer.replaceString(before, after);
+
+    if (status == StreamReplacer::ReadError) {
         setError(UserDefinedError);
         setErrorString(tr("Cannot open file \"%1\" for reading: %2").arg(
-                           QDir::toNativeSeparators(fileName), file.errorString()));
+                           QDir::toNativeSeparators(fileName), replacer.errorString()));
         return false;
     }
-
-    QTextStream stream(&file);
-    QString replacedFileContent = stream.readAll();
-    file.close();
-
-    if (!file.open(QIODevice::WriteOnly)) {
+    if (status == StreamReplacer::WriteError) {
         setError(UserDefinedError);
         setErrorString(tr("Cannot open file \"%1\" for writing: %2").arg(
-                           QDir::toNativeSeparators(fileName), file.errorString()));
+                           QDir::toNativeSeparators(fileName), replacer.errorString()));
         return false;
     }
 
-    stream.setDevice(&file);
-    if (mode == regexMode) {
-        QRegularExpression regex(before);
-        stream << replacedFileContent.replace(regex, after);
-    } else if (mode == stringMode) {
-        stream << replacedFileContent.replace(before, after);
-    }
-    file.close();
-
     return true;
 }
 
@@ -80,6 +80,7 @@ static const QLatin1String scHttpProxy("HttpProxy");
 static const QLatin1String scProxyType("ProxyType");
 
 static const QLatin1String scLocalCachePath("LocalCachePath");
+static const QLatin1String scArchiveCacheSize("ArchiveCacheSize");
 
 const char scControlScript[] = "ControlScript";
 
@@ -320,7 +321,7 @@ Settings Settings::fromFileAndPrefix(const QString &path, const QString &prefix,
                 << scInstallerApplicationIcon << scInstallerWindowIcon
                 << scLogo << scWatermark << scBanner << scBackground << scPageListPixmap
                 << scStartMenuDir << scMaintenanceToolName << scMaintenanceToolIniFile << scMaintenanceToolAlias
-                << scRemoveTargetDir << scLocalCacheDir << scPersistentLocalCache
+                << scRemoveTargetDir << scLocalCacheDir << scPersistentLocalCache << scArchiveCacheSize
                 << scRunProgram << scRunProgramArguments << scRunProgramDescription
                 << scDependsOnLocalInstallerBinary
                 << scAllowSpaceInPath << scAllowNonAsciiCharacters << scDisableAuthorizationFallback
@@ -911,6 +912,16 @@ void Settings::setLocalCachePath(const QString &path)
     d->m_data.replace(scLocalCachePath, path);
 }
 
+qint64 Settings::archiveCacheSize() const
+{
+    return d->m_data.value(scArchiveCacheSize, 0).toLongLong();
+}
+
+void Settings::setArchiveCacheSize(qint64 megabytes)
+{
+    d->m_data.replace(scArchiveCacheSize, megabytes);
+}
+
 Settings::ProxyType Settings::proxyType() const
 {
     return Settings::ProxyType(d->m_data.value(scProxyType, Settings::NoProxy).toInt());
@@ -162,6 +162,9 @@ public:
     QString localCachePath() const;
     void setLocalCachePath(const QString &path);
 
+    qint64 archiveCacheSize() const;
+    void setArchiveCacheSize(qint64 megabytes);
+
     Settings::ProxyType proxyType() const;
     void setProxyType(Settings::ProxyType type);
 
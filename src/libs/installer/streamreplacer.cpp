@@ -0,0 +1,620 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "streamreplacer.h"
+
+#include "remoteclient.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStringMatcher>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <vector>
+
+namespace QInstaller {
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::StreamReplacer
+    \internal
+    \brief The StreamReplacer class replaces text in files without reading them into memory
+    as a whole.
+
+    The file is read and written in chunks of chunkSize() characters with the same text
+    codec as QTextStream uses by default. The result is written to a temporary file that
+    replaces the original file only after all content was written successfully, so the
+    original file stays intact on errors.
+
+    If no temporary file can be created next to the file, or the file is accessed through
+    the elevated remote file engine, the whole file is read into memory before it is
+    rewritten in place.
+
+    Text that a regular expression might still match once more content is read is kept
+    for the next chunk, together with some preceding context for look-behind assertions.
+    Files that fit into one chunk are processed in one piece.
+*/
+
+/*!
+    \enum StreamReplacer::Status
+
+    This enum type specifies the result of a replace:
+
+    \value NoError
+           The file was processed successfully.
+    \value ReadError
+           The file could not be opened for reading.
+    \value WriteError
+           The replaced content could not be written.
+*/
+
+namespace {
+
+// Number of characters kept before the unprocessed text, for look-behind assertions
+// and word boundaries at chunk borders.
+const int scContextSize = 1024;
+
+struct BackReference
+{
+    int pos;
+    int length;
+    int number;
+};
+
+/*
+    Locates the back references in \a after the same way QString::replace() does.
+*/
+QVector<BackReference> backReferences(const QString &after, int captureCount)
+{
+    QVector<BackReference> references;
+    for (int i = 0; i < after.size() - 1; ++i) {
+        if (after.at(i) != QLatin1Char('\\'))
+            continue;
+
+        int number = after.at(i + 1).digitValue();
+        if (number <= 0 || number > captureCount)
+            continue;
+
+        BackReference reference = { i, 2, number };
+        if (i < after.size() - 2) {
+            const int secondDigit = after.at(i + 2).digitValue();
+            if (secondDigit != -1 && ((number * 10) + secondDigit) <= captureCount) {
+                reference.number = (number * 10) + secondDigit;
+                ++reference.length;
+            }
+        }
+        references.append(reference);
+    }
+    return references;
+}
+
+QString expand(const QString &after, const QVector<BackReference> &references,
+    const QRegularExpressionMatch &match)
+{
+    if (references.isEmpty())
+        return after;
+
+    QString result;
+    int pos = 0;
+    for (const BackReference &reference : references) {
+        result.append(QStringView(after).mid(pos, reference.pos - pos));
+        result.append(match.capturedView(reference.number));
+        pos = reference.pos + reference.length;
+    }
+    result.append(QStringView(after).mid(pos));
+    return result;
+}
+
+/*
+    Aho-Corasick automaton over the characters of a set of strings. The transitions are
+    stored as a complete table over the characters used in the strings, all other
+    characters lead back to the root state.
+*/
+class MultiStringMatcher
+{
+public:
+    explicit MultiStringMatcher(const QStringList &strings)
+        : m_classes(0x10000, 0)
+        , m_classCount(1)
+        , m_maxLength(0)
+    {
+        for (const QString &string : strings) {
+            for (const QChar &c : string) {
+                if (m_classes.at(c.unicode()) == 0)
+                    m_classes[c.unicode()] = quint16(m_classCount++);
+            }
+            m_lengths.append(string.size());
+            m_maxLength = qMax(m_maxLength, int(string.size()));
+        }
+
+        // trie
+        m_next.fill(-1, m_classCount);
+        m_output.append(-1);
+        for (int i = 0; i < strings.size(); ++i) {
+            int state = 0;
+            for (const QChar &c : strings.at(i)) {
+                const int index = state * m_classCount + m_classes.at(c.unicode());
+                if (m_next.at(index) < 0) {
+                    m_next[index] = m_output.size();
+                    m_next.resize(m_next.size() + m_classCount);
+                    std::fill(m_next.end() - m_classCount, m_next.end(), -1);
+                    m_output.append(-1);
+                }
+                state = m_next.at(index);
+            }
+            if (m_output.at(state) < 0)
+                m_output[state] = i;
+        }
+
+        // failure links folded into the transition table, breadth first
+        QVector<int> failure(m_output.size(), 0);
+        QVector<int> queue;
+        for (int c = 0; c < m_classCount; ++c) {
+            int &next = m_next[c];
+            if (next < 0)
+                next = 0;
+            else
+                queue.append(next);
+        }
+        for (int head = 0; head < queue.size(); ++head) {
+            const int state = queue.at(head);
+            if (m_output.at(state) < 0)
+                m_output[state] = m_output.at(failure.at(state));
+            for (int c = 0; c < m_classCount; ++c) {
+                const int index = state * m_classCount + c;
+                const int fallback = m_next.at(failure.at(state) * m_classCount + c);
+                if (m_next.at(index) < 0) {
+                    m_next[index] = fallback;
+                } else {
+                    failure[m_next.at(index)] = fallback;
+                    queue.append(m_next.at(index));
+                }
+            }
+        }
+    }
+
+    int maxLength() const { return m_maxLength; }
+
+    // Returns the start of the first occurrence that ends at or after from, or -1.
+    int indexIn(const QString &text, int from, int *stringIndex) const
+    {
+        const QChar *data = text.constData();
+        int state = 0;
+        for (int pos = from; pos < text.size(); ++pos) {
+            state = m_next.at(state * m_classCount + m_classes.at(data[pos].unicode()));
+            const int output = m_output.at(state);
+            if (output >= 0) {
+                *stringIndex = output;
+                return pos - m_lengths.at(output) + 1;
+            }
+        }
+        return -1;
+    }
+
+private:
+    QVector<quint16> m_classes;
+    int m_classCount;
+    int m_maxLength;
+    QVector<int> m_next;
+    QVector<int> m_output;
+    QVector<int> m_lengths;
+};
+
+/*
+    Replaces one string in text that arrives in chunks. A possible partial occurrence at
+    the end of a chunk is kept until the next chunk arrives.
+*/
+class StringReplaceStep
+{
+public:
+    StringReplaceStep(const QString &before, const QString &after)
+        : m_before(before)
+        , m_after(after)
+        , m_matcher(before)
+    {}
+
+    QString feed(const QString &input, bool atEnd, qint64 *count)
+    {
+        m_buffer += input;
+        QString output;
+        int pos = 0;
+        int index;
+        while ((index = m_matcher.indexIn(m_buffer, pos)) >= 0) {
+            output.append(QStringView(m_buffer).mid(pos, index - pos));
+            output.append(m_after);
+            pos = index + m_before.size();
+            ++*count;
+        }
+        const int keep = atEnd ? m_buffer.size() : qMax(pos, int(m_buffer.size() - m_before.size()) + 1);
+        output.append(QStringView(m_buffer).mid(pos, keep - pos));
+        m_buffer.remove(0, keep);
+        return output;
+    }
+
+private:
+    QString m_before;
+    QString m_after;
+    QStringMatcher m_matcher;
+    QString m_buffer;
+};
+
+/*
+    Replaces several strings in one scan over text that arrives in chunks.
+*/
+class MultiStringReplaceStep
+{
+public:
+    MultiStringReplaceStep(const QStringList &before, const QStringList &after)
+        : m_before(before)
+        , m_after(after)
+        , m_matcher(before)
+    {}
+
+    QString feed(const QString &input, bool atEnd, qint64 *count)
+    {
+        m_buffer += input;
+        QString output;
+        int pos = 0;
+        int index;
+        int stringIndex = -1;
+        while ((index = m_matcher.indexIn(m_buffer, pos, &stringIndex)) >= 0) {
+            output.append(QStringView(m_buffer).mid(pos, index - pos));
+            output.append(m_after.at(stringIndex));
+            pos = index + m_before.at(stringIndex).size();
+            ++*count;
+        }
+        const int keep = atEnd ? m_buffer.size() : qMax(pos, int(m_buffer.size()) - m_matcher.maxLength() + 1);
+        output.append(QStringView(m_buffer).mid(pos, keep - pos));
+        m_buffer.remove(0, keep);
+        return output;
+    }
+
+private:
+    QStringList m_before;
+    QStringList m_after;
+    MultiStringMatcher m_matcher;
+    QString m_buffer;
+};
+
+/*
+    Returns true if x and y can be placed so that they share at least one character and
+    agree on all shared characters.
+*/
+bool canOverlap(const QString &x, const QString &y)
+{
+    if (x.isEmpty() || y.isEmpty())
+        return false;
+
+    for (int offset = 1 - int(x.size()); offset < y.size(); ++offset) {
+        const int begin = qMax(0, offset);
+        const int end = qMin(int(y.size()), offset + int(x.size()));
+        if (QStringView(y).mid(begin, end - begin) == QStringView(x).mid(begin - offset, end - begin))
+            return true;
+    }
+    return false;
+}
+
+/*
+    Returns true if replacing all strings in one scan gives the same result as replacing
+    them one after the other. This is the case if no replacement string is empty and no
+    search string can overlap a preceding search or replacement string, because then no
+    replacement can create or destroy an occurrence of a following search string.
+*/
+bool canReplaceInOnePass(const QStringList &before, const QStringList &after)
+{
+    for (int i = 0; i < before.size(); ++i) {
+        if (after.at(i).isEmpty())
+            return false;
+        for (int j = 0; j < i; ++j) {
+            if (canOverlap(before.at(j), before.at(i)) || canOverlap(after.at(j), before.at(i)))
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+/*!
+    Constructs a replacer for the file \a fileName.
+*/
+StreamReplacer::StreamReplacer(const QString &fileName)
+    : m_fileName(fileName)
+    , m_chunkSize(DefaultChunkSize)
+    , m_replacementCount(0)
+{
+}
+
+/*!
+    Sets the number of characters read at once to \a size.
+*/
+void StreamReplacer::setChunkSize(int size)
+{
+    m_chunkSize = qMax(1, size);
+}
+
+/*!
+    \fn QInstaller::StreamReplacer::chunkSize() const
+
+    Returns the number of characters read at once.
+*/
+
+/*!
+    \fn QInstaller::StreamReplacer::replacementCount() const
+
+    Returns the number of replacements done by the last replace.
+*/
+
+/*!
+    \fn QInstaller::StreamReplacer::errorString() const
+
+    Returns a description of the last error.
+*/
+
+/*!
+    Replaces every occurrence of \a before with \a after, with the same result as
+    QString::replace() on the whole file content.
+*/
+StreamReplacer::Status StreamReplacer::replaceString(const QString &before, const QString &after)
+{
+    if (before.isEmpty())
+        return NoError;
+
+    StringReplaceStep step(before, after);
+    return process(QIODevice::NotOpen, [&](QTextStream &in, QTextStream &out) {
+        bool atEnd = false;
+        while (!atEnd) {
+            const QString chunk = in.read(m_chunkSize);
+            atEnd = in.atEnd();
+            out << step.feed(chunk, atEnd, &m_replacementCount);
+        }
+    });
+}
+
+/*!
+    Replaces the search strings in \a replacements with their replacement strings, with the
+    same result as calling QString::replace() for each pair in order, but with one pass
+    over the file. Empty search strings are ignored.
+
+    If no replacement can create or destroy an occurrence of a following search string,
+    all strings are found in a single scan with an Aho-Corasick automaton. Otherwise each
+    chunk runs through one replace step per pair.
+*/
+StreamReplacer::Status StreamReplacer::replaceStrings(const QVector<QPair<QString, QString>> &replacements)
+{
+    QStringList before;
+    QStringList after;
+    for (const auto &replacement : replacements) {
+        if (replacement.first.isEmpty())
+            continue;
+        before.append(replacement.first);
+        after.append(replacement.second);
+    }
+    if (before.isEmpty())
+        return NoError;
+
+    if (before.size() > 1 && canReplaceInOnePass(before, after)) {
+        MultiStringReplaceStep step(before, after);
+        return process(QIODevice::NotOpen, [&](QTextStream &in, QTextStream &out) {
+            bool atEnd = false;
+            while (!atEnd) {
+                const QString chunk = in.read(m_chunkSize);
+                atEnd = in.atEnd();
+                out << step.feed(chunk, atEnd, &m_replacementCount);
+            }
+        });
+    }
+
+    std::vector<StringReplaceStep> steps;
+    for (int i = 0; i < before.size(); ++i)
+        steps.emplace_back(before.at(i), after.at(i));
+    return process(QIODevice::NotOpen, [&](QTextStream &in, QTextStream &out) {
+        bool atEnd = false;
+        while (!atEnd) {
+            QString chunk = in.read(m_chunkSize);
+            atEnd = in.atEnd();
+            for (StringReplaceStep &step : steps)
+                chunk = step.feed(chunk, atEnd, &m_replacementCount);
+            out << chunk;
+        }
+    });
+}
+
+/*!
+    Replaces every match of \a regex with \a after, with the same result as
+    QString::replace() on the whole file content. Back references like \c{\1} in
+    \a after are expanded.
+*/
+StreamReplacer::Status StreamReplacer::replaceRegularExpression(const QRegularExpression &regex,
+    const QString &after)
+{
+    if (!regex.isValid())
+        return NoError;
+
+    const QVector<BackReference> references = backReferences(after, regex.captureCount());
+    return process(QIODevice::NotOpen, [&](QTextStream &in, QTextStream &out) {
+        QString buffer;
+        int start = 0; // text before start was written already and is kept as context only
+        bool skipEmptyMatchAtStart = false;
+        while (true) {
+            buffer += in.read(m_chunkSize);
+            const bool atEnd = in.atEnd();
+
+            // Unless all content was read, a match that reaches the end of the buffer and
+            // might continue in the next chunk is reported as partial match.
+            int pos = start;
+            int end = buffer.size();
+            bool lastMatchEmpty = false;
+            QRegularExpressionMatchIterator it = regex.globalMatch(buffer, start, atEnd
+                ? QRegularExpression::NormalMatch : QRegularExpression::PartialPreferFirstMatch);
+            while (it.hasNext()) {
+                const QRegularExpressionMatch match = it.next();
+                if (match.hasPartialMatch()) {
+                    end = match.capturedStart();
+                    break;
+                }
+                if (skipEmptyMatchAtStart && match.capturedStart() == start
+                        && match.capturedLength() == 0) {
+                    continue;   // already replaced with the previous chunk
+                }
+                out << QStringView(buffer).mid(pos, match.capturedStart() - pos)
+                    << expand(after, references, match);
+                pos = match.capturedEnd();
+                lastMatchEmpty = (match.capturedLength() == 0);
+                ++m_replacementCount;
+            }
+            if (atEnd) {
+                out << QStringView(buffer).mid(pos);
+                break;
+            }
+
+            end = qMax(pos, end);
+            out << QStringView(buffer).mid(pos, end - pos);
+
+            skipEmptyMatchAtStart = lastMatchEmpty && pos == end;
+            const int keepFrom = qMax(0, end - scContextSize);
+            buffer.remove(0, keepFrom);
+            start = end - keepFrom;
+        }
+    });
+}
+
+/*!
+    Replaces every line that starts with \a searchString, ignoring leading and trailing
+    whitespace, with \a replacement. The file is read and written in text mode.
+*/
+StreamReplacer::Status StreamReplacer::replaceLinesStartingWith(const QString &searchString,
+    const QString &replacement)
+{
+    return process(QIODevice::Text, [&](QTextStream &in, QTextStream &out) {
+        while (!in.atEnd()) {
+            const QString line = in.readLine();
+            if (line.trimmed().startsWith(searchString)) {
+                out << replacement << QLatin1Char('\n');
+                ++m_replacementCount;
+            } else {
+                out << line << QLatin1Char('\n');
+            }
+        }
+    });
+}
+
+/*!
+    \internal
+
+    Opens the file for reading and a temporary file for writing with the additional open
+    \a mode flags, and calls \a function with text streams on both. Replaces the file
+    with the temporary file afterwards.
+*/
+StreamReplacer::Status StreamReplacer::process(QIODevice::OpenMode mode,
+    const std::function<void (QTextStream &in, QTextStream &out)> &function)
+{
+    m_replacementCount = 0;
+    m_errorString.clear();
+
+    QFile source(m_fileName);
+    if (!source.open(QIODevice::ReadOnly | mode)) {
+        m_errorString = source.errorString();
+        return ReadError;
+    }
+
+    // QSaveFile creates its temporary file with the native file engine, which cannot
+    // write to locations only the elevated remote file engine has access to.
+    if (RemoteClient::instance().isActive())
+        return processInMemory(&source, mode, function);
+
+    QSaveFile target(m_fileName);
+    if (!target.open(QIODevice::WriteOnly | mode)) {
+        // no temporary file can be created next to the file
+        return processInMemory(&source, mode, function);
+    }
+
+    {
+        QTextStream in(&source);
+        QTextStream out(&target);
+        function(in, out);
+        out.flush();
+        if (out.status() != QTextStream::Ok) {
+            m_errorString = target.errorString();
+            target.cancelWriting();
+            return WriteError;
+        }
+    }
+    source.close();
+
+    if (!target.commit()) {
+        m_errorString = target.errorString();
+        return WriteError;
+    }
+    return NoError;
+}
+
+/*!
+    \internal
+
+    Reads the whole content of the open \a source into memory and closes it, and then
+    rewrites the file in place with a plain QFile, which uses the remote file engine if
+    it is active.
+*/
+StreamReplacer::Status StreamReplacer::processInMemory(QFile *source, QIODevice::OpenMode mode,
+    const std::function<void (QTextStream &in, QTextStream &out)> &function)
+{
+    QByteArray content = source->readAll();
+    if (source->error() != QFile::NoError) {
+        m_errorString = source->errorString();
+        return ReadError;
+    }
+    source->close();
+
+    // line endings were already converted when reading the source in text mode
+    QBuffer buffer(&content);
+    buffer.open(QIODevice::ReadOnly);
+
+    QFile target(m_fileName);
+    if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate | mode)) {
+        m_errorString = target.errorString();
+        return WriteError;
+    }
+
+    QTextStream in(&buffer);
+    QTextStream out(&target);
+    function(in, out);
+    out.flush();
+    if (out.status() != QTextStream::Ok) {
+        m_errorString = target.errorString();
+        return WriteError;
+    }
+    target.close();
+    return NoError;
+}
+
+} // namespace QInstaller
@@ -0,0 +1,86 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef STREAMREPLACER_H
+#define STREAMREPLACER_H
+
+#include "installer_global.h"
+
+#include <QIODevice>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(QFile)
+QT_FORWARD_DECLARE_CLASS(QRegularExpression)
+QT_FORWARD_DECLARE_CLASS(QTextStream)
+
+namespace QInstaller {
+
+class INSTALLER_EXPORT StreamReplacer
+{
+public:
+    enum Status {
+        NoError,
+        ReadError,
+        WriteError
+    };
+
+    static const int DefaultChunkSize = 4 * 1024 * 1024;
+
+    explicit StreamReplacer(const QString &fileName);
+
+    void setChunkSize(int size);
+    int chunkSize() const { return m_chunkSize; }
+
+    Status replaceString(const QString &before, const QString &after);
+    Status replaceStrings(const QVector<QPair<QString, QString>> &replacements);
+    Status replaceRegularExpression(const QRegularExpression &regex, const QString &after);
+    Status replaceLinesStartingWith(const QString &searchString, const QString &replacement);
+
+    qint64 replacementCount() const { return m_replacementCount; }
+    QString errorString() const { return m_errorString; }
+
+private:
+    Status process(QIODevice::OpenMode mode,
+        const std::function<void (QTextStream &in, QTextStream &out)> &function);
+    Status processInMemory(QFile *source, QIODevice::OpenMode mode,
+        const std::function<void (QTextStream &in, QTextStream &out)> &function);
+
+private:
+    QString m_fileName;
+    int m_chunkSize;
+    qint64 m_replacementCount;
+    QString m_errorString;
+};
+
+} // namespace QInstaller
+
+#endif // STREAMREPLACER_H
@@ -0,0 +1,473 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "tracelog.h"
+
+#include "errors.h"
+#include "globals.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+
+namespace QInstaller {
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::TraceLog
+    \brief The TraceLog class records timed spans of installer phases into a
+    compact binary ring buffer file.
+
+    Tracing is disabled by default and costs a single atomic load per span
+    in that case. Once open() is called, every finished span is written as a
+    fixed size record into a memory mapped file. When the buffer is full, the
+    oldest records are overwritten. Because the file is memory mapped, the
+    records written so far survive a crash of the application and can be
+    examined post-mortem with TraceReader or \c {devtool trace}.
+*/
+
+/*!
+    \enum TraceLog::Category
+    \brief This enum holds the installer phases a span can belong to.
+
+    \value Generic
+    \value Metadata
+           Fetching and parsing of repository metadata.
+    \value Download
+           Downloading of component archives.
+    \value Operation
+           Backup, perform and undo steps of operations.
+    \value Script
+           Calls into component and control scripts.
+    \value MaintenanceTool
+           Writing of the maintenance tool and its data file.
+*/
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::TraceSpan
+    \brief The TraceSpan class records the lifetime of a scope to the TraceLog.
+
+    The span is only measured if tracing was enabled on construction.
+*/
+
+/*!
+    \inmodule QtInstallerFramework
+    \class QInstaller::TraceReader
+    \brief The TraceReader class reads trace files written by TraceLog.
+*/
+
+static const char scTraceMagic[8] = { 'I', 'F', 'W', 'T', 'R', 'A', 'C', 'E' };
+static const quint32 scTraceVersion = 1;
+static const int scMaxNameLength = 32;
+
+struct TraceFileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 capacity;
+    quint32 recordSize;
+    quint32 reserved;
+    qint64 startTime;
+    quint64 sequence;
+    char padding[24];
+};
+
+struct TraceRecord
+{
+    quint64 sequence;
+    qint64 start;
+    qint64 duration;
+    quint64 threadId;
+    quint16 category;
+    quint8 nameLength;
+    quint8 detailLength;
+    char text[92];
+};
+
+Q_STATIC_ASSERT(sizeof(TraceFileHeader) == 64);
+Q_STATIC_ASSERT(sizeof(TraceRecord) == 128);
+
+// Returns the number of bytes from the beginning of \a utf8 that fit into
+// \a maxSize without splitting a multi-byte sequence.
+static int headLength(const QByteArray &utf8, int maxSize)
+{
+    if (utf8.size() <= maxSize)
+        return utf8.size();
+    int size = maxSize;
+    while (size > 0 && (uchar(utf8.at(size)) & 0xC0) == 0x80)
+        --size;
+    return size;
+}
+
+// Returns the offset of the tail of \a utf8 that fits into \a maxSize
+// without splitting a multi-byte sequence.
+static int tailOffset(const QByteArray &utf8, int maxSize)
+{
+    if (utf8.size() <= maxSize)
+        return 0;
+    int offset = utf8.size() - maxSize;
+    while (offset < utf8.size() && (uchar(utf8.at(offset)) & 0xC0) == 0x80)
+        ++offset;
+    return offset;
+}
+
+/*!
+    \internal
+*/
+TraceLog::TraceLog()
+    : m_data(nullptr)
+    , m_capacity(0)
+    , m_sequence(0)
+    , m_enabled(false)
+{
+}
+
+/*!
+    \internal
+*/
+TraceLog::~TraceLog()
+{
+    close();
+}
+
+/*!
+    Returns the only instance of this class.
+*/
+TraceLog &TraceLog::instance()
+{
+    static TraceLog instance;
+    return instance;
+}
+
+/*!
+    Creates the trace file \a fileName with room for \a capacity records and
+    enables tracing. Returns \c true on success, \c false otherwise. An error
+    description is stored in \a errorString if it is not \c nullptr.
+*/
+bool TraceLog::open(const QString &fileName, quint32 capacity, QString *errorString)
+{
+    QMutexLocker _(&m_mutex);
+    if (m_data) {
+        if (errorString)
+            *errorString = QString::fromLatin1("Trace file \"%1\" is already open.").arg(m_file.fileName());
+        return false;
+    }
+
+    capacity = qMax<quint32>(capacity, 1);
+    const qint64 size = qint64(sizeof(TraceFileHeader)) + qint64(capacity) * sizeof(TraceRecord);
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !m_file.resize(size)) {
+        if (errorString) {
+            *errorString = QString::fromLatin1("Cannot create trace file \"%1\": %2")
+                .arg(QDir::toNativeSeparators(fileName), m_file.errorString());
+        }
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, size);
+    if (!m_data) {
+        if (errorString) {
+            *errorString = QString::fromLatin1("Cannot map trace file \"%1\": %2")
+                .arg(QDir::toNativeSeparators(fileName), m_file.errorString());
+        }
+        m_file.close();
+        return false;
+    }
+    std::memset(m_data, 0, size_t(size));
+
+    TraceFileHeader *header = reinterpret_cast<TraceFileHeader *>(m_data);
+    std::memcpy(header->magic, scTraceMagic, sizeof(scTraceMagic));
+    header->version = scTraceVersion;
+    header->capacity = capacity;
+    header->recordSize = sizeof(TraceRecord);
+    header->startTime = QDateTime::currentMSecsSinceEpoch();
+
+    m_capacity = capacity;
+    m_sequence.storeRelaxed(0);
+    m_timer.start();
+    m_enabled.storeRelease(true);
+
+    qCDebug(QInstaller::lcInstallerInstallLog) << "Tracing installer phases to"
+        << QDir::toNativeSeparators(fileName);
+    return true;
+}
+
+/*!
+    Disables tracing and closes the trace file. Must not be called while
+    spans are still being recorded from other threads.
+*/
+void TraceLog::close()
+{
+    QMutexLocker _(&m_mutex);
+    if (!m_data)
+        return;
+
+    m_enabled.storeRelease(false);
+    reinterpret_cast<TraceFileHeader *>(m_data)->sequence = m_sequence.loadAcquire();
+    m_file.unmap(m_data);
+    m_file.close();
+    m_data = nullptr;
+}
+
+/*!
+    \fn QInstaller::TraceLog::isEnabled() const
+
+    Returns \c true if a trace file is open and spans are recorded.
+*/
+
+/*!
+    Returns the name of the current trace file.
+*/
+QString TraceLog::fileName() const
+{
+    QMutexLocker _(&m_mutex);
+    return m_file.fileName();
+}
+
+/*!
+    Returns the number of microseconds elapsed since the trace file was opened,
+    or \c -1 if tracing is disabled.
+*/
+qint64 TraceLog::timestamp() const
+{
+    if (!isEnabled())
+        return -1;
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+/*!
+    Records a span of \a category with \a name and \a detail that started
+    at \a start and finished at \a end. Both timestamps are in microseconds
+    as returned by timestamp(). Does nothing if tracing is disabled or
+    \a start is negative.
+*/
+void TraceLog::addSpan(Category category, const QString &name, const QString &detail,
+    qint64 start, qint64 end)
+{
+    if (!isEnabled() || start < 0)
+        return;
+
+    const quint64 sequence = m_sequence.fetchAndAddRelaxed(1) + 1;
+    TraceRecord *record = reinterpret_cast<TraceRecord *>(m_data + sizeof(TraceFileHeader))
+        + ((sequence - 1) % m_capacity);
+
+    record->sequence = 0; // mark the slot as incomplete while writing
+    record->start = start;
+    record->duration = qMax<qint64>(0, end - start);
+    record->threadId = quint64(quintptr(QThread::currentThreadId()));
+    record->category = category;
+
+    const QByteArray nameUtf8 = name.toUtf8();
+    const int nameLength = headLength(nameUtf8, scMaxNameLength);
+    std::memcpy(record->text, nameUtf8.constData(), size_t(nameLength));
+    record->nameLength = quint8(nameLength);
+
+    const QByteArray detailUtf8 = detail.toUtf8();
+    const int available = int(sizeof(record->text)) - nameLength;
+    const int offset = tailOffset(detailUtf8, available); // keep the end of long paths
+    const int detailLength = detailUtf8.size() - offset;
+    std::memcpy(record->text + nameLength, detailUtf8.constData() + offset, size_t(detailLength));
+    record->detailLength = quint8(detailLength);
+
+    record->sequence = sequence;
+}
+
+/*!
+    Records a span of \a category with \a name and \a detail that started at
+    \a start and finishes now.
+*/
+void TraceLog::addSpan(Category category, const QString &name, const QString &detail, qint64 start)
+{
+    if (!isEnabled() || start < 0)
+        return;
+    addSpan(category, name, detail, start, timestamp());
+}
+
+
+/*!
+    Starts a span of \a category with \a name and optional \a detail. The span
+    is recorded when the object is destroyed.
+*/
+TraceSpan::TraceSpan(TraceLog::Category category, const QString &name, const QString &detail)
+    : m_category(category)
+    , m_start(TraceLog::instance().timestamp())
+{
+    if (m_start < 0)
+        return;
+    m_name = name;
+    m_detail = detail;
+}
+
+/*!
+    Records the span if tracing was enabled on construction.
+*/
+TraceSpan::~TraceSpan()
+{
+    if (m_start < 0)
+        return;
+    TraceLog::instance().addSpan(m_category, m_name, m_detail, m_start);
+}
+
+/*!
+    Replaces the detail text of the span with \a detail.
+*/
+void TraceSpan::setDetail(const QString &detail)
+{
+    if (m_start >= 0)
+        m_detail = detail;
+}
+
+
+/*!
+    Reads all complete records from the trace file \a fileName and returns
+    them ordered by their sequence number. The wall clock time the trace was
+    started at, in milliseconds since epoch, is stored in \a startTime if it
+    is not \c nullptr. Throws Error if the file cannot be read or is not a
+    trace file.
+*/
+QList<TraceEvent> TraceReader::read(const QString &fileName, qint64 *startTime)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw Error(QString::fromLatin1("Cannot open trace file \"%1\" for reading: %2")
+            .arg(QDir::toNativeSeparators(fileName), file.errorString()));
+    }
+
+    const QByteArray data = file.readAll();
+    if (data.size() < int(sizeof(TraceFileHeader)))
+        throw Error(QString::fromLatin1("File \"%1\" is not a trace file.").arg(fileName));
+
+    TraceFileHeader header;
+    std::memcpy(&header, data.constData(), sizeof(TraceFileHeader));
+    if (std::memcmp(header.magic, scTraceMagic, sizeof(scTraceMagic)) != 0)
+        throw Error(QString::fromLatin1("File \"%1\" is not a trace file.").arg(fileName));
+    if (header.version != scTraceVersion || header.recordSize != sizeof(TraceRecord)) {
+        throw Error(QString::fromLatin1("Unsupported trace file version %1 in \"%2\".")
+            .arg(header.version).arg(fileName));
+    }
+    if (startTime)
+        *startTime = header.startTime;
+
+    const quint32 available = quint32((data.size() - sizeof(TraceFileHeader)) / sizeof(TraceRecord));
+    const quint32 count = qMin(header.capacity, available);
+
+    QList<TraceEvent> events;
+    events.reserve(int(count));
+    for (quint32 i = 0; i < count; ++i) {
+        TraceRecord record;
+        std::memcpy(&record, data.constData() + sizeof(TraceFileHeader) + i * sizeof(TraceRecord),
+            sizeof(TraceRecord));
+        if (record.sequence == 0)
+            continue;
+        if (int(record.nameLength) + int(record.detailLength) > int(sizeof(record.text)))
+            continue; // torn record
+
+        TraceEvent event;
+        event.sequence = record.sequence;
+        event.start = record.start;
+        event.duration = record.duration;
+        event.threadId = record.threadId;
+        event.category = static_cast<TraceLog::Category>(record.category);
+        event.name = QString::fromUtf8(record.text, record.nameLength);
+        event.detail = QString::fromUtf8(record.text + record.nameLength, record.detailLength);
+        events.append(event);
+    }
+
+    std::sort(events.begin(), events.end(), [](const TraceEvent &lhs, const TraceEvent &rhs) {
+        return lhs.sequence < rhs.sequence;
+    });
+    return events;
+}
+
+/*!
+    Returns \a events in the Chrome trace event JSON format, which can be
+    loaded into \c chrome://tracing or Perfetto.
+*/
+QByteArray TraceReader::toChromeTrace(const QList<TraceEvent> &events)
+{
+    QHash<quint64, int> threads;
+    QJsonArray traceEvents;
+    foreach (const TraceEvent &event, events) {
+        if (!threads.contains(event.threadId))
+            threads.insert(event.threadId, threads.count() + 1);
+
+        QJsonObject object;
+        object.insert(QLatin1String("name"), event.name);
+        object.insert(QLatin1String("cat"), categoryName(event.category));
+        object.insert(QLatin1String("ph"), QLatin1String("X"));
+        object.insert(QLatin1String("ts"), double(event.start));
+        object.insert(QLatin1String("dur"), double(event.duration));
+        object.insert(QLatin1String("pid"), 1);
+        object.insert(QLatin1String("tid"), threads.value(event.threadId));
+        if (!event.detail.isEmpty()) {
+            QJsonObject args;
+            args.insert(QLatin1String("detail"), event.detail);
+            object.insert(QLatin1String("args"), args);
+        }
+        traceEvents.append(object);
+    }
+
+    QJsonObject root;
+    root.insert(QLatin1String("traceEvents"), traceEvents);
+    root.insert(QLatin1String("displayTimeUnit"), QLatin1String("ms"));
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+/*!
+    Returns a human readable name for \a category.
+*/
+QString TraceReader::categoryName(TraceLog::Category category)
+{
+    switch (category) {
+    case TraceLog::Metadata:
+        return QLatin1String("metadata");
+    case TraceLog::Download:
+        return QLatin1String("download");
+    case TraceLog::Operation:
+        return QLatin1String("operation");
+    case TraceLog::Script:
+        return QLatin1String("script");
+    case TraceLog::MaintenanceTool:
+        return QLatin1String("maintenancetool");
+    default:
+        break;
+    }
+    return QLatin1String("generic");
+}
+
+} // namespace QInstaller
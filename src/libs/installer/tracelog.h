@@ -0,0 +1,126 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include "installer_global.h"
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+namespace QInstaller {
+
+class INSTALLER_EXPORT TraceLog
+{
+    Q_DISABLE_COPY(TraceLog)
+
+public:
+    enum Category : quint16 {
+        Generic = 0,
+        Metadata,
+        Download,
+        Operation,
+        Script,
+        MaintenanceTool
+    };
+
+    static const quint32 DefaultCapacity = 65536;
+
+    static TraceLog &instance();
+
+    bool open(const QString &fileName, quint32 capacity = DefaultCapacity,
+        QString *errorString = nullptr);
+    void close();
+
+    bool isEnabled() const { return m_enabled.loadAcquire(); }
+    QString fileName() const;
+
+    qint64 timestamp() const;
+    void addSpan(Category category, const QString &name, const QString &detail,
+        qint64 start, qint64 end);
+    void addSpan(Category category, const QString &name, const QString &detail, qint64 start);
+
+private:
+    TraceLog();
+    ~TraceLog();
+
+private:
+    QFile m_file;
+    uchar *m_data;
+    quint32 m_capacity;
+    QAtomicInteger<quint64> m_sequence;
+    QAtomicInt m_enabled;
+    QElapsedTimer m_timer;
+    mutable QMutex m_mutex;
+};
+
+class INSTALLER_EXPORT TraceSpan
+{
+    Q_DISABLE_COPY(TraceSpan)
+
+public:
+    TraceSpan(TraceLog::Category category, const QString &name,
+        const QString &detail = QString());
+    ~TraceSpan();
+
+    void setDetail(const QString &detail);
+
+private:
+    TraceLog::Category m_category;
+    QString m_name;
+    QString m_detail;
+    qint64 m_start;
+};
+
+struct INSTALLER_EXPORT TraceEvent
+{
+    quint64 sequence;
+    qint64 start;
+    qint64 duration;
+    quint64 threadId;
+    TraceLog::Category category;
+    QString name;
+    QString detail;
+};
+
+class INSTALLER_EXPORT TraceReader
+{
+public:
+    static QList<TraceEvent> read(const QString &fileName, qint64 *startTime = nullptr);
+    static QByteArray toChromeTrace(const QList<TraceEvent> &events);
+    static QString categoryName(TraceLog::Category category);
+};
+
+} // namespace QInstaller
+
+#endif // TRACELOG_H
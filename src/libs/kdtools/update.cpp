@@ -48,6 +48,12 @@ using namespace KDUpdater;
     Returns the package source.
 */
 
+/*!
+    \fn KDUpdater::Update::allData() const
+
+    Returns all data read for the update, keyed by element name.
+*/
+
 /*!
    \internal
 */
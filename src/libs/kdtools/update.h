@@ -39,6 +39,7 @@ class Update
 {
 public:
     QVariant data(const QString &name, const QVariant &defaultValue = QVariant()) const;
+    QHash<QString, QVariant> allData() const { return m_updateInfo.data; }
 
     QInstaller::PackageSource packageSource() const {return m_packageSource; }
 
@@ -30,6 +30,7 @@
 #include "updateoperation.h"
 
 #include "constants.h"
+#include "deletionservice.h"
 #include "fileutils.h"
 #include "packagemanagercore.h"
 #include "globals.h"
@@ -478,15 +479,19 @@ void UpdateOperation::registerForDelayedDeletion(const QStringList &files)
 }
 
 /*!
-    Tries to delete \a file. If \a file cannot be deleted, it is registered for delayed deletion.
+    Tries to delete \a file. The file is moved to the trash of DeletionService if possible,
+    otherwise it is deleted right away. If \a file cannot be deleted, it is registered for
+    delayed deletion.
 
     If a backup copy of the file cannot be created, returns \c false and displays the error
     message specified by \a errorString.
 */
 bool UpdateOperation::deleteFileNowOrLater(const QString &file, QString *errorString)
 {
-    if (file.isEmpty() || QFile::remove(file))
+    if (file.isEmpty() || QInstaller::DeletionService::instance().remove(file)
+            || QFile::remove(file)) {
         return true;
+    }
 
     if (!QFile::exists(file))
         return true;
@@ -538,7 +543,7 @@ bool UpdateOperation::deleteFileNowOrLater(const QString &file, QString *errorSt
     document. You can override this method to store your
     own extra-data. Extra-data can be any data that you need to store to perform or undo the
     operation. The default implementation is taking care of arguments and values set via
-    UpdateOperation::setValue().
+    UpdateOperation::setValue() for which isPersistentValue() returns \c true.
 */
 QDomDocument UpdateOperation::toXml() const
 {
@@ -547,18 +552,9 @@ QDomDocument UpdateOperation::toXml() const
     doc.appendChild(root);
 
     QDomElement args = doc.createElement(QLatin1String("arguments"));
-    const QString target = m_core ? m_core->value(QInstaller::scTargetDir) : QString();
-    Q_FOREACH (const QString &s, arguments()) {
+    Q_FOREACH (const QString &s, relocatableArguments()) {
         QDomElement arg = doc.createElement(QLatin1String("argument"));
-        // Do not call cleanPath to Execute operations paths. The operation might require the
-        // exact separators that are set in the operation call.
-        if (name() == QLatin1String("Execute")) {
-            arg.appendChild(doc.createTextNode(QInstaller::replacePath(s, target,
-                QLatin1String(QInstaller::scRelocatable), false)));
-        } else {
-            arg.appendChild(doc.createTextNode(QInstaller::replacePath(s, target,
-                QLatin1String(QInstaller::scRelocatable))));
-        }
+        arg.appendChild(doc.createTextNode(s));
         args.appendChild(arg);
     }
     root.appendChild(args);
@@ -566,10 +562,10 @@ QDomDocument UpdateOperation::toXml() const
         return doc;
 
     // append all values set with setValue
+    const QString target = m_core ? m_core->value(QInstaller::scTargetDir) : QString();
     QDomElement values = doc.createElement(QLatin1String("values"));
     for (QVariantMap::const_iterator it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
-        // the installer can't be put into XML, ignore
-        if (it.key() == QLatin1String("installer"))
+        if (!isPersistentValue(it.key()))
             continue;
 
         QDomElement value = doc.createElement(QLatin1String("value"));
@@ -609,40 +605,19 @@ QDomDocument UpdateOperation::toXml() const
 */
 bool UpdateOperation::fromXml(const QDomDocument &doc)
 {
-    QString target = QCoreApplication::applicationDirPath();
-    static const QLatin1String relocatable = QLatin1String(QInstaller::scRelocatable);
-    // Does not change target on non macOS platforms.
-    if (QInstaller::isInBundle(target, &target))
-        target = QDir::cleanPath(target + QLatin1String("/.."));
-
     QStringList args;
     const QDomElement root = doc.documentElement();
     const QDomElement argsElem = root.firstChildElement(QLatin1String("arguments"));
     Q_ASSERT(! argsElem.isNull());
     for (QDomNode n = argsElem.firstChild(); ! n.isNull(); n = n.nextSibling()) {
         const QDomElement e = n.toElement();
-        if (!e.isNull() && e.tagName() == QLatin1String("argument")) {
-            // Sniff the Execute -operations file path separator. The operation might be
-            // strict with the used path separator
-            bool useCleanPath = true;
-            if (name() == QLatin1String("Execute")) {
-                if (e.text().startsWith(relocatable) && e.text().size() > relocatable.size()) {
-                    const QChar separator = e.text().at(relocatable.size());
-                    if (separator == QLatin1Char('\\')) {
-                        target = QDir::toNativeSeparators(target);
-                        useCleanPath = false;
-                    }
-                }
-            }
-            args << QInstaller::replacePath(e.text(), relocatable,
-                target, useCleanPath);
-        }
+        if (!e.isNull() && e.tagName() == QLatin1String("argument"))
+            args << e.text();
     }
-    setArguments(args);
 
-    m_values.clear();
-    const QDomElement values = root.firstChildElement(QLatin1String("values"));
-    for (QDomNode n = values.firstChild(); !n.isNull(); n = n.nextSibling()) {
+    QVariantMap values;
+    const QDomElement valuesElem = root.firstChildElement(QLatin1String("values"));
+    for (QDomNode n = valuesElem.firstChild(); !n.isNull(); n = n.nextSibling()) {
         const QDomElement v = n.toElement();
         if (v.isNull() || v.tagName() != QLatin1String("value"))
             continue;
@@ -656,24 +631,130 @@ bool UpdateOperation::fromXml(const QDomDocument &doc)
         if (t == QVariant::List || t == QVariant::StringList || !var.convert(t)) {
             QDataStream stream(QByteArray::fromBase64( value.toLatin1()));
             stream >> var;
-            if (t == QVariant::StringList) {
-                QStringList list = var.toStringList();
-                for (int i = 0; i < list.count(); ++i) {
-                    list[i] = QInstaller::replacePath(list.at(i),
-                        relocatable, target);
+        }
+        values[name] = var;
+    }
+
+    restore(args, values);
+    return true;
+}
+
+/*!
+    Returns the arguments of the operation in the form they are stored in, with the
+    installation directory replaced by a placeholder. Execute operations keep the path
+    separators they were called with.
+*/
+QStringList UpdateOperation::relocatableArguments() const
+{
+    const QString target = m_core ? m_core->value(QInstaller::scTargetDir) : QString();
+    QStringList args;
+    Q_FOREACH (const QString &s, arguments()) {
+        // Do not call cleanPath to Execute operations paths. The operation might require the
+        // exact separators that are set in the operation call.
+        if (name() == QLatin1String("Execute")) {
+            args << QInstaller::replacePath(s, target,
+                QLatin1String(QInstaller::scRelocatable), false);
+        } else {
+            args << QInstaller::replacePath(s, target,
+                QLatin1String(QInstaller::scRelocatable));
+        }
+    }
+    return args;
+}
+
+/*!
+    Returns the values of the operation that are stored, see isPersistentValue(). The
+    installation directory is replaced by a placeholder in string and string list values,
+    all other values are returned unchanged.
+*/
+QVariantMap UpdateOperation::relocatableValues() const
+{
+    const QString target = m_core ? m_core->value(QInstaller::scTargetDir) : QString();
+    QVariantMap values;
+    for (QVariantMap::const_iterator it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+        if (!isPersistentValue(it.key()))
+            continue;
+
+        QVariant variant = it.value();
+        if (variant.type() == QVariant::String) {
+            variant = QInstaller::replacePath(variant.toString(), target,
+                QLatin1String(QInstaller::scRelocatable));
+        } else if (variant.type() == QVariant::StringList) {
+            QStringList list = variant.toStringList();
+            for (int i = 0; i < list.count(); ++i) {
+                list[i] = QInstaller::replacePath(list.at(i), target,
+                    QLatin1String(QInstaller::scRelocatable));
+            }
+            variant = QVariant::fromValue(list);
+        }
+        values.insert(it.key(), variant);
+    }
+    return values;
+}
+
+/*!
+    Restores the operation from \a arguments and \a values as returned by
+    relocatableArguments() and relocatableValues(). The placeholder for the installation
+    directory is resolved the same way as in fromXml(). \note: Clears all previously set
+    values and arguments.
+*/
+void UpdateOperation::restore(const QStringList &arguments, const QVariantMap &values)
+{
+    QString target = QCoreApplication::applicationDirPath();
+    static const QLatin1String relocatable = QLatin1String(QInstaller::scRelocatable);
+    // Does not change target on non macOS platforms.
+    if (QInstaller::isInBundle(target, &target))
+        target = QDir::cleanPath(target + QLatin1String("/.."));
+
+    QStringList args;
+    for (const QString &argument : arguments) {
+        // Sniff the Execute -operations file path separator. The operation might be
+        // strict with the used path separator
+        bool useCleanPath = true;
+        if (name() == QLatin1String("Execute")) {
+            if (argument.startsWith(relocatable) && argument.size() > relocatable.size()) {
+                const QChar separator = argument.at(relocatable.size());
+                if (separator == QLatin1Char('\\')) {
+                    target = QDir::toNativeSeparators(target);
+                    useCleanPath = false;
                 }
-                var = QVariant::fromValue(list);
             }
-        } else if (t == QVariant::String) {
-              const QString str = QInstaller::replacePath(value,
+        }
+        args << QInstaller::replacePath(argument, relocatable,
+            target, useCleanPath);
+    }
+    setArguments(args);
+
+    m_values.clear();
+    for (QVariantMap::const_iterator it = values.constBegin(); it != values.constEnd(); ++it) {
+        QVariant var = it.value();
+        if (var.type() == QVariant::StringList) {
+            QStringList list = var.toStringList();
+            for (int i = 0; i < list.count(); ++i) {
+                list[i] = QInstaller::replacePath(list.at(i),
+                    relocatable, target);
+            }
+            var = QVariant::fromValue(list);
+        } else if (var.type() == QVariant::String) {
+              const QString str = QInstaller::replacePath(var.toString(),
                         relocatable, target);
               var = QVariant::fromValue(str);
         }
 
-        m_values[name] = var;
+        m_values[it.key()] = var;
     }
+}
 
-    return true;
+/*!
+    Returns \c true if the value \a name is stored together with the operation by toXml()
+    and relocatableValues(). The default implementation stores all values except the
+    installer. Subclasses can override this to leave out values that are only needed while
+    the operation runs.
+*/
+bool UpdateOperation::isPersistentValue(const QString &name) const
+{
+    // the installer can't be stored, ignore
+    return name != QLatin1String("installer");
 }
 
 /*!
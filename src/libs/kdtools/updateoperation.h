@@ -99,6 +99,9 @@ public:
     virtual QDomDocument toXml() const;
     virtual bool fromXml(const QString &xml);
     virtual bool fromXml(const QDomDocument &doc);
+    QStringList relocatableArguments() const;
+    QVariantMap relocatableValues() const;
+    void restore(const QStringList &arguments, const QVariantMap &values);
 
     virtual quint64 sizeHint();
 
@@ -115,6 +118,7 @@ protected:
     QStringList parseUndoOperationArguments();
     void setRequiresUnreplacedVariables(bool isRequired);
     bool variableReplacement(QString *variableValue);
+    virtual bool isPersistentValue(const QString &name) const;
 
 private:
     QString m_name;
@@ -181,14 +181,14 @@ bool CopyOperation::performOperation()
         }
     }
 
-    const bool copied = sourceFile.copy(destination);
-    if (!copied) {
+    try {
+        QInstaller::copyFile(source, destination);
+    } catch (const QInstaller::Error &error) {
         setError(UserDefinedError);
-        setErrorString(tr("Cannot copy file \"%1\" to \"%2\": %3").arg(
-                           QDir::toNativeSeparators(source), QDir::toNativeSeparators(destination),
-                           sourceFile.errorString()));
+        setErrorString(error.message());
+        return false;
     }
-    return copied;
+    return true;
 }
 
 bool CopyOperation::undoOperation()
@@ -225,19 +225,11 @@ bool CopyOperation::undoOperation()
 /*!
  \reimp
  */
-QDomDocument CopyOperation::toXml() const
+bool CopyOperation::isPersistentValue(const QString &name) const
 {
     // we don't want to save the backupOfExistingDestination
-    if (!hasValue(QLatin1String("backupOfExistingDestination")))
-        return UpdateOperation::toXml();
-
-    CopyOperation *const me = const_cast<CopyOperation *>(this);
-
-    const QVariant v = value(QLatin1String("backupOfExistingDestination"));
-    me->clearValue(QLatin1String("backupOfExistingDestination"));
-    const QDomDocument xml = UpdateOperation::toXml();
-    me->setValue(QLatin1String("backupOfExistingDestination"), v);
-    return xml;
+    return name != QLatin1String("backupOfExistingDestination")
+        && UpdateOperation::isPersistentValue(name);
 }
 
 bool CopyOperation::testOperation()
@@ -420,19 +412,11 @@ bool DeleteOperation::testOperation()
 /*!
  \reimp
  */
-QDomDocument DeleteOperation::toXml() const
+bool DeleteOperation::isPersistentValue(const QString &name) const
 {
     // we don't want to save the backupOfExistingFile
-    if (!hasValue(QLatin1String("backupOfExistingFile")))
-        return UpdateOperation::toXml();
-
-    DeleteOperation *const me = const_cast<DeleteOperation *>(this);
-
-    const QVariant v = value(QLatin1String("backupOfExistingFile"));
-    me->clearValue(QLatin1String("backupOfExistingFile"));
-    const QDomDocument xml = UpdateOperation::toXml();
-    me->setValue(QLatin1String("backupOfExistingFile"), v);
-    return xml;
+    return name != QLatin1String("backupOfExistingFile")
+        && UpdateOperation::isPersistentValue(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -46,7 +46,9 @@ public:
     bool undoOperation() override;
     bool testOperation() override;
 
-    QDomDocument toXml() const override;
+protected:
+    bool isPersistentValue(const QString &name) const override;
+
 private:
     QString sourcePath();
     QString destinationPath();
@@ -77,7 +79,8 @@ public:
     bool undoOperation() override;
     bool testOperation() override;
 
-    QDomDocument toXml() const override;
+protected:
+    bool isPersistentValue(const QString &name) const override;
 };
 
 class KDTOOLS_EXPORT MkdirOperation : public UpdateOperation
@@ -133,6 +133,8 @@ bool UpdatesInfoData::parsePackageUpdateElement(QXmlStreamReader &reader, const
             info.data[QLatin1String("UncompressedSize")] = reader.attributes().value(QLatin1String("UncompressedSize")).toString();
         } else if (elementName == QLatin1String("Operations")) {
             parseOperations(reader, info.data);
+        } else if (elementName == QLatin1String("DeltaArchives")) {
+            parseDeltaArchives(reader, info.data);
         } else if (elementName == QLatin1String("Script")) {
             const QXmlStreamAttributes attr = reader.attributes();
             const bool postLoad = attr.value(QLatin1String("postLoad")).toString().toLower() == QInstaller::scTrue ? true : false;
@@ -235,6 +237,28 @@ void UpdatesInfoData::parseLicenses(QXmlStreamReader &reader, QHash<QString, QVa
     if (!licenseHash.isEmpty())
         info.insert(QLatin1String("Licenses"), licenseHash);
 }
+
+void UpdatesInfoData::parseDeltaArchives(QXmlStreamReader &reader, QHash<QString, QVariant> &info) const
+{
+    QHash<QString, QVariant> deltaHash;
+    while (reader.readNext()) {
+        const QString subElementName = reader.name().toString();
+        // End of parsing DeltaArchives
+        if ((subElementName == QLatin1String("DeltaArchives"))
+                && (reader.tokenType() == QXmlStreamReader::EndElement)) {
+            break;
+        }
+        if (subElementName != QLatin1String("DeltaArchive") || reader.tokenType() == QXmlStreamReader::EndElement)
+            continue;
+        const QXmlStreamAttributes attr = reader.attributes();
+        QVariantMap attributes;
+        attributes.insert(QLatin1String("archive"), attr.value(QLatin1String("archive")).toString());
+        attributes.insert(QLatin1String("base"), attr.value(QLatin1String("base")).toString());
+        deltaHash.insert(reader.readElementText(), attributes);
+    }
+    if (!deltaHash.isEmpty())
+        info.insert(QLatin1String("DeltaArchives"), deltaHash);
+}
 //
 // UpdatesInfo
 //
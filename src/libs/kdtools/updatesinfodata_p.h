@@ -63,6 +63,7 @@ private:
     void processLocalizedTag(QXmlStreamReader &reader, QHash<QString, QVariant> &info) const;
     void parseOperations(QXmlStreamReader &reader, QHash<QString, QVariant> &info) const;
     void parseLicenses(QXmlStreamReader &reader, QHash<QString, QVariant> &info) const;
+    void parseDeltaArchives(QXmlStreamReader &reader, QHash<QString, QVariant> &info) const;
 };
 
 } // namespace KDUpdater
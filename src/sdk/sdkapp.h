@@ -48,6 +48,7 @@
 #include <errors.h>
 #include <loggingutils.h>
 #include <scriptengine.h>
+#include <tracelog.h>
 
 #include <QApplication>
 #include <QDir>
@@ -369,6 +370,15 @@ public:
             QInstaller::PackageManagerCore::setMaxConcurrentOperations(count);
         }
 
+        if (m_parser.isSet(CommandLineOptions::scTraceFileLong)) {
+            QString traceError;
+            if (!QInstaller::TraceLog::instance().open(m_parser.value(CommandLineOptions::scTraceFileLong),
+                    QInstaller::TraceLog::DefaultCapacity, &traceError)) {
+                errorMessage = traceError;
+                return false;
+            }
+        }
+
         if (m_parser.isSet(CommandLineOptions::scAcceptLicensesLong))
             m_core->setAutoAcceptLicenses();
 
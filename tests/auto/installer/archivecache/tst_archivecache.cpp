@@ -0,0 +1,201 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "archivecache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_ArchiveCache : public QObject
+{
+    Q_OBJECT
+
+private:
+    QByteArray writeArchive(const QString &fileName, const QByteArray &content)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size())
+            return QByteArray();
+        return QCryptographicHash::hash(content, QCryptographicHash::Sha1).toHex();
+    }
+
+    QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+private slots:
+    void init()
+    {
+        m_dir.reset(new QTemporaryDir);
+        QVERIFY(m_dir->isValid());
+        m_cachePath = ArchiveCache::archiveCachePath(m_dir->filePath(QLatin1String("cache")));
+    }
+
+    void testValidChecksum()
+    {
+        QVERIFY(ArchiveCache::isValidChecksum("da39a3ee5e6b4b0d3255bfef95601890afd80709"));
+        QVERIFY(!ArchiveCache::isValidChecksum("DA39A3EE5E6B4B0D3255BFEF95601890AFD80709"));
+        QVERIFY(!ArchiveCache::isValidChecksum("da39a3ee5e6b4b0d3255bfef95601890afd8070"));
+        QVERIFY(!ArchiveCache::isValidChecksum("../../../../../../../../../../../../etc"));
+        QVERIFY(!ArchiveCache::isValidChecksum(QByteArray()));
+    }
+
+    void testStoreAndFetch()
+    {
+        const QString source = m_dir->filePath(QLatin1String("content.7z"));
+        const QByteArray content("archive contents");
+        const QByteArray checksum = writeArchive(source, content);
+
+        {
+            ArchiveCache cache(m_cachePath);
+            QVERIFY(cache.isValid());
+            QVERIFY(cache.store(checksum, source));
+            QCOMPARE(cache.items().count(), 1);
+        }
+
+        // A new cache object restores the items from the manifest
+        ArchiveCache cache(m_cachePath);
+        QVERIFY(cache.isValid());
+        QCOMPARE(cache.items().count(), 1);
+
+        const QString target = m_dir->filePath(QLatin1String("target/content.7z"));
+        QVERIFY(cache.fetch(checksum, target));
+        QCOMPARE(readFile(target), content);
+
+        QVERIFY(!cache.fetch(QCryptographicHash::hash("missing", QCryptographicHash::Sha1).toHex(),
+            target));
+    }
+
+    void testStoreRejectsInvalidChecksum()
+    {
+        const QString source = m_dir->filePath(QLatin1String("content.7z"));
+        writeArchive(source, "archive contents");
+
+        ArchiveCache cache(m_cachePath);
+        QVERIFY(!cache.store("not-a-checksum", source));
+        QVERIFY(cache.items().isEmpty());
+    }
+
+    void testFetchRemovesCorruptArchive()
+    {
+        const QString source = m_dir->filePath(QLatin1String("content.7z"));
+        const QByteArray checksum = writeArchive(source, "archive contents");
+
+        ArchiveCache cache(m_cachePath);
+        QVERIFY(cache.store(checksum, source));
+
+        QFile cached(cache.itemByChecksum(checksum)->fileName());
+        QVERIFY(cached.open(QIODevice::WriteOnly));
+        QVERIFY(cached.write("tampered") > 0);
+        cached.close();
+
+        const QString target = m_dir->filePath(QLatin1String("target.7z"));
+        QVERIFY(!cache.fetch(checksum, target));
+        QVERIFY(!QFile::exists(target));
+        QVERIFY(!cache.itemByChecksum(checksum));
+    }
+
+    void testSizeLimit()
+    {
+        const QString source = m_dir->filePath(QLatin1String("content.7z"));
+        const QByteArray checksum = writeArchive(source, QByteArray(64, 'x'));
+
+        ArchiveCache cache(m_cachePath);
+        cache.setSizeLimit(32);
+        QVERIFY(!cache.store(checksum, source));
+        QVERIFY(cache.items().isEmpty());
+    }
+
+    void testEvictLeastRecentlyUsed()
+    {
+        QList<QByteArray> checksums;
+        {
+            ArchiveCache cache(m_cachePath);
+            for (int i = 0; i < 3; ++i) {
+                const QString source = m_dir->filePath(QString::fromLatin1("content%1.7z").arg(i));
+                checksums.append(writeArchive(source, QByteArray(10, char('a' + i))));
+                QVERIFY(cache.store(checksums.last(), source));
+            }
+
+            // Make the first archive the most recently used one
+            const QDateTime now = QDateTime::currentDateTimeUtc();
+            for (int i = 0; i < 3; ++i) {
+                QFile file(cache.itemByChecksum(checksums.at(i))->fileName());
+                QVERIFY(file.open(QIODevice::ReadWrite));
+                QVERIFY(file.setFileTime(now.addSecs(i == 0 ? 60 : i), QFileDevice::FileModificationTime));
+            }
+        }
+
+        ArchiveCache cache(m_cachePath);
+        cache.setSizeLimit(20);
+        cache.evict();
+
+        QCOMPARE(cache.items().count(), 2);
+        QVERIFY(cache.itemByChecksum(checksums.at(0)));
+        QVERIFY(!cache.itemByChecksum(checksums.at(1)));
+        QVERIFY(cache.itemByChecksum(checksums.at(2)));
+    }
+
+    void testSecondInstanceCannotLock()
+    {
+        ArchiveCache cache(m_cachePath);
+        QVERIFY(cache.isValid());
+
+        ArchiveCache other(m_cachePath);
+        QVERIFY(!other.isValid());
+    }
+
+    void testClear()
+    {
+        const QString source = m_dir->filePath(QLatin1String("content.7z"));
+        const QByteArray checksum = writeArchive(source, "archive contents");
+
+        ArchiveCache cache(m_cachePath);
+        QVERIFY(cache.store(checksum, source));
+        QVERIFY(cache.clear());
+        QVERIFY(!QFile::exists(m_cachePath));
+    }
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_cachePath;
+};
+
+QTEST_MAIN(tst_ArchiveCache)
+
+#include "tst_archivecache.moc"
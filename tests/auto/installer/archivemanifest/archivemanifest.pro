@@ -0,0 +1,5 @@
+include(../../qttest.pri)
+
+QT += qml
+
+SOURCES += tst_archivemanifest.cpp
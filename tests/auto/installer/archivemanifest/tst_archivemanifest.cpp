@@ -0,0 +1,180 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "../shared/packagemanager.h"
+
+#include <repositorygen.h>
+#include <repositorygen.cpp>
+
+#include <QDateTime>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_ArchiveManifest : public QObject
+{
+    Q_OBJECT
+
+private:
+    bool writeFile(const QString &fileName, const QByteArray &content)
+    {
+        if (!QDir().mkpath(QFileInfo(fileName).absolutePath()))
+            return false;
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly) && file.write(content) == content.size();
+    }
+
+    QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+    bool writePackage(const QString &packageDir, const QString &name, const QString &version,
+        const QHash<QString, QByteArray> &files, const QByteArray &script = QByteArray())
+    {
+        QByteArray packageXml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Package>\n"
+            "    <DisplayName>" + name.toLatin1() + "</DisplayName>\n"
+            "    <Description>" + name.toLatin1() + "</Description>\n"
+            "    <Version>" + version.toLatin1() + "</Version>\n"
+            "    <ReleaseDate>2023-01-01</ReleaseDate>\n";
+        if (!script.isEmpty()) {
+            packageXml += "    <Script>installscript.qs</Script>\n";
+            if (!writeFile(packageDir + '/' + name + "/meta/installscript.qs", script))
+                return false;
+        }
+        packageXml += "</Package>\n";
+        if (!writeFile(packageDir + '/' + name + "/meta/package.xml", packageXml))
+            return false;
+
+        for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+            if (!writeFile(packageDir + '/' + name + "/data/" + it.key(), it.value()))
+                return false;
+        }
+        return true;
+    }
+
+    void generateRepo(const QString &packageDir, const QString &repositoryDir)
+    {
+        QInstallerTools::RepositoryInfo info;
+        info.packages << packageDir;
+        info.repositoryDir = repositoryDir;
+
+        QStringList filteredPackages;
+        QInstallerTools::PackageInfoVector packages = QInstallerTools::collectPackages(info,
+            &filteredPackages, QInstallerTools::Exclude, false, QStringList());
+
+        QTemporaryDir tmpMetaDir;
+        QInstallerTools::createRepository(info, &packages, tmpMetaDir.path(), true, false,
+            QLatin1String("7z"), QInstallerTools::Compression::Normal, false, true);
+    }
+
+    void setRepository(const QString &repository, PackageManagerCore *core)
+    {
+        core->reset();
+        core->cancelMetaInfoJob(); //Call cancel to reset metadata so that update repositories are fetched
+
+        QSet<Repository> repoList;
+        repoList.insert(Repository::fromUserInput(repository));
+        core->settings().setDefaultRepositories(repoList);
+    }
+
+private slots:
+    void testUpdateKeepsUnchangedFiles()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString installDir = dir.path() + "/install";
+        QVERIFY(QDir().mkpath(installDir));
+
+        QScopedPointer<PackageManagerCore> core(PackageManager::getPackageManagerWithInit(installDir,
+            dir.path() + "/repository1"));
+
+        QHash<QString, QByteArray> filesA;
+        filesA.insert("unchanged.txt", "unchanged content\n");
+        filesA.insert("changed.txt", "old content\n");
+        filesA.insert("removed.txt", "removed content\n");
+        QHash<QString, QByteArray> filesB;
+        filesB.insert("moved.txt", "moved content\n");
+        QVERIFY(writePackage(dir.path() + "/packages1", "A", "1.0.0", filesA));
+        QVERIFY(writePackage(dir.path() + "/packages1", "B", "1.0.0", filesB));
+        generateRepo(dir.path() + "/packages1", dir.path() + "/repository1");
+
+        // Same size, but different content for changed.txt. B extracts its archive into
+        // another directory, so the installed moved.txt does not belong to the update.
+        filesA.insert("changed.txt", "new content\n");
+        filesA.remove("removed.txt");
+        QVERIFY(writePackage(dir.path() + "/packages2", "A", "2.0.0", filesA));
+        QVERIFY(writePackage(dir.path() + "/packages2", "B", "2.0.0", filesB,
+            "function Component() {}\n"
+            "Component.prototype.createOperationsForArchive = function(archive)\n"
+            "{\n"
+            "    component.addOperation(\"Extract\", archive, \"@TargetDir@/sub\");\n"
+            "}\n"));
+        generateRepo(dir.path() + "/packages2", dir.path() + "/repository2");
+
+        QCOMPARE(core->installSelectedComponentsSilently(QStringList() << "A" << "B"),
+            PackageManagerCore::Success);
+        QCOMPARE(readFile(installDir + "/changed.txt"), QByteArray("old content\n"));
+        QVERIFY(QFileInfo::exists(installDir + "/removed.txt"));
+        QVERIFY(QFileInfo::exists(installDir + "/moved.txt"));
+
+        // Extracting restores the modification time from the archive, an unchanged file
+        // that is neither removed nor extracted again keeps this one.
+        const QDateTime marker(QDate(2001, 1, 1), QTime(12, 0), Qt::UTC);
+        QFile unchanged(installDir + "/unchanged.txt");
+        QVERIFY(unchanged.open(QIODevice::ReadWrite));
+        QVERIFY(unchanged.setFileTime(marker, QFileDevice::FileModificationTime));
+        unchanged.close();
+        QFile moved(installDir + "/moved.txt");
+        QVERIFY(moved.open(QIODevice::ReadWrite));
+        QVERIFY(moved.setFileTime(marker, QFileDevice::FileModificationTime));
+        moved.close();
+
+        core->commitSessionOperations();
+        core->setPackageManager();
+        setRepository(dir.path() + "/repository2", core.data());
+        QCOMPARE(core->updateComponentsSilently(QStringList()), PackageManagerCore::Success);
+
+        QCOMPARE(readFile(installDir + "/unchanged.txt"), QByteArray("unchanged content\n"));
+        QCOMPARE(QFileInfo(installDir + "/unchanged.txt").lastModified().toUTC(), marker);
+        QCOMPARE(readFile(installDir + "/changed.txt"), QByteArray("new content\n"));
+        QVERIFY(!QFileInfo::exists(installDir + "/removed.txt"));
+
+        QVERIFY(!QFileInfo::exists(installDir + "/moved.txt"));
+        QCOMPARE(readFile(installDir + "/sub/moved.txt"), QByteArray("moved content\n"));
+        QVERIFY(QFileInfo(installDir + "/sub/moved.txt").lastModified().toUTC() != marker);
+    }
+};
+
+QTEST_MAIN(tst_ArchiveManifest)
+
+#include "tst_archivemanifest.moc"
@@ -0,0 +1,166 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "binarydelta.h"
+#include "errors.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_BinaryDelta : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString writeFile(const QString &name, const QByteArray &content)
+    {
+        const QString fileName = m_dir.filePath(name);
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size())
+            return QString();
+        return fileName;
+    }
+
+    QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+    QByteArray randomData(int size)
+    {
+        QByteArray data(size, '\0');
+        QRandomGenerator generator(42);
+        for (int i = 0; i < size; ++i)
+            data[i] = char(generator.bounded(256));
+        return data;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void testRoundTrip_data()
+    {
+        QTest::addColumn<QByteArray>("source");
+        QTest::addColumn<QByteArray>("target");
+
+        const QByteArray data = randomData(256 * 1024);
+        QByteArray modified = data;
+        modified.replace(1000, 16, QByteArray(16, 'x'));
+        modified.insert(50000, QByteArray("inserted bytes"));
+        modified.remove(120000, 300);
+
+        QTest::newRow("identical") << data << data;
+        QTest::newRow("modified") << data << modified;
+        QTest::newRow("appended") << data << (data + randomData(100));
+        QTest::newRow("empty source") << QByteArray() << data.left(1000);
+        QTest::newRow("empty target") << data << QByteArray();
+        QTest::newRow("small") << QByteArray("abc") << QByteArray("abcd");
+    }
+
+    void testRoundTrip()
+    {
+        QFETCH(QByteArray, source);
+        QFETCH(QByteArray, target);
+
+        const QString sourceFile = writeFile(QLatin1String("source"), source);
+        const QString targetFile = writeFile(QLatin1String("target"), target);
+        const QString deltaFile = m_dir.filePath(QLatin1String("delta"));
+        const QString resultFile = m_dir.filePath(QLatin1String("result"));
+
+        BinaryDelta::create(sourceFile, targetFile, deltaFile);
+        const QByteArray checksum = BinaryDelta::apply(sourceFile, deltaFile, resultFile);
+
+        QCOMPARE(readFile(resultFile), target);
+        QCOMPARE(checksum, QCryptographicHash::hash(target, QCryptographicHash::Sha1));
+    }
+
+    void testDeltaIsSmall()
+    {
+        const QByteArray source = randomData(512 * 1024);
+        QByteArray target = source;
+        target.replace(4096, 64, QByteArray(64, 'y'));
+
+        const QString sourceFile = writeFile(QLatin1String("source"), source);
+        const QString targetFile = writeFile(QLatin1String("target"), target);
+        const QString deltaFile = m_dir.filePath(QLatin1String("delta"));
+
+        BinaryDelta::create(sourceFile, targetFile, deltaFile);
+        QVERIFY(QFileInfo(deltaFile).size() < 1024);
+    }
+
+    void testWrongSource()
+    {
+        const QString sourceFile = writeFile(QLatin1String("source"), randomData(4096));
+        const QString targetFile = writeFile(QLatin1String("target"), randomData(2048));
+        const QString deltaFile = m_dir.filePath(QLatin1String("delta"));
+        BinaryDelta::create(sourceFile, targetFile, deltaFile);
+
+        const QString otherFile = writeFile(QLatin1String("other"), QByteArray(4096, 'z'));
+        QVERIFY_EXCEPTION_THROWN(BinaryDelta::apply(otherFile, deltaFile,
+            m_dir.filePath(QLatin1String("result"))), Error);
+    }
+
+    void testCorruptDelta()
+    {
+        const QByteArray source = randomData(4096);
+        QByteArray target = source;
+        target.insert(100, QByteArray("some new content"));
+
+        const QString sourceFile = writeFile(QLatin1String("source"), source);
+        const QString targetFile = writeFile(QLatin1String("target"), target);
+        const QString deltaFile = m_dir.filePath(QLatin1String("delta"));
+        BinaryDelta::create(sourceFile, targetFile, deltaFile);
+
+        QByteArray delta = readFile(deltaFile);
+        delta.truncate(delta.size() - 5);
+        writeFile(QLatin1String("delta"), delta);
+
+        QVERIFY_EXCEPTION_THROWN(BinaryDelta::apply(sourceFile, deltaFile,
+            m_dir.filePath(QLatin1String("result"))), Error);
+    }
+
+private:
+    QTemporaryDir m_dir;
+};
+
+QTEST_MAIN(tst_BinaryDelta)
+
+#include "tst_binarydelta.moc"
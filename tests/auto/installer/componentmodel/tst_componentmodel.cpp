@@ -31,6 +31,7 @@
 #include "updatesinfo_p.h"
 #include "packagemanagercore.h"
 
+#include <QSignalSpy>
 #include <QTest>
 #include <QtCore/QLocale>
 
@@ -369,6 +370,46 @@ private slots:
             delete component;
     }
 
+    void testFetchMore()
+    {
+        setPackageManagerOptions(NoFlags);
+
+        QList<Component*> rootComponents = loadComponents();
+        testComponentsLoaded(rootComponents);
+
+        ComponentModel model(1, &m_core);
+        model.reset(rootComponents);
+
+        // only the root components are reported initially
+        const QModelIndex parent = model.indexFromComponentName(vendorSecondProduct);
+        const QModelIndex subnode = model.indexFromComponentName(vendorSecondProductSubnode);
+        QVERIFY(model.hasChildren(parent));
+        QVERIFY(model.canFetchMore(parent));
+        QCOMPARE(model.rowCount(parent), 0);
+        QVERIFY(model.canFetchMore(subnode));
+
+        // components can be changed before they were fetched
+        const QModelIndex sub = model.indexFromComponentName(vendorSecondProductSubnodeSub);
+        QVERIFY(model.setData(sub, Qt::Checked, Qt::CheckStateRole));
+        QVERIFY(model.checked().contains(model.componentFromIndex(sub)));
+
+        QSignalSpy spy(&model, &ComponentModel::rowsInserted);
+        model.fetchAncestors(sub);
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(spy.at(0).at(0).value<QModelIndex>(), parent);
+        QCOMPARE(spy.at(1).at(0).value<QModelIndex>(), subnode);
+        QCOMPARE(model.rowCount(parent), 3);
+        QCOMPARE(model.rowCount(subnode), 1);
+        QCOMPARE(model.index(0, 0, subnode), sub);
+
+        // fetching again does nothing
+        model.fetchAll();
+        QCOMPARE(spy.count(), 2);
+
+        foreach (Component *const component, rootComponents)
+            delete component;
+    }
+
     void testComponentsLocalization()
     {
         QStringList localesToTest = { "en_US", "ru_RU", "de_DE", "fr_FR" };
@@ -475,7 +516,14 @@ private:
         const QModelIndex forthParent = model->indexFromComponentName(vendorSecondProductSubnode);
         QCOMPARE(model->parent(model->indexFromComponentName(vendorSecondProductSubnodeSub)), forthParent);
 
+        // children are reported after they were fetched
+        QVERIFY(model->hasChildren(secondParent));
+        if (model->canFetchMore(secondParent))
+            model->fetchMore(secondParent);
+        QVERIFY(!model->canFetchMore(secondParent));
+
         // row count should be 0, as they have no children
+        QVERIFY(!model->canFetchMore(firstParent));
         QCOMPARE(model->rowCount(firstParent), 0);
         QCOMPARE(model->rowCount(model->indexFromComponentName(vendorSecondProductSub)), 0);
         QCOMPARE(model->rowCount(model->indexFromComponentName(vendorSecondProductSub1)), 0);
@@ -0,0 +1,5 @@
+include(../../qttest.pri)
+
+QT += testlib
+
+SOURCES += tst_componentsortfilterproxymodel.cpp
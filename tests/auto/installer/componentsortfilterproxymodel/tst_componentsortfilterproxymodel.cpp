@@ -0,0 +1,169 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <componentsortfilterproxymodel.h>
+
+#include <QStandardItemModel>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_ComponentSortFilterProxyModel : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Returns the texts of all rows the proxy shows, in pre-order.
+    QStringList visibleRows(const QSortFilterProxyModel &proxy, const QModelIndex &parent = QModelIndex())
+    {
+        QStringList rows;
+        for (int row = 0; row < proxy.rowCount(parent); ++row) {
+            const QModelIndex index = proxy.index(row, 0, parent);
+            rows.append(index.data().toString());
+            rows += visibleRows(proxy, index);
+        }
+        return rows;
+    }
+
+    QStringList directlyAccepted(const ComponentSortFilterProxyModel &proxy)
+    {
+        QStringList rows;
+        foreach (const QModelIndex &index, proxy.directlyAcceptedIndexes())
+            rows.append(index.data().toString());
+        return rows;
+    }
+
+private slots:
+    void init()
+    {
+        m_model.clear();
+        QStandardItem *sdk = new QStandardItem(QLatin1String("SDK"));
+        QStandardItem *qt = new QStandardItem(QLatin1String("Qt 6"));
+        qt->appendRow(new QStandardItem(QLatin1String("Qt Charts")));
+        qt->appendRow(new QStandardItem(QLatin1String("Qt Quick")));
+        sdk->appendRow(qt);
+        sdk->appendRow(new QStandardItem(QLatin1String("Documentation")));
+        m_model.appendRow(sdk);
+        m_model.appendRow(new QStandardItem(QLatin1String("Tools")));
+    }
+
+    void testFilterPattern_data()
+    {
+        QTest::addColumn<QString>("pattern");
+        QTest::addColumn<QStringList>("visible");
+        QTest::addColumn<QStringList>("direct");
+
+        QTest::newRow("empty") << QString()
+            << (QStringList() << "SDK" << "Qt 6" << "Qt Charts" << "Qt Quick" << "Documentation" << "Tools")
+            << (QStringList() << "Qt Charts" << "Qt Quick" << "Documentation" << "Tools");
+        QTest::newRow("leaf") << "chart"
+            << (QStringList() << "SDK" << "Qt 6" << "Qt Charts")
+            << (QStringList() << "Qt Charts");
+        QTest::newRow("descendants of match") << "qt 6"
+            << (QStringList() << "SDK" << "Qt 6" << "Qt Charts" << "Qt Quick")
+            << (QStringList() << "Qt 6");
+        QTest::newRow("wildcard") << "q*k"
+            << (QStringList() << "SDK" << "Qt 6" << "Qt Quick")
+            << (QStringList() << "Qt Quick");
+        QTest::newRow("no match") << "designer" << QStringList() << QStringList();
+    }
+
+    void testFilterPattern()
+    {
+        QFETCH(QString, pattern);
+        QFETCH(QStringList, visible);
+        QFETCH(QStringList, direct);
+
+        ComponentSortFilterProxyModel proxy;
+        proxy.setRecursiveFilteringEnabled(true);
+        proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+        proxy.setSourceModel(&m_model);
+        proxy.setFilterPattern(pattern);
+
+        QCOMPARE(proxy.filterPattern(), pattern);
+        QCOMPARE(visibleRows(proxy), visible);
+        QCOMPARE(directlyAccepted(proxy), direct);
+    }
+
+    void testNarrowingPattern()
+    {
+        ComponentSortFilterProxyModel proxy;
+        proxy.setRecursiveFilteringEnabled(true);
+        proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+        proxy.setSourceModel(&m_model);
+
+        // typing extends the previous pattern, the result must equal a fresh filter
+        QString pattern;
+        foreach (const QChar &c, QString::fromLatin1("qt q")) {
+            pattern.append(c);
+            proxy.setFilterPattern(pattern);
+
+            ComponentSortFilterProxyModel fresh;
+            fresh.setRecursiveFilteringEnabled(true);
+            fresh.setFilterCaseSensitivity(Qt::CaseInsensitive);
+            fresh.setSourceModel(&m_model);
+            fresh.setFilterPattern(pattern);
+            QCOMPARE(visibleRows(proxy), visibleRows(fresh));
+        }
+        QCOMPARE(visibleRows(proxy), QStringList() << "SDK" << "Qt 6" << "Qt Quick");
+
+        // removing characters widens the result again
+        proxy.setFilterPattern(QLatin1String("qt"));
+        QCOMPARE(visibleRows(proxy), QStringList() << "SDK" << "Qt 6" << "Qt Charts" << "Qt Quick");
+    }
+
+    void testSourceModelChanges()
+    {
+        ComponentSortFilterProxyModel proxy;
+        proxy.setRecursiveFilteringEnabled(true);
+        proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+        proxy.setSourceModel(&m_model);
+        proxy.setFilterPattern(QLatin1String("tools"));
+        QCOMPARE(visibleRows(proxy), QStringList() << "Tools");
+
+        // renamed rows are filtered again
+        m_model.item(0)->child(1)->setText(QLatin1String("Tools Documentation"));
+        QCOMPARE(visibleRows(proxy), QStringList() << "SDK" << "Tools Documentation" << "Tools");
+
+        // inserted rows shift their siblings, which must not reuse stale results
+        m_model.item(0)->insertRow(0, new QStandardItem(QLatin1String("Debugging Tools")));
+        QCOMPARE(visibleRows(proxy), QStringList() << "SDK" << "Debugging Tools"
+            << "Tools Documentation" << "Tools");
+
+        m_model.removeRow(1);
+        QCOMPARE(visibleRows(proxy), QStringList() << "SDK" << "Debugging Tools"
+            << "Tools Documentation");
+    }
+
+private:
+    QStandardItemModel m_model;
+};
+
+QTEST_MAIN(tst_ComponentSortFilterProxyModel)
+
+#include "tst_componentsortfilterproxymodel.moc"
@@ -0,0 +1,170 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <deletionservice.h>
+#include <lockfile.h>
+
+#include <QDir>
+#include <QFile>
+#include <QStorageInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_DeletionService : public QObject
+{
+    Q_OBJECT
+
+private:
+    void createFile(const QString &path)
+    {
+        QVERIFY(QDir().mkpath(QFileInfo(path).absolutePath()));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write("content") > 0);
+    }
+
+    QStringList trashEntries()
+    {
+        QStringList entries;
+        foreach (const QString &trash, DeletionService::instance().trashDirectories()) {
+            entries += QDir(trash).entryList(QDir::AllEntries | QDir::Hidden | QDir::System
+                | QDir::NoDotAndDotDot);
+        }
+        return entries;
+    }
+
+private slots:
+    void testRemoveFile()
+    {
+        QTemporaryDir root;
+        QVERIFY(root.isValid());
+        const QString path = root.path() + "/file.txt";
+        createFile(path);
+
+        QVERIFY(DeletionService::instance().remove(path, root.path()));
+        QVERIFY(!QFileInfo::exists(path));
+
+        // The root is on the volume of the temporary directory, so the trash is created there
+        bool inTempPath = false;
+        foreach (const QString &trash, DeletionService::instance().trashDirectories()) {
+            if (QFileInfo(trash).absolutePath() == QDir::cleanPath(QDir::tempPath()))
+                inTempPath = true;
+        }
+        QVERIFY(inTempPath);
+
+        DeletionService::instance().waitForDone();
+        QVERIFY(QDir(root.path()).isEmpty());
+        QVERIFY(trashEntries().isEmpty());
+    }
+
+    void testRemoveDirectory()
+    {
+        QTemporaryDir root;
+        QVERIFY(root.isValid());
+        const QString path = root.path() + "/tree";
+        for (int i = 0; i < 10; ++i)
+            createFile(QString::fromLatin1("%1/sub%2/file%2.txt").arg(path).arg(i));
+
+        QVERIFY(DeletionService::instance().remove(path, root.path()));
+        QVERIFY(!QFileInfo::exists(path));
+
+        DeletionService::instance().waitForDone();
+        QVERIFY(QDir(root.path()).isEmpty());
+        QVERIFY(trashEntries().isEmpty());
+    }
+
+    void testTrashNextToRoot()
+    {
+        const QStorageInfo tempVolume(QDir::tempPath());
+        QString base;
+        foreach (const QString &candidate, QStringList() << QDir::currentPath() << QDir::homePath()) {
+            if (QStorageInfo(candidate) != tempVolume && QFileInfo(candidate).isWritable()) {
+                base = candidate;
+                break;
+            }
+        }
+        if (base.isEmpty())
+            QSKIP("No writable directory outside of the volume of the temporary directory.");
+
+        QTemporaryDir parent(base + "/tst_deletionservice-XXXXXX");
+        QVERIFY(parent.isValid());
+        const QString root = parent.path() + "/root";
+        const QString path = root + "/file.txt";
+        createFile(path);
+
+        // The trash cannot be created in the temporary directory, but next to the root
+        QVERIFY(DeletionService::instance().remove(path, root));
+        QVERIFY(!QFileInfo::exists(path));
+
+        QString trash;
+        foreach (const QString &dir, DeletionService::instance().trashDirectories()) {
+            if (QFileInfo(dir).absolutePath() == QDir::cleanPath(parent.path()))
+                trash = dir;
+        }
+        QVERIFY(!trash.isEmpty());
+
+        DeletionService::instance().waitForDone();
+        QVERIFY(QDir(root).isEmpty());
+        QVERIFY(QDir(trash).isEmpty());
+    }
+
+    void testRemoveStaleTrash()
+    {
+        const QString base = QDir::tempPath();
+        QTemporaryDir stale(base + "/installerTrash-XXXXXX");
+        QTemporaryDir running(base + "/installerTrash-XXXXXX");
+        QVERIFY(stale.isValid());
+        QVERIFY(running.isValid());
+        createFile(stale.path() + "/1/file.txt");
+        createFile(running.path() + "/1/file.txt");
+
+        // The trash of an application that is still running is locked
+        KDUpdater::LockFile lock(running.path() + ".lock");
+        QVERIFY2(lock.lock(), qPrintable(lock.errorString()));
+
+        DeletionService::instance().removeStaleTrash(base);
+        DeletionService::instance().waitForDone();
+        QVERIFY(!QFileInfo::exists(stale.path()));
+        QVERIFY(QFileInfo::exists(running.path() + "/1/file.txt"));
+
+        QVERIFY(lock.unlock());
+    }
+
+    void testRemoveMissingPath()
+    {
+        QTemporaryDir root;
+        QVERIFY(root.isValid());
+        QVERIFY(!DeletionService::instance().remove(root.path() + "/missing", root.path()));
+    }
+};
+
+QTEST_MAIN(tst_DeletionService)
+
+#include "tst_deletionservice.moc"
@@ -28,11 +28,15 @@
 
 #include "../shared/packagemanager.h"
 
+#include "archivefactory.h"
+#include "archivemanifest.h"
 #include "concurrentoperationrunner.h"
+#include "deletionservice.h"
 #include "init.h"
 #include "extractarchiveoperation.h"
 
 #include <QDir>
+#include <QDirIterator>
 #include <QObject>
 #include <QTest>
 
@@ -87,6 +91,131 @@ private slots:
         QCOMPARE(UpdateOperation::Error(op.error()), UpdateOperation::UserDefinedError);
     }
 
+    void testExtractOverExistingFiles()
+    {
+        const QString testDirectory = generateTemporaryFileName();
+        QVERIFY(QDir().mkpath(testDirectory));
+
+        ExtractArchiveOperation first(nullptr);
+        first.setArguments(QStringList() << ":///data/valid.7z" << testDirectory);
+        first.backup();
+        QVERIFY(first.performOperation());
+
+        const QString snapshot = testDirectory + "/installerBackup.tmpUpdate";
+        QVERIFY(!QFileInfo::exists(snapshot));
+
+        // Existing files are moved to the snapshot directory before extracting ...
+        ExtractArchiveOperation second(nullptr);
+        second.setArguments(QStringList() << ":///data/valid.7z" << testDirectory);
+        second.backup();
+        QVERIFY(QFileInfo(snapshot).isDir());
+        QVERIFY(!QDir(snapshot).isEmpty());
+
+        // ... and the directory is handed to DeletionService after the extraction.
+        QVERIFY(second.performOperation());
+        QVERIFY(!QFileInfo::exists(snapshot));
+        DeletionService::instance().waitForDone();
+        foreach (const QString &trash, DeletionService::instance().trashDirectories())
+            QVERIFY(QDir(trash).isEmpty());
+
+        QVERIFY(second.undoOperation());
+        QVERIFY(QDir(testDirectory).removeRecursively());
+    }
+
+    void testUndoRemovesFilesInBackground()
+    {
+        const QString testDirectory = generateTemporaryFileName();
+        QVERIFY(QDir().mkpath(testDirectory));
+
+        ExtractArchiveOperation op(nullptr);
+        op.setArguments(QStringList() << ":///data/valid.7z" << testDirectory);
+        op.backup();
+        QVERIFY(op.performOperation());
+
+        // The extracted files are moved to the trash and removed by DeletionService
+        QVERIFY(op.undoOperation());
+        DeletionService::instance().waitForDone();
+        QDirIterator it(testDirectory, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+        QVERIFY(!it.hasNext());
+        foreach (const QString &trash, DeletionService::instance().trashDirectories())
+            QVERIFY(QDir(trash).isEmpty());
+
+        QVERIFY(QDir(testDirectory).removeRecursively());
+    }
+
+    void testExtractSkipsUnchangedFiles()
+    {
+        const QString testDirectory = generateTemporaryFileName();
+        QVERIFY(QDir().mkpath(testDirectory));
+
+        const QString archivePath = generateTemporaryFileName() + ".7z";
+        QVERIFY(QFile::copy(":///data/valid.7z", archivePath));
+
+        ExtractArchiveOperation first(nullptr);
+        first.setArguments(QStringList() << archivePath << testDirectory);
+        first.backup();
+        QVERIFY(first.performOperation());
+
+        const ArchiveManifest manifest = ArchiveManifest::fromDirectory(testDirectory);
+        manifest.save(ArchiveManifest::manifestFileName(archivePath));
+
+        QStringList files;
+        {
+            QScopedPointer<AbstractArchive> archive(ArchiveFactory::instance().create(archivePath));
+            QVERIFY(archive && archive->open(QIODevice::ReadOnly));
+            foreach (const ArchiveEntry &entry, archive->list()) {
+                if (!entry.isDirectory && !entry.isSymbolicLink)
+                    files.append(entry.path);
+            }
+        }
+        QVERIFY(!files.isEmpty());
+
+        // Change the content of the first file, and mark the others to detect rewrites
+        const QString changedFile = testDirectory + '/' + files.first();
+        {
+            QFile file(changedFile);
+            QVERIFY(file.open(QIODevice::Append));
+            QVERIFY(file.write("changed") > 0);
+        }
+        const QDateTime marker(QDate(2000, 1, 1), QTime(0, 0), Qt::UTC);
+        for (int i = 1; i < files.count(); ++i) {
+            QFile file(testDirectory + '/' + files.at(i));
+            QVERIFY(file.open(QIODevice::ReadWrite));
+            QVERIFY(file.setFileTime(marker, QFileDevice::FileModificationTime));
+        }
+
+        // Only the changed file is moved to the snapshot directory ...
+        ExtractArchiveOperation second(nullptr);
+        second.setArguments(QStringList() << archivePath << testDirectory);
+        second.backup();
+        const QString snapshot = testDirectory + "/installerBackup.tmpUpdate";
+        QVERIFY(QFileInfo::exists(snapshot + '/' + files.first()));
+        for (int i = 1; i < files.count(); ++i)
+            QVERIFY(!QFileInfo::exists(snapshot + '/' + files.at(i)));
+
+        // ... and extracted again, while the unchanged files are not touched.
+        QVERIFY(second.performOperation());
+        QVERIFY(!QFileInfo::exists(snapshot));
+        DeletionService::instance().waitForDone();
+        foreach (const QString &trash, DeletionService::instance().trashDirectories())
+            QVERIFY(QDir(trash).isEmpty());
+        QVERIFY(manifest.matches(files.first(), changedFile));
+        for (int i = 1; i < files.count(); ++i) {
+            const QFileInfo fi(testDirectory + '/' + files.at(i));
+            QVERIFY(manifest.matches(files.at(i), fi.filePath()));
+            QCOMPARE(fi.lastModified().toUTC(), marker);
+        }
+
+        // Skipped files still belong to the package
+        QVERIFY(second.undoOperation());
+        foreach (const QString &file, files)
+            QVERIFY(!QFileInfo::exists(testDirectory + '/' + file));
+
+        QVERIFY(QDir(testDirectory).removeRecursively());
+        QFile::remove(ArchiveManifest::manifestFileName(archivePath));
+        QFile::remove(archivePath);
+    }
+
     void testConcurrentExtractWithCompetingData()
     {
         // Suppress warnings about already deleted installerResources file
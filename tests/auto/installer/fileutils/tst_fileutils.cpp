@@ -28,7 +28,9 @@
 
 #include <qinstallerglobal.h>
 #include <fileutils.h>
+#include <errors.h>
 
+#include <QCryptographicHash>
 #include <QObject>
 #include <QTest>
 #include <QFile>
@@ -36,10 +38,21 @@
 
 using namespace QInstaller;
 
+Q_DECLARE_METATYPE(QInstaller::FileCopyMethod)
+
 class tst_fileutils : public QObject
 {
     Q_OBJECT
 
+private:
+    QByteArray testData(int size) const
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; ++i)
+            data[i] = char((i * 31 + i / 4099) & 0xff);
+        return data;
+    }
+
 private slots:
     void testSetDefaultFilePermissions()
     {
@@ -128,6 +141,267 @@ private slots:
         QVERIFY(testFile.remove());
 #endif
     }
+
+    void testCopyFileData_data()
+    {
+        QTest::addColumn<FileCopyMethod>("method");
+        QTest::addColumn<int>("size");
+
+        QTest::newRow("Automatic") << FileCopyMethod::Automatic << 3 * 1024 * 1024 + 17;
+        QTest::newRow("Clone") << FileCopyMethod::Clone << 3 * 1024 * 1024 + 17;
+        QTest::newRow("CopyFileRange") << FileCopyMethod::CopyFileRange << 3 * 1024 * 1024 + 17;
+        QTest::newRow("SendFile") << FileCopyMethod::SendFile << 3 * 1024 * 1024 + 17;
+        QTest::newRow("Buffered") << FileCopyMethod::Buffered << 3 * 1024 * 1024 + 17;
+        QTest::newRow("Empty file") << FileCopyMethod::Automatic << 0;
+    }
+
+    void testCopyFileData()
+    {
+        QFETCH(FileCopyMethod, method);
+        QFETCH(int, size);
+
+        const QByteArray data = testData(size);
+        QFile source(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadWrite));
+        QCOMPARE(source.write(data), qint64(size));
+        source.close();
+
+        QFile target(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        QVERIFY(target.open(QIODevice::WriteOnly));
+
+        qint64 lastProgress = 0;
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        try {
+            const FileCopyMethod used = copyFileData(&source, &target, method,
+                [&lastProgress](qint64 copied) {
+                    if (copied < lastProgress)
+                        return false;
+                    lastProgress = copied;
+                    return true;
+                }, &hash);
+            // Unsupported methods fall back to a buffered copy
+            QVERIFY(used == method || used == FileCopyMethod::Buffered);
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+        QCOMPARE(lastProgress, qint64(size));
+        source.close();
+        target.close();
+
+        QVERIFY(target.open(QIODevice::ReadOnly));
+        QCOMPARE(target.readAll(), data);
+        QCOMPARE(hash.result(), QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+
+        QVERIFY(source.remove());
+        QVERIFY(target.remove());
+    }
+
+    void testCopyFileDataCanceled()
+    {
+        const QByteArray data = testData(4 * 1024 * 1024);
+        QFile source(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadWrite));
+        QCOMPARE(source.write(data), qint64(data.size()));
+        source.close();
+
+        QFile target(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        QVERIFY(target.open(QIODevice::WriteOnly));
+
+        int calls = 0;
+        copyFileData(&source, &target, FileCopyMethod::Buffered, [&calls](qint64) {
+            return ++calls < 2;
+        });
+        QCOMPARE(calls, 2);
+        QVERIFY(target.size() < data.size());
+
+        QVERIFY(source.remove());
+        QVERIFY(target.remove());
+    }
+
+    void testCopyFileSegment_data()
+    {
+        QTest::addColumn<FileCopyMethod>("method");
+        QTest::addColumn<int>("offset");
+        QTest::addColumn<int>("length");
+        QTest::addColumn<QByteArray>("header");
+
+        QTest::newRow("Automatic") << FileCopyMethod::Automatic << 1234 << 2 * 1024 * 1024 + 5
+            << QByteArray();
+        QTest::newRow("Automatic aligned") << FileCopyMethod::Automatic << 64 * 1024 << 256 * 1024
+            << QByteArray();
+        QTest::newRow("Automatic behind header") << FileCopyMethod::Automatic << 17 << 100000
+            << QByteArray("header");
+        QTest::newRow("Clone") << FileCopyMethod::Clone << 64 * 1024 << 256 * 1024 << QByteArray();
+        QTest::newRow("CopyFileRange") << FileCopyMethod::CopyFileRange << 1234 << 100000
+            << QByteArray("header");
+        QTest::newRow("SendFile") << FileCopyMethod::SendFile << 1234 << 100000
+            << QByteArray("header");
+        QTest::newRow("Buffered") << FileCopyMethod::Buffered << 1234 << 100000
+            << QByteArray("header");
+        QTest::newRow("Empty segment") << FileCopyMethod::Automatic << 1234 << 0 << QByteArray();
+    }
+
+    void testCopyFileSegment()
+    {
+        QFETCH(FileCopyMethod, method);
+        QFETCH(int, offset);
+        QFETCH(int, length);
+        QFETCH(QByteArray, header);
+
+        const QByteArray data = testData(3 * 1024 * 1024);
+        QFile source(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadWrite));
+        QCOMPARE(source.write(data), qint64(data.size()));
+        source.close();
+
+        QFile target(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        QVERIFY(target.open(QIODevice::WriteOnly));
+        QCOMPARE(target.write(header), qint64(header.size()));
+
+        try {
+            const FileCopyMethod used = copyFileSegment(&source, offset, length, &target, method);
+            QVERIFY(used == method || used == FileCopyMethod::Buffered);
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+        QCOMPARE(target.pos(), qint64(header.size() + length));
+        QCOMPARE(target.write("end"), qint64(3));
+        source.close();
+        target.close();
+
+        QVERIFY(target.open(QIODevice::ReadOnly));
+        QCOMPARE(target.readAll(), header + data.mid(offset, length) + "end");
+
+        QVERIFY(source.remove());
+        QVERIFY(target.remove());
+    }
+
+    void testCopyFileSegmentBeyondEnd()
+    {
+        const QByteArray data = testData(1024);
+        QFile source(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadWrite));
+        QCOMPARE(source.write(data), qint64(data.size()));
+        source.close();
+
+        QFile target(generateTemporaryFileName());
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        QVERIFY(target.open(QIODevice::WriteOnly));
+        QVERIFY_EXCEPTION_THROWN(copyFileSegment(&source, 512, 1024, &target), QInstaller::Error);
+
+        QVERIFY(source.remove());
+        QVERIFY(target.remove());
+    }
+
+    void testCopyFile()
+    {
+        const QByteArray data = testData(1024 * 1024);
+        const QString sourceName = generateTemporaryFileName();
+        const QString targetName = generateTemporaryFileName();
+        {
+            QFile source(sourceName);
+            QVERIFY(source.open(QIODevice::WriteOnly));
+            QCOMPARE(source.write(data), qint64(data.size()));
+        }
+        QVERIFY(QFile::setPermissions(sourceName, QFileDevice::ReadOwner | QFileDevice::WriteOwner
+            | QFileDevice::ExeOwner));
+
+        try {
+            copyFile(sourceName, targetName);
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+        QFile target(targetName);
+        QVERIFY(target.open(QIODevice::ReadOnly));
+        QCOMPARE(target.readAll(), data);
+        target.close();
+        QCOMPARE(QFile::permissions(targetName), QFile::permissions(sourceName));
+
+        // Like QFile::copy(), an existing target is not overwritten
+        QVERIFY_EXCEPTION_THROWN(copyFile(sourceName, targetName), QInstaller::Error);
+
+        QVERIFY(QFile::remove(sourceName));
+        QVERIFY(QFile::remove(targetName));
+    }
+
+    void testCopyFileFromProcfs()
+    {
+#ifndef Q_OS_LINUX
+        QSKIP("Linux only test");
+#else
+        // procfs reports no size and no data for copy_file_range()
+        const QString sourceName = QLatin1String("/proc/version");
+        QFile source(sourceName);
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        const QByteArray data = source.readAll();
+        source.close();
+        QVERIFY(!data.isEmpty());
+
+        const QString targetName = generateTemporaryFileName();
+        try {
+            copyFile(sourceName, targetName);
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+        QFile target(targetName);
+        QVERIFY(target.open(QIODevice::ReadOnly));
+        QCOMPARE(target.readAll(), data);
+        target.close();
+        QVERIFY(QFile::remove(targetName));
+#endif
+    }
+
+    void testDirectoryTree()
+    {
+        const QString sourceDir = generateTemporaryFileName();
+        const QString targetDir = generateTemporaryFileName();
+        QStringList files;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                const QString name = QString::fromLatin1("dir%1/sub%2/file%2.txt").arg(i).arg(j);
+                QVERIFY(QDir().mkpath(QFileInfo(sourceDir + '/' + name).absolutePath()));
+                QFile file(sourceDir + '/' + name);
+                QVERIFY(file.open(QIODevice::WriteOnly));
+                QCOMPARE(file.write(name.toLatin1()), qint64(name.size()));
+                files.append(name);
+            }
+        }
+        files.append("top.txt");
+        QFile top(sourceDir + "/top.txt");
+        QVERIFY(top.open(QIODevice::WriteOnly));
+        top.close();
+
+        const DirectoryTree tree = listDirectoryTree(sourceDir);
+        QCOMPARE(tree.directories.size(), 2);
+        QCOMPARE(tree.directories.at(0).size(), 4);
+        QCOMPARE(tree.directories.at(1).size(), 16);
+        QCOMPARE(tree.files.size(), files.size());
+        for (const QString &directory : tree.directories.at(1))
+            QVERIFY(tree.directories.at(0).contains(QFileInfo(directory).absolutePath()));
+
+        try {
+            copyDirectoryContents(sourceDir, targetDir);
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+        for (const QString &name : qAsConst(files)) {
+            QFile file(targetDir + '/' + name);
+            QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(name));
+            QCOMPARE(file.readAll(), name == "top.txt" ? QByteArray() : name.toLatin1());
+        }
+
+        try {
+            removeDirectory(sourceDir);
+            removeDirectory(targetDir);
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+        QVERIFY(!QFileInfo::exists(sourceDir));
+        QVERIFY(!QFileInfo::exists(targetDir));
+    }
 };
 
 QTEST_MAIN(tst_fileutils)
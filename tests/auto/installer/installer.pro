@@ -43,7 +43,19 @@ SUBDIRS += \
     contentshaupdate \
     componentreplace \
     metadatacache \
-    contentsha1check
+    contentsha1check \
+    tracelog \
+    relocationstage \
+    componentsortfilterproxymodel \
+    deletionservice \
+    operationlog \
+    operationjournal \
+    archivecache \
+    binarydelta \
+    packagesearchindex \
+    qtpatch \
+    archivemanifest \
+    loggingutils
 
 CONFIG(libarchive) {
     SUBDIRS += libarchivearchive
@@ -27,9 +27,13 @@
 **************************************************************************/
 #include "../shared/packagemanager.h"
 
+#include <component.h>
+#include <constants.h>
 #include <packagemanagercore.h>
 
 #include <QFile>
+#include <QRegularExpression>
+#include <QTemporaryDir>
 #include <QTest>
 
 using namespace KDUpdater;
@@ -56,6 +60,44 @@ private slots:
         QVERIFY(dir.removeRecursively());
         core->deleteLater();
     }
+
+    void testLicenseTextsAreCached()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        for (const QString &name : { QString("a.txt"), QString("b.txt") }) {
+            QFile file(dir.filePath(name));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("Text of " + name.toLatin1());
+        }
+
+        QVariantMap licenseA;
+        licenseA.insert(scFile, QLatin1String("a.txt"));
+        QVariantMap licenseB;
+        licenseB.insert(scFile, QLatin1String("b.txt"));
+        QHash<QString, QVariant> hash;
+        hash.insert(QLatin1String("License A"), licenseA);
+        hash.insert(QLatin1String("License B"), licenseB);
+
+        PackageManagerCore core;
+        Component component(&core);
+        component.loadLicenses(dir.path(), hash);
+        QVERIFY(component.hasLicenses());
+
+        // A file that is gone before the texts are read is reported and has no text.
+        QVERIFY(QFile::remove(dir.filePath("b.txt")));
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Cannot open the requested license file .*b\\.txt"));
+        QHash<QString, QVariantMap> licenses = component.licenses();
+        QCOMPARE(licenses.count(), 2);
+        QCOMPARE(licenses.value("License A").value(scContent).toString(), QLatin1String("Text of a.txt"));
+        QVERIFY(!licenses.value("License B").contains(scContent));
+
+        // Texts read once are kept, even if the file is removed afterwards.
+        QVERIFY(QFile::remove(dir.filePath("a.txt")));
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Cannot open the requested license file .*b\\.txt"));
+        licenses = component.licenses();
+        QCOMPARE(licenses.value("License A").value(scContent).toString(), QLatin1String("Text of a.txt"));
+    }
 };
 
 QTEST_MAIN(tst_licenseagreement)
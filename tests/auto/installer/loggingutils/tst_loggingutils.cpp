@@ -0,0 +1,127 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <loggingutils.h>
+
+#include <QDir>
+#include <QHash>
+#include <QRegularExpression>
+#include <QTest>
+#include <QThread>
+
+using namespace QInstaller;
+
+// Runs the post routines, that is what QCoreApplication does on destruction.
+Q_CORE_EXPORT void qt_call_post_routines();
+
+static const int ThreadCount = 4;
+static const int MessageCount = 500;
+
+class CaptureOutput : public VerboseWriterOutput
+{
+public:
+    bool write(const QString &fileName, QIODevice::OpenMode openMode, const QByteArray &data) override
+    {
+        Q_UNUSED(fileName)
+        Q_UNUSED(openMode)
+        m_data = data;
+        return false; // keep the messages in the verbose writer for the next test
+    }
+
+    QByteArray m_data;
+};
+
+class tst_LoggingUtils : public QObject
+{
+    Q_OBJECT
+
+private:
+    void logFromThreads(const QString &tag, bool shutdownWhileLogging)
+    {
+        QList<QThread *> threads;
+        for (int i = 0; i < ThreadCount; ++i) {
+            threads.append(QThread::create([tag, i] {
+                for (int j = 0; j < MessageCount; ++j) {
+                    LoggingHandler::instance().messageHandler(QtDebugMsg, QMessageLogContext(),
+                        QString::fromLatin1("%1 thread%2 message%3").arg(tag).arg(i).arg(j));
+                }
+            }));
+        }
+        foreach (QThread *thread, threads)
+            thread->start();
+        if (shutdownWhileLogging)
+            qt_call_post_routines();
+        foreach (QThread *thread, threads)
+            thread->wait();
+        qDeleteAll(threads);
+    }
+
+    void verifyMessages(const QString &tag)
+    {
+        CaptureOutput output;
+        QVERIFY(!VerboseWriter::instance()->flush(&output));
+
+        const QRegularExpression re(tag + QLatin1String(" thread(\\d+) message(\\d+)$"));
+        QHash<int, int> next;
+        foreach (const QString &line, QString::fromLocal8Bit(output.m_data).split(QLatin1Char('\n'))) {
+            const QRegularExpressionMatch match = re.match(line);
+            if (!match.hasMatch())
+                continue;
+            const int thread = match.captured(1).toInt();
+            QCOMPARE(match.captured(2).toInt(), next.value(thread));
+            next[thread] = next.value(thread) + 1;
+        }
+        for (int i = 0; i < ThreadCount; ++i)
+            QCOMPARE(next.value(i), MessageCount);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        // The verbose writer hands out its messages only if a log file name is set.
+        VerboseWriter::instance()->setFileName(QDir::tempPath() + "/tst_loggingutils.log");
+        LoggingHandler::instance();
+    }
+
+    void testFlushWritesMessagesInOrder()
+    {
+        logFromThreads("flush", false);
+        verifyMessages("flush");
+    }
+
+    void testShutdownDrainsQueue()
+    {
+        // Must be the last test, the messages are written synchronously afterwards.
+        logFromThreads("shutdown", true);
+        verifyMessages("shutdown");
+    }
+};
+
+QTEST_MAIN(tst_LoggingUtils)
+
+#include "tst_loggingutils.moc"
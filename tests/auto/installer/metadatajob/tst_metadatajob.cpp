@@ -36,10 +36,86 @@
 #include <packagemanagercore.h>
 #include <progresscoordinator.h>
 
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
 #include <QTest>
 
 using namespace QInstaller;
 
+// Minimal HTTP server serving a single Updates.xml, answering conditional
+// requests carrying the current ETag with 304 Not Modified.
+class UpdatesXmlServer
+{
+public:
+    explicit UpdatesXmlServer(const QString &updatesFile)
+        : m_eTag("\"updates-1\"")
+        , m_requestCount(0)
+        , m_notModifiedCount(0)
+    {
+        QFile file(updatesFile);
+        if (file.open(QIODevice::ReadOnly))
+            m_updates = file.readAll();
+
+        QObject::connect(&m_server, &QTcpServer::newConnection, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    handleRequest(socket);
+                });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+        m_server.listen(QHostAddress::LocalHost);
+    }
+
+    bool isListening() const { return m_server.isListening(); }
+    QUrl url() const
+    {
+        return QUrl(QString::fromLatin1("http://127.0.0.1:%1").arg(m_server.serverPort()));
+    }
+    int requestCount() const { return m_requestCount; }
+    int notModifiedCount() const { return m_notModifiedCount; }
+
+private:
+    void handleRequest(QTcpSocket *socket)
+    {
+        QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+        if (!request.contains("\r\n\r\n")) {
+            socket->setProperty("request", request);
+            return;
+        }
+        socket->setProperty("request", QByteArray());
+        ++m_requestCount;
+
+        QByteArray ifNoneMatch;
+        foreach (const QByteArray &line, request.split('\n')) {
+            if (line.toLower().startsWith("if-none-match:"))
+                ifNoneMatch = line.mid(14).trimmed();
+        }
+
+        QByteArray response;
+        if (ifNoneMatch == m_eTag) {
+            ++m_notModifiedCount;
+            response = "HTTP/1.1 304 Not Modified\r\nETag: " + m_eTag
+                + "\r\nContent-Length: 0\r\n\r\n";
+        } else if (request.startsWith("GET /Updates.xml")) {
+            response = "HTTP/1.1 200 OK\r\nETag: " + m_eTag
+                + "\r\nContent-Type: text/xml\r\nContent-Length: "
+                + QByteArray::number(m_updates.size()) + "\r\n\r\n" + m_updates;
+        } else {
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+        }
+        socket->write(response);
+    }
+
+private:
+    QTcpServer m_server;
+    QByteArray m_updates;
+    const QByteArray m_eTag;
+    int m_requestCount;
+    int m_notModifiedCount;
+};
+
 class tst_MetaDataJob : public QObject
 {
     Q_OBJECT
@@ -98,6 +174,35 @@ private slots:
         QCOMPARE(metadata.metadata().count(), 1);
     }
 
+    void testConditionalUpdatesRequest()
+    {
+        UpdatesXmlServer server(":///data/repository/Updates.xml");
+        QVERIFY(server.isListening());
+
+        QTemporaryDir cacheDir;
+        QVERIFY(cacheDir.isValid());
+
+        // The first run fetches and caches the metadata, the second one sends
+        // the cached ETag and reuses the metadata on 304 Not Modified.
+        for (int run = 0; run < 2; ++run) {
+            PackageManagerCore core;
+            core.setInstaller();
+            core.settings().setLocalCachePath(cacheDir.path());
+            QSet<Repository> repoList;
+            repoList.insert(Repository(server.url(), false));
+            core.settings().setDefaultRepositories(repoList);
+
+            MetadataJob metadata;
+            metadata.setPackageManagerCore(&core);
+            metadata.start();
+            metadata.waitForFinished();
+            QCOMPARE(metadata.error(), int(Job::NoError));
+            QCOMPARE(metadata.metadata().count(), 1);
+        }
+        QCOMPARE(server.requestCount(), 2);
+        QCOMPARE(server.notModifiedCount(), 1);
+    }
+
     void testZippedRepository_data()
     {
         QTest::addColumn<QStringList>("repositories");
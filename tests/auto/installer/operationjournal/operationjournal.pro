@@ -0,0 +1,6 @@
+include(../../qttest.pri)
+
+QT -= gui
+QT += testlib xml
+
+SOURCES += tst_operationjournal.cpp
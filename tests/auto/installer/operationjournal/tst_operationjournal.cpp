@@ -0,0 +1,189 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "init.h"
+#include "binaryformat.h"
+#include "operationjournal.h"
+#include "updateoperations.h"
+
+#include <QFile>
+#include <QObject>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace KDUpdater;
+using namespace QInstaller;
+
+class tst_OperationJournal : public QObject
+{
+    Q_OBJECT
+
+private:
+    QList<OperationBlob> baseOperations() const
+    {
+        QList<OperationBlob> operations;
+        for (int i = 0; i < 3; ++i)
+            operations.append(OperationBlob(QLatin1String("Base%1").arg(i), QString()));
+        return operations;
+    }
+
+    QStringList names(const QList<OperationBlob> &operations) const
+    {
+        QStringList result;
+        foreach (const OperationBlob &operation, operations)
+            result.append(operation.name);
+        return result;
+    }
+
+    void writeDataFile(const QByteArray &content)
+    {
+        QFile file(m_dataFileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(content), qint64(content.size()));
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QInstaller::init();
+        QVERIFY(m_dir.isValid());
+        m_dataFileName = m_dir.filePath(QLatin1String("maintenancetool.dat"));
+    }
+
+    void init()
+    {
+        writeDataFile(QByteArray(64, 'x'));
+        QVERIFY(OperationJournal(m_dataFileName).remove());
+    }
+
+    void testReplayWithoutJournal()
+    {
+        QList<OperationBlob> operations = baseOperations();
+        QVector<quint32> ids;
+        QCOMPARE(OperationJournal(m_dataFileName).replay(&operations, &ids), quint32(3));
+        QCOMPARE(ids, QVector<quint32>({ 0, 1, 2 }));
+        QCOMPARE(operations.count(), 3);
+    }
+
+    void testAppendReplay()
+    {
+        MkdirOperation mkdir(nullptr);
+        mkdir.setArguments(QStringList() << QLatin1String("/some/path"));
+        mkdir.setValue(QLatin1String("component"), QLatin1String("A"));
+        CopyOperation copy(nullptr);
+        copy.setArguments(QStringList() << QLatin1String("/source") << QLatin1String("/target"));
+        copy.setValue(QLatin1String("component"), QLatin1String("B"));
+
+        OperationJournal journal(m_dataFileName);
+        journal.append(3, { 1 }, OperationList() << &mkdir);
+        // removes the Mkdir operation added by the first session, it got the identifier 3
+        journal.append(3, { 0, 3 }, OperationList() << &copy);
+
+        QList<OperationBlob> operations = baseOperations();
+        QVector<quint32> ids;
+        QCOMPARE(journal.replay(&operations, &ids), quint32(5));
+        QCOMPARE(names(operations), QStringList() << QLatin1String("Base2")
+            << QLatin1String("Copy"));
+        QCOMPARE(ids, QVector<quint32>({ 2, 4 }));
+        QCOMPARE(operations.at(1).component, QLatin1String("B"));
+    }
+
+    void testIncompleteSession()
+    {
+        MkdirOperation mkdir(nullptr);
+        mkdir.setArguments(QStringList() << QLatin1String("/some/path"));
+
+        OperationJournal journal(m_dataFileName);
+        journal.append(3, { 0 }, OperationList());
+        const qint64 size = journal.size();
+        {
+            QFile file(journal.fileName());
+            QVERIFY(file.open(QIODevice::Append));
+            QVERIFY(file.write(QByteArray("\x00\x00\x10\x00garbage", 11)) == 11);
+        }
+
+        QList<OperationBlob> operations = baseOperations();
+        QVector<quint32> ids;
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QLatin1String("Ignoring incomplete session.*")));
+        QCOMPARE(journal.replay(&operations, &ids), quint32(3));
+        QCOMPARE(ids, QVector<quint32>({ 1, 2 }));
+
+        // the incomplete session is dropped before appending
+        journal.append(3, { 1 }, OperationList() << &mkdir);
+        QVERIFY(journal.size() > size);
+        operations = baseOperations();
+        QCOMPARE(journal.replay(&operations, &ids), quint32(4));
+        QCOMPARE(names(operations), QStringList() << QLatin1String("Base2")
+            << QLatin1String("Mkdir"));
+        QCOMPARE(ids, QVector<quint32>({ 2, 3 }));
+    }
+
+    void testJournalOfOtherDataFile()
+    {
+        OperationJournal journal(m_dataFileName);
+        journal.append(3, { 0 }, OperationList());
+
+        // the data file was rewritten without the journal being removed
+        writeDataFile(QByteArray(128, 'y'));
+        QList<OperationBlob> operations = baseOperations();
+        QVector<quint32> ids;
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QLatin1String("Ignoring operation journal.*")));
+        QCOMPARE(journal.replay(&operations, &ids), quint32(3));
+        QCOMPARE(ids, QVector<quint32>({ 0, 1, 2 }));
+
+        // appending starts a new journal for the current data file
+        journal.append(3, { 2 }, OperationList());
+        QCOMPARE(journal.replay(&operations, &ids), quint32(3));
+        QCOMPARE(ids, QVector<quint32>({ 0, 1 }));
+    }
+
+    void testNeedsCompaction()
+    {
+        OperationJournal journal(m_dataFileName);
+        QVERIFY(!journal.needsCompaction(0));
+        journal.append(3, { 0 }, OperationList());
+        QVERIFY(!journal.needsCompaction(0));
+        QVERIFY(journal.size() < OperationJournal::MinimumCompactionSize);
+
+        QVector<quint32> removed;
+        for (quint32 id = 0; id < quint32(OperationJournal::MinimumCompactionSize / 4); ++id)
+            removed.append(id);
+        journal.append(3, removed, OperationList());
+        QVERIFY(journal.needsCompaction(0));
+        QVERIFY(!journal.needsCompaction(journal.size()));
+    }
+
+private:
+    QTemporaryDir m_dir;
+    QString m_dataFileName;
+};
+
+QTEST_MAIN(tst_OperationJournal)
+
+#include "tst_operationjournal.moc"
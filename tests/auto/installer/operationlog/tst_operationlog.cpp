@@ -0,0 +1,170 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "init.h"
+#include "binaryformat.h"
+#include "fileio.h"
+#include "operationlog.h"
+#include "updateoperations.h"
+
+#include <QDir>
+#include <QObject>
+#include <QTemporaryFile>
+#include <QTest>
+
+using namespace KDUpdater;
+using namespace QInstaller;
+
+class tst_OperationLog : public QObject
+{
+    Q_OBJECT
+
+private:
+    void verifyOperation(Operation *op, const QString &name, const QStringList &arguments,
+        const QVariantMap &values)
+    {
+        QVERIFY(op);
+        QCOMPARE(op->name(), name);
+        QCOMPARE(op->arguments(), arguments);
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+            QCOMPARE(op->value(it.key()), it.value());
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QInstaller::init();
+    }
+
+    void testWriteRead()
+    {
+        MkdirOperation mkdir(nullptr);
+        mkdir.setArguments(QStringList() << QLatin1String("/some/path"));
+        mkdir.setValue(QLatin1String("component"), QLatin1String("A"));
+        mkdir.setValue(QLatin1String("createddir"), QLatin1String("/some"));
+
+        CopyOperation copy(nullptr);
+        copy.setArguments(QStringList() << QLatin1String("/source") << QLatin1String("/target"));
+        copy.setValue(QLatin1String("component"), QLatin1String("B"));
+        copy.setValue(QLatin1String("admin"), true);
+        copy.setValue(QLatin1String("files"), QStringList() << QLatin1String("a") << QLatin1String("b"));
+        // not written, see CopyOperation::isPersistentValue()
+        copy.setValue(QLatin1String("backupOfExistingDestination"), QLatin1String("/backup"));
+
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        OperationList operations;
+        operations << &mkdir << &copy;
+        OperationLog::write(&file, operations);
+
+        QVERIFY(file.seek(0));
+        QCOMPARE(QInstaller::retrieveInt64(&file), qint64(OperationLog::Marker));
+        QList<OperationBlob> blobs;
+        OperationLog::read(&file, &blobs);
+        QCOMPARE(QInstaller::retrieveInt64(&file), qint64(operations.count()));
+        QVERIFY(file.atEnd());
+
+        QCOMPARE(blobs.count(), 2);
+        QCOMPARE(blobs.at(0).name, QLatin1String("Mkdir"));
+        QCOMPARE(blobs.at(0).component, QLatin1String("A"));
+        QCOMPARE(blobs.at(1).name, QLatin1String("Copy"));
+        QCOMPARE(blobs.at(1).component, QLatin1String("B"));
+
+        QScopedPointer<Operation> op(OperationLog::create(blobs.at(0), nullptr));
+        verifyOperation(op.data(), QLatin1String("Mkdir"), mkdir.arguments(),
+            { { QLatin1String("component"), QLatin1String("A") },
+              { QLatin1String("createddir"), QLatin1String("/some") } });
+
+        op.reset(OperationLog::create(blobs.at(1), nullptr));
+        verifyOperation(op.data(), QLatin1String("Copy"), copy.arguments(),
+            { { QLatin1String("component"), QLatin1String("B") },
+              { QLatin1String("admin"), true },
+              { QLatin1String("files"), QStringList() << QLatin1String("a") << QLatin1String("b") } });
+        QVERIFY(!op->hasValue(QLatin1String("backupOfExistingDestination")));
+    }
+
+    void testTypedValues()
+    {
+        const QVariantList list = QVariantList() << 1 << QLatin1String("two")
+            << QByteArray("\x00\x01", 2);
+        const QByteArray binary("<a>\x00\xff</a>", 9);
+
+        MkdirOperation mkdir(nullptr);
+        mkdir.setArguments(QStringList() << QLatin1String("@RELOCATABLE_PATH@/path"));
+        mkdir.setValue(QLatin1String("count"), qint64(1) << 40);
+        mkdir.setValue(QLatin1String("binary"), binary);
+        mkdir.setValue(QLatin1String("list"), list);
+        mkdir.setValue(QLatin1String("createddir"), QLatin1String("@RELOCATABLE_PATH@/path"));
+
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        OperationLog::write(out, OperationList() << &mkdir);
+        QCOMPARE(out.status(), QDataStream::Ok);
+
+        QList<OperationBlob> blobs;
+        QDataStream in(data);
+        OperationLog::read(in, &blobs);
+        QCOMPARE(blobs.count(), 1);
+
+        // values keep their type, only the installation directory placeholder is resolved
+        const QString path = QDir::cleanPath(QCoreApplication::applicationDirPath())
+            + QLatin1String("/path");
+        QScopedPointer<Operation> op(OperationLog::create(blobs.at(0), nullptr));
+        verifyOperation(op.data(), QLatin1String("Mkdir"), QStringList() << path,
+            { { QLatin1String("count"), qint64(1) << 40 },
+              { QLatin1String("binary"), binary },
+              { QLatin1String("list"), list },
+              { QLatin1String("createddir"), path } });
+        QCOMPARE(op->value(QLatin1String("count")).type(), QVariant::LongLong);
+        QCOMPARE(op->value(QLatin1String("binary")).type(), QVariant::ByteArray);
+    }
+
+    void testCreateFromXml()
+    {
+        MkdirOperation mkdir(nullptr);
+        mkdir.setArguments(QStringList() << QLatin1String("/some/path"));
+        mkdir.setValue(QLatin1String("component"), QLatin1String("A"));
+
+        const OperationBlob blob(mkdir.name(), mkdir.toXml().toString());
+        QScopedPointer<Operation> op(OperationLog::create(blob, nullptr));
+        verifyOperation(op.data(), QLatin1String("Mkdir"), mkdir.arguments(),
+            { { QLatin1String("component"), QLatin1String("A") } });
+    }
+
+    void testUnknownOperation()
+    {
+        const OperationBlob blob(QLatin1String("NoSuchOperation"), QString(), QByteArray("x"),
+            QStringList());
+        QScopedPointer<Operation> op(OperationLog::create(blob, nullptr));
+        QVERIFY(op.isNull());
+    }
+};
+
+QTEST_MAIN(tst_OperationLog)
+
+#include "tst_operationlog.moc"
@@ -324,6 +324,25 @@ private slots:
         core->deleteLater();
     }
 
+    void testReplaceVariables()
+    {
+        PackageManagerCore *core = new PackageManagerCore(BinaryContent::MagicInstallerMarker, QList<OperationBlob> (),
+                                                          QString(), QString(), Protocol::DefaultAuthorizationKey, Protocol::Mode::Production,
+                                                          QHash<QString, QString>(), true);
+        core->setValue("Prefix", "/opt/app");
+        const QString text("@Prefix@/lib@Unknown@ @LibDir@");
+        QCOMPARE(core->replaceVariables(text), QLatin1String("/opt/app/lib "));
+        QCOMPARE(core->replaceVariables(text.toUtf8()), QByteArray("/opt/app/lib "));
+
+        // The cached template sees changed and newly set variables.
+        core->setValue("Prefix", "/usr");
+        core->setValue("LibDir", "/usr/lib");
+        QCOMPARE(core->replaceVariables(text), QLatin1String("/usr/lib /usr/lib"));
+        QCOMPARE(core->replaceVariables(text.toUtf8()), QByteArray("/usr/lib /usr/lib"));
+
+        core->deleteLater();
+    }
+
     void testToFromNativeSeparators_data()
     {
         QTest::addColumn<QString>("path");
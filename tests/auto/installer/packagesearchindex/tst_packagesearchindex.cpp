@@ -0,0 +1,221 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <localpackagehub.h>
+#include <packagesearchindex.h>
+#include <updatefinder.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_PackageSearchIndex : public QObject
+{
+    Q_OBJECT
+
+private:
+    void writeUpdatesXml(const QString &displayName = QLatin1String("Qt Tools"))
+    {
+        QFile file(m_repository.path() + QLatin1String("/Updates.xml"));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("<Updates>\n"
+            " <ApplicationName>{AnyApplication}</ApplicationName>\n"
+            " <ApplicationVersion>1.0.0</ApplicationVersion>\n");
+        writePackage(&file, "org.qt", "Qt");
+        writePackage(&file, "org.qt.tools", displayName.toUtf8());
+        writePackage(&file, "org.qt.color", "Color");
+        writePackage(&file, "org.qt.virtualroot", "Virtual root", true);
+        writePackage(&file, "org.qt.virtualroot.child", "Child of virtual root");
+        writePackage(&file, "com.example.editor", "Editor");
+        file.write("</Updates>\n");
+    }
+
+    void writePackage(QFile *file, const QByteArray &name, const QByteArray &displayName,
+        bool virtualPackage = false)
+    {
+        file->write(" <PackageUpdate>\n  <Name>" + name + "</Name>\n  <DisplayName>"
+            + displayName + "</DisplayName>\n  <Version>1.0.0</Version>\n"
+            "  <ReleaseDate>2023-01-01</ReleaseDate>\n");
+        if (virtualPackage)
+            file->write("  <Virtual>true</Virtual>\n");
+        file->write(" </PackageUpdate>\n");
+    }
+
+    QSet<PackageSource> sources() const
+    {
+        QSet<PackageSource> sources;
+        sources.insert(PackageSource(QUrl::fromLocalFile(m_repository.path()), 0));
+        return sources;
+    }
+
+    void buildIndex(PackageSearchIndex *index)
+    {
+        KDUpdater::UpdateFinder finder;
+        finder.setAutoDelete(false);
+        finder.setPackageSources(sources());
+        finder.setLocalPackageHub(m_packageHub);
+        finder.run();
+        QCOMPARE(finder.updates().count(), 6);
+        index->build(finder.updates());
+    }
+
+    static QStringList names(const QList<PackageSearchIndex::Entry> &entries)
+    {
+        QStringList result;
+        for (const PackageSearchIndex::Entry &entry : entries)
+            result.append(entry.name());
+        result.sort();
+        return result;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_repository.isValid());
+        writeUpdatesXml();
+    }
+
+    void testSearch_data()
+    {
+        QTest::addColumn<QString>("regexp");
+        QTest::addColumn<QStringList>("expected");
+
+        QTest::newRow("literal") << "tools" << (QStringList() << "org.qt.tools");
+        QTest::newRow("case insensitive") << "TOOLS" << (QStringList() << "org.qt.tools");
+        QTest::newRow("optional character") << "colou?r" << (QStringList() << "org.qt.color");
+        QTest::newRow("wildcard between literals") << "org.*tools"
+            << (QStringList() << "org.qt.tools");
+        QTest::newRow("anchored") << "^com" << (QStringList() << "com.example.editor");
+        QTest::newRow("escaped, full scan") << "^com\\.example" << (QStringList()
+            << "com.example.editor");
+        QTest::newRow("alternation, full scan") << "(editor|tools)" << (QStringList()
+            << "com.example.editor" << "org.qt.tools");
+        QTest::newRow("short literal") << "qt" << (QStringList()
+            << "org.qt" << "org.qt.color" << "org.qt.tools");
+        QTest::newRow("no match") << "xyz" << QStringList();
+        QTest::newRow("match all") << ".*" << (QStringList() << "com.example.editor"
+            << "org.qt" << "org.qt.color" << "org.qt.tools");
+    }
+
+    void testSearch()
+    {
+        QFETCH(QString, regexp);
+        QFETCH(QStringList, expected);
+
+        PackageSearchIndex index;
+        buildIndex(&index);
+        QCOMPARE(index.count(), 6);
+        QCOMPARE(names(index.search(regexp, QHash<QString, QString>())), expected);
+    }
+
+    void testFilters()
+    {
+        PackageSearchIndex index;
+        buildIndex(&index);
+
+        QHash<QString, QString> filters;
+        filters.insert(QLatin1String("DisplayName"), QLatin1String("^qt t"));
+        QCOMPARE(names(index.search(QLatin1String(".*"), filters)),
+            QStringList() << "org.qt.tools");
+
+        filters.insert(QLatin1String("Description"), QLatin1String(".*"));
+        QVERIFY(index.search(QLatin1String(".*"), filters).isEmpty());
+    }
+
+    void testVirtualComponents()
+    {
+        PackageSearchIndex index;
+        buildIndex(&index);
+
+        // Virtual components and their descendants are hidden unless requested.
+        QVERIFY(index.search(QLatin1String("virtualroot"), QHash<QString, QString>()).isEmpty());
+        QCOMPARE(names(index.search(QLatin1String("virtualroot"), QHash<QString, QString>(), true)),
+            QStringList() << "org.qt.virtualroot" << "org.qt.virtualroot.child");
+    }
+
+    void testSaveAndLoad()
+    {
+        QTemporaryDir cacheDir;
+        QVERIFY(cacheDir.isValid());
+        const QString fileName = cacheDir.path() + QLatin1String("/searchindex.dat");
+        const QByteArray fingerprint = PackageSearchIndex::fingerprint(sources(),
+            QLatin1String("Application"));
+        QVERIFY(!fingerprint.isEmpty());
+
+        PackageSearchIndex index;
+        buildIndex(&index);
+        QVERIFY(!index.save(fileName)); // no fingerprint set
+        index.setFingerprint(fingerprint);
+        QVERIFY(index.save(fileName));
+
+        PackageSearchIndex loaded;
+        QVERIFY(loaded.load(fileName, fingerprint));
+        QCOMPARE(loaded.count(), index.count());
+        QCOMPARE(loaded.fingerprint(), fingerprint);
+        QCOMPARE(names(loaded.search(QLatin1String("tools"), QHash<QString, QString>())),
+            QStringList() << "org.qt.tools");
+        QVERIFY(loaded.search(QLatin1String("virtualroot"), QHash<QString, QString>()).isEmpty());
+
+        // Another application name or changed Updates.xml files invalidate the saved index.
+        QVERIFY(!loaded.load(fileName, PackageSearchIndex::fingerprint(sources(),
+            QLatin1String("Other"))));
+        QVERIFY(loaded.isEmpty());
+
+        writeUpdatesXml(QLatin1String("Qt Tools Updated"));
+        const QByteArray changedFingerprint = PackageSearchIndex::fingerprint(sources(),
+            QLatin1String("Application"));
+        QVERIFY(changedFingerprint != fingerprint);
+        QVERIFY(!loaded.load(fileName, changedFingerprint));
+        QVERIFY(loaded.isEmpty());
+
+        writeUpdatesXml();
+        QCOMPARE(PackageSearchIndex::fingerprint(sources(), QLatin1String("Application")),
+            fingerprint);
+    }
+
+    void testRemoteSourceHasNoFingerprint()
+    {
+        QSet<PackageSource> remote;
+        remote.insert(PackageSource(QUrl(QLatin1String("https://example.com/repository")), 0));
+        QVERIFY(PackageSearchIndex::fingerprint(remote, QLatin1String("Application")).isEmpty());
+
+        PackageSearchIndex index;
+        QVERIFY(!index.load(QLatin1String("searchindex.dat"), QByteArray()));
+    }
+
+private:
+    QTemporaryDir m_repository;
+    std::shared_ptr<KDUpdater::LocalPackageHub> m_packageHub
+        = std::make_shared<KDUpdater::LocalPackageHub>();
+};
+
+QTEST_MAIN(tst_PackageSearchIndex)
+
+#include "tst_packagesearchindex.moc"
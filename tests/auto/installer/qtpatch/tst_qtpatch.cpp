@@ -0,0 +1,157 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <qtpatch.h>
+
+#include <QFile>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+
+class tst_QtPatch : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QByteArray padded(const QByteArray &newPath, const QByteArray &oldPath)
+    {
+        return newPath + QByteArray(oldPath.size() - newPath.size(), '\0');
+    }
+
+    static QByteArray randomData(int size)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; ++i) // printable bytes that never start an old path
+            data[i] = char('a' + QRandomGenerator::global()->bounded(26));
+        return data;
+    }
+
+    static bool writeFile(const QString &fileName, const QByteArray &data)
+    {
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+    }
+
+    static QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    }
+
+private slots:
+    void testPatchBinaryFiles()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        const QByteArray oldQtPath("/home/build/Qt/5.15.2/gcc_64");
+        const QByteArray oldPrefix("/opt/qt-build-prefix");
+        const QByteArray newQtPath("/opt/Qt/5.15.2/gcc_64");
+        const QByteArray newPrefix("/usr/local/qt");
+        QHash<QByteArray, QByteArray> paths;
+        paths.insert(oldQtPath, newQtPath);
+        paths.insert(oldPrefix, newPrefix);
+
+        QStringList fileNames;
+        QList<QByteArray> expected;
+        for (int i = 0; i < 8; ++i) {
+            // old paths at the start, in the middle, next to each other and at the end
+            QByteArray data = oldQtPath + randomData(100 + i * 1000) + oldPrefix + oldQtPath
+                + randomData(64) + oldPrefix + randomData(i) + oldQtPath;
+            if (i == 0)
+                data = randomData(256); // nothing to patch
+
+            const QString fileName = dir.filePath(QString::fromLatin1("lib%1.so").arg(i));
+            QVERIFY(writeFile(fileName, data));
+            fileNames.append(fileName);
+
+            expected.append(data.replace(oldQtPath, padded(newQtPath, oldQtPath))
+                .replace(oldPrefix, padded(newPrefix, oldPrefix)));
+        }
+
+        const QString emptyFile = dir.filePath(QLatin1String("empty.so"));
+        QVERIFY(writeFile(emptyFile, QByteArray()));
+        fileNames.append(emptyFile);
+        expected.append(QByteArray());
+
+        QStringList failedFiles;
+        QVERIFY(QtPatch::patchBinaryFiles(fileNames, paths, &failedFiles));
+        QVERIFY(failedFiles.isEmpty());
+        for (int i = 0; i < fileNames.count(); ++i) {
+            const QByteArray patched = readFile(fileNames.at(i));
+            QCOMPARE(patched.size(), expected.at(i).size());
+            QVERIFY2(patched == expected.at(i), qPrintable(fileNames.at(i)));
+            QVERIFY(!patched.contains(oldQtPath));
+            QVERIFY(!patched.contains(oldPrefix));
+        }
+    }
+
+    void testMissingFile()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        const QString existing = dir.filePath(QLatin1String("existing.so"));
+        QVERIFY(writeFile(existing, QByteArray("xx/old/pathxx")));
+        const QString missing = dir.filePath(QLatin1String("missing.so"));
+
+        QHash<QByteArray, QByteArray> paths;
+        paths.insert(QByteArray("/old/path"), QByteArray("/new"));
+
+        QStringList failedFiles;
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QLatin1String("not found")));
+        QVERIFY(!QtPatch::patchBinaryFiles(QStringList() << existing << missing, paths,
+            &failedFiles));
+        QCOMPARE(failedFiles, QStringList() << missing);
+        QCOMPARE(readFile(existing), QByteArray("xx/new\0\0\0\0\0xx", 13));
+    }
+
+    void testLongerNewPathIsRejected()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        const QByteArray data("xx/old/pathxx");
+        const QString fileName = dir.filePath(QLatin1String("lib.so"));
+        QVERIFY(writeFile(fileName, data));
+
+        QHash<QByteArray, QByteArray> paths;
+        paths.insert(QByteArray("/old/path"), QByteArray("/a/much/longer/new/path"));
+
+        QStringList failedFiles;
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QLatin1String("is longer than")));
+        QVERIFY(!QtPatch::patchBinaryFiles(QStringList(fileName), paths, &failedFiles));
+        QCOMPARE(failedFiles, QStringList(fileName));
+        QCOMPARE(readFile(fileName), data);
+    }
+};
+
+QTEST_MAIN(tst_QtPatch)
+
+#include "tst_qtpatch.moc"
@@ -0,0 +1,202 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <relocationstage.h>
+#include <replaceoperation.h>
+#include <streamreplacer.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+typedef QVector<QPair<QString, QString>> Replacements;
+
+class tst_relocationstage : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString writeFile(const QString &name, const QByteArray &content)
+    {
+        QFile file(m_tempDir.path() + QLatin1Char('/') + name);
+        if (!file.open(QIODevice::WriteOnly))
+            return QString();
+        file.write(content);
+        return file.fileName();
+    }
+
+    QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+    }
+
+    void testReplaceStrings_data()
+    {
+        QTest::addColumn<QString>("content");
+        QTest::addColumn<Replacements>("replacements");
+
+        QTest::newRow("placeholders") << "prefix=@TargetDir@\nlib=@TargetDir@/lib @Version@ @@\n"
+            << Replacements { { "@TargetDir@", "/opt/app" }, { "@Version@", "1.2.3" } };
+        QTest::newRow("replacement creates placeholder") << "@A@B@ @B@"
+            << Replacements { { "@A@", "@" }, { "@B@", "b" } };
+        QTest::newRow("replacement in later search") << "/opt/app /opt"
+            << Replacements { { "/opt", "/usr" }, { "/usr/app", "/x" } };
+        QTest::newRow("empty replacement") << "a@V@b@V@c"
+            << Replacements { { "@V@", "" }, { "ab", "x" } };
+        QTest::newRow("overlapping searches") << "acbbcbcbccbc"
+            << Replacements { { "bbc", "y" }, { "cbb", "yy" } };
+        QTest::newRow("overlapping replacement") << "cbabbacbcccbaa"
+            << Replacements { { "abb", "yy" }, { "cba", "yxy" } };
+        QTest::newRow("empty search ignored") << "abc"
+            << Replacements { { "", "x" }, { "b", "y" } };
+    }
+
+    void testReplaceStrings()
+    {
+        QFETCH(QString, content);
+        QFETCH(Replacements, replacements);
+
+        QString expected = content;
+        for (const auto &replacement : replacements) {
+            if (!replacement.first.isEmpty())
+                expected.replace(replacement.first, replacement.second);
+        }
+
+        const QString fileName = writeFile(QLatin1String("replace.txt"), content.toUtf8());
+        for (int chunkSize : { 1, 2, 3, 5, 1024 }) {
+            QVERIFY(writeFile(QLatin1String("replace.txt"), content.toUtf8()) == fileName);
+            StreamReplacer replacer(fileName);
+            replacer.setChunkSize(chunkSize);
+            QCOMPARE(replacer.replaceStrings(replacements), StreamReplacer::NoError);
+            QCOMPARE(QString::fromUtf8(readFile(fileName)), expected);
+        }
+    }
+
+    void testAddOperation()
+    {
+        ReplaceOperation stringOperation(nullptr);
+        stringOperation.setArguments(QStringList() << "file" << "@A@" << "a" << "string");
+        ReplaceOperation defaultModeOperation(nullptr);
+        defaultModeOperation.setArguments(QStringList() << "file" << "@B@" << "b");
+        ReplaceOperation regexOperation(nullptr);
+        regexOperation.setArguments(QStringList() << "file" << "@C@" << "c" << "regex");
+        ReplaceOperation adminOperation(nullptr);
+        adminOperation.setArguments(QStringList() << "file" << "@D@" << "d");
+        adminOperation.setValue(QLatin1String("admin"), true);
+
+        RelocationStage stage;
+        QVERIFY(stage.addOperation(&stringOperation));
+        QVERIFY(stage.addOperation(&defaultModeOperation));
+        QVERIFY(!stage.addOperation(&regexOperation));
+        QVERIFY(!stage.addOperation(&adminOperation));
+        QCOMPARE(stage.count(), 2);
+        QCOMPARE(stage.fileNames(), QStringList() << "file");
+    }
+
+    void testRun()
+    {
+        const QByteArray content = "prefix=@TargetDir@\nlibdir=@TargetDir@/lib\nversion=@Version@\n"
+            "relocatable=@RELOCATABLE_PATH@/bin\n";
+        const Replacements replacements {
+            { "@TargetDir@", "/opt/app" },
+            { "@Version@", "1.2.3" },
+            { "@RELOCATABLE_PATH@", "/opt/app" }
+        };
+
+        RelocationStage stage;
+        QStringList files;
+        for (int i = 0; i < 8; ++i) {
+            files.append(writeFile(QString::fromLatin1("file%1.pc").arg(i), content));
+            for (const auto &replacement : replacements)
+                QVERIFY(stage.addReplacement(files.last(), replacement.first, replacement.second));
+        }
+        QVERIFY(stage.addReplacement(m_tempDir.path() + "/missing.pc", "@TargetDir@", "/opt/app"));
+
+        QVERIFY(!stage.run());
+        QCOMPARE(stage.failedFiles(), QStringList() << QDir::cleanPath(m_tempDir.path() + "/missing.pc"));
+
+        QString expected = QString::fromLatin1(content);
+        for (const auto &replacement : replacements)
+            expected.replace(replacement.first, replacement.second);
+        for (const QString &file : qAsConst(files))
+            QCOMPARE(QString::fromLatin1(readFile(file)), expected);
+    }
+
+    void testRunOperations()
+    {
+        const QString fileName = writeFile(QLatin1String("operations.pc"), "@A@ @B@\n");
+        const QString missing = m_tempDir.path() + QLatin1String("/missing-operations.pc");
+
+        ReplaceOperation first(nullptr);
+        first.setArguments(QStringList() << fileName << "@A@" << "a");
+        ReplaceOperation second(nullptr);
+        second.setArguments(QStringList() << fileName << "@B@" << "b");
+        ReplaceOperation third(nullptr);
+        third.setArguments(QStringList() << missing << "@C@" << "c");
+
+        RelocationStage stage;
+        QVERIFY(stage.addOperation(&first));
+        QVERIFY(stage.addOperation(&second));
+        QVERIFY(stage.addOperation(&third));
+        QVERIFY(!stage.run());
+        QCOMPARE(readFile(fileName), QByteArray("a b\n"));
+
+        QVERIFY(first.value(QLatin1String("relocated")).toBool());
+        QVERIFY(second.value(QLatin1String("relocated")).toBool());
+        QVERIFY(!third.hasValue(QLatin1String("relocated")));
+
+        // Relocated operations only confirm the result and must not replace again.
+        QVERIFY(writeFile(QLatin1String("operations.pc"), "@A@ @B@\n") == fileName);
+        QVERIFY(first.performOperation());
+        QVERIFY(second.performOperation());
+        QCOMPARE(readFile(fileName), QByteArray("@A@ @B@\n"));
+        QVERIFY(!first.hasValue(QLatin1String("relocated")));
+
+        // Operations the stage could not process perform the replacement themselves.
+        QVERIFY(!third.performOperation());
+        QCOMPARE(third.error(), ReplaceOperation::UserDefinedError);
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_MAIN(tst_relocationstage)
+
+#include "tst_relocationstage.moc"
@@ -30,11 +30,13 @@
 #include <fileutils.h>
 #include <replaceoperation.h>
 #include <packagemanagercore.h>
+#include <streamreplacer.h>
 
 #include <QDir>
 #include <QFile>
 #include <QTest>
 #include <QRandomGenerator>
+#include <QRegularExpression>
 
 using namespace KDUpdater;
 using namespace QInstaller;
@@ -175,6 +177,86 @@ private slots:
         QVERIFY(QDir().rmdir(m_testDirectory));
     }
 
+    void testChunkedReplace_data()
+    {
+        QTest::addColumn<QString>("mode");
+        QTest::addColumn<QString>("before");
+        QTest::addColumn<QString>("after");
+
+        QTest::newRow("string") << "string" << "dolore" << "test";
+        QTest::newRow("single character") << "string" << "o" << "0";
+        QTest::newRow("overlapping") << "string" << "aa" << "b";
+        QTest::newRow("regex") << "regex" << "[-+]?[0-9]*\\.?[0-9]+" << "number-match";
+        QTest::newRow("regex capture") << "regex" << "<i>([^<]*)</i>" << "\\emph{\\1}";
+        QTest::newRow("regex anchors") << "regex" << "^L|\\.$" << "#";
+        QTest::newRow("regex word boundary") << "regex" << "\\bdo\\b" << "DO";
+        QTest::newRow("regex empty match") << "regex" << "x*" << "-";
+    }
+
+    void testChunkedReplace()
+    {
+        QFETCH(QString, mode);
+        QFETCH(QString, before);
+        QFETCH(QString, after);
+
+        const QString content = QLatin1String("Lorem ipsum dolore sit amet, aaa do <i>bon mot</i> "
+            "1.2345 | 0.00001 | 7 | consectetur do adipiscing elit, sed do eiusmod tempor.");
+        QString expected = content;
+        if (mode == QLatin1String("regex"))
+            expected.replace(QRegularExpression(before), after);
+        else
+            expected.replace(before, after);
+
+        QVERIFY(QDir().mkpath(m_testDirectory));
+        for (int chunkSize = 1; chunkSize <= content.size() + 1; ++chunkSize) {
+            QFile file(m_testFilePath);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(content.toUtf8());
+            file.close();
+
+            StreamReplacer replacer(m_testFilePath);
+            replacer.setChunkSize(chunkSize);
+            const StreamReplacer::Status status = (mode == QLatin1String("regex"))
+                ? replacer.replaceRegularExpression(QRegularExpression(before), after)
+                : replacer.replaceString(before, after);
+            QCOMPARE(status, StreamReplacer::NoError);
+
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            QCOMPARE(QString::fromUtf8(file.readAll()), expected);
+            file.close();
+        }
+        QVERIFY(QFile::remove(m_testFilePath));
+        QVERIFY(QDir().rmdir(m_testDirectory));
+    }
+
+    void testReplaceInReadOnlyDirectory()
+    {
+#ifdef Q_OS_WIN
+        QSKIP("Directory permissions do not prevent creating files on Windows.");
+#endif
+        QVERIFY(QDir().mkpath(m_testDirectory));
+        QFile file(m_testFilePath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("one two one\n");
+        file.close();
+
+        // No temporary file can be created next to the file, it is rewritten in place.
+        const QFile::Permissions permissions = QFile::permissions(m_testDirectory);
+        QVERIFY(QFile::setPermissions(m_testDirectory, QFile::ReadOwner | QFile::ExeOwner));
+
+        StreamReplacer replacer(m_testFilePath);
+        QCOMPARE(replacer.replaceString(QLatin1String("one"), QLatin1String("three")),
+            StreamReplacer::NoError);
+        QCOMPARE(replacer.replacementCount(), 2);
+
+        QVERIFY(QFile::setPermissions(m_testDirectory, permissions));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), QByteArray("three two three\n"));
+        file.close();
+        QVERIFY(QFile::remove(m_testFilePath));
+        QVERIFY(QDir().rmdir(m_testDirectory));
+    }
+
     void testPerformingFromCLI()
     {
         QVERIFY(QDir().mkpath(m_testDirectory));
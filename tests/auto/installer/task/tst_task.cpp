@@ -30,10 +30,15 @@
 #include <downloadfiletask.h>
 #include <fileio.h>
 
+#include <QFileInfo>
 #include <QFutureWatcher>
 #include <QSignalSpy>
-#include <QTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
+#include <QTest>
+#include <QTimer>
 
 using namespace QInstaller;
 
@@ -111,6 +116,55 @@ private slots:
             QCOMPARE(result.checkSum().toHex(), QByteArray("85304f87b8d90554a63c6f6d1e9cc974fbef8d32"));
         }
     }
+
+    void downloadFilesWithConcurrencyLimit()
+    {
+        // HTTP stand-in answering each request after a short delay, recording
+        // the highest number of requests that were in flight at the same time.
+        QTcpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        int inFlight = 0;
+        int maxInFlight = 0;
+        connect(&server, &QTcpServer::newConnection, [&]() {
+            while (QTcpSocket *socket = server.nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, socket, [&, socket]() {
+                    const QByteArray request = socket->property("request").toByteArray()
+                        + socket->readAll();
+                    socket->setProperty("request", request);
+                    if (!request.endsWith("\r\n\r\n"))
+                        return;
+                    socket->setProperty("request", QByteArray());
+                    maxInFlight = qMax(maxInFlight, ++inFlight);
+                    QTimer::singleShot(20, socket, [&, socket]() {
+                        --inFlight;
+                        socket->write("HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\ndata");
+                    });
+                });
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+
+        QTemporaryDir targetDir;
+        QVERIFY(targetDir.isValid());
+        const QString baseUrl = QString::fromLatin1("http://127.0.0.1:%1/").arg(server.serverPort());
+        QList<FileTaskItem> items;
+        for (int i = 0; i < 10; ++i) {
+            items.append(FileTaskItem(baseUrl + QString::number(i),
+                targetDir.filePath(QString::number(i))));
+        }
+
+        DownloadFileTask fileTask(items);
+        fileTask.setMaxConcurrentDownloads(4, 2);
+        QFutureWatcher<FileTaskResult> watcher;
+        watcher.setFuture(QtConcurrent::run(&DownloadFileTask::doTask, &fileTask));
+        QTRY_VERIFY_WITH_TIMEOUT(watcher.isFinished(), 10000);
+
+        QCOMPARE(watcher.future().resultCount(), 10);
+        QVERIFY(maxInFlight > 0);
+        QVERIFY(maxInFlight <= 2);
+        foreach (const FileTaskResult &result, watcher.future().results())
+            QCOMPARE(QFileInfo(result.target()).size(), 4);
+    }
 };
 
 QTEST_MAIN(tst_Task)
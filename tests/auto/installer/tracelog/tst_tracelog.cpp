@@ -0,0 +1,163 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <errors.h>
+#include <tracelog.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_tracelog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init()
+    {
+        QVERIFY(m_tempDir.isValid());
+        m_traceFile = m_tempDir.filePath(QLatin1String("installer.trace"));
+    }
+
+    void cleanup()
+    {
+        TraceLog::instance().close();
+    }
+
+    void testDisabledByDefault()
+    {
+        QVERIFY(!TraceLog::instance().isEnabled());
+        QCOMPARE(TraceLog::instance().timestamp(), qint64(-1));
+        {
+            TraceSpan span(TraceLog::Operation, QLatin1String("perform"));
+        }
+        QVERIFY(!QFile::exists(m_traceFile));
+    }
+
+    void testRecordSpans()
+    {
+        QVERIFY(TraceLog::instance().open(m_traceFile));
+        {
+            TraceSpan span(TraceLog::Operation, QLatin1String("perform"), QLatin1String("A Copy"));
+        }
+        {
+            TraceSpan span(TraceLog::Script, QLatin1String("createOperations"));
+            span.setDetail(QLatin1String("B"));
+        }
+        TraceLog::instance().addSpan(TraceLog::Download, QLatin1String("download archive"),
+            QLatin1String("http://localhost/repo/A/1.0.0content.7z"), 10, 25);
+        TraceLog::instance().close();
+
+        const QList<TraceEvent> events = TraceReader::read(m_traceFile);
+        QCOMPARE(events.count(), 3);
+        QCOMPARE(events.at(0).category, TraceLog::Operation);
+        QCOMPARE(events.at(0).name, QLatin1String("perform"));
+        QCOMPARE(events.at(0).detail, QLatin1String("A Copy"));
+        QCOMPARE(events.at(1).category, TraceLog::Script);
+        QCOMPARE(events.at(1).detail, QLatin1String("B"));
+        QCOMPARE(events.at(2).start, qint64(10));
+        QCOMPARE(events.at(2).duration, qint64(15));
+        QCOMPARE(events.at(2).detail, QLatin1String("http://localhost/repo/A/1.0.0content.7z"));
+    }
+
+    void testRingBufferWraps()
+    {
+        QVERIFY(TraceLog::instance().open(m_traceFile, 4));
+        for (int i = 0; i < 6; ++i) {
+            TraceLog::instance().addSpan(TraceLog::Generic, QString::number(i), QString(),
+                i * 10, i * 10 + 5);
+        }
+        TraceLog::instance().close();
+
+        const QList<TraceEvent> events = TraceReader::read(m_traceFile);
+        QCOMPARE(events.count(), 4);
+        QCOMPARE(events.first().sequence, quint64(3));
+        QCOMPARE(events.first().name, QLatin1String("2"));
+        QCOMPARE(events.last().name, QLatin1String("5"));
+    }
+
+    void testTruncatesLongDetailFromStart()
+    {
+        QVERIFY(TraceLog::instance().open(m_traceFile));
+        const QString detail = QString(200, QLatin1Char('x')) + QLatin1String("/archive.7z");
+        TraceLog::instance().addSpan(TraceLog::Download, QLatin1String("download archive"),
+            detail, 0, 1);
+        TraceLog::instance().close();
+
+        const QList<TraceEvent> events = TraceReader::read(m_traceFile);
+        QCOMPARE(events.count(), 1);
+        QVERIFY(events.first().detail.length() < detail.length());
+        QVERIFY(events.first().detail.endsWith(QLatin1String("/archive.7z")));
+    }
+
+    void testChromeTrace()
+    {
+        QVERIFY(TraceLog::instance().open(m_traceFile));
+        TraceLog::instance().addSpan(TraceLog::Metadata, QLatin1String("parse Updates.xml"),
+            QString(), 100, 300);
+        TraceLog::instance().close();
+
+        const QJsonDocument doc = QJsonDocument::fromJson(
+            TraceReader::toChromeTrace(TraceReader::read(m_traceFile)));
+        const QJsonArray events = doc.object().value(QLatin1String("traceEvents")).toArray();
+        QCOMPARE(events.count(), 1);
+        const QJsonObject event = events.first().toObject();
+        QCOMPARE(event.value(QLatin1String("name")).toString(), QLatin1String("parse Updates.xml"));
+        QCOMPARE(event.value(QLatin1String("cat")).toString(), QLatin1String("metadata"));
+        QCOMPARE(event.value(QLatin1String("ph")).toString(), QLatin1String("X"));
+        QCOMPARE(event.value(QLatin1String("ts")).toDouble(), 100.0);
+        QCOMPARE(event.value(QLatin1String("dur")).toDouble(), 200.0);
+    }
+
+    void testReadInvalidFile()
+    {
+        QFile file(m_traceFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(128, 'a'));
+        file.close();
+
+        try {
+            TraceReader::read(m_traceFile);
+            QFAIL("Reading an invalid trace file should throw.");
+        } catch (const Error &) {
+        }
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+    QString m_traceFile;
+};
+
+QTEST_MAIN(tst_tracelog)
+
+#include "tst_tracelog.moc"
@@ -0,0 +1,165 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <binarycontent.h>
+#include <binarycreator.h>
+#include <binaryformat.h>
+#include <fileio.h>
+#include <repositorygen.h>
+
+#ifdef IFW_LIB7Z
+#include <lib7z_facade.h>
+#endif
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_binarycreator : public QObject
+{
+    Q_OBJECT
+
+private:
+    bool writeFile(const QString &fileName, const QByteArray &content)
+    {
+        if (!QDir().mkpath(QFileInfo(fileName).absolutePath()))
+            return false;
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly) && file.write(content) == content.size();
+    }
+
+    QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+private slots:
+    void initTestCase()
+    {
+#ifdef Q_OS_MACOS
+        QSKIP("The installer data is written into an application bundle on macOS.");
+#endif
+#ifdef IFW_LIB7Z
+        Lib7z::initSevenZ();
+#endif
+        QVERIFY(m_dir.isValid());
+
+        m_configFile = m_dir.path() + "/config/config.xml";
+        QVERIFY(writeFile(m_configFile, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Installer>\n"
+            "    <Name>test</Name>\n    <Version>1.0.0</Version>\n</Installer>\n"));
+        // Only appended to, no need for a real installerbase
+        m_templateBinary = m_dir.path() + "/installerbase";
+        QVERIFY(writeFile(m_templateBinary, QByteArray(4096, 'x')));
+
+        // A package with a prebuilt data archive
+        m_packagesDir = m_dir.path() + "/packages";
+        QVERIFY(writeFile(m_packagesDir + "/A/meta/package.xml", "<?xml version=\"1.0\" "
+            "encoding=\"UTF-8\"?>\n<Package>\n    <DisplayName>A</DisplayName>\n"
+            "    <Description>Component A</Description>\n    <Version>1.0.0</Version>\n"
+            "    <ReleaseDate>2023-01-01</ReleaseDate>\n</Package>\n"));
+        QVERIFY(writeFile(m_dir.path() + "/content/file.txt", QByteArray("content\n").repeated(1000)));
+        m_archive = m_packagesDir + "/A/data/content.7z";
+        QVERIFY(QDir().mkpath(QFileInfo(m_archive).absolutePath()));
+        QInstallerTools::createArchive(m_archive, QStringList() << m_dir.path() + "/content",
+            QInstallerTools::Compression::Non);
+        m_archiveData = readFile(m_archive);
+        QVERIFY(!m_archiveData.isEmpty());
+    }
+
+    void testPrebuiltArchive_data()
+    {
+        QTest::addColumn<bool>("copyArchives");
+        QTest::newRow("Stream from package directory") << false;
+        QTest::newRow("Copy archives") << true;
+    }
+
+    void testPrebuiltArchive()
+    {
+        QFETCH(bool, copyArchives);
+
+        QInstallerTools::BinaryCreatorArgs args;
+        args.target = m_dir.path() + (copyArchives ? "/installer-copied" : "/installer-streamed");
+        args.configFile = m_configFile;
+        args.templateBinary = m_templateBinary;
+        args.packagesDirectories << m_packagesDir;
+        args.streamComponentData = !copyArchives; // --copy-archives
+
+        QString argumentError;
+        QCOMPARE(QInstallerTools::createBinary(args, argumentError), EXIT_SUCCESS);
+        QVERIFY(argumentError.isEmpty());
+#ifdef Q_OS_WIN
+        args.target += ".exe";
+#endif
+
+        QFile binary(args.target);
+        QInstaller::openForRead(&binary);
+        ResourceCollectionManager manager;
+        qint64 magicMarker = 0;
+        BinaryContent::readBinaryContent(&binary, nullptr, &manager, &magicMarker,
+            BinaryContent::MagicCookie);
+        QVERIFY(magicMarker == BinaryContent::MagicInstallerMarker);
+
+        // The archive is appended unchanged, with the hash of the source file
+        const ResourceCollection collection = manager.collectionByName("A");
+        const QSharedPointer<Resource> archive = collection.resourceByName("A-1.0.0-content.7z");
+        QVERIFY(archive);
+        QVERIFY(archive->open());
+        QCOMPARE(archive->readAll(), m_archiveData);
+        archive->close();
+
+        const QSharedPointer<Resource> hash = collection.resourceByName("A-1.0.0-content.7z.sha1");
+        QVERIFY(hash);
+        QVERIFY(hash->open());
+        QCOMPARE(hash->readAll(), QCryptographicHash::hash(m_archiveData,
+            QCryptographicHash::Sha1).toHex());
+        hash->close();
+
+        // The package directory is left as it was
+        QCOMPARE(QDir(QFileInfo(m_archive).absolutePath()).entryList(QDir::Files),
+            QStringList() << "content.7z");
+        QCOMPARE(readFile(m_archive), m_archiveData);
+    }
+
+private:
+    QTemporaryDir m_dir;
+    QString m_configFile;
+    QString m_templateBinary;
+    QString m_packagesDir;
+    QString m_archive;
+    QByteArray m_archiveData;
+};
+
+QTEST_MAIN(tst_binarycreator)
+
+#include "tst_binarycreator.moc"
@@ -0,0 +1,158 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <repositorygen.h>
+#include <repositorygen.cpp>
+#include <binarydelta.h>
+#include <init.h>
+
+#ifdef IFW_LIB7Z
+#include <lib7z_facade.h>
+#endif
+
+#include <QDomDocument>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTest>
+
+class tst_repodelta : public QObject
+{
+    Q_OBJECT
+
+private:
+    bool writeFile(const QString &fileName, const QByteArray &content)
+    {
+        if (!QDir().mkpath(QFileInfo(fileName).absolutePath()))
+            return false;
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly) && file.write(content) == content.size();
+    }
+
+    QByteArray readFile(const QString &fileName)
+    {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+        return file.readAll();
+    }
+
+    // Writes component A with the given version and data files to packageDir.
+    bool writePackage(const QString &packageDir, const QString &version,
+        const QHash<QString, QByteArray> &files)
+    {
+        const QByteArray packageXml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Package>\n"
+            "    <DisplayName>A</DisplayName>\n    <Description>Component A</Description>\n"
+            "    <Version>" + version.toLatin1() + "</Version>\n"
+            "    <ReleaseDate>2023-01-01</ReleaseDate>\n</Package>\n";
+        if (!writeFile(packageDir + "/A/meta/package.xml", packageXml))
+            return false;
+        for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+            if (!writeFile(packageDir + "/A/data/content/" + it.key(), it.value()))
+                return false;
+        }
+        return true;
+    }
+
+    void generateRepo(const QString &packageDir, bool createDeltas)
+    {
+        QInstallerTools::RepositoryInfo info;
+        info.packages << packageDir;
+        info.repositoryDir = m_repositoryDir;
+
+        QStringList filteredPackages;
+        QInstallerTools::PackageInfoVector packages = QInstallerTools::collectPackages(info,
+            &filteredPackages, QInstallerTools::Exclude, false, QStringList());
+
+        QTemporaryDir tmpMetaDir;
+        QInstallerTools::createRepository(info, &packages, tmpMetaDir.path(), true, false,
+            QLatin1String("7z"), QInstallerTools::Compression::Non, createDeltas);
+    }
+
+private slots:
+    void initTestCase()
+    {
+#ifdef IFW_LIB7Z
+        Lib7z::initSevenZ();
+#endif
+        QVERIFY(m_dir.isValid());
+        m_repositoryDir = m_dir.path() + "/repository";
+    }
+
+    void testDeltaOfStoredArchiveIsKept()
+    {
+        // A typical component: many files, of which an update changes only a few.
+        QHash<QString, QByteArray> files;
+        QRandomGenerator generator(42);
+        for (int i = 0; i < 64; ++i) {
+            QByteArray content;
+            while (content.size() < 16 * 1024)
+                content += QByteArray::number(generator.generate64(), 36) + '\n';
+            files.insert(QString::fromLatin1("lib/file%1.txt").arg(i), content);
+        }
+        QVERIFY(writePackage(m_dir.path() + "/packages1", "1.0.0", files));
+        generateRepo(m_dir.path() + "/packages1", false);
+
+        const QString base = m_repositoryDir + "/A-1.0.0-content.7z";
+        QVERIFY(QFileInfo::exists(base));
+
+        files[QLatin1String("lib/file10.txt")].replace(100, 8, "modified");
+        files.insert(QLatin1String("lib/added.txt"), QByteArray("a new file\n").repeated(100));
+        QVERIFY(writePackage(m_dir.path() + "/packages2", "2.0.0", files));
+        generateRepo(m_dir.path() + "/packages2", true);
+
+        const QString archive = m_repositoryDir + "/A-2.0.0-content.7z";
+        const QString delta = m_repositoryDir + "/A-2.0.0-content.7z.from-1.0.0.delta";
+        QVERIFY(QFileInfo::exists(archive));
+        QVERIFY2(QFileInfo::exists(delta), "The delta was discarded.");
+        QVERIFY(QFileInfo(delta).size() < QFileInfo(archive).size() / 10);
+
+        QDomDocument doc;
+        QVERIFY(doc.setContent(readFile(m_repositoryDir + "/Updates.xml")));
+        const QDomElement deltaElement = doc.documentElement().firstChildElement("PackageUpdate")
+            .firstChildElement("DeltaArchives").firstChildElement("DeltaArchive");
+        QCOMPARE(deltaElement.attribute("archive"), QLatin1String("A-2.0.0-content.7z"));
+        QCOMPARE(deltaElement.attribute("base"), QLatin1String(QInstaller::calculateHash(base,
+            QCryptographicHash::Sha1).toHex()));
+        QCOMPARE(deltaElement.text(), QLatin1String("A-2.0.0-content.7z.from-1.0.0.delta"));
+
+        // The installer rebuilds the published archive from the base archive and the delta.
+        const QString rebuilt = m_dir.path() + "/rebuilt.7z";
+        const QByteArray sha1 = QInstaller::BinaryDelta::apply(base, delta, rebuilt);
+        QCOMPARE(sha1.toHex(), readFile(archive + ".sha1"));
+        QCOMPARE(readFile(rebuilt), readFile(archive));
+    }
+
+private:
+    QTemporaryDir m_dir;
+    QString m_repositoryDir;
+};
+
+QTEST_MAIN(tst_repodelta)
+
+#include "tst_repodelta.moc"
@@ -0,0 +1,6 @@
+include(../auto/qttest.pri)
+
+# Benchmarks are not run by 'make check', use run-benchmarks.py instead.
+CONFIG += benchmark
+INCLUDEPATH += $$PWD/shared
+HEADERS += $$PWD/shared/repositorygenerator.h
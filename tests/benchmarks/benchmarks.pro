@@ -0,0 +1,22 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    metadata \
+    metadatacache \
+    compareversion \
+    componenttree \
+    installercalculator \
+    binarylayout \
+    filecopy \
+    replace \
+    variables \
+    qtpatch \
+    remotefileengine
+
+CONFIG(libarchive) {
+    SUBDIRS += libarchiveextract
+}
+
+CONFIG(lzmasdk) {
+    SUBDIRS += lib7zextract
+}
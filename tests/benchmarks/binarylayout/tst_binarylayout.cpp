@@ -0,0 +1,147 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "repositorygenerator.h"
+
+#include <binarycontent.h>
+#include <binaryformat.h>
+#include <binarylayout.h>
+#include <errors.h>
+#include <fileio.h>
+
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+static const qint64 scExecutableSize = 72704LL;
+static const int scOperationCount = 100;
+
+class tst_binarylayout : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString binaryPath(int count) const
+    {
+        return m_tempDir.path() + QLatin1String("/binary_") + QString::number(count);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        const QStringList data = RepositoryGenerator::writeDataFiles(m_tempDir.path()
+            + QLatin1String("/data"), 1, 1024);
+        QCOMPARE(data.count(), 1);
+
+        QList<OperationBlob> operations;
+        for (int i = 0; i < scOperationCount; ++i) {
+            operations.append(OperationBlob(QLatin1String("Mkdir"),
+                QString::fromLatin1("<operation name=\"Mkdir\"><arguments><argument>"
+                "@TargetDir@/dir%1</argument></arguments></operation>").arg(i)));
+        }
+
+        // One collection per component, as created by the binarycreator for offline installers
+        try {
+            foreach (int count, RepositoryGenerator::scales()) {
+                ResourceCollectionManager manager;
+                for (int i = 0; i < count; ++i) {
+                    ResourceCollection collection(RepositoryGenerator::componentName(i).toUtf8());
+                    collection.appendResource(QSharedPointer<Resource>(new Resource(data.first(),
+                        QByteArray("1.0.0content.7z"))));
+                    manager.insertCollection(collection);
+                }
+
+                QFile binary(binaryPath(count));
+                QInstaller::openForWrite(&binary);
+                QInstaller::blockingWrite(&binary, QByteArray(scExecutableSize, '1'));
+                BinaryContent::writeBinaryContent(&binary, operations, manager,
+                    BinaryContent::MagicInstallerMarker, BinaryContent::MagicCookie);
+            }
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+    }
+
+    void binaryLayout_data()
+    {
+        RepositoryGenerator::addScaleData();
+    }
+
+    void binaryLayout()
+    {
+        QFETCH(int, components);
+
+        try {
+            QBENCHMARK {
+                QFile binary(binaryPath(components));
+                QInstaller::openForRead(&binary);
+                const BinaryLayout layout = BinaryContent::binaryLayout(&binary,
+                    BinaryContent::MagicCookie);
+                QCOMPARE(layout.endOfExectuable, scExecutableSize);
+            }
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+    }
+
+    void readBinaryContent_data()
+    {
+        RepositoryGenerator::addScaleData();
+    }
+
+    void readBinaryContent()
+    {
+        QFETCH(int, components);
+
+        try {
+            QBENCHMARK {
+                QFile binary(binaryPath(components));
+                QInstaller::openForRead(&binary);
+
+                qint64 magicMarker = 0;
+                QList<OperationBlob> operations;
+                ResourceCollectionManager manager;
+                BinaryContent::readBinaryContent(&binary, &operations, &manager, &magicMarker,
+                    BinaryContent::MagicCookie);
+                QCOMPARE(operations.count(), scOperationCount);
+                QCOMPARE(manager.collectionCount(), components);
+            }
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_MAIN(tst_binarylayout)
+
+#include "tst_binarylayout.moc"
@@ -0,0 +1,5 @@
+include(../benchmark.pri)
+
+QT -= gui
+
+SOURCES += tst_compareversion.cpp
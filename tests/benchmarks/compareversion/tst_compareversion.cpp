@@ -0,0 +1,82 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "repositorygenerator.h"
+
+#include <updater.h>
+
+#include <QTest>
+
+class tst_compareversion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void compareVersion_data()
+    {
+        QTest::addColumn<QStringList>("left");
+        QTest::addColumn<QStringList>("right");
+
+        QStringList left;
+        QStringList right;
+        for (int i = 0; i < 10000; ++i) {
+            left.append(RepositoryGenerator::componentVersion(i));
+            right.append(RepositoryGenerator::componentVersion(i + 1));
+        }
+        QTest::newRow("generated") << left << right;
+
+        left.clear();
+        right.clear();
+        const QStringList versions = QStringList() << QLatin1String("1.0.0")
+            << QLatin1String("1.0.0-1") << QLatin1String("5.15.2-0-202011130602")
+            << QLatin1String("6.5.0-0-202303241041") << QLatin1String("1.0.0.0.0.1")
+            << QLatin1String("1.2.x") << QLatin1String("2.0.0-beta") << QLatin1String("10");
+        for (int i = 0; i < 10000; ++i) {
+            left.append(versions.at(i % versions.count()));
+            right.append(versions.at((i * 3 + 1) % versions.count()));
+        }
+        QTest::newRow("mixed") << left << right;
+    }
+
+    void compareVersion()
+    {
+        QFETCH(QStringList, left);
+        QFETCH(QStringList, right);
+
+        int result = 0;
+        QBENCHMARK {
+            for (int i = 0; i < left.count(); ++i)
+                result += KDUpdater::compareVersion(left.at(i), right.at(i));
+        }
+        Q_UNUSED(result)
+    }
+};
+
+QTEST_MAIN(tst_compareversion)
+
+#include "tst_compareversion.moc"
@@ -0,0 +1,6 @@
+include(../benchmark.pri)
+
+QT -= gui
+QT += qml network xml
+
+SOURCES += tst_componenttree.cpp
@@ -0,0 +1,86 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "../../auto/installer/shared/packagemanager.h"
+#include "repositorygenerator.h"
+
+#include <component.h>
+#include <packagemanagercore.h>
+#include <settings.h>
+
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_componenttree : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString repositoryPath(int count) const
+    {
+        return m_tempDir.path() + QLatin1String("/repository_") + QString::number(count);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        foreach (int count, RepositoryGenerator::scales())
+            QVERIFY(RepositoryGenerator::writeRepository(repositoryPath(count), count));
+    }
+
+    void fetchRemotePackagesTree_data()
+    {
+        RepositoryGenerator::addScaleData();
+    }
+
+    void fetchRemotePackagesTree()
+    {
+        QFETCH(int, components);
+
+        const QString targetDir = m_tempDir.path() + QLatin1String("/target");
+        QScopedPointer<PackageManagerCore> core(PackageManager::getPackageManagerWithInit(targetDir,
+            repositoryPath(components)));
+        core->settings().setLocalCachePath(m_tempDir.path() + QLatin1String("/cache"));
+
+        QBENCHMARK {
+            QVERIFY(core->fetchRemotePackagesTree());
+        }
+        QCOMPARE(core->components(PackageManagerCore::ComponentType::AllNoReplacements).count(),
+            components);
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_MAIN(tst_componenttree)
+
+#include "tst_componenttree.moc"
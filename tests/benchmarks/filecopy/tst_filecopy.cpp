@@ -0,0 +1,90 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "repositorygenerator.h"
+
+#include <errors.h>
+#include <fileutils.h>
+
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+Q_DECLARE_METATYPE(QInstaller::FileCopyMethod)
+
+class tst_filecopy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        m_files = RepositoryGenerator::writeDataFiles(m_tempDir.path() + QLatin1String("/source"),
+            1, 256 * 1024 * 1024);
+        QCOMPARE(m_files.count(), 1);
+    }
+
+    void copyFile_data()
+    {
+        QTest::addColumn<FileCopyMethod>("method");
+        QTest::newRow("Automatic") << FileCopyMethod::Automatic;
+        QTest::newRow("Clone") << FileCopyMethod::Clone;
+        QTest::newRow("CopyFileRange") << FileCopyMethod::CopyFileRange;
+        QTest::newRow("SendFile") << FileCopyMethod::SendFile;
+        QTest::newRow("Buffered") << FileCopyMethod::Buffered;
+    }
+
+    void copyFile()
+    {
+        QFETCH(FileCopyMethod, method);
+
+        const QString target = m_tempDir.path() + QLatin1String("/target");
+        try {
+            FileCopyMethod used = method;
+            QBENCHMARK {
+                QFile::remove(target);
+                used = QInstaller::copyFile(m_files.first(), target, method);
+            }
+            if (method != FileCopyMethod::Automatic && used != method)
+                QSKIP("Copy method not supported for the temporary directory.");
+        } catch (const Error &error) {
+            QFAIL(qPrintable(error.message()));
+        }
+        QFile::remove(target);
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+    QStringList m_files;
+};
+
+QTEST_MAIN(tst_filecopy)
+
+#include "tst_filecopy.moc"
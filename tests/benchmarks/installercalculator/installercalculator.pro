@@ -0,0 +1,6 @@
+include(../benchmark.pri)
+
+QT -= gui
+QT += qml
+
+SOURCES += tst_installercalculator.cpp
@@ -0,0 +1,100 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "repositorygenerator.h"
+
+#include <component.h>
+#include <installercalculator.h>
+#include <packagemanagercore.h>
+
+#include <QTest>
+
+using namespace QInstaller;
+
+class NamedComponent : public Component
+{
+public:
+    NamedComponent(PackageManagerCore *core, const QString &name, const QString &version)
+        : Component(core)
+    {
+        setValue(scName, name);
+        setValue(scVersion, version);
+    }
+};
+
+class tst_installercalculator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void solve_data()
+    {
+        RepositoryGenerator::addScaleData();
+    }
+
+    void solve()
+    {
+        QFETCH(int, components);
+
+        QScopedPointer<PackageManagerCore> core(new PackageManagerCore());
+        core->setPackageManager();
+
+        // Mirrors the layout of the generated repositories: one root per group, every
+        // child depends on its previous sibling. Selecting the last child of each group
+        // has to resolve the whole dependency chain of the group.
+        QList<Component *> selected;
+        Component *root = nullptr;
+        for (int i = 0; i < components; ++i) {
+            NamedComponent *component = new NamedComponent(core.data(),
+                RepositoryGenerator::componentName(i), RepositoryGenerator::componentVersion(i));
+            foreach (const QString &dependency, RepositoryGenerator::componentDependencies(i))
+                component->addDependency(dependency);
+
+            if (i % RepositoryGenerator::GroupSize == 0) {
+                root = component;
+                core->appendRootComponent(component);
+            } else {
+                root->appendComponent(component);
+            }
+            if ((i + 1) % RepositoryGenerator::GroupSize == 0 || i == components - 1)
+                selected.append(component);
+        }
+
+        int resolved = 0;
+        QBENCHMARK {
+            InstallerCalculator calc(core.data(), AutoDependencyHash());
+            QVERIFY(calc.solve(selected));
+            resolved = calc.resolvedComponents().count();
+        }
+        QVERIFY(resolved >= selected.count());
+    }
+};
+
+QTEST_MAIN(tst_installercalculator)
+
+#include "tst_installercalculator.moc"
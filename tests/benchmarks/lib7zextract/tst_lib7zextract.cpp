@@ -0,0 +1,91 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "repositorygenerator.h"
+
+#include <lib7z_facade.h>
+#include <lib7zarchive.h>
+
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_lib7zextract : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        Lib7z::initSevenZ();
+        QVERIFY(m_tempDir.isValid());
+    }
+
+    void extract_data()
+    {
+        QTest::addColumn<QString>("suffix");
+        QTest::addColumn<int>("files");
+        QTest::addColumn<int>("size");
+
+        QTest::newRow("7z 1000 x 4KB") << QString::fromLatin1(".7z") << 1000 << 4 * 1024;
+        QTest::newRow("7z 10 x 4MB") << QString::fromLatin1(".7z") << 10 << 4 * 1024 * 1024;
+    }
+
+    void extract()
+    {
+        QFETCH(QString, suffix);
+        QFETCH(int, files);
+        QFETCH(int, size);
+
+        const QString name = QString::fromLatin1("%1_%2").arg(files).arg(size);
+        const QStringList sources = RepositoryGenerator::writeDataFiles(m_tempDir.path()
+            + QLatin1String("/source_") + name, files, size);
+        QCOMPARE(sources.count(), files);
+
+        const QString archiveName = m_tempDir.path() + QLatin1String("/archive_") + name + suffix;
+        Lib7zArchive archive(archiveName);
+        QVERIFY(archive.open(QIODevice::ReadWrite));
+        QVERIFY2(archive.create(sources), qPrintable(archive.errorString()));
+        archive.close();
+
+        const QString targetDir = m_tempDir.path() + QLatin1String("/target_") + name + suffix;
+        QVERIFY(archive.open(QIODevice::ReadOnly));
+        QBENCHMARK {
+            QVERIFY2(archive.extract(targetDir), qPrintable(archive.errorString()));
+        }
+        archive.close();
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_MAIN(tst_lib7zextract)
+
+#include "tst_lib7zextract.moc"
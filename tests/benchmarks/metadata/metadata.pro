@@ -0,0 +1,6 @@
+include(../benchmark.pri)
+
+QT -= gui
+QT += xml
+
+SOURCES += tst_metadata.cpp
@@ -0,0 +1,112 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "repositorygenerator.h"
+
+#include <metadata.h>
+#include <metadatajob.h>
+
+#include <QDomDocument>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_metadata : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString repositoryPath(int count) const
+    {
+        return m_tempDir.path() + QLatin1String("/repository_") + QString::number(count);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        foreach (int count, RepositoryGenerator::scales())
+            QVERIFY(RepositoryGenerator::writeRepository(repositoryPath(count), count));
+    }
+
+    void parseUpdatesDocument_data()
+    {
+        RepositoryGenerator::addScaleData();
+    }
+
+    void parseUpdatesDocument()
+    {
+        QFETCH(int, components);
+
+        int packages = 0;
+        QBENCHMARK {
+            packages = 0;
+            Metadata metadata(repositoryPath(components));
+            const QDomDocument doc = metadata.updatesDocument();
+            const QDomNodeList children = doc.documentElement().childNodes();
+            for (int i = 0; i < children.count(); ++i) {
+                const QDomElement element = children.at(i).toElement();
+                if (element.isNull() || element.tagName() != QLatin1String("PackageUpdate"))
+                    continue;
+
+                QString name;
+                QString version;
+                QString hash;
+                if (MetadataJob::parsePackageUpdate(element.childNodes(), name, version, hash,
+                        true, false)) {
+                    ++packages;
+                }
+            }
+        }
+        QCOMPARE(packages, components);
+    }
+
+    void verifyMetadata_data()
+    {
+        RepositoryGenerator::addScaleData();
+    }
+
+    void verifyMetadata()
+    {
+        QFETCH(int, components);
+
+        QBENCHMARK {
+            Metadata metadata(repositoryPath(components));
+            QVERIFY(metadata.isValid());
+            QVERIFY(!metadata.checksum().isEmpty());
+        }
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_MAIN(tst_metadata)
+
+#include "tst_metadata.moc"
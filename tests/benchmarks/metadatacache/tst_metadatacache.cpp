@@ -0,0 +1,116 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "repositorygenerator.h"
+
+#include <metadatacache.h>
+#include <metadata.h>
+
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_metadatacache : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString cachePath(int count) const
+    {
+        return m_tempDir.path() + QLatin1String("/cache_") + QString::number(count);
+    }
+
+    void addItemCountData()
+    {
+        QTest::addColumn<int>("items");
+        QTest::newRow("10") << 10;
+        QTest::newRow("100") << 100;
+        QTest::newRow("1k") << 1000;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+
+        // Every cached repository gets a different size so that the checksums differ
+        const QString sourcePath = m_tempDir.path() + QLatin1String("/source_");
+        for (int i = 0; i < 1000; ++i) {
+            QVERIFY(RepositoryGenerator::writeRepository(sourcePath + QString::number(i),
+                10 + i));
+        }
+
+        foreach (int count, QList<int>() << 10 << 100 << 1000) {
+            MetadataCache cache(cachePath(count));
+            QVERIFY2(cache.isValid(), qPrintable(cache.errorString()));
+            for (int i = 0; i < count; ++i)
+                QVERIFY(cache.registerItem(new Metadata(sourcePath + QString::number(i))));
+            QVERIFY2(cache.sync(), qPrintable(cache.errorString()));
+        }
+    }
+
+    void load_data()
+    {
+        addItemCountData();
+    }
+
+    void load()
+    {
+        QFETCH(int, items);
+
+        QBENCHMARK {
+            MetadataCache cache(cachePath(items));
+            QVERIFY2(cache.isValid(), qPrintable(cache.errorString()));
+            QCOMPARE(cache.items().count(), items);
+        }
+    }
+
+    void sync_data()
+    {
+        addItemCountData();
+    }
+
+    void sync()
+    {
+        QFETCH(int, items);
+
+        MetadataCache cache(cachePath(items));
+        QVERIFY2(cache.isValid(), qPrintable(cache.errorString()));
+        QBENCHMARK {
+            QVERIFY2(cache.sync(), qPrintable(cache.errorString()));
+        }
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_MAIN(tst_metadatacache)
+
+#include "tst_metadatacache.moc"
@@ -0,0 +1,153 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <qtpatch.h>
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace QInstaller;
+
+static const int scFileSize = 4 * 1024 * 1024;
+static const int scPathInterval = 256 * 1024;
+
+class tst_qtpatch : public QObject
+{
+    Q_OBJECT
+
+private:
+    QHash<QByteArray, QByteArray> forwardPaths() const
+    {
+        QHash<QByteArray, QByteArray> paths;
+        paths.insert("/home/builder/work/build/qtbase", "/opt/Qt/6.5.0/gcc_64");
+        paths.insert("/home/builder/work/install/qt-6.5.0/plugins", "/opt/Qt/6.5.0/gcc_64/plugins");
+        paths.insert("/home/builder/work/install/qt-6.5.0/translations", "/opt/Qt/6.5.0/gcc_64/translations");
+        return paths;
+    }
+
+    QHash<QByteArray, QByteArray> equalLengthPaths(bool forward) const
+    {
+        // paths of the same length, so a benchmark iteration can undo the previous one
+        QHash<QByteArray, QByteArray> paths;
+        const QByteArray first = "/home/builder/work/install/qt-6.5.0";
+        const QByteArray second = "/opt/Qt/6.5.0/gcc_64/xxxxxxxxxxxxxx";
+        const QByteArray third = "/home/builder/work/build/qtbase/lib";
+        const QByteArray fourth = "/opt/Qt/6.5.0/gcc_64/lib/xxxxxxxxxx";
+        if (forward) {
+            paths.insert(first, second);
+            paths.insert(third, fourth);
+        } else {
+            paths.insert(second, first);
+            paths.insert(fourth, third);
+        }
+        return paths;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+
+        // 256 MB by default, 5 GB in 1280 files when large benchmarks are enabled
+        const int fileCount = qEnvironmentVariableIsSet("IFW_BENCHMARK_LARGE") ? 1280 : 64;
+
+        QByteArray content(scFileSize, '\0');
+        for (int i = 0; i < scFileSize; ++i)
+            content[i] = char((i * 131 + i / 7) % 251);
+
+        const QList<QByteArray> oldPaths = equalLengthPaths(true).keys();
+        for (int offset = 0, i = 0; offset + 64 < scFileSize; offset += scPathInterval, ++i) {
+            const QByteArray &path = oldPaths.at(i % oldPaths.count());
+            content.replace(offset, path.size() + 1, path + '\0');
+        }
+
+        for (int i = 0; i < fileCount; ++i) {
+            const QString dir = m_tempDir.path() + QString::fromLatin1("/lib%1").arg(i % 16);
+            QVERIFY(QDir().mkpath(dir));
+            QFile file(dir + QString::fromLatin1("/libQt6Module%1.so").arg(i));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            QCOMPARE(file.write(content), qint64(content.size()));
+            m_files.append(file.fileName());
+        }
+    }
+
+    void patchBinaryFileSequential()
+    {
+        bool forward = true;
+        QBENCHMARK {
+            const QHash<QByteArray, QByteArray> paths = equalLengthPaths(forward);
+            for (const QString &fileName : qAsConst(m_files)) {
+                for (auto it = paths.constBegin(); it != paths.constEnd(); ++it)
+                    QVERIFY(QtPatch::patchBinaryFile(fileName, it.key(), it.value()));
+            }
+            forward = !forward;
+        }
+        if (!forward)
+            QVERIFY(QtPatch::patchBinaryFiles(m_files, equalLengthPaths(false)));
+    }
+
+    void patchBinaryFiles()
+    {
+        bool forward = true;
+        QBENCHMARK {
+            QStringList failed;
+            QVERIFY(QtPatch::patchBinaryFiles(m_files, equalLengthPaths(forward), &failed));
+            QVERIFY(failed.isEmpty());
+            forward = !forward;
+        }
+        if (!forward)
+            QVERIFY(QtPatch::patchBinaryFiles(m_files, equalLengthPaths(false)));
+    }
+
+    void verifyPatchedContent()
+    {
+        const QString fileName = m_files.first();
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray original = file.readAll();
+        file.close();
+
+        QVERIFY(QtPatch::patchBinaryFiles(QStringList() << fileName, forwardPaths()));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray patched = file.readAll();
+        file.close();
+
+        QCOMPARE(patched.size(), original.size());
+        QVERIFY(!patched.contains("/home/builder/work/build/qtbase"));
+        QVERIFY(patched.contains(QByteArray("/opt/Qt/6.5.0/gcc_64") + '\0'));
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+    QStringList m_files;
+};
+
+QTEST_MAIN(tst_qtpatch)
+
+#include "tst_qtpatch.moc"
@@ -0,0 +1,6 @@
+include(../benchmark.pri)
+
+QT -= gui
+QT += network
+
+SOURCES += tst_remotefileengine.cpp
@@ -0,0 +1,135 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <protocol.h>
+#include <remoteclient.h>
+#include <remotefileengine.h>
+#include <remoteserver.h>
+
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QTest>
+#include <QUuid>
+
+using namespace QInstaller;
+
+static const int scFileSize = 4 * 1024 * 1024;
+
+class tst_remotefileengine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_file.open());
+        QCOMPARE(m_file.write(QByteArray(scFileSize, 'x')), qint64(scFileSize));
+        m_file.close();
+
+        const QString socketName = QUuid::createUuid().toString();
+        m_server.init(socketName, QLatin1String("SomeKey"), Protocol::Mode::Production);
+        m_server.start();
+
+        RemoteClient::instance().init(socketName, QLatin1String("SomeKey"), Protocol::Mode::Debug,
+                                      Protocol::StartAs::User);
+        RemoteClient::instance().setActive(true);
+        QVERIFY(RemoteClient::instance().isActive());
+
+        // All file access below goes through the server process connection
+        m_handler.reset(new RemoteFileEngineHandler);
+    }
+
+    void cleanupTestCase()
+    {
+        m_handler.reset();
+        RemoteClient::instance().setActive(false);
+    }
+
+    void read_data()
+    {
+        QTest::addColumn<int>("chunkSize");
+        QTest::newRow("4KB chunks") << 4 * 1024;
+        QTest::newRow("64KB chunks") << 64 * 1024;
+        QTest::newRow("1MB chunks") << 1024 * 1024;
+    }
+
+    void read()
+    {
+        QFETCH(int, chunkSize);
+
+        QByteArray buffer(chunkSize, '\0');
+        QBENCHMARK {
+            QFile file(m_file.fileName());
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            qint64 total = 0;
+            qint64 bytesRead = 0;
+            while ((bytesRead = file.read(buffer.data(), chunkSize)) > 0)
+                total += bytesRead;
+            QCOMPARE(total, qint64(scFileSize));
+        }
+    }
+
+    void write_data()
+    {
+        read_data();
+    }
+
+    void write()
+    {
+        QFETCH(int, chunkSize);
+
+        const QByteArray buffer(chunkSize, 'y');
+        QBENCHMARK {
+            QFile file(m_file.fileName() + QLatin1String(".out"));
+            QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+            for (int written = 0; written < scFileSize; written += chunkSize)
+                QCOMPARE(file.write(buffer), qint64(chunkSize));
+        }
+        QFile::remove(m_file.fileName() + QLatin1String(".out"));
+    }
+
+    void fileInfo()
+    {
+        QBENCHMARK {
+            for (int i = 0; i < 100; ++i) {
+                QFileInfo info(m_file.fileName());
+                QVERIFY(info.exists());
+                QCOMPARE(info.size(), qint64(scFileSize));
+            }
+        }
+    }
+
+private:
+    RemoteServer m_server;
+    QTemporaryFile m_file;
+    QScopedPointer<RemoteFileEngineHandler> m_handler;
+};
+
+QTEST_MAIN(tst_remotefileengine)
+
+#include "tst_remotefileengine.moc"
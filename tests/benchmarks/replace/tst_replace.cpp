@@ -0,0 +1,154 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <linereplaceoperation.h>
+#include <replaceoperation.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace QInstaller;
+
+class tst_replace : public QObject
+{
+    Q_OBJECT
+
+private:
+    static qint64 peakResidentSize()
+    {
+#ifdef Q_OS_UNIX
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MACOS
+            return usage.ru_maxrss;
+#else
+            return qint64(usage.ru_maxrss) * 1024;
+#endif
+        }
+#endif
+        return -1;
+    }
+
+    void writeFile(qint64 size)
+    {
+        QFile file(m_fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (qint64 i = 0, written = 0; written < size; ++i) {
+            const QByteArray number = QByteArray::number(i);
+            const QByteArray line = "set(CMAKE_LIBRARY_PATH_" + number + " \"/opt/prefix/lib/path_"
+                + number + "\" CACHE PATH \"Library path\")\n";
+            QCOMPARE(file.write(line), qint64(line.size()));
+            written += line.size();
+        }
+    }
+
+    void reportMemory(qint64 before)
+    {
+        const qint64 after = peakResidentSize();
+        if (before >= 0 && after >= 0)
+            qDebug("Peak resident size grew by %lld kB", (after - before) / 1024);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        m_fileName = m_tempDir.path() + QLatin1String("/CMakeCache.txt");
+    }
+
+    void replace_data()
+    {
+        QTest::addColumn<qint64>("size");
+        QTest::addColumn<QString>("mode");
+        QTest::addColumn<QString>("before");
+        QTest::addColumn<QString>("after");
+
+        const QList<qint64> sizes = { 16 * 1024 * 1024, 256 * 1024 * 1024 };
+        for (const qint64 size : sizes) {
+            const QByteArray scale = QByteArray::number(size / (1024 * 1024)) + "MB";
+            QTest::newRow(scale + ":string") << size << QString::fromLatin1("string")
+                << QString::fromLatin1("/opt/prefix") << QString::fromLatin1("/usr/local");
+            QTest::newRow(scale + ":regex") << size << QString::fromLatin1("regex")
+                << QString::fromLatin1("/opt/(\\w+)/lib") << QString::fromLatin1("/usr/\\1/lib64");
+        }
+    }
+
+    void replace()
+    {
+        QFETCH(qint64, size);
+        QFETCH(QString, mode);
+        QFETCH(QString, before);
+        QFETCH(QString, after);
+
+        writeFile(size);
+        const qint64 memoryBefore = peakResidentSize();
+        QBENCHMARK {
+            ReplaceOperation operation(nullptr);
+            operation.setArguments(QStringList() << m_fileName << before << after << mode);
+            QVERIFY2(operation.performOperation(), qPrintable(operation.errorString()));
+        }
+        reportMemory(memoryBefore);
+        QFile::remove(m_fileName);
+    }
+
+    void lineReplace_data()
+    {
+        QTest::addColumn<qint64>("size");
+        QTest::newRow("16MB") << qint64(16 * 1024 * 1024);
+        QTest::newRow("256MB") << qint64(256 * 1024 * 1024);
+    }
+
+    void lineReplace()
+    {
+        QFETCH(qint64, size);
+
+        writeFile(size);
+        const qint64 memoryBefore = peakResidentSize();
+        QBENCHMARK {
+            LineReplaceOperation operation(nullptr);
+            operation.setArguments(QStringList() << m_fileName << QLatin1String("set(CMAKE_LIBRARY_PATH_1")
+                << QLatin1String("set(CMAKE_LIBRARY_PATH_1 \"/usr/local/lib\")"));
+            QVERIFY2(operation.performOperation(), qPrintable(operation.errorString()));
+        }
+        reportMemory(memoryBefore);
+        QFile::remove(m_fileName);
+    }
+
+private:
+    QTemporaryDir m_tempDir;
+    QString m_fileName;
+};
+
+QTEST_MAIN(tst_replace)
+
+#include "tst_replace.moc"
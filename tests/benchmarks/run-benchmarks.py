@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+#############################################################################
+##
+## Copyright (C) 2023 The Qt Company Ltd.
+## Contact: https://www.qt.io/licensing/
+##
+## This file is part of the Qt Installer Framework.
+##
+## $QT_BEGIN_LICENSE:GPL-EXCEPT$
+## Commercial License Usage
+## Licensees holding valid commercial Qt licenses may use this file in
+## accordance with the commercial license agreement provided with the
+## Software or, alternatively, in accordance with the terms contained in
+## a written agreement between you and The Qt Company. For licensing terms
+## and conditions see https://www.qt.io/terms-conditions. For further
+## information use the contact form at https://www.qt.io/contact-us.
+##
+## GNU General Public License Usage
+## Alternatively, this file may be used under the terms of the GNU
+## General Public License version 3 as published by the Free Software
+## Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+## included in the packaging of this file. Please review the following
+## information to ensure the GNU General Public License requirements will
+## be met: https://www.gnu.org/licenses/gpl-3.0.html.
+##
+## $QT_END_LICENSE$
+##
+#############################################################################
+
+"""Runs the installer framework benchmarks and writes the results as JSON.
+
+QtTest cannot emit JSON, so every benchmark binary is run with the XML logger
+and the BenchmarkResult elements are collected into a single document. When
+a baseline is given, results that got slower than the threshold are reported
+and the script exits with a non-zero status.
+"""
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+import xml.etree.ElementTree as ET
+
+
+def find_benchmarks(build_dir):
+    benchmarks = []
+    for root, _, files in os.walk(build_dir):
+        for name in files:
+            path = os.path.join(root, name)
+            base, ext = os.path.splitext(name)
+            if not base.startswith('tst_') or ext not in ('', '.exe'):
+                continue
+            if os.access(path, os.X_OK):
+                benchmarks.append(path)
+    return sorted(benchmarks)
+
+
+def parse_results(benchmark, xml_file):
+    results = []
+    tree = ET.parse(xml_file)
+    for function in tree.getroot().iter('TestFunction'):
+        for result in function.iter('BenchmarkResult'):
+            results.append({
+                'benchmark': benchmark,
+                'function': function.get('name'),
+                'tag': result.get('tag', ''),
+                'metric': result.get('metric'),
+                'value': float(result.get('value')),
+                'iterations': int(result.get('iterations')),
+            })
+    return results
+
+
+def run_benchmark(path, extra_args):
+    benchmark = os.path.splitext(os.path.basename(path))[0][len('tst_'):]
+    fd, xml_file = tempfile.mkstemp(suffix='.xml')
+    os.close(fd)
+    try:
+        status = subprocess.call([path, '-o', xml_file + ',xml'] + extra_args,
+                                 cwd=os.path.dirname(path))
+        results = parse_results(benchmark, xml_file) if os.path.getsize(xml_file) else []
+    finally:
+        os.remove(xml_file)
+    return status, results
+
+
+def result_key(result):
+    return (result['benchmark'], result['function'], result['tag'], result['metric'])
+
+
+def compare(results, baseline_file, threshold):
+    with open(baseline_file) as f:
+        baseline = {result_key(r): r for r in json.load(f)['results']}
+
+    regressions = []
+    for result in results:
+        old = baseline.get(result_key(result))
+        if not old or old['value'] <= 0:
+            continue
+        change = (result['value'] - old['value']) / old['value']
+        if change > threshold:
+            regressions.append((result, old, change))
+
+    for result, old, change in regressions:
+        print('REGRESSION %s::%s(%s): %.3f -> %.3f %s (+%.1f%%)' % (result['benchmark'],
+              result['function'], result['tag'], old['value'], result['value'],
+              result['metric'], change * 100))
+    return not regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('build_dir', help='build directory of tests/benchmarks')
+    parser.add_argument('-o', '--output', default='benchmarks.json',
+                        help='JSON file to write the results to')
+    parser.add_argument('-b', '--baseline', help='JSON results to compare against')
+    parser.add_argument('-t', '--threshold', type=float, default=0.1,
+                        help='relative slowdown reported as a regression (default: 0.1)')
+    parser.add_argument('--large', action='store_true',
+                        help='include the 100k component scale (sets IFW_BENCHMARK_LARGE)')
+    parser.add_argument('args', nargs=argparse.REMAINDER,
+                        help='additional arguments passed to every benchmark, e.g. -- -tickcounter')
+    options = parser.parse_args()
+
+    if options.large:
+        os.environ['IFW_BENCHMARK_LARGE'] = '1'
+    extra_args = [arg for arg in options.args if arg != '--']
+
+    failed = []
+    results = []
+    for path in find_benchmarks(options.build_dir):
+        status, benchmark_results = run_benchmark(path, extra_args)
+        if status != 0:
+            failed.append(path)
+        results.extend(benchmark_results)
+
+    with open(options.output, 'w') as f:
+        json.dump({
+            'platform': platform.platform(),
+            'machine': platform.machine(),
+            'results': results,
+        }, f, indent=2)
+    print('Wrote %d results to %s' % (len(results), options.output))
+
+    for path in failed:
+        print('FAILED %s' % path)
+
+    ok = not failed
+    if options.baseline:
+        ok = compare(results, options.baseline, options.threshold) and ok
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
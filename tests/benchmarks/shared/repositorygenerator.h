@@ -0,0 +1,155 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#ifndef REPOSITORYGENERATOR_H
+#define REPOSITORYGENERATOR_H
+
+#include <QDir>
+#include <QFile>
+#include <QTest>
+#include <QXmlStreamWriter>
+
+/*
+    Generates synthetic online repositories for the benchmarks. Components are grouped under
+    one root per hundred packages, each child depends on its previous sibling. The 100k
+    scale is only added when the IFW_BENCHMARK_LARGE environment variable is set, it takes
+    several minutes per benchmark.
+*/
+struct RepositoryGenerator
+{
+    static const int GroupSize = 100;
+
+    static QList<int> scales()
+    {
+        QList<int> counts;
+        counts << 100 << 10000;
+        if (qEnvironmentVariableIsSet("IFW_BENCHMARK_LARGE"))
+            counts << 100000;
+        return counts;
+    }
+
+    static QString scaleName(int count)
+    {
+        if (count >= 1000 && count % 1000 == 0)
+            return QString::number(count / 1000) + QLatin1Char('k');
+        return QString::number(count);
+    }
+
+    static void addScaleData(const char *column = "components")
+    {
+        QTest::addColumn<int>(column);
+        foreach (int count, scales())
+            QTest::newRow(qPrintable(scaleName(count))) << count;
+    }
+
+    static QString componentName(int index)
+    {
+        const int group = index / GroupSize;
+        if (index % GroupSize == 0)
+            return QString::fromLatin1("bench.g%1").arg(group);
+        return QString::fromLatin1("bench.g%1.c%2").arg(group).arg(index);
+    }
+
+    static QString componentVersion(int index)
+    {
+        return QString::fromLatin1("1.%1.%2-%3").arg(index % 7).arg(index % 13).arg(index % 3);
+    }
+
+    static QStringList componentDependencies(int index)
+    {
+        if (index % GroupSize < 2)
+            return QStringList();
+        return QStringList(componentName(index - 1));
+    }
+
+    static QByteArray updatesXml(int count)
+    {
+        QByteArray data;
+        QXmlStreamWriter writer(&data);
+        writer.setAutoFormatting(true);
+        writer.writeStartElement(QLatin1String("Updates"));
+        writer.writeTextElement(QLatin1String("ApplicationName"), QLatin1String("{AnyApplication}"));
+        writer.writeTextElement(QLatin1String("ApplicationVersion"), QLatin1String("1.0.0"));
+        writer.writeTextElement(QLatin1String("Checksum"), QLatin1String("false"));
+        for (int i = 0; i < count; ++i) {
+            const QString name = componentName(i);
+            writer.writeStartElement(QLatin1String("PackageUpdate"));
+            writer.writeTextElement(QLatin1String("Name"), name);
+            writer.writeTextElement(QLatin1String("DisplayName"), name);
+            writer.writeTextElement(QLatin1String("Description"),
+                QLatin1String("Synthetic benchmark component ") + name);
+            writer.writeTextElement(QLatin1String("Version"), componentVersion(i));
+            writer.writeTextElement(QLatin1String("ReleaseDate"), QLatin1String("2023-01-01"));
+            const QStringList dependencies = componentDependencies(i);
+            if (!dependencies.isEmpty()) {
+                writer.writeTextElement(QLatin1String("Dependencies"),
+                    dependencies.join(QLatin1Char(',')));
+            }
+            writer.writeTextElement(QLatin1String("Default"), QLatin1String("false"));
+            writer.writeStartElement(QLatin1String("UpdateFile"));
+            writer.writeAttribute(QLatin1String("CompressedSize"), QString::number(1024 + i));
+            writer.writeAttribute(QLatin1String("UncompressedSize"), QString::number(4096 + i));
+            writer.writeAttribute(QLatin1String("OS"), QLatin1String("Any"));
+            writer.writeEndElement();
+            writer.writeEndElement();
+        }
+        writer.writeEndElement();
+        return data;
+    }
+
+    static bool writeRepository(const QString &path, int count)
+    {
+        if (!QDir().mkpath(path))
+            return false;
+        QFile file(path + QLatin1String("/Updates.xml"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+        const QByteArray data = updatesXml(count);
+        return file.write(data) == data.size();
+    }
+
+    static QStringList writeDataFiles(const QString &path, int count, int size)
+    {
+        QStringList files;
+        if (!QDir().mkpath(path))
+            return files;
+        QByteArray content(size, '\0');
+        for (int i = 0; i < size; ++i)
+            content[i] = char('a' + (i * 7 + i / 13) % 26);
+        for (int i = 0; i < count; ++i) {
+            QFile file(path + QString::fromLatin1("/file%1.txt").arg(i));
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                return QStringList();
+            file.write(content);
+            files.append(file.fileName());
+        }
+        return files;
+    }
+};
+
+#endif // REPOSITORYGENERATOR_H
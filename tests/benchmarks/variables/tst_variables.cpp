@@ -0,0 +1,111 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include <constants.h>
+#include <packagemanagercore.h>
+
+#include <QTest>
+
+using namespace QInstaller;
+
+class tst_variables : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Arguments as written by component scripts, e.g. for Extract, Copy, or Execute operations.
+    static QStringList arguments(int count, bool unique)
+    {
+        QStringList result;
+        for (int i = 0; i < count; ++i) {
+            const QString number = QString::number(unique ? i : i % 100);
+            result << QLatin1String("@TargetDir@/lib/component_") + number + QLatin1String(".so")
+                << QLatin1String("@TargetDir@/@ProductName@/@ProductVersion@/data_") + number
+                << QLatin1String("plain argument ") + number;
+        }
+        return result;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        m_core.reset(new PackageManagerCore());
+        m_core->setValue(scTargetDir, QLatin1String("/opt/Benchmark"));
+        m_core->setValue(QLatin1String("ProductName"), QLatin1String("Benchmark"));
+        m_core->setValue(QLatin1String("ProductVersion"), QLatin1String("1.0.0"));
+    }
+
+    void replaceVariables_data()
+    {
+        QTest::addColumn<bool>("unique");
+        QTest::addColumn<int>("setValueInterval");
+
+        QTest::newRow("repeated") << false << 0;
+        QTest::newRow("unique") << true << 0;
+        QTest::newRow("repeated:setValue") << false << 1000;
+    }
+
+    void replaceVariables()
+    {
+        QFETCH(bool, unique);
+        QFETCH(int, setValueInterval);
+
+        const QStringList input = arguments(100000, unique);
+        int replaced = 0;
+        QBENCHMARK {
+            replaced = 0;
+            for (int i = 0; i < input.count(); ++i) {
+                if (setValueInterval > 0 && i % setValueInterval == 0)
+                    m_core->setValue(QLatin1String("Counter"), QString::number(i));
+                if (!m_core->replaceVariables(input.at(i)).contains(QLatin1Char('@')))
+                    ++replaced;
+            }
+        }
+        QCOMPARE(replaced, input.count());
+        QCOMPARE(m_core->replaceVariables(input.at(1)),
+            QLatin1String("/opt/Benchmark/Benchmark/1.0.0/data_0"));
+    }
+
+    void replaceVariablesByteArray()
+    {
+        const QByteArray input = "PATH=@TargetDir@/bin:@TargetDir@/@ProductName@/bin\n";
+        QByteArray result;
+        QBENCHMARK {
+            for (int i = 0; i < 100000; ++i)
+                result = m_core->replaceVariables(input);
+        }
+        QCOMPARE(result, QByteArray("PATH=/opt/Benchmark/bin:/opt/Benchmark/Benchmark/bin\n"));
+    }
+
+private:
+    QScopedPointer<PackageManagerCore> m_core;
+};
+
+QTEST_MAIN(tst_variables)
+
+#include "tst_variables.moc"
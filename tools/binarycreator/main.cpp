@@ -83,6 +83,8 @@ static void printUsage()
     std::cout << "                            you omit this option the 7z format will be used as a default." << std::endl;
     std::cout << "  --ac|--compression 0,1,3,5,7,9" << std::endl;
     std::cout << "                            Sets the compression level used when packaging new data archives." << std::endl;
+    std::cout << "  --copy-archives           Copy existing data archives to a temporary repository before" << std::endl;
+    std::cout << "                            appending them, instead of reading them from the package directories." << std::endl;
     std::cout << std::endl;
     std::cout << "Packages are to be found in the current working directory and get listed as "
         "their names" << std::endl << std::endl;
@@ -213,6 +215,8 @@ int main(int argc, char **argv)
                     "Error: Unknown compression level \"%1\".").arg(value));
             }
             parsedArgs.compression = static_cast<AbstractArchive::CompressionLevel>(value);
+        } else if (*it == QLatin1String("--copy-archives")) {
+            parsedArgs.streamComponentData = false;
 #ifdef Q_OS_MACOS
         } else if (*it == QLatin1String("--mt") || *it == QLatin1String("--create-maintenancetool")) {
             parsedArgs.createMaintenanceTool = true;
@@ -12,12 +12,14 @@ DESTDIR = $$IFW_APP_PATH
 
 HEADERS += operationrunner.h \
     binaryreplace.h \
-    binarydump.h
+    binarydump.h \
+    tracesummary.h
 
 SOURCES += main.cpp \
     operationrunner.cpp \
     binaryreplace.cpp \
-    binarydump.cpp
+    binarydump.cpp \
+    tracesummary.cpp
 
 osx:include(../../no_app_bundle.pri)
 
@@ -29,6 +29,7 @@
 #include "binarydump.h"
 #include "binaryreplace.h"
 #include "operationrunner.h"
+#include "tracesummary.h"
 
 #include <binarycontent.h>
 #include <binaryformatenginehandler.h>
@@ -68,6 +69,11 @@ struct Command
         "<binary> <mode,name,args,...>", "The <binary> to run the operation with.\n"
         "<mode,name,args,...> 'mode' can be DO or UNDO. 'name' of the operation. 'args,...' "
         "used to run the operation."
+    },
+
+    { "trace", "Summarizes where time went in a trace file written with the --trace-file option "
+        "of an installer or maintenance tool.", 1, "<tracefile>", "The <tracefile> to summarize. "
+        "Use the --chrome-trace option to also convert it to Chrome trace JSON format."
     }
 };
 
@@ -105,6 +111,9 @@ int main(int argc, char *argv[])
     QCommandLineOption verbose(QLatin1String("verbose"), QLatin1String("Verbose mode. Prints out "
         "more information."));
     parser.addOption(verbose);
+    QCommandLineOption chromeTrace(QLatin1String("chrome-trace"), QLatin1String("Writes the spans "
+        "of the 'trace' command to <file> in Chrome trace JSON format."), QLatin1String("file"));
+    parser.addOption(chromeTrace);
 
     parser.parse(app.arguments());
     if (parser.isSet(version)) {
@@ -164,6 +173,17 @@ int main(int argc, char *argv[])
     QInstaller::init();
     QInstaller::LoggingHandler::instance().setVerbose(parser.isSet(verbose));
 
+    if (command == QLatin1String("trace")) {
+        // Trace files are not bound to a binary, no need to read any binary content.
+        try {
+            TraceSummary summary;
+            return summary.summarize(arguments.first(), parser.value(chromeTrace));
+        } catch (const QInstaller::Error &error) {
+            std::cerr << qPrintable(error.message()) << std::endl;
+        }
+        return EXIT_FAILURE;
+    }
+
     QString bundlePath;
     QString path = QFileInfo(arguments.first()).absoluteFilePath();
     if (QInstaller::isInBundle(path, &bundlePath)) {
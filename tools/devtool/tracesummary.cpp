@@ -0,0 +1,158 @@
+/**************************************************************************
+**
+** Copyright (C) 2023 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Installer Framework.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+**************************************************************************/
+
+#include "tracesummary.h"
+
+#include <errors.h>
+#include <tracelog.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct Aggregate
+{
+    Aggregate() : count(0), total(0), longest(0) {}
+
+    QString label;
+    int count;
+    qint64 total;
+    qint64 longest;
+};
+
+QString formatDuration(qint64 usecs)
+{
+    if (usecs >= 1000000)
+        return QString::fromLatin1("%1 s").arg(double(usecs) / 1000000, 0, 'f', 2);
+    if (usecs >= 1000)
+        return QString::fromLatin1("%1 ms").arg(double(usecs) / 1000, 0, 'f', 2);
+    return QString::fromLatin1("%1 us").arg(usecs);
+}
+
+void printAggregates(QList<Aggregate> aggregates, int limit)
+{
+    std::sort(aggregates.begin(), aggregates.end(), [](const Aggregate &lhs, const Aggregate &rhs) {
+        return lhs.total > rhs.total;
+    });
+    std::cout << "  " << std::setw(12) << std::right << "total" << std::setw(8) << "count"
+        << std::setw(12) << "longest" << "  " << std::left << "span" << std::endl;
+    for (int i = 0; i < aggregates.count() && i < limit; ++i) {
+        const Aggregate &aggregate = aggregates.at(i);
+        std::cout << "  " << std::setw(12) << std::right << qPrintable(formatDuration(aggregate.total))
+            << std::setw(8) << aggregate.count
+            << std::setw(12) << qPrintable(formatDuration(aggregate.longest))
+            << "  " << std::left << qPrintable(aggregate.label) << std::endl;
+    }
+}
+
+} // namespace
+
+int TraceSummary::summarize(const QString &traceFile, const QString &chromeTraceFile)
+{
+    using namespace QInstaller;
+
+    qint64 startTime = 0;
+    const QList<TraceEvent> events = TraceReader::read(traceFile, &startTime);
+
+    if (!chromeTraceFile.isEmpty()) {
+        QFile output(chromeTraceFile);
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << qPrintable(QString::fromLatin1("Cannot open \"%1\" for writing: %2")
+                .arg(QDir::toNativeSeparators(chromeTraceFile), output.errorString())) << std::endl;
+            return EXIT_FAILURE;
+        }
+        output.write(TraceReader::toChromeTrace(events));
+        std::cout << "Wrote " << events.count() << " spans to "
+            << qPrintable(QDir::toNativeSeparators(chromeTraceFile)) << std::endl;
+    }
+
+    if (events.isEmpty()) {
+        std::cout << "The trace file does not contain any spans." << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    qint64 first = events.first().start;
+    qint64 last = 0;
+    QHash<int, Aggregate> categories;
+    QHash<QString, Aggregate> spans;
+    foreach (const TraceEvent &event, events) {
+        first = qMin(first, event.start);
+        last = qMax(last, event.start + event.duration);
+
+        Aggregate &category = categories[event.category];
+        category.label = TraceReader::categoryName(event.category);
+        category.count++;
+        category.total += event.duration;
+        category.longest = qMax(category.longest, event.duration);
+
+        const QString key = category.label + QLatin1String(": ") + event.name;
+        Aggregate &span = spans[key];
+        span.label = key;
+        span.count++;
+        span.total += event.duration;
+        span.longest = qMax(span.longest, event.duration);
+    }
+
+    std::cout << "Trace started " << qPrintable(QDateTime::fromMSecsSinceEpoch(startTime)
+        .toString(Qt::ISODate)) << ", " << events.count() << " spans covering "
+        << qPrintable(formatDuration(last - first)) << "." << std::endl;
+    if (events.first().sequence != 1) {
+        std::cout << "The ring buffer wrapped, the oldest " << (events.first().sequence - 1)
+            << " spans were overwritten." << std::endl;
+    }
+
+    std::cout << std::endl << "Time per category (spans on concurrent threads may overlap):"
+        << std::endl;
+    printAggregates(categories.values(), categories.count());
+
+    std::cout << std::endl << "Top spans by total time:" << std::endl;
+    printAggregates(spans.values(), 20);
+
+    QList<TraceEvent> slowest = events;
+    std::sort(slowest.begin(), slowest.end(), [](const TraceEvent &lhs, const TraceEvent &rhs) {
+        return lhs.duration > rhs.duration;
+    });
+    std::cout << std::endl << "Slowest individual spans:" << std::endl;
+    for (int i = 0; i < slowest.count() && i < 10; ++i) {
+        const TraceEvent &event = slowest.at(i);
+        std::cout << "  " << std::setw(12) << std::right << qPrintable(formatDuration(event.duration))
+            << "  " << std::left << qPrintable(TraceReader::categoryName(event.category))
+            << ": " << qPrintable(event.name);
+        if (!event.detail.isEmpty())
+            std::cout << " (" << qPrintable(event.detail) << ")";
+        std::cout << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -80,6 +80,11 @@ static void printUsage()
     std::cout << "                            you omit this option the 7z format will be used as a default." << std::endl;
     std::cout << "  --ac|--compression 0,1,3,5,7,9" << std::endl;
     std::cout << "                            Sets the compression level used when packaging new data archives." << std::endl;
+    std::cout << "  --delta                   Create binary deltas of updated data archives against the" << std::endl;
+    std::cout << "                            previously published version in the repository. Deltas of" << std::endl;
+    std::cout << "                            compressed archives are rarely smaller, use --ac 0 with it." << std::endl;
+    std::cout << "  --manifests               Create manifests of the files contained in the data archives, so that" << std::endl;
+    std::cout << "                            updates can skip extracting unchanged files." << std::endl;
 
     std::cout << std::endl;
     std::cout << "Example:" << std::endl;
@@ -114,6 +119,8 @@ int main(int argc, char** argv)
         bool updateExistingRepositoryWithNewComponents = false;
         bool createUnifiedMetadata = true;
         bool createComponentMetadata = true;
+        bool createDeltas = false;
+        bool createManifests = false;
         QString archiveSuffix = QLatin1String("7z");
         AbstractArchive::CompressionLevel compression = AbstractArchive::Normal;
 
@@ -203,6 +210,12 @@ int main(int argc, char** argv)
             } else if (args.first() == QLatin1String("--component-metadata")) {
                 createUnifiedMetadata = false;
                 args.removeFirst();
+            } else if (args.first() == QLatin1String("--delta")) {
+                createDeltas = true;
+                args.removeFirst();
+            } else if (args.first() == QLatin1String("--manifests")) {
+                createManifests = true;
+                args.removeFirst();
             } else if (args.first() == QLatin1String("--sha-update") || args.first() == QLatin1String("-s")) {
                 args.removeFirst();
                 packagesUpdatedWithSha = args.first().split(QLatin1Char(','));
@@ -271,7 +284,8 @@ int main(int argc, char** argv)
         tmp.setAutoRemove(false);
         tmpMetaDir = tmp.path();
         QInstallerTools::createRepository(repoInfo, &packages, tmpMetaDir,
-            createComponentMetadata, createUnifiedMetadata, archiveSuffix, compression);
+            createComponentMetadata, createUnifiedMetadata, archiveSuffix, compression, createDeltas,
+            createManifests);
 
         exitCode = EXIT_SUCCESS;
     } catch (const QInstaller::Error &e) {